@@ -21,6 +21,26 @@
 
 #include "anjuta-completion.h"
 
+/* Bonuses of the fuzzy score */
+#define FUZZY_SCORE_MATCH           1
+#define FUZZY_SCORE_BOUNDARY        8
+#define FUZZY_SCORE_CONSECUTIVE     4
+#define FUZZY_SCORE_START           3
+#define FUZZY_GAP_PENALTY_MAX       3
+
+/* Precomputed data of an item for fuzzy matching */
+typedef struct
+{
+    guint64 chars;        /* bit set of the (lower case) characters of the name */
+    guint64 boundaries;   /* word starts in the first 64 bytes of the name */
+} AnjutaCompletionFuzzyInfo;
+
+typedef struct
+{
+    guint index;
+    gint  score;
+} AnjutaCompletionFuzzyMatch;
+
 
 struct _AnjutaCompletionPrivate
 {
@@ -37,6 +57,11 @@ struct _AnjutaCompletionPrivate
     AnjutaCompletionFilterFunc filter_func;
     void*                      filter_func_user_data;
 
+    /* Fuzzy matching, fuzzy_info follows the sorted items */
+    GArray*    fuzzy_info;
+    char*      last_fuzzy;
+    GArray*    last_fuzzy_matches;
+
     /* Properties */
     gboolean   case_sensitive;
 };
@@ -75,6 +100,185 @@ anjuta_completion_item_sort_func (gconstpointer a, gconstpointer b,
         return g_ascii_strcasecmp (name_a, name_b);
 }
 
+static void
+anjuta_completion_sort_items (AnjutaCompletion* self)
+{
+    if (self->priv->items_sorted)
+        return;
+
+    g_ptr_array_sort_with_data (self->priv->items, anjuta_completion_item_sort_func,
+                                self);
+    self->priv->items_sorted = TRUE;
+
+    /* Indexes of the fuzzy data are not valid anymore */
+    g_array_set_size (self->priv->fuzzy_info, 0);
+    g_free (self->priv->last_fuzzy);
+    self->priv->last_fuzzy = NULL;
+}
+
+static inline guint64
+anjuta_completion_char_bit (char c)
+{
+    c = g_ascii_tolower (c);
+    if (c >= 'a' && c <= 'z')
+        return G_GUINT64_CONSTANT (1) << (c - 'a');
+    else if (c >= '0' && c <= '9')
+        return G_GUINT64_CONSTANT (1) << (26 + c - '0');
+    else if (c == '_')
+        return G_GUINT64_CONSTANT (1) << 36;
+    else
+        return G_GUINT64_CONSTANT (1) << (37 + ((guchar)c % 27));
+}
+
+static void
+anjuta_completion_get_fuzzy_info (const char* name,
+                                  AnjutaCompletionFuzzyInfo* info)
+{
+    gint i;
+
+    info->chars = 0;
+    info->boundaries = 0;
+    for (i = 0; name[i] != '\0'; i++)
+    {
+        info->chars |= anjuta_completion_char_bit (name[i]);
+
+        /* A word starts at the beginning, after a separator, on a lower to
+         * upper case change (camel case) and on a letter to digit change */
+        if (i < 64 && g_ascii_isalnum (name[i]) &&
+            (i == 0 ||
+             !g_ascii_isalnum (name[i - 1]) ||
+             (g_ascii_isupper (name[i]) && g_ascii_islower (name[i - 1])) ||
+             (g_ascii_isdigit (name[i]) && g_ascii_isalpha (name[i - 1]))))
+        {
+            info->boundaries |= G_GUINT64_CONSTANT (1) << i;
+        }
+    }
+}
+
+static void
+anjuta_completion_update_fuzzy_info (AnjutaCompletion* self)
+{
+    guint i;
+
+    if (self->priv->fuzzy_info->len == self->priv->items->len)
+        return;
+
+    g_array_set_size (self->priv->fuzzy_info, self->priv->items->len);
+    for (i = 0; i < self->priv->items->len; i++)
+    {
+        void* item = g_ptr_array_index (self->priv->items, i);
+
+        anjuta_completion_get_fuzzy_info (self->priv->name_func (item),
+                                          &g_array_index (self->priv->fuzzy_info,
+                                                          AnjutaCompletionFuzzyInfo, i));
+    }
+}
+
+static inline gboolean
+anjuta_completion_char_equal (char a, char b, gboolean case_sensitive)
+{
+    return case_sensitive ? a == b : g_ascii_tolower (a) == g_ascii_tolower (b);
+}
+
+/*
+ * Returns the score of name for pattern, or -1 if pattern is not a
+ * subsequence of name. With prefer_boundaries, the characters are taken at
+ * word starts when the next one does not match, so "gab" scores better on
+ * get_active_buffer than on garbage. This can miss a match, which taking
+ * the first matching character never does.
+ */
+static gint
+anjuta_completion_fuzzy_score_pass (const char* name,
+                                    const AnjutaCompletionFuzzyInfo* info,
+                                    const char* pattern,
+                                    gboolean case_sensitive,
+                                    gboolean prefer_boundaries)
+{
+    const char* p;
+    gint last;
+    gint score;
+
+    score = 0;
+    last = -1;
+    for (p = pattern; *p != '\0'; p++)
+    {
+        gint pos;
+        gint next;
+
+        pos = last + 1;
+        next = -1;
+        if (prefer_boundaries && pos < 64 && name[pos] != '\0' &&
+            !anjuta_completion_char_equal (name[pos], *p, case_sensitive))
+        {
+            guint64 boundaries;
+
+            /* Look at the following word starts */
+            boundaries = info->boundaries >> pos << pos;
+            while (boundaries)
+            {
+                gint start = g_bit_nth_lsf (boundaries, -1);
+
+                if (anjuta_completion_char_equal (name[start], *p, case_sensitive))
+                {
+                    next = start;
+                    break;
+                }
+                boundaries &= ~(G_GUINT64_CONSTANT (1) << start);
+            }
+        }
+
+        /* Or the first matching character */
+        for (; next < 0 && name[pos] != '\0'; pos++)
+        {
+            if (anjuta_completion_char_equal (name[pos], *p, case_sensitive))
+                next = pos;
+        }
+        if (next < 0)
+            return -1;
+
+        score += FUZZY_SCORE_MATCH;
+        if (next == 0)
+            score += FUZZY_SCORE_START;
+        if (next < 64 && (info->boundaries & (G_GUINT64_CONSTANT (1) << next)))
+            score += FUZZY_SCORE_BOUNDARY;
+        if (last >= 0 && next == last + 1)
+            score += FUZZY_SCORE_CONSECUTIVE;
+        else if (last >= 0)
+            score -= MIN (next - last - 1, FUZZY_GAP_PENALTY_MAX);
+        last = next;
+    }
+
+    return score;
+}
+
+static gint
+anjuta_completion_fuzzy_score (const char* name,
+                               const AnjutaCompletionFuzzyInfo* info,
+                               const char* pattern,
+                               gboolean case_sensitive)
+{
+    gint score;
+
+    score = anjuta_completion_fuzzy_score_pass (name, info, pattern,
+                                                case_sensitive, TRUE);
+    if (score < 0)
+        score = anjuta_completion_fuzzy_score_pass (name, info, pattern,
+                                                    case_sensitive, FALSE);
+    return score;
+}
+
+static gint
+anjuta_completion_fuzzy_match_compare (gconstpointer a, gconstpointer b)
+{
+    const AnjutaCompletionFuzzyMatch* match_a = a;
+    const AnjutaCompletionFuzzyMatch* match_b = b;
+
+    /* Best scores first, then in the order of the names */
+    if (match_a->score != match_b->score)
+        return match_b->score - match_a->score;
+    return match_a->index < match_b->index ? -1 : 1;
+}
+
 /**
  * anjuta_completion_complete:
  * @self: A #AnjutaCompletion
@@ -120,12 +324,7 @@ anjuta_completion_complete (AnjutaCompletion* self,
     }
 
     /* Sort the items if they're not already sorted */
-    if (!self->priv->items_sorted)
-    {
-        g_ptr_array_sort_with_data (self->priv->items, anjuta_completion_item_sort_func,
-                                    self);
-        self->priv->items_sorted = TRUE;
-    }
+    anjuta_completion_sort_items (self);
 
     ncmp_func = self->priv->case_sensitive ? strncmp : g_ascii_strncasecmp;
 
@@ -208,6 +407,115 @@ anjuta_completion_complete (AnjutaCompletion* self,
     return completions;
 }
 
+/**
+ * anjuta_completion_complete_fuzzy:
+ * @self: A #AnjutaCompletion
+ * @pattern: The characters to look for, in order.
+ * @max_completions: The maximum number of completions returned, -1 for all.
+ *
+ * Find the items containing all characters of @pattern in the same order,
+ * not necessarily next to each other, like "gab" in get_active_buffer or
+ * GetActiveBuffer. Matches at word starts and runs of consecutive characters
+ * are ranked first. When @pattern extends the pattern of the previous call,
+ * only the previous matches are checked again.
+ *
+ * Returns: (transfer container): The list of completions that matched
+ * @pattern, best matches first.
+ */
+GList*
+anjuta_completion_complete_fuzzy (AnjutaCompletion* self,
+                                  const char*       pattern,
+                                  gint              max_completions)
+{
+    GArray* matches;
+    guint64 pattern_chars;
+    const char* p;
+    GList* completions = NULL;
+    gint n_completions;
+    guint i;
+
+    g_return_val_if_fail (ANJUTA_IS_COMPLETION (self), NULL);
+    g_return_val_if_fail (pattern, NULL);
+
+    anjuta_completion_sort_items (self);
+    anjuta_completion_update_fuzzy_info (self);
+
+    pattern_chars = 0;
+    for (p = pattern; *p != '\0'; p++)
+        pattern_chars |= anjuta_completion_char_bit (*p);
+
+    matches = g_array_new (FALSE, FALSE, sizeof (AnjutaCompletionFuzzyMatch));
+    if (self->priv->last_fuzzy && g_str_has_prefix (pattern, self->priv->last_fuzzy))
+    {
+        /* A longer pattern can only match a subset of the previous matches */
+        for (i = 0; i < self->priv->last_fuzzy_matches->len; i++)
+        {
+            AnjutaCompletionFuzzyMatch match;
+            AnjutaCompletionFuzzyInfo* info;
+
+            match.index = g_array_index (self->priv->last_fuzzy_matches,
+                                         AnjutaCompletionFuzzyMatch, i).index;
+            info = &g_array_index (self->priv->fuzzy_info,
+                                   AnjutaCompletionFuzzyInfo, match.index);
+            if (pattern_chars & ~info->chars)
+                continue;
+
+            match.score = anjuta_completion_fuzzy_score (
+                self->priv->name_func (g_ptr_array_index (self->priv->items, match.index)),
+                info, pattern, self->priv->case_sensitive);
+            if (match.score >= 0)
+                g_array_append_val (matches, match);
+        }
+    }
+    else
+    {
+        for (i = 0; i < self->priv->items->len; i++)
+        {
+            AnjutaCompletionFuzzyMatch match;
+            AnjutaCompletionFuzzyInfo* info;
+
+            info = &g_array_index (self->priv->fuzzy_info,
+                                   AnjutaCompletionFuzzyInfo, i);
+            if (pattern_chars & ~info->chars)
+                continue;
+
+            match.index = i;
+            match.score = anjuta_completion_fuzzy_score (
+                self->priv->name_func (g_ptr_array_index (self->priv->items, i)),
+                info, pattern, self->priv->case_sensitive);
+            if (match.score >= 0)
+                g_array_append_val (matches, match);
+        }
+    }
+    g_array_sort (matches, anjuta_completion_fuzzy_match_compare);
+
+    n_completions = 0;
+    for (i = 0; i < matches->len; i++)
+    {
+        void* item;
+
+        item = g_ptr_array_index (self->priv->items,
+                                  g_array_index (matches, AnjutaCompletionFuzzyMatch, i).index);
+
+        if (self->priv->filter_func &&
+            !self->priv->filter_func (item, self->priv->filter_func_user_data))
+            continue;
+
+        completions = g_list_prepend (completions, item);
+        n_completions++;
+        if (max_completions > 0 && n_completions == max_completions)
+            break;
+    }
+    completions = g_list_reverse (completions);
+
+    g_free (self->priv->last_fuzzy);
+    self->priv->last_fuzzy = g_strdup (pattern);
+    g_array_unref (self->priv->last_fuzzy_matches);
+    self->priv->last_fuzzy_matches = matches;
+
+    return completions;
+}
+
 static void
 anjuta_completion_clear_items (AnjutaCompletion* self)
 {
@@ -226,6 +534,10 @@ anjuta_completion_clear_items (AnjutaCompletion* self)
 
     g_free (self->priv->last_complete);
     self->priv->last_complete = NULL;
+
+    g_array_set_size (self->priv->fuzzy_info, 0);
+    g_free (self->priv->last_fuzzy);
+    self->priv->last_fuzzy = NULL;
 }
 
 /**
@@ -257,6 +569,8 @@ anjuta_completion_add_item (AnjutaCompletion* self,
     g_ptr_array_add (self->priv->items, item);
 
     self->priv->items_sorted = FALSE;
+    g_free (self->priv->last_fuzzy);
+    self->priv->last_fuzzy = NULL;
 }
 
 void
@@ -305,6 +619,9 @@ anjuta_completion_set_case_sensitive (AnjutaCompletion* self,
     g_free (self->priv->last_complete);
     self->priv->last_complete = NULL;
 
+    g_free (self->priv->last_fuzzy);
+    self->priv->last_fuzzy = NULL;
+
     self->priv->items_sorted = FALSE;
 
     self->priv->case_sensitive = case_sensitive;
@@ -334,6 +651,11 @@ anjuta_completion_init (AnjutaCompletion* self)
     self->priv->case_sensitive = TRUE;
 
     self->priv->items = g_ptr_array_new ();
+
+    self->priv->fuzzy_info = g_array_new (FALSE, FALSE,
+                                          sizeof (AnjutaCompletionFuzzyInfo));
+    self->priv->last_fuzzy_matches = g_array_new (FALSE, FALSE,
+                                                  sizeof (AnjutaCompletionFuzzyMatch));
 }
 
 static void
@@ -342,6 +664,8 @@ anjuta_completion_finalize (GObject *object)
     AnjutaCompletion* self  = ANJUTA_COMPLETION (object);
 
     anjuta_completion_clear_items (self);
+    g_array_unref (self->priv->fuzzy_info);
+    g_array_unref (self->priv->last_fuzzy_matches);
 
     G_OBJECT_CLASS (anjuta_completion_parent_class)->finalize (object);
 }
@@ -87,6 +87,11 @@ anjuta_completion_complete (AnjutaCompletion* self,
                             const char*       prefix,
                             gint              max_completions);
 
+GList*
+anjuta_completion_complete_fuzzy (AnjutaCompletion* self,
+                                  const char*       pattern,
+                                  gint              max_completions);
+
 G_END_DECLS
 
 #endif /* _ANJUTA_COMPLETION_H_ */
@@ -66,6 +66,7 @@
 
 #define ANJUTA_PIXMAP_PASSWORD "password.png"
 #define FILE_BUFFER_SIZE 1024
+#define FILE_BUFFER_SIZE_MAX (64 * 1024)
 #define FILE_INPUT_BUFFER_SIZE  (1024 * 1024 * 4)
 #ifndef __MAX_BAUD
 #  if defined(B460800)
@@ -79,6 +80,18 @@
 #  endif
 #endif
 
+/* Output of the child. Complete lines are delivered from the buffer itself,
+ * only the last incomplete line is kept for the next read. */
+typedef struct
+{
+	gchar *data;
+	gsize size;
+	gsize length;
+
+	/* Grows while the child writes more than we read at once */
+	gsize read_size;
+} AnjutaLauncherLineBuffer;
+
 /*
 static gboolean
 anjuta_launcher_pty_check_child_exit_code (AnjutaLauncher *launcher,
@@ -108,11 +121,11 @@ struct _AnjutaLauncherPriv
 	guint pty_watch;
 	
 	/* Output line buffers */
-	gchar *stdout_buffer;
-	gchar *stderr_buffer;
+	AnjutaLauncherLineBuffer stdout_buffer;
+	AnjutaLauncherLineBuffer stderr_buffer;
 	
-	/* Output of the pty is constantly stored here.*/
-	gchar *pty_output_buffer;
+	/* Last line of the pty output, for password prompts */
+	AnjutaLauncherLineBuffer pty_output_buffer;
 
 	/* Terminal echo */
 	gboolean terminal_echo_on;
@@ -188,11 +201,11 @@ anjuta_launcher_initialize (AnjutaLauncher *obj)
 	obj->priv->pty_channel = NULL;
 	
 	/* Output line buffers */
-	obj->priv->stdout_buffer = NULL;
-	obj->priv->stderr_buffer = NULL;
+	memset (&obj->priv->stdout_buffer, 0, sizeof (AnjutaLauncherLineBuffer));
+	memset (&obj->priv->stderr_buffer, 0, sizeof (AnjutaLauncherLineBuffer));
 	
 	/* Pty buffer */
-	obj->priv->pty_output_buffer = NULL;
+	memset (&obj->priv->pty_output_buffer, 0, sizeof (AnjutaLauncherLineBuffer));
 	
 	obj->priv->terminal_echo_on = TRUE;
 	
@@ -681,100 +694,146 @@ is_password_prompt (const gchar* line)
 	return FALSE;
 }
 
-static void
-anjuta_launcher_buffered_output (AnjutaLauncher *launcher,
-								 AnjutaLauncherOutputType output_type,
-								 const gchar *chars)
+/* Read as much as available in one go, returns TRUE if the read filled the
+ * space given, so that there is probably more to read */
+static gboolean
+anjuta_launcher_line_buffer_read (AnjutaLauncherLineBuffer *buffer,
+								  GIOChannel *channel,
+								  GError **err)
 {
-	gchar *all_lines;
-	gchar *incomplete_line;
-	gchar **buffer;
+	gsize requested;
+	gsize n = 0;
 
-	g_return_if_fail (chars != NULL);
-	g_return_if_fail (strlen (chars) > 0);
+	if (buffer->read_size == 0)
+		buffer->read_size = FILE_BUFFER_SIZE;
+	requested = buffer->read_size;
 
-	if (launcher->priv->output_callback == NULL)
-		return;
-	if (launcher->priv->buffered_output == FALSE)
+	/* Keep room for a terminating nul */
+	if (buffer->size < buffer->length + requested + 1)
 	{
-		(launcher->priv->output_callback)(launcher, output_type, chars,
-										  launcher->priv->callback_data);
-		return;
+		buffer->size = buffer->length + requested + 1;
+		buffer->data = g_realloc (buffer->data, buffer->size);
 	}
-	switch (output_type)
+
+	g_io_channel_read_chars (channel, buffer->data + buffer->length,
+							 requested, &n, err);
+	buffer->length += n;
+	buffer->data[buffer->length] = '\0';
+
+	/* The maximum length of one character is 6 bytes, so a conversion can
+	 * leave up to 6 bytes unused */
+	if (n + 6 < requested)
+		return FALSE;
+
+	if (buffer->read_size < FILE_BUFFER_SIZE_MAX)
+		buffer->read_size *= 2;
+
+	return TRUE;
+}
+
+/* Returns the length of the complete lines in the buffer, only the data
+ * read after from can contain a new line */
+static gsize
+anjuta_launcher_line_buffer_get_lines_length (AnjutaLauncherLineBuffer *buffer,
+											  gsize from)
+{
+	gsize end;
+
+	for (end = buffer->length; end > from; end--)
 	{
-	case ANJUTA_LAUNCHER_OUTPUT_STDOUT:
-		buffer = &launcher->priv->stdout_buffer;
-		break;
-	case ANJUTA_LAUNCHER_OUTPUT_STDERR:
-		buffer = &launcher->priv->stderr_buffer;
-		break;
-	default:
-		g_warning ("Should not reach here");
-		return;
+		if (buffer->data[end - 1] == '\n')
+			return end;
 	}
-	if (*buffer) 
-		all_lines = g_strconcat (*buffer, chars, NULL);
-	else
-		all_lines = g_strdup (chars);
-	
-	/* Buffer the last incomplete line */
-	incomplete_line = all_lines + strlen (all_lines);
-	while (incomplete_line > all_lines &&
-		   *incomplete_line != '\n')
+
+	return 0;
+}
+
+/* Drops the length first bytes of the buffer */
+static void
+anjuta_launcher_line_buffer_consume (AnjutaLauncherLineBuffer *buffer,
+									 gsize length)
+{
+	buffer->length -= length;
+	memmove (buffer->data, buffer->data + length, buffer->length + 1);
+}
+
+static void
+anjuta_launcher_line_buffer_free (AnjutaLauncherLineBuffer *buffer)
+{
+	g_free (buffer->data);
+	memset (buffer, 0, sizeof (AnjutaLauncherLineBuffer));
+}
+
+/* Deliver the length first bytes of the buffer to the output callback */
+static void
+anjuta_launcher_deliver_output (AnjutaLauncher *launcher,
+								AnjutaLauncherOutputType output_type,
+								AnjutaLauncherLineBuffer *buffer,
+								gsize length)
+{
+	gchar last;
+
+	if (launcher->priv->output_callback == NULL || length == 0)
+		return;
+
+	last = buffer->data[length];
+	buffer->data[length] = '\0';
+
+	/* The channels convert the output to UTF-8, except when no encoding is
+	 * set and we get the raw bytes */
+	if (launcher->priv->encoding == NULL &&
+		!g_utf8_validate (buffer->data, length, NULL))
 	{
-		incomplete_line = g_utf8_prev_char (incomplete_line);
+		gchar *utf8_chars;
+
+		utf8_chars = anjuta_util_convert_to_utf8 (buffer->data);
+		if (utf8_chars)
+			(launcher->priv->output_callback)(launcher, output_type, utf8_chars,
+											  launcher->priv->callback_data);
+		g_free (utf8_chars);
 	}
-	if (*incomplete_line == '\n')
-		incomplete_line++;
-	
-	/* Update line buffer */
-	g_free(*buffer);
-	*buffer = NULL;
-	if (strlen(incomplete_line))
+	else
 	{
-		*buffer = g_strdup (incomplete_line);
-		/* DEBUG_PRINT ("Line buffer for %d: %s", output_type, incomplete_line); */
-	}
-	/* Check for password prompt */
-	if (launcher->priv->check_for_passwd_prompt)
-		anjuta_launcher_check_password (launcher, incomplete_line);
-	
-	/* Deliver complete lines */
-	*incomplete_line = '\0';
-	if (strlen (all_lines) > 0)
-		(launcher->priv->output_callback)(launcher, output_type, all_lines,
+		(launcher->priv->output_callback)(launcher, output_type, buffer->data,
 										  launcher->priv->callback_data);
-	g_free (all_lines);
+	}
+
+	buffer->data[length] = last;
 }
 
 static gboolean
-anjuta_launcher_scan_output (GIOChannel *channel, GIOCondition condition,
-							 AnjutaLauncher *launcher)
+anjuta_launcher_scan_lines (AnjutaLauncher *launcher, GIOChannel *channel,
+							GIOCondition condition,
+							AnjutaLauncherOutputType output_type,
+							AnjutaLauncherLineBuffer *buffer,
+							gboolean *is_done)
 {
-	gsize n;
-	gchar buffer[FILE_BUFFER_SIZE];
 	gboolean ret = TRUE;
 
 	if (condition & G_IO_IN)
 	{
 		GError *err = NULL;
+		gboolean more;
 		do
 		{
-			g_io_channel_read_chars (channel, buffer, FILE_BUFFER_SIZE-1, &n, &err);
-			if (n > 0) /* There is output */
+			gsize from = buffer->length;
+			gsize length;
+
+			more = anjuta_launcher_line_buffer_read (buffer, channel, &err);
+
+			/* Buffer the last incomplete line */
+			if (launcher->priv->buffered_output)
+				length = anjuta_launcher_line_buffer_get_lines_length (buffer, from);
+			else
+				length = buffer->length;
+
+			if (length > 0)
 			{
-				gchar *utf8_chars = NULL;
-				buffer[n] = '\0';
-				if (!launcher->priv->custom_encoding)
-					utf8_chars = anjuta_util_convert_to_utf8 (buffer);
-				else
-					utf8_chars = g_strdup(buffer);
-				anjuta_launcher_buffered_output (launcher,
-												 ANJUTA_LAUNCHER_OUTPUT_STDOUT,
-												 utf8_chars);
-				g_free (utf8_chars);
+				anjuta_launcher_deliver_output (launcher, output_type, buffer,
+												length);
+				anjuta_launcher_line_buffer_consume (buffer, length);
 			}
+
 			/* Ignore illegal characters */
 			if (err && err->domain == G_CONVERT_ERROR)
 			{
@@ -785,111 +844,71 @@ anjuta_launcher_scan_output (GIOChannel *channel, GIOCondition condition,
 			/* if not related to non blocking read or interrupted syscall */
 			else if (err && errno != EAGAIN && errno != EINTR)
 			{
-				launcher->priv->stdout_is_done = TRUE;
+				*is_done = TRUE;
 				anjuta_launcher_synchronize (launcher);
 				ret = FALSE;
 			}
-		/* Read next chars if buffer was too small
-		 * (the maximum length of one character is 6 bytes) */
-		} while (!err && (n > FILE_BUFFER_SIZE - 7));
+		} while (!err && more);
 		if (err)
 			g_error_free (err);
+
+		/* Check for password prompt */
+		if (launcher->priv->check_for_passwd_prompt && buffer->length > 0)
+			anjuta_launcher_check_password (launcher, buffer->data);
 	}
 	if ((condition & G_IO_ERR) || (condition & G_IO_HUP))
 	{
-		DEBUG_PRINT ("%s", "launcher.c: STDOUT pipe closed");
-		launcher->priv->stdout_is_done = TRUE;
+		DEBUG_PRINT ("launcher.c: %s pipe closed",
+					 output_type == ANJUTA_LAUNCHER_OUTPUT_STDOUT ? "STDOUT" : "STDERR");
+		*is_done = TRUE;
 		anjuta_launcher_synchronize (launcher);
 		ret = FALSE;
 	}
 	return ret;
 }
 
+static gboolean
+anjuta_launcher_scan_output (GIOChannel *channel, GIOCondition condition,
+							 AnjutaLauncher *launcher)
+{
+	return anjuta_launcher_scan_lines (launcher, channel, condition,
+									   ANJUTA_LAUNCHER_OUTPUT_STDOUT,
+									   &launcher->priv->stdout_buffer,
+									   &launcher->priv->stdout_is_done);
+}
+
 static gboolean
 anjuta_launcher_scan_error (GIOChannel *channel, GIOCondition condition,
 							AnjutaLauncher *launcher)
 {
-	gsize n;
-	gchar buffer[FILE_BUFFER_SIZE];
-	gboolean ret = TRUE;
-	
-	if (condition & G_IO_IN)
-	{
-		GError *err = NULL;
-		do
-		{
-			g_io_channel_read_chars (channel, buffer, FILE_BUFFER_SIZE-1, &n, &err);
-			if (n > 0) /* There is stderr output */
-			{
-				gchar *utf8_chars;
-				buffer[n] = '\0';
-				utf8_chars = anjuta_util_convert_to_utf8 (buffer);
-				anjuta_launcher_buffered_output (launcher,
-												 ANJUTA_LAUNCHER_OUTPUT_STDERR,
-												 utf8_chars);
-				g_free (utf8_chars);
-			}
-			/* Ignore illegal characters */
-			if (err && err->domain == G_CONVERT_ERROR)
-			{
-				g_error_free (err);
-				err = NULL;
-			}
-			/* The pipe is closed on the other side */
-			/* if not related to non blocking read or interrupted syscall */
-			else if (err && errno != EAGAIN && errno != EINTR)
-			{
-				
-				launcher->priv->stderr_is_done = TRUE;
-				anjuta_launcher_synchronize (launcher);
-				ret = FALSE;
-			}
-		/* Read next chars if buffer was too small
-		 * (the maximum length of one character is 6 bytes) */
-		} while (!err && (n > FILE_BUFFER_SIZE - 7));
-		if (err)
-			g_error_free (err);
-	}
-	if ((condition & G_IO_ERR) || (condition & G_IO_HUP))
-	{
-		DEBUG_PRINT ("%s", "launcher.c: STDERR pipe closed");
-		launcher->priv->stderr_is_done = TRUE;
-		anjuta_launcher_synchronize (launcher);
-		ret = FALSE;
-	}
-	return ret;
+	return anjuta_launcher_scan_lines (launcher, channel, condition,
+									   ANJUTA_LAUNCHER_OUTPUT_STDERR,
+									   &launcher->priv->stderr_buffer,
+									   &launcher->priv->stderr_is_done);
 }
 
 static gboolean
 anjuta_launcher_scan_pty (GIOChannel *channel, GIOCondition condition,
 						  AnjutaLauncher *launcher)
 {
-	gsize n;
-	gchar buffer[FILE_BUFFER_SIZE];
+	AnjutaLauncherLineBuffer *buffer = &launcher->priv->pty_output_buffer;
 	gboolean ret = TRUE;
 	
 	if (condition & G_IO_IN)
 	{
 		GError *err = NULL;
+		gboolean more;
 		do
 		{
-			g_io_channel_read_chars (channel, buffer, FILE_BUFFER_SIZE-1, &n, &err);
-			if (n > 0) /* There is stderr output */
-			{
-				gchar *utf8_chars;
-				gchar *old_str = launcher->priv->pty_output_buffer;
-				buffer[n] = '\0';
-				utf8_chars = anjuta_util_convert_to_utf8 (buffer);
-				if (old_str)
-				{
-					gchar *str = g_strconcat (old_str, utf8_chars, NULL);
-					launcher->priv->pty_output_buffer = str;
-					g_free (old_str);
-				}
-				else
-					launcher->priv->pty_output_buffer = g_strdup (utf8_chars);
-				g_free (utf8_chars);
-			}
+			gsize length;
+
+			more = anjuta_launcher_line_buffer_read (buffer, channel, &err);
+
+			/* Only the last line can be a password prompt */
+			length = anjuta_launcher_line_buffer_get_lines_length (buffer, 0);
+			if (length > 0)
+				anjuta_launcher_line_buffer_consume (buffer, length);
+
 			/* Ignore illegal characters */
 			if (err && err->domain == G_CONVERT_ERROR)
 			{
@@ -902,17 +921,12 @@ anjuta_launcher_scan_pty (GIOChannel *channel, GIOCondition condition,
 			{
 				ret = FALSE;
 			}
-		/* Read next chars if buffer was too small
-		 * (the maximum length of one character is 6 bytes) */
-		} while (!err && (n > FILE_BUFFER_SIZE - 7));
+		} while (!err && more);
 		if (err)
 			g_error_free (err);
-		if (launcher->priv->check_for_passwd_prompt
-			&& launcher->priv->pty_output_buffer
-			&& strlen (launcher->priv->pty_output_buffer) > 0)
+		if (launcher->priv->check_for_passwd_prompt && buffer->length > 0)
 		{
-			anjuta_launcher_check_password (launcher,
-											launcher->priv->pty_output_buffer);
+			anjuta_launcher_check_password (launcher, buffer->data);
 		}
 	}
 	/* In pty case, we handle the cases in different invocations */
@@ -960,26 +974,17 @@ anjuta_launcher_execution_done_cleanup (AnjutaLauncher *launcher,
 		g_source_remove (launcher->priv->pty_watch);
 	}
 
-	if (launcher->priv->pty_output_buffer)
-		g_free (launcher->priv->pty_output_buffer);
-	if (launcher->priv->stdout_buffer)
-	{
-		/* Send remaining data if last line is not terminated with EOL */
-		(launcher->priv->output_callback)(launcher,
-			       ANJUTA_LAUNCHER_OUTPUT_STDOUT,
-			       launcher->priv->stdout_buffer,
-			       launcher->priv->callback_data);
-		g_free (launcher->priv->stdout_buffer);
-	}
-	if (launcher->priv->stderr_buffer)
-	{
-		/* Send remaining data if last line is not terminated with EOL */
-		(launcher->priv->output_callback)(launcher,
-			       ANJUTA_LAUNCHER_OUTPUT_STDERR,
-			       launcher->priv->stderr_buffer,
-			       launcher->priv->callback_data);
-		g_free (launcher->priv->stdout_buffer);
-	}
+	anjuta_launcher_line_buffer_free (&launcher->priv->pty_output_buffer);
+
+	/* Send remaining data if last line is not terminated with EOL */
+	anjuta_launcher_deliver_output (launcher, ANJUTA_LAUNCHER_OUTPUT_STDOUT,
+									&launcher->priv->stdout_buffer,
+									launcher->priv->stdout_buffer.length);
+	anjuta_launcher_line_buffer_free (&launcher->priv->stdout_buffer);
+	anjuta_launcher_deliver_output (launcher, ANJUTA_LAUNCHER_OUTPUT_STDERR,
+									&launcher->priv->stderr_buffer,
+									launcher->priv->stderr_buffer.length);
+	anjuta_launcher_line_buffer_free (&launcher->priv->stderr_buffer);
 	
 	/* Save them before we re-initialize */
 	child_status = launcher->priv->child_status;
@@ -74,12 +74,61 @@ test_completion_basic (void)
     g_object_unref (completion);
 }
 
+static void
+test_completion_fuzzy (void)
+{
+    AnjutaCompletion* completion;
+    GList* l;
+
+    completion = anjuta_completion_new (NULL);
+    anjuta_completion_add_item (completion, "garbage");
+    anjuta_completion_add_item (completion, "get_active_buffer");
+    anjuta_completion_add_item (completion, "gtk_widget_show");
+    anjuta_completion_add_item (completion, "GetActiveBuffer");
+
+    l = anjuta_completion_complete_fuzzy (completion, "g", -1);
+    g_assert_cmpint (g_list_length (l), ==, 3);
+    g_list_free (l);
+
+    /* Word starts are ranked first */
+    l = anjuta_completion_complete_fuzzy (completion, "ga", -1);
+    g_assert_cmpint (g_list_length (l), ==, 2);
+    g_assert_cmpstr (l->data, ==, "get_active_buffer");
+    g_list_free (l);
+
+    /* Growing the pattern filters the previous matches */
+    l = anjuta_completion_complete_fuzzy (completion, "gab", -1);
+    g_assert_cmpint (g_list_length (l), ==, 2);
+    g_assert_cmpstr (l->data, ==, "get_active_buffer");
+    g_assert_cmpstr (l->next->data, ==, "garbage");
+    g_list_free (l);
+
+    l = anjuta_completion_complete_fuzzy (completion, "gabx", -1);
+    g_assert_cmpint (g_list_length (l), ==, 0);
+    g_list_free (l);
+
+    l = anjuta_completion_complete_fuzzy (completion, "gws", -1);
+    g_assert_cmpint (g_list_length (l), ==, 1);
+    g_assert_cmpstr (l->data, ==, "gtk_widget_show");
+    g_list_free (l);
+
+    /* Camel case words */
+    anjuta_completion_set_case_sensitive (completion, FALSE);
+    l = anjuta_completion_complete_fuzzy (completion, "gab", 1);
+    g_assert_cmpint (g_list_length (l), ==, 1);
+    g_assert_cmpstr (l->data, ==, "GetActiveBuffer");
+    g_list_free (l);
+
+    g_object_unref (completion);
+}
+
 int
 main (int argc, char** argv)
 {
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/completion/basic", test_completion_basic);
+    g_test_add_func ("/completion/fuzzy", test_completion_fuzzy);
 
     return g_test_run ();
 }
@@ -0,0 +1,364 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-matcher.c
+    Copyright (C) 2012 Sébastien Granjoux
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * The literal strings are found with an Aho-Corasick automaton, a trie of
+ * all strings where each state has a transition for every byte, so a line
+ * is scanned once whatever the number of patterns. The strings and the line
+ * are compared in ASCII lower case, which can only give more candidates
+ * than needed, so caseless patterns work too.
+ *---------------------------------------------------------------------------*/
+
+#include <config.h>
+
+#include "build-matcher.h"
+
+#include <string.h>
+
+/* Patterns above this are always candidates */
+#define MAX_ANCHORED_PATTERNS	64
+
+#define N_BYTES	256
+
+struct _BuildMatcher
+{
+	/* Literal string of each pattern or NULL if it has none */
+	GPtrArray *anchors;
+	guint64 always;
+
+	/* Automaton, state 0 is the start */
+	gboolean compiled;
+	guint n_states;
+	guint16 *next;
+	guint64 *output;
+};
+
+/* Literal string extraction
+ *---------------------------------------------------------------------------*/
+
+static void
+build_matcher_end_run (GString *run, gchar **anchor)
+{
+	if (run->len > 0 && (*anchor == NULL || run->len > strlen (*anchor)))
+	{
+		g_free (*anchor);
+		*anchor = g_ascii_strdown (run->str, run->len);
+	}
+	g_string_truncate (run, 0);
+}
+
+/* Skip a counted repetition like {2,3}, returns NULL if it is not one */
+static const gchar *
+build_matcher_skip_repeat (const gchar *p)
+{
+	p++;
+	if (!g_ascii_isdigit (*p) && *p != ',') return NULL;
+	while (g_ascii_isdigit (*p) || *p == ',') p++;
+
+	return *p == '}' ? p + 1 : NULL;
+}
+
+/* Skip a character class like [^a-z], returns NULL if it is not closed */
+static const gchar *
+build_matcher_skip_class (const gchar *p)
+{
+	p++;
+	if (*p == '^') p++;
+	if (*p == ']') p++;
+	while (*p != ']')
+	{
+		if (*p == '\0') return NULL;
+		if (*p == '\\' && p[1] != '\0')
+		{
+			p += 2;
+		}
+		else if (*p == '[' && p[1] == ':')
+		{
+			/* POSIX class like [:alpha:] */
+			const gchar *end = strstr (p, ":]");
+			if (end == NULL) return NULL;
+			p = end + 2;
+		}
+		else
+		{
+			p++;
+		}
+	}
+
+	return p + 1;
+}
+
+/* Returns the longest string which is in all matches of the pattern, this
+ * is done only for simple patterns, for others it returns NULL */
+static gchar *
+build_matcher_get_anchor (const gchar *pattern, GRegexCompileFlags options)
+{
+	GString *run;
+	gchar *anchor = NULL;
+	const gchar *p;
+	gint depth = 0;
+
+	if (options & G_REGEX_EXTENDED) return NULL;
+
+	run = g_string_new (NULL);
+	for (p = pattern; *p != '\0';)
+	{
+		const gchar *next = p + 1;
+		gchar literal = '\0';
+
+		switch (*p)
+		{
+		case '\\':
+			if (p[1] == '\0')
+			{
+				next = NULL;
+			}
+			else if (!g_ascii_isalnum (p[1]))
+			{
+				/* Escaped character */
+				if (!(p[1] & 0x80)) literal = p[1];
+				next = p + 2;
+			}
+			else if (strchr ("dDsSwWbBhHvVntrfaeAzZG", p[1]) != NULL)
+			{
+				/* Character type or assertion */
+				next = p + 2;
+			}
+			else
+			{
+				/* Back reference, character code, \Q... */
+				next = NULL;
+			}
+			break;
+		case '[':
+			next = build_matcher_skip_class (p);
+			break;
+		case '{':
+			next = build_matcher_skip_repeat (p);
+			break;
+		case '(':
+			/* Options and assertions can change the meaning of the rest */
+			if (p[1] == '?' && p[2] != ':') next = NULL;
+			depth++;
+			break;
+		case ')':
+			depth--;
+			break;
+		case '|':
+			/* Any alternative can match */
+			if (depth == 0) next = NULL;
+			break;
+		case '.':
+		case '^':
+		case '$':
+		case '*':
+		case '+':
+		case '?':
+			break;
+		default:
+			if (!(*p & 0x80)) literal = *p;
+			break;
+		}
+
+		if (next == NULL)
+		{
+			g_free (anchor);
+			anchor = NULL;
+			g_string_truncate (run, 0);
+			break;
+		}
+
+		if ((literal == '\0') || (depth > 0))
+		{
+			build_matcher_end_run (run, &anchor);
+		}
+		else if ((*next == '*') || (*next == '?') || (*next == '{'))
+		{
+			/* Optional character */
+			build_matcher_end_run (run, &anchor);
+		}
+		else
+		{
+			g_string_append_c (run, literal);
+			if (*next == '+') build_matcher_end_run (run, &anchor);
+		}
+
+		p = next;
+	}
+	build_matcher_end_run (run, &anchor);
+	g_string_free (run, TRUE);
+
+	return anchor;
+}
+
+/* Automaton
+ *---------------------------------------------------------------------------*/
+
+static guint
+build_matcher_new_state (BuildMatcher *matcher)
+{
+	guint state = matcher->n_states++;
+
+	matcher->next = g_renew (guint16, matcher->next, matcher->n_states * N_BYTES);
+	memset (matcher->next + state * N_BYTES, 0, N_BYTES * sizeof (guint16));
+	matcher->output = g_renew (guint64, matcher->output, matcher->n_states);
+	matcher->output[state] = 0;
+
+	return state;
+}
+
+static void
+build_matcher_compile (BuildMatcher *matcher)
+{
+	guint id;
+	guint *fail;
+	guint *queue;
+	guint head, tail;
+
+	g_free (matcher->next);
+	matcher->next = NULL;
+	g_free (matcher->output);
+	matcher->output = NULL;
+	matcher->n_states = 0;
+	build_matcher_new_state (matcher);
+
+	/* Trie of all strings */
+	for (id = 0; id < matcher->anchors->len; id++)
+	{
+		const guchar *anchor = g_ptr_array_index (matcher->anchors, id);
+		guint state = 0;
+
+		if (anchor == NULL) continue;
+
+		for (; *anchor != '\0'; anchor++)
+		{
+			guint next = matcher->next[state * N_BYTES + *anchor];
+
+			if (next == 0)
+			{
+				next = build_matcher_new_state (matcher);
+				matcher->next[state * N_BYTES + *anchor] = next;
+			}
+			state = next;
+		}
+		matcher->output[state] |= G_GUINT64_CONSTANT (1) << id;
+	}
+
+	/* Add failure transitions in breadth first order, so the state to fall
+	 * back to is always complete */
+	fail = g_new0 (guint, matcher->n_states);
+	queue = g_new (guint, matcher->n_states);
+	head = tail = 0;
+	queue[tail++] = 0;
+	while (head < tail)
+	{
+		guint state = queue[head++];
+		guint byte;
+
+		for (byte = 0; byte < N_BYTES; byte++)
+		{
+			guint next = matcher->next[state * N_BYTES + byte];
+			guint fallback = state == 0 ? 0 : matcher->next[fail[state] * N_BYTES + byte];
+
+			if (next != 0)
+			{
+				fail[next] = fallback;
+				matcher->output[next] |= matcher->output[fallback];
+				queue[tail++] = next;
+			}
+			else
+			{
+				matcher->next[state * N_BYTES + byte] = fallback;
+			}
+		}
+	}
+	g_free (queue);
+	g_free (fail);
+
+	matcher->compiled = TRUE;
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+BuildMatcher *
+build_matcher_new (void)
+{
+	BuildMatcher *matcher;
+
+	matcher = g_new0 (BuildMatcher, 1);
+	matcher->anchors = g_ptr_array_new_with_free_func (g_free);
+
+	return matcher;
+}
+
+void
+build_matcher_free (BuildMatcher *matcher)
+{
+	g_ptr_array_free (matcher->anchors, TRUE);
+	g_free (matcher->next);
+	g_free (matcher->output);
+	g_free (matcher);
+}
+
+/* Returns the identifier of the pattern, to use with
+ * build_matcher_is_candidate() */
+gint
+build_matcher_add_pattern (BuildMatcher *matcher, const gchar *pattern,
+						   GRegexCompileFlags options)
+{
+	gint id = matcher->anchors->len;
+	gchar *anchor = NULL;
+
+	if (id < MAX_ANCHORED_PATTERNS)
+	{
+		anchor = build_matcher_get_anchor (pattern, options);
+		if (anchor == NULL) matcher->always |= G_GUINT64_CONSTANT (1) << id;
+	}
+	g_ptr_array_add (matcher->anchors, anchor);
+	matcher->compiled = FALSE;
+
+	return id;
+}
+
+/* Returns the set of patterns which can match text */
+guint64
+build_matcher_match (BuildMatcher *matcher, const gchar *text)
+{
+	const guchar *p;
+	guint state = 0;
+	guint64 candidates = matcher->always;
+
+	if (!matcher->compiled) build_matcher_compile (matcher);
+
+	for (p = (const guchar *)text; *p != '\0'; p++)
+	{
+		state = matcher->next[state * N_BYTES + g_ascii_tolower (*p)];
+		candidates |= matcher->output[state];
+	}
+
+	return candidates;
+}
+
+gboolean
+build_matcher_is_candidate (guint64 candidates, gint id)
+{
+	return (id < 0) || (id >= MAX_ANCHORED_PATTERNS) || (candidates & (G_GUINT64_CONSTANT (1) << id));
+}
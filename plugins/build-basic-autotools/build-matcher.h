@@ -0,0 +1,40 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-matcher.h
+    Copyright (C) 2012 Sébastien Granjoux
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BUILD_MATCHER_H
+#define BUILD_MATCHER_H
+
+#include <glib.h>
+
+/* Prefilter for the regular expressions used on build messages. A literal
+ * string which has to be in any match is taken from each pattern, all of them
+ * are searched at once in a line and only the patterns having their string
+ * in it need to be tried. */
+typedef struct _BuildMatcher BuildMatcher;
+
+BuildMatcher *build_matcher_new (void);
+void build_matcher_free (BuildMatcher *matcher);
+
+gint build_matcher_add_pattern (BuildMatcher *matcher, const gchar *pattern,
+								GRegexCompileFlags options);
+guint64 build_matcher_match (BuildMatcher *matcher, const gchar *text);
+gboolean build_matcher_is_candidate (guint64 candidates, gint id);
+
+#endif /* BUILD_MATCHER_H */
@@ -49,6 +49,7 @@
 #include "executer.h"
 #include "program.h"
 #include "build.h"
+#include "build-matcher.h"
 
 #include <sys/wait.h>
 #if defined(__FreeBSD__)
@@ -83,6 +84,7 @@ typedef struct
 	int options;
 	gchar *replace;
 	GRegex *regex;
+	gint id;
 } BuildPattern;
 
 typedef struct
@@ -90,6 +92,8 @@ typedef struct
 	gchar *pattern;
 	GRegex *regex;
 	GRegex *local_regex;
+	gint id;
+	gint local_id;
 } MessagePattern;
 
 typedef struct
@@ -131,6 +135,9 @@ static void update_project_ui (BasicAutotoolsPlugin *bb_plugin);
 
 static GList *patterns_list = NULL;
 
+/* Literal strings of all patterns, to avoid trying most of them on each line */
+static BuildMatcher *patterns_matcher = NULL;
+
 /* The translations should match that of 'make' program. Both strings uses
  * pearl regular expression
  * 2 similar strings are used in order to parse the output of 2 different
@@ -492,6 +499,8 @@ build_regex_init_message (MessagePattern *patterns)
 			   0,
 			   0,
 			   NULL);
+		patterns->id = build_matcher_add_pattern (patterns_matcher,
+												  patterns->pattern, 0);
 
 		/* Translated string */
 		patterns->local_regex = g_regex_new(
@@ -499,6 +508,8 @@ build_regex_init_message (MessagePattern *patterns)
 			   0,
 			   0,
 			   NULL);
+		patterns->local_id = build_matcher_add_pattern (patterns_matcher,
+														_(patterns->pattern), 0);
 	}
 }
 
@@ -508,6 +519,9 @@ build_regex_init (void)
 	GList *node;
 	GError *error = NULL;
 
+	if (patterns_matcher == NULL)
+		patterns_matcher = build_matcher_new ();
+
 	build_regex_init_message (patterns_make_entering);
 
 	build_regex_init_message (patterns_make_leaving);
@@ -536,6 +550,9 @@ build_regex_init (void)
 						pattern->pattern, error->message);
 			g_error_free (error);
 		}
+		pattern->id = build_matcher_add_pattern (patterns_matcher,
+												 pattern->pattern,
+												 pattern->options);
 		node = g_list_next (node);
 	}
 }
@@ -699,27 +716,36 @@ on_build_mesg_format (IAnjutaMessageView *view, const gchar *one_line,
 	gboolean matched;
 	GMatchInfo *match_info;
 	MessagePattern *pat;
+	guint64 candidates;
 
 	g_return_if_fail (one_line != NULL);
 
+	candidates = build_matcher_match (patterns_matcher, one_line);
+
 	/* Check if make enter a new directory */
 	matched = FALSE;
 	for (pat = patterns_make_entering; pat->pattern != NULL; pat++)
 	{
-		matched = g_regex_match(
-						pat->regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
-		matched = g_regex_match(
-						pat->local_regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
+		if (build_matcher_is_candidate (candidates, pat->id))
+		{
+			matched = g_regex_match(
+							pat->regex,
+					  		one_line,
+				  			0,
+				  			&match_info);
+			if (matched) break;
+			g_match_info_free (match_info);
+		}
+		if (build_matcher_is_candidate (candidates, pat->local_id))
+		{
+			matched = g_regex_match(
+							pat->local_regex,
+					  		one_line,
+				  			0,
+				  			&match_info);
+			if (matched) break;
+			g_match_info_free (match_info);
+		}
 	}
 	if (matched)
 	{
@@ -742,20 +768,26 @@ on_build_mesg_format (IAnjutaMessageView *view, const gchar *one_line,
 	matched = FALSE;
 	for (pat = patterns_make_leaving; pat->pattern != NULL; pat++)
 	{
-		matched = g_regex_match(
-						pat->regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
-		matched = g_regex_match(
-						pat->local_regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
+		if (build_matcher_is_candidate (candidates, pat->id))
+		{
+			matched = g_regex_match(
+							pat->regex,
+					  		one_line,
+				  			0,
+				  			&match_info);
+			if (matched) break;
+			g_match_info_free (match_info);
+		}
+		if (build_matcher_is_candidate (candidates, pat->local_id))
+		{
+			matched = g_regex_match(
+							pat->local_regex,
+					  		one_line,
+				  			0,
+				  			&match_info);
+			if (matched) break;
+			g_match_info_free (match_info);
+		}
 	}
 	if (matched)
 	{
@@ -898,11 +930,13 @@ on_build_mesg_format (IAnjutaMessageView *view, const gchar *one_line,
 		g_free (dummy_fn);
 	}
 
+	candidates = build_matcher_match (patterns_matcher, line);
 	node = patterns_list;
 	while (node)
 	{
 		BuildPattern *pattern = node->data;
-		summary = build_get_summary (line, pattern);
+		if (build_matcher_is_candidate (candidates, pattern->id))
+			summary = build_get_summary (line, pattern);
 		if (summary)
 			break;
 		node = g_list_next (node);
@@ -92,11 +92,12 @@ typedef enum
 	INFO_SIGNAL_COMMAND,
 	SET_FRAME_COMMAND,	
 	LIST_FRAME_COMMAND,
+	LIST_FRAME_RANGE_COMMAND,
 	DUMP_STACK_TRACE_COMMAND,
 	UPDATE_REGISTER_COMMAND,
 	WRITE_REGISTER_COMMAND,
-	EVALUATE_COMMAND,
-	INSPECT_COMMAND,			/* 0x30 */
+	EVALUATE_COMMAND,			/* 0x30 */
+	INSPECT_COMMAND,
 	PRINT_COMMAND,
 	CREATE_VARIABLE,
 	EVALUATE_VARIABLE,
@@ -128,13 +129,13 @@ typedef enum
 		USER_COMMAND |
 	    NEED_DEBUGGER_STARTED | NEED_PROGRAM_LOADED | NEED_PROGRAM_STOPPED  | NEED_PROGRAM_RUNNING,
 	DMA_INSPECT_MEMORY_COMMAND =
-		INSPECT_MEMORY_COMMAND |
+		INSPECT_MEMORY_COMMAND | CONCURRENT |
 		NEED_DEBUGGER_STARTED | NEED_PROGRAM_LOADED | NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_DISASSEMBLE_COMMAND =
-		DISASSEMBLE_COMMAND |
+		DISASSEMBLE_COMMAND | CONCURRENT |
 		NEED_DEBUGGER_STARTED | NEED_PROGRAM_LOADED | NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_LIST_REGISTER_COMMAND =
-		LIST_REGISTER_COMMAND |
+		LIST_REGISTER_COMMAND | CONCURRENT |
 		NEED_DEBUGGER_STARTED | NEED_PROGRAM_LOADED | NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_SET_WORKING_DIRECTORY_COMMAND =
 		SET_WORKING_DIRECTORY_COMMAND |
@@ -215,13 +216,13 @@ typedef enum
 		HANDLE_SIGNAL_COMMAND |
 		NEED_PROGRAM_STOPPED,
 	DMA_LIST_LOCAL_COMMAND =
-		LIST_LOCAL_COMMAND |
+		LIST_LOCAL_COMMAND | CONCURRENT |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_LIST_ARG_COMMAND =
-		LIST_ARG_COMMAND |
+		LIST_ARG_COMMAND | CONCURRENT |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_LIST_THREAD_COMMAND =
-		LIST_THREAD_COMMAND |
+		LIST_THREAD_COMMAND | CONCURRENT |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_SET_THREAD_COMMAND =
 		SET_THREAD_COMMAND |
@@ -236,13 +237,16 @@ typedef enum
 		SET_FRAME_COMMAND |
 		NEED_PROGRAM_STOPPED,
 	DMA_LIST_FRAME_COMMAND =
-		LIST_FRAME_COMMAND |
+		LIST_FRAME_COMMAND | CONCURRENT |
+		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
+	DMA_LIST_FRAME_RANGE_COMMAND =
+		LIST_FRAME_RANGE_COMMAND | CONCURRENT |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_DUMP_STACK_TRACE_COMMAND =
 		DUMP_STACK_TRACE_COMMAND |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_UPDATE_REGISTER_COMMAND =
-		UPDATE_REGISTER_COMMAND |
+		UPDATE_REGISTER_COMMAND | CONCURRENT |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_WRITE_REGISTER_COMMAND =
 		WRITE_REGISTER_COMMAND |
@@ -260,10 +264,10 @@ typedef enum
 	   CREATE_VARIABLE |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	DMA_EVALUATE_VARIABLE_COMMAND =
-	    EVALUATE_VARIABLE | CANCEL_IF_PROGRAM_RUNNING |
+	    EVALUATE_VARIABLE | CANCEL_IF_PROGRAM_RUNNING | CONCURRENT |
 	    NEED_PROGRAM_STOPPED,
 	DMA_LIST_VARIABLE_CHILDREN_COMMAND =
-	    LIST_VARIABLE_CHILDREN |
+	    LIST_VARIABLE_CHILDREN | CONCURRENT |
 		NEED_PROGRAM_STOPPED,
 	DMA_DELETE_VARIABLE_COMMAND =
 		DELETE_VARIABLE |
@@ -272,7 +276,7 @@ typedef enum
 		ASSIGN_VARIABLE |
 		NEED_PROGRAM_STOPPED,
 	DMA_UPDATE_VARIABLE_COMMAND =
-	    UPDATE_VARIABLE | CANCEL_IF_PROGRAM_RUNNING |
+	    UPDATE_VARIABLE | CANCEL_IF_PROGRAM_RUNNING | CONCURRENT |
 		NEED_PROGRAM_STOPPED | NEED_PROGRAM_RUNNING,
 	/* DMA_INTERRUPT_COMMAND doesn't automatically go in stop-program state
 	 * because sometimes it doesn't work. I don't know if it comes from anjuta,
@@ -287,6 +291,7 @@ struct _DmaQueueCommand
 	DmaDebuggerCommandType type;
 	IAnjutaDebuggerCallback callback;
 	gpointer user_data;
+	DmaDebuggerQueue *queue;	/* Set on concurrent commands sent */
 	union {
 		struct {
 			gchar *file;
@@ -339,6 +344,11 @@ struct _DmaQueueCommand
 		struct {
 			guint frame;
 		} frame;
+		struct {
+			guint first;
+			guint last;
+			gboolean all_values;
+		} range;
 		struct {
 			gulong address;
 			guint length;
@@ -543,6 +553,13 @@ dma_command_new (DmaDebuggerCommand cmd_type,...)
 		cmd->callback = va_arg (args, IAnjutaDebuggerCallback);
 		cmd->user_data = va_arg (args, gpointer);
 		break;
+	case LIST_FRAME_RANGE_COMMAND:
+		cmd->data.range.first = va_arg (args, guint);
+		cmd->data.range.last = va_arg (args, guint);
+		cmd->data.range.all_values = va_arg (args, gboolean);
+		cmd->callback = va_arg (args, IAnjutaDebuggerCallback);
+		cmd->user_data = va_arg (args, gpointer);
+		break;
 	case DUMP_STACK_TRACE_COMMAND:
 		cmd->callback = va_arg (args, IAnjutaDebuggerCallback);
 		cmd->user_data = va_arg (args, gpointer);
@@ -837,6 +854,12 @@ dma_queue_list_frame (DmaDebuggerQueue *self, IAnjutaDebuggerCallback callback ,
 	return dma_debugger_queue_append (self, dma_command_new (DMA_LIST_FRAME_COMMAND, callback, user_data));
 }
 
+gboolean
+dma_queue_list_frame_range (DmaDebuggerQueue *self, guint first, guint last, gboolean all_values, IAnjutaDebuggerCallback callback , gpointer user_data)
+{
+	return dma_debugger_queue_append (self, dma_command_new (DMA_LIST_FRAME_RANGE_COMMAND, first, last, all_values, callback, user_data));
+}
+
 gboolean
 dma_queue_dump_stack_trace (DmaDebuggerQueue *self, IAnjutaDebuggerCallback callback , gpointer user_data)
 {
@@ -1002,6 +1025,7 @@ dma_command_free (DmaQueueCommand *cmd)
 	    break;
 	case SET_FRAME_COMMAND:
 	case LIST_FRAME_COMMAND:
+	case LIST_FRAME_RANGE_COMMAND:
 	case DUMP_STACK_TRACE_COMMAND:
 	case INSPECT_MEMORY_COMMAND:
 	case DISASSEMBLE_COMMAND:
@@ -1106,6 +1130,16 @@ dma_command_is_breakpoint_pending (DmaQueueCommand *cmd)
 	return FALSE;
 }
 
+/* The reply of a concurrent command comes with the command itself, as other
+ * commands can be sent before it */
+static void
+on_dma_command_reply (const gpointer data, gpointer user_data, GError *err)
+{
+	DmaQueueCommand *cmd = (DmaQueueCommand *)user_data;
+
+	dma_debugger_queue_command_reply (cmd->queue, cmd, data, err);
+}
+
 gboolean
 dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 				 DmaDebuggerQueue *queue, GError **err)
@@ -1114,13 +1148,21 @@ dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 	gboolean ret = FALSE;
 	DmaDebuggerCommandType type = cmd->type & COMMAND_MASK;
 	IAnjutaDebuggerCallback callback = cmd->callback == NULL ? NULL : dma_debugger_queue_command_callback;
+	gpointer callback_data = queue;
+
+	if (dma_command_is_concurrent (cmd))
+	{
+		cmd->queue = queue;
+		callback = on_dma_command_reply;
+		callback_data = cmd;
+	}
 	switch (type)
 	{
 	case EMPTY_COMMAND:
 		ret = TRUE;
 		break;
 	case CALLBACK_COMMAND:
-		ret = ianjuta_debugger_callback (debugger, callback, queue, err);	
+		ret = ianjuta_debugger_callback (debugger, callback, callback_data, err);	
 		break;
 	case LOAD_COMMAND:
 		ret = ianjuta_debugger_load (debugger, cmd->data.load.file, cmd->data.load.type, cmd->data.load.dirs, err);
@@ -1186,18 +1228,18 @@ dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 		ret = ianjuta_debugger_interrupt (debugger, err);	
 		break;
 	case ENABLE_BREAK_COMMAND:
-		ret = ianjuta_debugger_breakpoint_enable_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, cmd->data.brk.enable, (IAnjutaDebuggerBreakpointCallback)callback, queue, err);	
+		ret = ianjuta_debugger_breakpoint_enable_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, cmd->data.brk.enable, (IAnjutaDebuggerBreakpointCallback)callback, callback_data, err);	
 		break;
 	case IGNORE_BREAK_COMMAND:
-		ret = ianjuta_debugger_breakpoint_ignore_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, cmd->data.brk.ignore, (IAnjutaDebuggerBreakpointCallback)callback, queue, err);	
+		ret = ianjuta_debugger_breakpoint_ignore_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, cmd->data.brk.ignore, (IAnjutaDebuggerBreakpointCallback)callback, callback_data, err);	
 		break;
 	case REMOVE_BREAK_COMMAND:
-		ret = ianjuta_debugger_breakpoint_clear_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, (IAnjutaDebuggerBreakpointCallback)callback, queue, err);	
+		ret = ianjuta_debugger_breakpoint_clear_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, (IAnjutaDebuggerBreakpointCallback)callback, callback_data, err);	
 		break;
 	case BREAK_LINE_COMMAND:
 		if (dma_command_is_breakpoint_pending (cmd))
 		{	
-			ret = ianjuta_debugger_breakpoint_set_breakpoint_at_line (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.pos.file, cmd->data.pos.line, (IAnjutaDebuggerBreakpointCallback)callback, queue, err);	
+			ret = ianjuta_debugger_breakpoint_set_breakpoint_at_line (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.pos.file, cmd->data.pos.line, (IAnjutaDebuggerBreakpointCallback)callback, callback_data, err);	
 		}
 		else
 		{
@@ -1207,7 +1249,7 @@ dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 	case BREAK_FUNCTION_COMMAND:
 		if (dma_command_is_breakpoint_pending (cmd))
 		{	
-			ret = ianjuta_debugger_breakpoint_set_breakpoint_at_function (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.pos.file, cmd->data.pos.function, (IAnjutaDebuggerBreakpointCallback)callback, queue, err);	
+			ret = ianjuta_debugger_breakpoint_set_breakpoint_at_function (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.pos.file, cmd->data.pos.function, (IAnjutaDebuggerBreakpointCallback)callback, callback_data, err);	
 		}
 		else
 		{
@@ -1217,7 +1259,7 @@ dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 	case BREAK_ADDRESS_COMMAND:
 		if (dma_command_is_breakpoint_pending (cmd))
 		{	
-			ret = ianjuta_debugger_breakpoint_set_breakpoint_at_address (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.pos.address, (IAnjutaDebuggerBreakpointCallback)callback, queue, err);	
+			ret = ianjuta_debugger_breakpoint_set_breakpoint_at_address (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.pos.address, (IAnjutaDebuggerBreakpointCallback)callback, callback_data, err);	
 		}
 		else
 		{
@@ -1225,52 +1267,55 @@ dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 		}
 		break;
 	case CONDITION_BREAK_COMMAND:
-		ret = ianjuta_debugger_breakpoint_condition_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, cmd->data.brk.condition, (IAnjutaDebuggerBreakpointCallback)callback, queue, err);	
+		ret = ianjuta_debugger_breakpoint_condition_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), cmd->data.brk.id, cmd->data.brk.condition, (IAnjutaDebuggerBreakpointCallback)callback, callback_data, err);	
 		break;
 	case LIST_BREAK_COMMAND:
-		ret = ianjuta_debugger_breakpoint_list_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_breakpoint_list_breakpoint (IANJUTA_DEBUGGER_BREAKPOINT (debugger), (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case INSPECT_COMMAND:
-		ret = ianjuta_debugger_inspect (debugger, cmd->data.watch.name, (IAnjutaDebuggerGCharCallback)callback, queue, err);
+		ret = ianjuta_debugger_inspect (debugger, cmd->data.watch.name, (IAnjutaDebuggerGCharCallback)callback, callback_data, err);
 	    break;
 	case EVALUATE_COMMAND:
-		ret = ianjuta_debugger_evaluate (debugger, cmd->data.watch.name, cmd->data.watch.value, (IAnjutaDebuggerGCharCallback)callback, queue, err);
+		ret = ianjuta_debugger_evaluate (debugger, cmd->data.watch.name, cmd->data.watch.value, (IAnjutaDebuggerGCharCallback)callback, callback_data, err);
 	    break;
 	case LIST_LOCAL_COMMAND:
-		ret = ianjuta_debugger_list_local (debugger, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_list_local (debugger, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case LIST_ARG_COMMAND:
-		ret = ianjuta_debugger_list_argument (debugger, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_list_argument (debugger, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case LIST_THREAD_COMMAND:
-		ret = ianjuta_debugger_list_thread (debugger, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_list_thread (debugger, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case SET_THREAD_COMMAND:
 		ret = ianjuta_debugger_set_thread (debugger, cmd->data.frame.frame, err);	
 		break;
 	case INFO_THREAD_COMMAND:
-		ret = ianjuta_debugger_info_thread (debugger, cmd->data.info.id, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_info_thread (debugger, cmd->data.info.id, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case INFO_SIGNAL_COMMAND:
-		ret = ianjuta_debugger_info_signal (debugger, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_info_signal (debugger, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case INFO_SHAREDLIB_COMMAND:
-		ret = ianjuta_debugger_info_sharedlib (debugger, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_info_sharedlib (debugger, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case SET_FRAME_COMMAND:
 		ret = ianjuta_debugger_set_frame (debugger, cmd->data.frame.frame, err);	
 		break;
 	case LIST_FRAME_COMMAND:
-		ret = ianjuta_debugger_list_frame (debugger, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_list_frame (debugger, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
+		break;
+	case LIST_FRAME_RANGE_COMMAND:
+		ret = ianjuta_debugger_list_frame_range (debugger, cmd->data.range.first, cmd->data.range.last, cmd->data.range.all_values, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case DUMP_STACK_TRACE_COMMAND:
-		ret = ianjuta_debugger_dump_stack_trace (debugger, (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_dump_stack_trace (debugger, (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case LIST_REGISTER_COMMAND:
-		ret = ianjuta_debugger_register_list_register (IANJUTA_DEBUGGER_REGISTER (debugger), (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_register_list_register (IANJUTA_DEBUGGER_REGISTER (debugger), (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case UPDATE_REGISTER_COMMAND:
-		ret = ianjuta_debugger_register_update_register (IANJUTA_DEBUGGER_REGISTER (debugger), (IAnjutaDebuggerGListCallback)callback, queue, err);	
+		ret = ianjuta_debugger_register_update_register (IANJUTA_DEBUGGER_REGISTER (debugger), (IAnjutaDebuggerGListCallback)callback, callback_data, err);	
 		break;
 	case WRITE_REGISTER_COMMAND:
 		reg.num = cmd->data.watch.id;
@@ -1279,16 +1324,16 @@ dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 		ret = ianjuta_debugger_register_write_register (IANJUTA_DEBUGGER_REGISTER (debugger), &reg, err);	
 		break;
 	case INSPECT_MEMORY_COMMAND:
-		ret = ianjuta_debugger_memory_inspect (IANJUTA_DEBUGGER_MEMORY (debugger), cmd->data.mem.address, cmd->data.mem.length, (IAnjutaDebuggerMemoryCallback)callback, queue, err);	
+		ret = ianjuta_debugger_memory_inspect (IANJUTA_DEBUGGER_MEMORY (debugger), cmd->data.mem.address, cmd->data.mem.length, (IAnjutaDebuggerMemoryCallback)callback, callback_data, err);	
 		break;
 	case DISASSEMBLE_COMMAND:
-		ret = ianjuta_debugger_instruction_disassemble (IANJUTA_DEBUGGER_INSTRUCTION (debugger), cmd->data.mem.address, cmd->data.mem.length, (IAnjutaDebuggerInstructionCallback)callback, queue, err);	
+		ret = ianjuta_debugger_instruction_disassemble (IANJUTA_DEBUGGER_INSTRUCTION (debugger), cmd->data.mem.address, cmd->data.mem.length, (IAnjutaDebuggerInstructionCallback)callback, callback_data, err);	
 		break;
 	case USER_COMMAND:
 		ret = ianjuta_debugger_send_command (debugger, cmd->data.user.cmd, err);	
 		break;
 	case PRINT_COMMAND:
-		ret = ianjuta_debugger_print (debugger, cmd->data.print.var, (IAnjutaDebuggerGCharCallback)callback, queue, err);	
+		ret = ianjuta_debugger_print (debugger, cmd->data.print.var, (IAnjutaDebuggerGCharCallback)callback, callback_data, err);	
 		break;
 	case HANDLE_SIGNAL_COMMAND:
 		ret = ianjuta_debugger_handle_signal (debugger, cmd->data.signal.name, cmd->data.signal.stop, cmd->data.signal.print, cmd->data.signal.ignore, err);	
@@ -1300,16 +1345,16 @@ dma_command_run (DmaQueueCommand *cmd, IAnjutaDebugger *debugger,
 		ret = ianjuta_debugger_variable_assign (IANJUTA_DEBUGGER_VARIABLE (debugger), cmd->data.var.name, cmd->data.var.value, err);
 		break;
 	case EVALUATE_VARIABLE:
-		ret = ianjuta_debugger_variable_evaluate (IANJUTA_DEBUGGER_VARIABLE (debugger), cmd->data.var.name, (IAnjutaDebuggerGCharCallback)callback, queue, err);
+		ret = ianjuta_debugger_variable_evaluate (IANJUTA_DEBUGGER_VARIABLE (debugger), cmd->data.var.name, (IAnjutaDebuggerGCharCallback)callback, callback_data, err);
 		break;
 	case LIST_VARIABLE_CHILDREN:
-		ret = ianjuta_debugger_variable_list_children (IANJUTA_DEBUGGER_VARIABLE (debugger), cmd->data.var.name, cmd->data.var.from, (IAnjutaDebuggerGListCallback)callback, queue, err);
+		ret = ianjuta_debugger_variable_list_children (IANJUTA_DEBUGGER_VARIABLE (debugger), cmd->data.var.name, cmd->data.var.from, (IAnjutaDebuggerGListCallback)callback, callback_data, err);
 		break;
 	case CREATE_VARIABLE:
-		ret = ianjuta_debugger_variable_create (IANJUTA_DEBUGGER_VARIABLE (debugger), cmd->data.var.name, (IAnjutaDebuggerVariableCallback)callback, queue, err);
+		ret = ianjuta_debugger_variable_create (IANJUTA_DEBUGGER_VARIABLE (debugger), cmd->data.var.name, (IAnjutaDebuggerVariableCallback)callback, callback_data, err);
 		break;
 	case UPDATE_VARIABLE:
-		ret = ianjuta_debugger_variable_update (IANJUTA_DEBUGGER_VARIABLE (debugger), (IAnjutaDebuggerGListCallback)callback, queue, err);
+		ret = ianjuta_debugger_variable_update (IANJUTA_DEBUGGER_VARIABLE (debugger), (IAnjutaDebuggerGListCallback)callback, callback_data, err);
 		break;
 	}
 	
@@ -1372,6 +1417,7 @@ dma_command_callback (DmaQueueCommand *cmd, const gpointer data, GError *err)
 	case INFO_SIGNAL_COMMAND:
 	case INFO_SHAREDLIB_COMMAND:
 	case LIST_FRAME_COMMAND:
+	case LIST_FRAME_RANGE_COMMAND:
 	case DUMP_STACK_TRACE_COMMAND:
 	case LIST_REGISTER_COMMAND:
 	case UPDATE_REGISTER_COMMAND:
@@ -1431,6 +1477,14 @@ dma_command_has_flag (DmaQueueCommand *cmd, DmaCommandFlag flag)
 	return cmd->type & flag;
 }
 
+/* A command without callback gets no reply, the queue would not know when it
+ * is done */
+gboolean
+dma_command_is_concurrent (DmaQueueCommand *cmd)
+{
+	return (cmd->type & CONCURRENT) && (cmd->callback != NULL);
+}
+
 int
 dma_command_get_type (DmaQueueCommand *cmd)
 {
@@ -53,7 +53,8 @@ typedef enum
 	CANCEL_IF_PROGRAM_RUNNING = 1 << 21,
 	CANCEL_ALL_COMMAND = 1 << 22,
 	ASYNCHRONOUS = 1 << 23,
-	HIGH_PRIORITY = 1 << 24
+	HIGH_PRIORITY = 1 << 24,
+	CONCURRENT = 1 << 25		/* Read only, can be sent before the previous reply */
 } DmaCommandFlag;
 
 /* Create a new command structure and append to command queue */
@@ -93,6 +94,7 @@ gboolean dma_queue_info_sharedlib (DmaDebuggerQueue *self, IAnjutaDebuggerCallba
 gboolean dma_queue_handle_signal (DmaDebuggerQueue *self, const gchar* name, gboolean stop, gboolean print, gboolean ignore);
 gboolean dma_queue_set_frame (DmaDebuggerQueue *self, guint frame);
 gboolean dma_queue_list_frame (DmaDebuggerQueue *self, IAnjutaDebuggerCallback callback , gpointer user_data);
+gboolean dma_queue_list_frame_range (DmaDebuggerQueue *self, guint first, guint last, gboolean all_values, IAnjutaDebuggerCallback callback , gpointer user_data);
 gboolean dma_queue_dump_stack_trace (DmaDebuggerQueue *self, IAnjutaDebuggerCallback callback , gpointer user_data);
 gboolean dma_queue_list_register (DmaDebuggerQueue *self, IAnjutaDebuggerCallback callback , gpointer user_data);
 gboolean dma_queue_callback (DmaDebuggerQueue *self, IAnjutaDebuggerCallback callback , gpointer user_data);
@@ -127,6 +129,7 @@ void dma_command_callback (DmaQueueCommand *cmd, const gpointer data, GError* er
 gboolean dma_command_is_valid_in_state (DmaQueueCommand *cmd, IAnjutaDebuggerState state);
 IAnjutaDebuggerState dma_command_is_going_to_state (DmaQueueCommand *cmd);
 gboolean dma_command_has_flag (DmaQueueCommand *cmd, DmaCommandFlag flag);
+gboolean dma_command_is_concurrent (DmaQueueCommand *cmd);
 
 int dma_command_get_type (DmaQueueCommand *cmd);
 
@@ -42,6 +42,9 @@
 
 #define ICON_FILE "anjuta-debug-manager.plugin.png"
 
+/* Maximum number of concurrent commands waiting for their reply */
+#define MAX_CONCURRENT_COMMANDS 16
+
 /* Private type
  *---------------------------------------------------------------------------*/
 
@@ -55,6 +58,7 @@ struct _DmaDebuggerQueue {
 	/* Command queue */
 	GQueue *queue;
 	DmaQueueCommand *last;
+	GQueue *sent;				/* Concurrent commands waiting for their reply */
 	GList *insert_command;		/* Insert command at the head of the list */
 	
 	IAnjutaDebuggerState debugger_state;
@@ -117,6 +121,20 @@ dma_queue_cancel_unexpected (DmaDebuggerQueue *self, IAnjutaDebuggerState state)
 	return TRUE;
 }
 
+/* Drop the concurrent commands still waiting, the debugger has nothing left
+ * to reply */
+static void
+dma_debugger_queue_clear_sent (DmaDebuggerQueue *self)
+{
+	DmaQueueCommand *cmd;
+
+	while ((cmd = (DmaQueueCommand *)g_queue_pop_head (self->sent)) != NULL)
+	{
+		DEBUG_PRINT("no reply for command %x", dma_command_get_type (cmd));
+		dma_command_free (cmd);
+	}
+}
+
 static void
 dma_debugger_queue_clear (DmaDebuggerQueue *self)
 {
@@ -129,6 +147,7 @@ dma_debugger_queue_clear (DmaDebuggerQueue *self)
 		dma_command_free (self->last);
 		self->last = NULL;
 	}
+	dma_debugger_queue_clear_sent (self);
 	
 	/* Queue is empty so has the same state than debugger */
 	self->queue_state = self->debugger_state;
@@ -247,6 +266,24 @@ dma_queue_emit_debugger_state_change (DmaDebuggerQueue *self, IAnjutaDebuggerSta
 	self->insert_command = g_list_delete_link (self->insert_command, self->insert_command);
 }
 
+/* Reply of a concurrent command, can come while other commands are running */
+void
+dma_debugger_queue_command_reply (DmaDebuggerQueue *self, DmaQueueCommand *cmd, const gpointer data, GError* err)
+{
+	gboolean sent;
+
+	sent = g_queue_remove (self->sent, cmd);
+	g_return_if_fail (sent);
+
+	self->insert_command = g_list_prepend (self->insert_command, g_queue_peek_head_link (self->queue));
+	if (self->queue_state != IANJUTA_DEBUGGER_STOPPED)
+	{
+		dma_command_callback (cmd, data, err);
+	}
+	self->insert_command = g_list_delete_link (self->insert_command, self->insert_command);
+	dma_command_free (cmd);
+}
+
 static void
 dma_queue_emit_debugger_state (DmaDebuggerQueue *self, IAnjutaDebuggerState state, GError* err)
 {
@@ -315,7 +352,7 @@ dma_queue_emit_debugger_ready (DmaDebuggerQueue *self)
 {
 	gboolean busy;
 	
-	if (g_queue_is_empty(self->queue) && (self->last == NULL))
+	if (g_queue_is_empty(self->queue) && (self->last == NULL) && g_queue_is_empty (self->sent))
 	{
 		busy = FALSE;
 	}
@@ -385,34 +422,59 @@ dma_debugger_queue_execute (DmaDebuggerQueue *self)
 		dma_debugger_queue_complete (self, state);
 	}
 
-	/* Check if there is something to execute */
+	/* Check if there is something to execute. Read only commands are sent
+	 * without waiting for the reply of the previous ones, the others wait
+	 * until the debugger has completed everything */
 	while (!g_queue_is_empty(self->queue) && (self->last == NULL))
 	{
 		DmaQueueCommand *cmd;
 		GError *err = NULL;
 		gboolean ok;
+		gboolean concurrent;
 		
-		cmd = (DmaQueueCommand *)g_queue_pop_head(self->queue);
+		cmd = (DmaQueueCommand *)g_queue_peek_head(self->queue);
+		concurrent = dma_command_is_concurrent (cmd);
+		if (concurrent ? g_queue_get_length (self->sent) >= MAX_CONCURRENT_COMMANDS : !g_queue_is_empty (self->sent))
+		{
+			/* Wait for replies */
+			break;
+		}
+		g_queue_pop_head(self->queue);
 
 		/* Start command */
-		self->last = cmd;
+		if (concurrent)
+			g_queue_push_tail (self->sent, cmd);
+		else
+			self->last = cmd;
 		DEBUG_PRINT("run command %x", dma_command_get_type (cmd));
 		ok = dma_command_run (cmd, self->debugger, self, &err);
 
 		if (!ok || (err != NULL))
 		{
-			/* Something fail */
-			if (dma_command_is_going_to_state (self->last) != IANJUTA_DEBUGGER_BUSY)
+			if (concurrent)
 			{
-				/* Command has been canceled in an unexpected state,
-				 * Remove invalid following command */
-				dma_queue_cancel_unexpected (self, self->debugger_state);
+				/* Remove current command, if it has not replied already */
+				if (g_queue_remove (self->sent, cmd))
+				{
+					DEBUG_PRINT("cancel command %x", dma_command_get_type (cmd));
+					dma_command_free (cmd);
+				}
 			}
+			else
+			{
+				/* Something fail */
+				if (dma_command_is_going_to_state (self->last) != IANJUTA_DEBUGGER_BUSY)
+				{
+					/* Command has been canceled in an unexpected state,
+					 * Remove invalid following command */
+					dma_queue_cancel_unexpected (self, self->debugger_state);
+				}
 
-			/* Remove current command */
-			DEBUG_PRINT("cancel command %x", dma_command_get_type (self->last));
-			dma_command_free (self->last);
-			self->last = NULL;
+				/* Remove current command */
+				DEBUG_PRINT("cancel command %x", dma_command_get_type (self->last));
+				dma_command_free (self->last);
+				self->last = NULL;
+			}
 
 			/* Display error message to user */
 			if (err != NULL)
@@ -567,6 +629,11 @@ static void
 on_dma_debugger_ready (DmaDebuggerQueue *self, IAnjutaDebuggerState state)
 {
 	DEBUG_PRINT ("From debugger: receive debugger ready %d", state);
+
+	/* The debugger is ready once all commands sent are completed, a
+	 * concurrent command without reply does not get one */
+	if (state != IANJUTA_DEBUGGER_BUSY)
+		dma_debugger_queue_clear_sent (self);
 	
 	dma_debugger_queue_complete (self, state);
 }
@@ -584,6 +651,7 @@ on_dma_debugger_stopped (DmaDebuggerQueue *self, GError *err)
 	IAnjutaDebuggerState state;
 
 	DEBUG_PRINT ("From debugger: receive debugger stopped with error %p", err);
+	dma_debugger_queue_clear_sent (self);
 	dma_queue_emit_debugger_state (self, IANJUTA_DEBUGGER_STOPPED, err);
 
 	/* Reread debugger state, could have changed while emitting signal */
@@ -887,6 +955,7 @@ dma_debugger_queue_finalize (GObject *obj)
 	DmaDebuggerQueue *self = DMA_DEBUGGER_QUEUE (obj);
 
 	g_queue_free (self->queue);
+	g_queue_free (self->sent);
 
 	G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -902,6 +971,7 @@ dma_debugger_queue_instance_init (DmaDebuggerQueue *self)
 	self->support = 0;
 	self->queue = g_queue_new ();
 	self->last = NULL;
+	self->sent = g_queue_new ();
 	self->busy = FALSE;
 	self->insert_command = NULL;
 	self->debugger_state = IANJUTA_DEBUGGER_STOPPED;
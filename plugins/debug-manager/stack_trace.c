@@ -43,6 +43,9 @@
 
 #define ANJUTA_PIXMAP_POINTER PACKAGE_PIXMAPS_DIR"/pointer.png"
 
+/* Number of frames read at once, more are read when the user scrolls */
+#define STACK_TRACE_WINDOW	32
+
 struct _StackTrace
 {
 	DebugManagerPlugin *plugin;
@@ -65,6 +68,7 @@ typedef struct _StackPacket StackPacket;
 struct _StackPacket {
 	StackTrace* self;
 	guint thread;
+	guint first;
 	gboolean scroll;
 	gboolean unblock;
 };
@@ -81,6 +85,7 @@ enum {
 	STACK_TRACE_DIRTY_COLUMN,
 	STACK_TRACE_URI_COLUMN,
 	STACK_TRACE_COLOR_COLUMN,
+	STACK_TRACE_FULL_ARGS_COLUMN,
 	STACK_TRACE_N_COLUMNS
 };
 
@@ -156,41 +161,6 @@ my_gtk_tree_model_get_iter_last(GtkTreeModel *model, GtkTreeIter *parent, GtkTre
 	return TRUE;
 }
 
-static gboolean
-my_gtk_tree_model_iter_prev(GtkTreeModel *model, GtkTreeIter *iter)
-{
-	GtkTreePath* path;
-	gboolean exist;
-
-	path = gtk_tree_model_get_path (model, iter);
-	exist = gtk_tree_path_prev (path);
-	if (exist)
-	{
-		exist = gtk_tree_model_get_iter (model, iter, path);
-	}
-	gtk_tree_path_free (path);
-
-	return exist;
-}
-
-static gint
-my_gtk_tree_iter_compare(GtkTreeModel *model, GtkTreeIter *itera, GtkTreeIter *iterb)
-{
-	GtkTreePath* patha;
-	GtkTreePath* pathb;
-	gint comp;
-
-	patha = gtk_tree_model_get_path (model, itera);
-	pathb = gtk_tree_model_get_path (model, iterb);
-
-	comp = gtk_tree_path_compare (patha, pathb);
-
-	gtk_tree_path_free (patha);
-	gtk_tree_path_free (pathb);
-
-	return comp;
-}
-
 static gboolean
 find_thread (GtkTreeModel *model, GtkTreeIter *iter, guint thread)
 {
@@ -260,23 +230,178 @@ set_stack_frame (StackTrace *self, guint frame, gint thread)
 	}
 }
 
+/* Frames are the children of the thread rows, ordered by level. When the
+ * stack has more frames than read, the last child is an empty row, used as
+ * placeholder until they are read. */
+static gboolean
+is_frame_row (GtkTreeModel *model, GtkTreeIter *iter)
+{
+	gchar *str;
+	gboolean frame;
+
+	gtk_tree_model_get (model, iter, STACK_TRACE_FRAME_COLUMN, &str, -1);
+	frame = str != NULL;
+	g_free (str);
+
+	return frame;
+}
+
+static gboolean
+is_same_frame (GtkTreeModel *model, GtkTreeIter *iter, IAnjutaDebuggerFrame *frame)
+{
+	gchar *adr_str;
+	gchar *line_str;
+	gchar *args;
+	gboolean full_args;
+	gulong address;
+	guint line;
+	gboolean same;
+
+	gtk_tree_model_get (model, iter,
+						STACK_TRACE_ADDR_COLUMN, &adr_str,
+						STACK_TRACE_LINE_COLUMN, &line_str,
+						STACK_TRACE_ARGS_COLUMN, &args,
+						STACK_TRACE_FULL_ARGS_COLUMN, &full_args,
+						-1);
+	address = adr_str != NULL ? strtoul (adr_str, NULL, 0) : 0;
+	line = line_str != NULL ? strtoul (line_str, NULL, 10) : 0;
+	same = (address == frame->address) && (line == frame->line);
+	if (full_args)
+	{
+		/* Arguments have been read with all values, they cannot be compared */
+	}
+	else if ((args == NULL) || (frame->args == NULL))
+	{
+		same = same && (args == frame->args);
+	}
+	else
+	{
+		same = same && (strcmp (args, frame->args) == 0);
+	}
+	g_free (adr_str);
+	g_free (line_str);
+	g_free (args);
+
+	return same;
+}
+
+static void
+set_frame_row (GtkTreeStore *store, GtkTreeIter *iter, IAnjutaDebuggerFrame *frame, const gchar *color, gboolean full_args)
+{
+	gchar *frame_str;
+	gchar *adr_str;
+	gchar *line_str;
+	gchar *uri;
+	gchar *file;
+
+	frame_str = g_strdup_printf ("%d", frame->level);
+	adr_str = g_strdup_printf ("0x%lx", frame->address);
+	if (frame->file)
+	{
+		if (g_path_is_absolute (frame->file))
+		{
+			GFile *gio_file = g_file_new_for_path (frame->file);
+			uri = g_file_get_uri (gio_file);
+			file = strrchr(frame->file, G_DIR_SEPARATOR) + 1;
+			g_object_unref (gio_file);
+		}
+		else
+		{
+			uri = NULL;
+			file = frame->file;
+		}
+		line_str = g_strdup_printf ("%d", frame->line);
+	}
+	else
+	{
+		uri = NULL;
+		file = frame->library;
+		line_str = NULL;
+	}
+
+	gtk_tree_store_set(store, iter,
+				   STACK_TRACE_ACTIVE_COLUMN, NULL,
+				   STACK_TRACE_FRAME_COLUMN, frame_str,
+				   STACK_TRACE_FILE_COLUMN, file,
+				   STACK_TRACE_LINE_COLUMN, line_str,
+				   STACK_TRACE_FUNC_COLUMN, frame->function,
+				   STACK_TRACE_ADDR_COLUMN, adr_str,
+				   STACK_TRACE_ARGS_COLUMN, frame->args,
+				   STACK_TRACE_URI_COLUMN, uri,
+				   STACK_TRACE_COLOR_COLUMN, color,
+				   STACK_TRACE_FULL_ARGS_COLUMN, full_args,
+				   -1);
+	g_free (uri);
+	g_free (line_str);
+	g_free (adr_str);
+	g_free (frame_str);
+}
+
+/* Returns the level of the first frame which was already displayed, the
+ * following ones are the same too. As only the top of the stack is read, the
+ * level of the frames can have changed, so the previous position of the
+ * deepest frame read is searched first. */
+static guint
+find_unchanged_frames (GtkTreeModel *model, GtkTreeIter *parent, const GList *stack, guint length)
+{
+	const GList *node;
+	IAnjutaDebuggerFrame *frame;
+	GtkTreeIter iter;
+	gboolean valid;
+	guint row;
+	gint shift;
+	guint first;
+
+	if (length == 0) return 0;
+
+	/* Find deepest frame */
+	node = g_list_nth ((GList *)stack, length - 1);
+	frame = (IAnjutaDebuggerFrame *)node->data;
+	row = 0;
+	for (valid = gtk_tree_model_iter_children (model, &iter, parent); valid; valid = gtk_tree_model_iter_next (model, &iter))
+	{
+		if (!is_frame_row (model, &iter)) return frame->level + 1;
+		if (is_same_frame (model, &iter, frame)) break;
+		row++;
+	}
+	if (!valid) return frame->level + 1;
+	shift = (gint)frame->level - (gint)row;
+
+	/* Check upper frames */
+	first = frame->level;
+	for (node = node->prev; node != NULL; node = node->prev)
+	{
+		frame = (IAnjutaDebuggerFrame *)node->data;
+		if ((gint)frame->level - shift < 0) break;
+		if (!gtk_tree_model_iter_nth_child (model, &iter, parent, frame->level - shift)) break;
+		if (!is_same_frame (model, &iter, frame)) break;
+		first = frame->level;
+	}
+
+	return first;
+}
+
 static void
 on_stack_trace_updated (const GList *stack, gpointer user_data, GError *error)
 {
 	StackPacket *packet = (StackPacket *)user_data;
 	StackTrace *self;
 	guint thread;
+	guint first;
 	GtkTreeModel *model;
 	GtkTreeIter iter;
 	GtkTreeIter parent;
 	const GList *node;
-	gboolean exist;
+	guint length;
+	gboolean more;
+	guint unchanged;
 	GtkTreePath *path;
 
 	g_return_if_fail (packet != NULL);
 
 	self = packet->self;
 	thread = packet->thread;
+	first = packet->first;
 	if (packet->unblock) g_signal_handler_unblock (self->plugin, self->changed_handler);
 	g_slice_free (StackPacket, packet);
 
@@ -286,143 +411,50 @@ on_stack_trace_updated (const GList *stack, gpointer user_data, GError *error)
 
 	if (!find_thread (model, &parent, thread)) return;
 
-	/* Check if there are already some data */
-	exist = my_gtk_tree_model_get_iter_last (GTK_TREE_MODEL (model), &parent, &iter);
-	if (exist)
+	/* One more frame is read to know if the stack continues */
+	length = g_list_length ((GList *)stack);
+	more = length > STACK_TRACE_WINDOW;
+	if (more) length = STACK_TRACE_WINDOW;
+
+	if (first == 0)
 	{
-		GValue val = {0};
+		/* Display only unchanged frames in black */
+		unchanged = find_unchanged_frames (model, &parent, stack, length);
 
-		gtk_tree_model_get_value(model, &iter, STACK_TRACE_FRAME_COLUMN, &val);
-		if (!G_IS_VALUE (&val))
+		/* Remove all previous frames */
+		while (gtk_tree_model_iter_children (model, &iter, &parent))
 		{
-			/* Remove dummy child */
 			gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
-
-			exist = FALSE;
 		}
 	}
-
-	for (node = (const GList *)g_list_last((GList *)stack); node != NULL; node = node->prev)
+	else
 	{
-		IAnjutaDebuggerFrame *frame;
-		gchar *frame_str;
-		gchar *adr_str;
-		gchar *line_str;
-		gchar *uri;
-		gchar *file;
-
-		frame = (IAnjutaDebuggerFrame *)node->data;
-
-		if (exist)
-		{
-			/* Check if it's the same stack frame */
-			gchar *args;
-			gulong address;
-			guint line;
-			gboolean same;
-
-			gtk_tree_model_get (GTK_TREE_MODEL (model), &iter,
-									STACK_TRACE_ADDR_COLUMN, &adr_str,
-									STACK_TRACE_LINE_COLUMN, &line_str,
-									STACK_TRACE_ARGS_COLUMN, &args,
-								-1);
-			address = adr_str != NULL ? strtoul (adr_str, NULL, 0) : 0;
-			line = line_str != NULL ? strtoul (line_str, NULL, 10) : 0;
-			same = (address == frame->address) && (line == frame->line);
-			if ((args == NULL) || (frame->args == NULL))
-			{
-				same = same && (args == frame->args);
-			}
-			else
-			{
-				same = same && (strcmp (args, frame->args) == 0);
-			}
-			g_free (adr_str);
-			g_free (args);
-
-			if (same)
-			{
-				/* Same frame, just change the color */
-				frame_str = g_strdup_printf ("%d", frame->level);
-				gtk_tree_store_set (GTK_TREE_STORE (model), &iter,
-								   	STACK_TRACE_ACTIVE_COLUMN, NULL,
-									STACK_TRACE_FRAME_COLUMN, frame_str,
-								   	STACK_TRACE_COLOR_COLUMN, "black", -1);
-				g_free (frame_str);
-
-				/* Check previous frame */
-				exist = my_gtk_tree_model_iter_prev (model, &iter);
-				if (!exist || (node->prev != NULL))
-				{
-					/* Last frame or Upper frame still exist */
-					continue;
-				}
-				/* Upper frame do not exist, remove all them */
-			}
-
-			/* New frame, remove all previous frame */
-			GtkTreeIter first;
-
-			gtk_tree_model_iter_children (model, &first, &parent);
-			while (my_gtk_tree_iter_compare (model, &first, &iter) < 0)
-			{
-				gtk_tree_store_remove (GTK_TREE_STORE (model), &first);
-			}
-			gtk_tree_store_remove (GTK_TREE_STORE (model), &first);
+		/* Remove placeholder, check that the frames before are still there */
+		if (!my_gtk_tree_model_get_iter_last (model, &parent, &iter)) return;
+		if (is_frame_row (model, &iter)) return;
+		if (gtk_tree_model_iter_n_children (model, &parent) != first + 1) return;
+		gtk_tree_store_remove (GTK_TREE_STORE (model), &iter);
+		unchanged = 0;
+	}
 
-			if (same)
-			{
-				break;
-			}
-			else
-			{
-				exist = FALSE;
-			}
-		}
+	for (node = stack; (node != NULL) && (length > 0); node = node->next, length--)
+	{
+		IAnjutaDebuggerFrame *frame = (IAnjutaDebuggerFrame *)node->data;
 
-		gtk_tree_store_prepend (GTK_TREE_STORE (model), &iter, &parent);
+		gtk_tree_store_append (GTK_TREE_STORE (model), &iter, &parent);
+		set_frame_row (GTK_TREE_STORE (model), &iter, frame, frame->level < unchanged ? "red" : "black", FALSE);
+	}
+	if (more)
+	{
+		gtk_tree_store_append (GTK_TREE_STORE (model), &iter, &parent);
+		gtk_tree_store_set (GTK_TREE_STORE (model), &iter,
+		                    STACK_TRACE_FUNC_COLUMN, "...",
+		                    STACK_TRACE_DIRTY_COLUMN, FALSE,
+		                    -1);
+	}
 
-		frame_str = g_strdup_printf ("%d", frame->level);
-		adr_str = g_strdup_printf ("0x%lx", frame->address);
-		if (frame->file)
-		{
-			if (g_path_is_absolute (frame->file))
-			{
-				GFile *gio_file = g_file_new_for_path (frame->file);
-				uri = g_file_get_uri (gio_file);
-				file = strrchr(frame->file, G_DIR_SEPARATOR) + 1;
-				g_object_unref (gio_file);
-			}
-			else
-			{
-				uri = NULL;
-				file = frame->file;
-			}
-			line_str = g_strdup_printf ("%d", frame->line);
-		}
-		else
-		{
-			uri = NULL;
-			file = frame->library;
-			line_str = NULL;
-		}
+	if (first != 0) return;
 
-		gtk_tree_store_set(GTK_TREE_STORE (model), &iter,
-					   STACK_TRACE_ACTIVE_COLUMN, NULL,
-					   STACK_TRACE_FRAME_COLUMN, frame_str,
-					   STACK_TRACE_FILE_COLUMN, file,
-					   STACK_TRACE_LINE_COLUMN, line_str,
-					   STACK_TRACE_FUNC_COLUMN, frame->function,
-					   STACK_TRACE_ADDR_COLUMN, adr_str,
-					   STACK_TRACE_ARGS_COLUMN, frame->args,
-					   STACK_TRACE_URI_COLUMN, uri,
-					   STACK_TRACE_COLOR_COLUMN, "red",
-					   -1);
-		g_free (uri);
-		g_free (line_str);
-		g_free (adr_str);
-		g_free (frame_str);
-	}
 	gtk_tree_store_set(GTK_TREE_STORE (model), &parent,
 	                   STACK_TRACE_DIRTY_COLUMN, FALSE,
 	                   -1);
@@ -438,6 +470,71 @@ on_stack_trace_updated (const GList *stack, gpointer user_data, GError *error)
 	gtk_tree_path_free (path);
 }
 
+static void
+on_frame_args_updated (const GList *stack, gpointer user_data, GError *error)
+{
+	StackPacket *packet = (StackPacket *)user_data;
+	StackTrace *self;
+	guint thread;
+	guint level;
+	IAnjutaDebuggerFrame *frame;
+	GtkTreeModel *model;
+	GtkTreeIter iter;
+	GtkTreeIter parent;
+	gchar *adr_str;
+	gulong address;
+
+	g_return_if_fail (packet != NULL);
+
+	self = packet->self;
+	thread = packet->thread;
+	level = packet->first;
+	if (packet->unblock) g_signal_handler_unblock (self->plugin, self->changed_handler);
+	g_slice_free (StackPacket, packet);
+
+	if ((error != NULL) || (stack == NULL)) return;
+	frame = (IAnjutaDebuggerFrame *)stack->data;
+
+	model = gtk_tree_view_get_model (self->treeview);
+
+	if (!find_thread (model, &parent, thread)) return;
+	if (!gtk_tree_model_iter_nth_child (model, &iter, &parent, level)) return;
+
+	/* Check that the stack has not changed meanwhile */
+	gtk_tree_model_get (model, &iter, STACK_TRACE_ADDR_COLUMN, &adr_str, -1);
+	address = adr_str != NULL ? strtoul (adr_str, NULL, 0) : 0;
+	g_free (adr_str);
+	if (address != frame->address) return;
+
+	gtk_tree_store_set (GTK_TREE_STORE (model), &iter,
+	                    STACK_TRACE_ARGS_COLUMN, frame->args,
+	                    STACK_TRACE_FULL_ARGS_COLUMN, TRUE,
+	                    -1);
+}
+
+static void
+list_stack_frame_range (StackTrace *self, guint thread, guint first, guint last, gboolean all_values, IAnjutaDebuggerCallback callback)
+{
+	StackPacket *packet;
+
+	if (thread != self->current_thread)
+	{
+		/* Change current thread temporarily */
+		dma_queue_set_thread (self->debugger, thread);
+		g_signal_handler_block (self->plugin, self->changed_handler);
+	}
+	packet = g_slice_new (StackPacket);
+	packet->thread = thread;
+	packet->first = first;
+	packet->self = self;
+	packet->scroll = first == 0;
+	packet->unblock = thread != self->current_thread;
+	dma_queue_list_frame_range (self->debugger,
+	                            first, last, all_values,
+	                            callback,
+	                            packet);
+	if (thread != self->current_thread) dma_queue_set_thread (self->debugger, self->current_thread);
+}
 
 static void
 list_stack_frame (StackTrace *self, guint thread, gboolean update)
@@ -463,24 +560,63 @@ list_stack_frame (StackTrace *self, guint thread, gboolean update)
 	/* Update stack trace */
 	if (update || !found || dirty)
 	{
-		StackPacket *packet;
+		list_stack_frame_range (self, thread, 0, STACK_TRACE_WINDOW,
+		                        FALSE, (IAnjutaDebuggerCallback)on_stack_trace_updated);
+	}
+}
 
-		if (thread != self->current_thread)
-		{
-			/* Change current thread temporarily */
-			dma_queue_set_thread (self->debugger, thread);
-			g_signal_handler_block (self->plugin, self->changed_handler);
-		}
-		packet = g_slice_new (StackPacket);
-		packet->thread = thread;
-		packet->self = self;
-		packet->scroll = update;
-		packet->unblock = thread != self->current_thread;
-		dma_queue_list_frame (self->debugger,
-							(IAnjutaDebuggerCallback)on_stack_trace_updated,
-							packet);
-		if (thread != self->current_thread) dma_queue_set_thread (self->debugger, self->current_thread);
+/* Read the next frames of the expanded threads having their placeholder
+ * visible */
+static void
+list_more_stack_frame (StackTrace *self)
+{
+	GtkTreeModel *model;
+	GtkTreeIter parent;
+	GtkTreeIter iter;
+	GtkTreePath *end;
+	gboolean valid;
+
+	if (!gtk_tree_view_get_visible_range (self->treeview, NULL, &end)) return;
+
+	model = gtk_tree_view_get_model (self->treeview);
+	for (valid = gtk_tree_model_get_iter_first (model, &parent); valid; valid = gtk_tree_model_iter_next (model, &parent))
+	{
+		GtkTreePath *path;
+		gint frames;
+		gboolean pending;
+		gboolean visible;
+		gchar *str;
+		guint thread;
+
+		/* The only child of a thread not read yet is a dummy row */
+		frames = gtk_tree_model_iter_n_children (model, &parent) - 1;
+		if (frames <= 0) continue;
+		if (!my_gtk_tree_model_get_iter_last (model, &parent, &iter)) continue;
+		if (is_frame_row (model, &iter)) continue;
+
+		gtk_tree_model_get (model, &iter, STACK_TRACE_DIRTY_COLUMN, &pending, -1);
+		if (pending) continue;
+
+		path = gtk_tree_model_get_path (model, &parent);
+		visible = gtk_tree_view_row_expanded (self->treeview, path);
+		gtk_tree_path_free (path);
+		if (!visible) continue;
+
+		path = gtk_tree_model_get_path (model, &iter);
+		visible = gtk_tree_path_compare (path, end) <= 0;
+		gtk_tree_path_free (path);
+		if (!visible) continue;
+
+		gtk_tree_store_set (GTK_TREE_STORE (model), &iter,
+		                    STACK_TRACE_DIRTY_COLUMN, TRUE,
+		                    -1);
+		gtk_tree_model_get (model, &parent, STACK_TRACE_THREAD_COLUMN, &str, -1);
+		thread = (str != NULL) ? strtoul (str, NULL, 10) : 0;
+		g_free (str);
+		list_stack_frame_range (self, thread, frames, frames + STACK_TRACE_WINDOW,
+		                        FALSE, (IAnjutaDebuggerCallback)on_stack_trace_updated);
 	}
+	gtk_tree_path_free (end);
 }
 
 static void
@@ -693,6 +829,49 @@ on_stack_trace_row_expanded            (GtkTreeView     *treeview,
 	list_stack_frame (st, thread, FALSE);
 }
 
+static void
+on_stack_trace_selection_changed (GtkTreeSelection *selection, StackTrace *st)
+{
+	GtkTreeModel *model;
+	GtkTreeIter iter;
+	GtkTreeIter parent;
+	gchar *frame_str;
+	gchar *thread_str;
+	gboolean full_args;
+	guint thread;
+	guint frame;
+
+	/* Read the values of all arguments of the selected frame */
+	if (!gtk_tree_selection_get_selected (selection, &model, &iter)) return;
+	if (!gtk_tree_model_iter_parent (model, &parent, &iter)) return;
+
+	gtk_tree_model_get (model, &iter,
+	                    STACK_TRACE_FRAME_COLUMN, &frame_str,
+	                    STACK_TRACE_FULL_ARGS_COLUMN, &full_args,
+	                    -1);
+	if ((frame_str == NULL) || full_args)
+	{
+		g_free (frame_str);
+		return;
+	}
+	frame = strtoul (frame_str, NULL, 10);
+	g_free (frame_str);
+
+	gtk_tree_model_get (model, &parent, STACK_TRACE_THREAD_COLUMN, &thread_str, -1);
+	thread = (thread_str != NULL) ? strtoul (thread_str, NULL, 10) : 0;
+	g_free (thread_str);
+
+	/* The row is marked when the values are received */
+	list_stack_frame_range (st, thread, frame, frame, TRUE,
+	                        (IAnjutaDebuggerCallback)on_frame_args_updated);
+}
+
+static void
+on_stack_trace_scrolled (GtkAdjustment *adjustment, StackTrace *st)
+{
+	list_more_stack_frame (st);
+}
+
 static gboolean
 on_stack_trace_button_press (GtkWidget *widget, GdkEventButton *bevent, gpointer user_data)
 {
@@ -751,6 +930,7 @@ create_stack_trace_gui(StackTrace *st)
 	GtkTreeSelection *selection;
 	GtkTreeViewColumn *column;
 	GtkCellRenderer *renderer;
+	GtkAdjustment *adjustment;
 	AnjutaUI *ui;
 
 	g_return_if_fail (st->scrolledwindow == NULL);
@@ -767,7 +947,8 @@ create_stack_trace_gui(StackTrace *st)
 											   G_TYPE_STRING,
 	                                           G_TYPE_BOOLEAN,
 											   G_TYPE_STRING,
-											   G_TYPE_STRING));
+											   G_TYPE_STRING,
+	                                           G_TYPE_BOOLEAN));
 	st->treeview = GTK_TREE_VIEW (gtk_tree_view_new_with_model (model));
 	g_object_unref (G_OBJECT (model));
 
@@ -877,6 +1058,7 @@ create_stack_trace_gui(StackTrace *st)
 	g_signal_connect (st->treeview, "button-press-event", G_CALLBACK (on_stack_trace_button_press), st);
 	g_signal_connect (st->treeview, "row-activated", G_CALLBACK (on_stack_trace_row_activated), st);
 	g_signal_connect (st->treeview, "row-expanded", G_CALLBACK (on_stack_trace_row_expanded), st);
+	g_signal_connect (selection, "changed", G_CALLBACK (on_stack_trace_selection_changed), st);
 
 	/* Add stack window */
 	st->scrolledwindow = gtk_scrolled_window_new (NULL, NULL);
@@ -889,6 +1071,11 @@ create_stack_trace_gui(StackTrace *st)
 					   GTK_WIDGET (st->treeview));
 	gtk_widget_show_all (st->scrolledwindow);
 
+	/* Read more frames when the end of the stack becomes visible */
+	adjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (st->scrolledwindow));
+	g_signal_connect (adjustment, "value-changed", G_CALLBACK (on_stack_trace_scrolled), st);
+	g_signal_connect (adjustment, "changed", G_CALLBACK (on_stack_trace_scrolled), st);
+
 	anjuta_shell_add_widget (ANJUTA_PLUGIN(st->plugin)->shell,
 							 st->scrolledwindow,
 							 "AnjutaDebuggerStack", _("Stack"),
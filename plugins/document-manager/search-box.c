@@ -26,6 +26,7 @@
 #include "search-box.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <gtk/gtk.h>
 
 #include <libanjuta/anjuta-shell.h>
@@ -46,6 +47,8 @@
 /* Time spend to do search in the idle callback */
 #define CONTINUOUS_SEARCH_TIMEOUT 0.1
 
+typedef struct _SearchBoxHighlight SearchBoxHighlight;
+
 struct _SearchBoxPrivate
 {
 	GtkWidget* grid;
@@ -77,8 +80,7 @@ struct _SearchBoxPrivate
 	gboolean highlight_all;	
 	gboolean regex_mode;
 	
-	IAnjutaEditorCell *start_highlight;
-	IAnjutaEditorCell *end_highlight;
+	SearchBoxHighlight *highlight;
 	guint idle_id;
 
 	GtkCssProvider *provider;
@@ -90,6 +92,29 @@ struct _SearchBoxPrivate
 #define GET_PRIVATE(o) \
 	(G_TYPE_INSTANCE_GET_PRIVATE((o), SEARCH_TYPE_BOX, SearchBoxPrivate))
 
+/* Matches of a highlight all, searched in a thread on a copy of the text */
+struct _SearchBoxHighlight
+{
+	SearchBox *search_box;
+	IAnjutaEditor *editor;
+	gchar *text;
+	gchar *pattern;
+	gboolean case_sensitive;
+	gboolean regex_mode;
+
+	/* Set when a newer search replaces this one */
+	gint cancelled;
+	/* Set once the search thread is done */
+	gboolean ready;
+
+	/* Pairs of start and end character offsets */
+	GArray *matches;
+	gint n_matches;
+	/* Next matches to highlight, after and before the cursor */
+	gint next_after;
+	gint next_before;
+};
+
 G_DEFINE_TYPE (SearchBox, search_box, GTK_TYPE_HBOX);
 
 static void
@@ -98,10 +123,13 @@ on_search_box_hide (GtkWidget* button, SearchBox* search_box)
 	search_box_hide (search_box);
 }
 
+static void search_box_highlight_cancel (SearchBox *search_box);
+
 static void
 on_document_changed (AnjutaDocman* docman, IAnjutaDocument* doc,
 					SearchBox* search_box)
 {
+	search_box_highlight_cancel (search_box);
 	if (!doc || !IANJUTA_IS_EDITOR (doc))
 	{
 		gtk_widget_hide (GTK_WIDGET (search_box));
@@ -114,6 +142,16 @@ on_document_changed (AnjutaDocman* docman, IAnjutaDocument* doc,
 	}
 }
 
+static void
+on_document_removed (AnjutaDocman* docman, IAnjutaDocument* doc,
+					SearchBox* search_box)
+{
+	SearchBoxHighlight *highlight = search_box->priv->highlight;
+
+	if (highlight && IANJUTA_DOCUMENT (highlight->editor) == doc)
+		search_box_highlight_cancel (search_box);
+}
+
 static void
 on_goto_activated (GtkWidget* widget, SearchBox* search_box)
 {
@@ -269,43 +307,105 @@ search_regex_in_text (const gchar* search_entry, const gchar* editor_text, gbool
 
 }
 
-/* Search string in text, return TRUE and matching part as start and
- * end integer position */
-static gboolean
-search_str_in_text (const gchar* search_entry, const gchar* editor_text, gboolean case_sensitive, gint * start_pos, gint * end_pos)
+/* Fold the case of a character for comparison, one character at a time
+ * unlike g_utf8_casefold () which can expand some characters */
+static inline gunichar
+search_fold_char (gunichar c)
 {
-	gboolean found;
-	
-	if (strlen (editor_text) >= strlen (search_entry))
-	{
-		gchar* selected_text_case;
-		gchar* search_text_case;
+	if (c < 0x80)
+		return g_ascii_tolower (c);
+	else
+		return g_unichar_tolower (g_unichar_toupper (c));
+}
 
-		if (case_sensitive)
+/* Check if text starts with search_entry, ignoring case. Return the end of
+ * the match in text or NULL */
+static const gchar*
+search_caseless_prefix (const gchar* text, const gchar* search_entry)
+{
+	const gchar* p = search_entry;
+	const gchar* t = text;
+
+	while (*p != '\0')
+	{
+		if ((guchar)*p < 0x80 && (guchar)*t < 0x80)
 		{
-			selected_text_case = g_strdup (editor_text);
-			search_text_case = g_strdup (search_entry);
+			/* ASCII characters, the common case */
+			if (g_ascii_tolower (*p) != g_ascii_tolower (*t))
+				return NULL;
+			p++;
+			t++;
 		}
 		else
 		{
-			selected_text_case = g_utf8_casefold (editor_text, strlen (editor_text));
-			search_text_case = g_utf8_casefold (search_entry, strlen (search_entry));
+			if (*t == '\0' ||
+			    search_fold_char (g_utf8_get_char (p)) != search_fold_char (g_utf8_get_char (t)))
+				return NULL;
+			p = g_utf8_next_char (p);
+			t = g_utf8_next_char (t);
 		}
+	}
 
-		gchar* strstr = g_strstr_len (selected_text_case, -1, search_text_case);
+	return t;
+}
+
+/* Search string in text, return TRUE and matching part as start and
+ * end integer position */
+static gboolean
+search_str_in_text (const gchar* search_entry, const gchar* editor_text, gboolean case_sensitive, gint * start_pos, gint * end_pos)
+{
+	const gchar* match = NULL;
+	const gchar* match_end = NULL;
 
-		if (strstr)
+	if (*search_entry == '\0')
+		return FALSE;
+
+	if (case_sensitive)
+	{
+		match = strstr (editor_text, search_entry);
+		if (match)
+			match_end = match + strlen (search_entry);
+	}
+	else if ((guchar)*search_entry < 0x80)
+	{
+		/* An ASCII character is always a character start in UTF-8, so
+		 * the text can be scanned byte per byte for the first one. Some
+		 * other characters fold to ASCII (KELVIN SIGN to k) so the start
+		 * of any non ASCII character is a candidate too */
+		gchar first = g_ascii_tolower (*search_entry);
+		const gchar* t;
+
+		for (t = editor_text; *t != '\0'; t++)
 		{
-			*start_pos = g_utf8_pointer_to_offset(selected_text_case, strstr);
-			*end_pos = g_utf8_pointer_to_offset(selected_text_case, strstr + strlen (search_entry));
-			found = TRUE;
+			if ((g_ascii_tolower (*t) == first || (guchar)*t >= 0xC0) &&
+			    (match_end = search_caseless_prefix (t, search_entry)) != NULL)
+			{
+				match = t;
+				break;
+			}
 		}
+	}
+	else
+	{
+		const gchar* t;
 
-		g_free (selected_text_case);
-		g_free (search_text_case);
+		for (t = editor_text; *t != '\0'; t = g_utf8_next_char (t))
+		{
+			if ((match_end = search_caseless_prefix (t, search_entry)) != NULL)
+			{
+				match = t;
+				break;
+			}
+		}
 	}
 
-	return found;
+	if (match == NULL)
+		return FALSE;
+
+	*start_pos = g_utf8_pointer_to_offset (editor_text, match);
+	*end_pos = *start_pos + g_utf8_pointer_to_offset (match, match_end);
+
+	return TRUE;
 }
 
 /* Search string in editor, return TRUE and matching part as start and
@@ -496,6 +596,23 @@ search_box_incremental_search (SearchBox* search_box,
 		ianjuta_iterable_first (IANJUTA_ITERABLE (search_start), NULL);
 		ianjuta_iterable_last (IANJUTA_ITERABLE (search_end), NULL);
 
+		/* The text on the other side of the start has just been searched,
+		 * only a match overlapping the start can still be found there. A
+		 * string match is at most as long in characters as its bytes */
+		if (!search_box->priv->regex_mode)
+		{
+			gint real_pos = ianjuta_iterable_get_position (real_start, NULL);
+			gint length = ianjuta_iterable_get_length (real_start, NULL);
+			gint overlap = strlen (search_text);
+
+			if (search_forward)
+				ianjuta_iterable_set_position (IANJUTA_ITERABLE (search_end),
+				                               MIN (real_pos + overlap, length), NULL);
+			else
+				ianjuta_iterable_set_position (IANJUTA_ITERABLE (search_start),
+				                               MAX (real_pos - overlap, 0), NULL);
+		}
+
 		/* Try to search again */
 		found = editor_search (search_box->priv->current_editor,
 		                       search_text,
@@ -577,78 +694,241 @@ search_box_incremental_search (SearchBox* search_box,
 	return found;
 }
 
+static void
+search_box_highlight_free (SearchBoxHighlight *highlight)
+{
+	g_object_unref (highlight->search_box);
+	g_object_unref (highlight->editor);
+	g_free (highlight->text);
+	g_free (highlight->pattern);
+	if (highlight->matches) g_array_unref (highlight->matches);
+	g_slice_free (SearchBoxHighlight, highlight);
+}
+
+/* Drop the current highlight all, the search thread frees it if running */
+static void
+search_box_highlight_cancel (SearchBox *search_box)
+{
+	SearchBoxHighlight *highlight = search_box->priv->highlight;
+
+	if (highlight == NULL)
+		return;
+	search_box->priv->highlight = NULL;
+
+	if (search_box->priv->idle_id)
+	{
+		g_source_remove (search_box->priv->idle_id);
+		search_box->priv->idle_id = 0;
+	}
+
+	if (highlight->ready)
+		search_box_highlight_free (highlight);
+	else
+		g_atomic_int_set (&highlight->cancelled, TRUE);
+}
+
+/* Highlight the matches found, starting from the cursor where the user is
+ * looking, for CONTINUOUS_SEARCH_TIMEOUT at most */
 static gboolean
 highlight_in_background (SearchBox *search_box)
 {
-	gboolean found = FALSE;
-	
+	SearchBoxHighlight *highlight = search_box->priv->highlight;
+	IAnjutaIterable *start;
+	IAnjutaIterable *end;
+	GTimer *timer;
+	gboolean after = TRUE;
 
-	if (search_box->priv->start_highlight != NULL)
+	if (highlight->editor != search_box->priv->current_editor)
 	{
-		const gchar* search_text = gtk_entry_get_text (GTK_ENTRY (search_box->priv->search_entry));
-		GTimer *timer = g_timer_new();
+		search_box->priv->idle_id = 0;
+		search_box->priv->highlight = NULL;
+		search_box_highlight_free (highlight);
+		return FALSE;
+	}
+
+	start = ianjuta_editor_get_start_position (highlight->editor, NULL);
+	end = ianjuta_editor_get_start_position (highlight->editor, NULL);
+	timer = g_timer_new ();
+	while ((highlight->next_after < highlight->n_matches ||
+	        highlight->next_before >= 0) &&
+	       g_timer_elapsed (timer, NULL) < CONTINUOUS_SEARCH_TIMEOUT)
+	{
+		gint match;
 
-		if (*search_text != '\0')
+		/* Alternate between the matches after and before the cursor */
+		if ((after && highlight->next_after < highlight->n_matches) ||
+		    highlight->next_before < 0)
+			match = highlight->next_after++;
+		else
+			match = highlight->next_before--;
+		after = !after;
+
+		if (ianjuta_iterable_set_position (start, 
+		                                   g_array_index (highlight->matches, gint, match * 2),
+		                                   NULL) &&
+		    ianjuta_iterable_set_position (end,
+		                                   g_array_index (highlight->matches, gint, match * 2 + 1),
+		                                   NULL))
 		{
-			do
-			{
-				IAnjutaEditorCell* result_start;
-				IAnjutaEditorCell* result_end;
-
-				found = editor_search (search_box->priv->current_editor,
-				                       search_text,
-				                       search_box->priv->case_sensitive,
-			        	               TRUE,
-			                	       search_box->priv->regex_mode,
-				                       search_box->priv->start_highlight,
-				                       search_box->priv->end_highlight,
-				                       &result_start,
-				                       &result_end);
-				if (found)
-				{
-					ianjuta_indicable_set(IANJUTA_INDICABLE(search_box->priv->current_editor), 
-					                      IANJUTA_ITERABLE (result_start), 
-					                      IANJUTA_ITERABLE (result_end),
-				        	              IANJUTA_INDICABLE_IMPORTANT, NULL);
-					g_object_unref (result_start);
-					g_object_unref (search_box->priv->start_highlight);
-					search_box->priv->start_highlight = result_end;
-				}
-			}
-			while (found && g_timer_elapsed(timer, NULL) < CONTINUOUS_SEARCH_TIMEOUT);
+			ianjuta_indicable_set (IANJUTA_INDICABLE (highlight->editor),
+			                       start, end,
+			                       IANJUTA_INDICABLE_IMPORTANT, NULL);
 		}
-		g_timer_destroy (timer);
 	}
+	g_timer_destroy (timer);
+	g_object_unref (start);
+	g_object_unref (end);
 
-	if (!found)
+	if (highlight->next_after < highlight->n_matches ||
+	    highlight->next_before >= 0)
+		return TRUE;
+
+	search_box->priv->idle_id = 0;
+	search_box->priv->highlight = NULL;
+	search_box_highlight_free (highlight);
+
+	return FALSE;
+}
+
+static gboolean
+highlight_ready (SearchBoxHighlight *highlight)
+{
+	SearchBox *search_box = highlight->search_box;
+	gint cursor;
+	gint i;
+
+	highlight->ready = TRUE;
+	if (highlight != search_box->priv->highlight)
 	{
-		search_box->priv->idle_id = 0;
-		g_clear_object (&search_box->priv->start_highlight);
-		g_clear_object (&search_box->priv->end_highlight);
+		search_box_highlight_free (highlight);
+		return FALSE;
+	}
+	if (highlight->editor != search_box->priv->current_editor)
+	{
+		search_box->priv->highlight = NULL;
+		search_box_highlight_free (highlight);
+		return FALSE;
 	}
 
-	return found;
+	/* Start with the first match after the cursor */
+	highlight->n_matches = highlight->matches->len / 2;
+	cursor = ianjuta_editor_get_offset (highlight->editor, NULL);
+	for (i = 0; i < highlight->n_matches; i++)
+	{
+		if (g_array_index (highlight->matches, gint, i * 2) >= cursor)
+			break;
+	}
+	highlight->next_after = i;
+	highlight->next_before = i - 1;
+
+	/* The matches around the cursor are highlighted now, the other ones
+	 * in idle time */
+	if (highlight_in_background (search_box))
+	{
+		search_box->priv->idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+		                                             (GSourceFunc)highlight_in_background,
+		                                             search_box,
+		                                             NULL);
+	}
+
+	return FALSE;
+}
+
+/* Find all matches in one pass, compiling the pattern once */
+static gpointer
+highlight_thread (SearchBoxHighlight *highlight)
+{
+	GRegex *regex;
+	GMatchInfo *match_info;
+	GRegexCompileFlags flags = 0;
+	gchar *pattern;
+	const gchar *last_pos;
+	gint last_offset;
+
+	if (highlight->regex_mode)
+	{
+		pattern = g_strdup (highlight->pattern);
+	}
+	else
+	{
+		pattern = g_regex_escape_string (highlight->pattern, -1);
+		if (!highlight->case_sensitive)
+			flags |= G_REGEX_CASELESS;
+	}
+
+	highlight->matches = g_array_new (FALSE, FALSE, sizeof (gint));
+	regex = g_regex_new (pattern, flags, 0, NULL);
+	g_free (pattern);
+	if (regex != NULL)
+	{
+		last_pos = highlight->text;
+		last_offset = 0;
+		g_regex_match (regex, highlight->text, 0, &match_info);
+		while (g_match_info_matches (match_info) &&
+		       !g_atomic_int_get (&highlight->cancelled))
+		{
+			gint start_pos;
+			gint end_pos;
+
+			g_match_info_fetch_pos (match_info, 0, &start_pos, &end_pos);
+			if (end_pos > start_pos)
+			{
+				/* Count characters from the previous match only */
+				gint start_offset;
+				gint end_offset;
+
+				start_offset = last_offset + 
+					g_utf8_pointer_to_offset (last_pos, highlight->text + start_pos);
+				end_offset = start_offset +
+					g_utf8_pointer_to_offset (highlight->text + start_pos,
+					                          highlight->text + end_pos);
+				g_array_append_val (highlight->matches, start_offset);
+				g_array_append_val (highlight->matches, end_offset);
+
+				last_pos = highlight->text + end_pos;
+				last_offset = end_offset;
+			}
+			g_match_info_next (match_info, NULL);
+		}
+		g_match_info_free (match_info);
+		g_regex_unref (regex);
+	}
+
+	g_idle_add ((GSourceFunc)highlight_ready, highlight);
+
+	return NULL;
 }
 
 void
 search_box_highlight_all (SearchBox *search_box)
 {
+	SearchBoxHighlight *highlight;
+	const gchar *search_text;
+
 	if (!search_box->priv->current_editor)
 		return;
 
 	ianjuta_indicable_clear(IANJUTA_INDICABLE(search_box->priv->current_editor), NULL);
-	if (search_box->priv->start_highlight != NULL) g_object_unref (search_box->priv->start_highlight);
-	if (search_box->priv->end_highlight != NULL) g_object_unref (search_box->priv->end_highlight);
-	search_box->priv->start_highlight = IANJUTA_EDITOR_CELL (ianjuta_editor_get_start_position (search_box->priv->current_editor, NULL));
-	search_box->priv->end_highlight = IANJUTA_EDITOR_CELL (ianjuta_editor_get_end_position (search_box->priv->current_editor, NULL));
+	search_box_highlight_cancel (search_box);
 
-	if (search_box->priv->idle_id == 0)
-	{
-		search_box->priv->idle_id = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
-		                                            (GSourceFunc)highlight_in_background,
-		                                            search_box,
-		                                            NULL);
-	}
+	search_text = gtk_entry_get_text (GTK_ENTRY (search_box->priv->search_entry));
+	if (*search_text == '\0')
+		return;
+
+	/* Search a snapshot of the text in a thread */
+	highlight = g_slice_new0 (SearchBoxHighlight);
+	highlight->search_box = g_object_ref (search_box);
+	highlight->editor = g_object_ref (search_box->priv->current_editor);
+	highlight->text = ianjuta_editor_get_text_all (highlight->editor, NULL);
+	highlight->pattern = g_strdup (search_text);
+	highlight->case_sensitive = search_box->priv->case_sensitive;
+	highlight->regex_mode = search_box->priv->regex_mode;
+	search_box->priv->highlight = highlight;
+
+	if (highlight->text == NULL)
+		highlight->text = g_strdup ("");
+	g_thread_unref (g_thread_new ("search-box-highlight",
+	                              (GThreadFunc)highlight_thread, highlight));
 }
 
 void 
@@ -673,8 +953,7 @@ search_box_toggle_highlight (SearchBox * search_box, gboolean status)
 	if (!status)
 	{
 		ianjuta_indicable_clear(IANJUTA_INDICABLE(search_box->priv->current_editor), NULL);
-		g_clear_object (&search_box->priv->start_highlight);
-		g_clear_object (&search_box->priv->end_highlight);
+		search_box_highlight_cancel (search_box);
 	}
 	else
 	{
@@ -1004,8 +1283,7 @@ search_box_init (SearchBox *search_box)
 	search_box->priv->case_sensitive = FALSE;
 
 	/* Highlight iterator */
-	search_box->priv->start_highlight = NULL;
-	search_box->priv->end_highlight = NULL;
+	search_box->priv->highlight = NULL;
 	search_box->priv->idle_id = 0;
 	
 	/* Initialize search_box grid */
@@ -1076,8 +1354,6 @@ search_box_finalize (GObject *object)
 	SearchBox *search_box = SEARCH_BOX (object);
 
 	if (search_box->priv->idle_id) g_source_remove (search_box->priv->idle_id);
-	if (search_box->priv->start_highlight) g_object_unref (search_box->priv->start_highlight);
-	if (search_box->priv->end_highlight) g_object_unref (search_box->priv->end_highlight);
 	if (search_box->priv->provider) g_object_unref (search_box->priv->provider);
 
 	G_OBJECT_CLASS (search_box_parent_class)->finalize (object);
@@ -1104,6 +1380,8 @@ search_box_new (AnjutaDocman *docman)
 
 	g_signal_connect (G_OBJECT (docman), "document-changed",
 					  G_CALLBACK (on_document_changed), search_box);
+	g_signal_connect (G_OBJECT (docman), "document-removed",
+					  G_CALLBACK (on_document_removed), search_box);
 
 	search_box->priv->status = anjuta_shell_get_status (docman->shell, NULL);
 	
@@ -0,0 +1,471 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * anjuta
+ * Copyright (C) Johannes Schmid 2012 <jhs@gnome.org>
+ *
+ * anjuta is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * anjuta is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include "search-files-command.h"
+#include <string.h>
+
+/* Files searched at the same time */
+#define SEARCH_THREADS_MAX 4
+
+struct _SearchFilesCommandPrivate
+{
+	GPtrArray* files;
+	gchar* pattern;
+	gboolean regex;
+	gboolean case_sensitive;
+
+	/* Compiled once for all files */
+	GRegex* compiled;
+
+	/* Text that any match contains, to skip files quickly */
+	gchar* literal;
+	gsize literal_len;
+
+	/* Results waiting for the ones of the previous files, and the results
+	 * ready to be read in order. Protected by the command lock */
+	SearchFilesResult** pending;
+	guint next_result;
+	GQueue* result_queue;
+};
+
+G_DEFINE_TYPE (SearchFilesCommand, search_files_command, ANJUTA_TYPE_ASYNC_COMMAND);
+
+void
+search_files_result_free (SearchFilesResult* result)
+{
+	g_free (result->error_message);
+	g_slice_free (SearchFilesResult, result);
+}
+
+/*
+ * Returns the longest run of plain characters of a regular expression which
+ * must be part of any match, or NULL if there is none or the expression is
+ * too complex to tell. Only the top level of the expression is considered,
+ * and a character followed by a quantifier ends the run.
+ */
+static gchar*
+search_files_command_get_regex_literal (const gchar* pattern)
+{
+	GString* run;
+	gchar* best = NULL;
+	gsize best_len = 0;
+	gint depth = 0;
+	const gchar* p;
+
+	/* Alternatives and inline options change everything */
+	if (strchr (pattern, '|') || strstr (pattern, "(?") || strstr (pattern, "\\Q"))
+		return NULL;
+
+	run = g_string_new (NULL);
+	for (p = pattern; *p != '\0'; p++)
+	{
+		gboolean end_run = FALSE;
+
+		switch (*p)
+		{
+			case '\\':
+				if (g_ascii_isalnum (p[1]) && !strchr ("dDwWsSbBAzZ", p[1]))
+				{
+					/* Back reference, character code, property... */
+					g_string_free (run, TRUE);
+					g_free (best);
+					return NULL;
+				}
+				else if (p[1] == '\0' || g_ascii_isalnum (p[1]) || (guchar)p[1] >= 0x80)
+				{
+					/* Character class or anchor */
+					if (p[1] != '\0')
+						p++;
+					end_run = TRUE;
+				}
+				else if (depth == 0)
+				{
+					p++;
+					g_string_append_c (run, *p);
+				}
+				else
+				{
+					p++;
+				}
+				break;
+			case '[':
+				/* Skip the class, a ']' first is part of it */
+				p++;
+				if (*p == '^')
+					p++;
+				if (*p == ']')
+					p++;
+				while (*p != '\0' && *p != ']')
+				{
+					if (*p == '\\' && p[1] != '\0')
+						p++;
+					p++;
+				}
+				if (*p == '\0')
+					p--;
+				end_run = TRUE;
+				break;
+			case '(':
+				depth++;
+				end_run = TRUE;
+				break;
+			case ')':
+				depth--;
+				end_run = TRUE;
+				break;
+			case '*':
+			case '?':
+			case '{':
+				/* The previous character may not be there */
+				if (depth == 0 && run->len > 0)
+				{
+					/* Do not cut a multibyte character */
+					const gchar* last = g_utf8_find_prev_char (run->str,
+					                                           run->str + run->len);
+					g_string_truncate (run, last ? last - run->str : 0);
+				}
+				if (*p == '{')
+				{
+					while (*p != '\0' && *p != '}')
+						p++;
+					if (*p == '\0')
+						p--;
+				}
+				end_run = TRUE;
+				break;
+			case '+':
+			case '.':
+			case '^':
+			case '$':
+				end_run = TRUE;
+				break;
+			default:
+				if (depth == 0)
+					g_string_append_c (run, *p);
+				break;
+		}
+
+		if (end_run || p[1] == '\0')
+		{
+			if (run->len > best_len)
+			{
+				g_free (best);
+				best = g_strndup (run->str, run->len);
+				best_len = run->len;
+			}
+			g_string_truncate (run, 0);
+		}
+	}
+	g_string_free (run, TRUE);
+
+	return best;
+}
+
+/* Like memmem, ignoring the case of ASCII characters */
+static const gchar*
+search_files_command_find_caseless (const gchar* text, gsize len,
+                                    const gchar* literal, gsize literal_len)
+{
+	gchar first[2];
+	const gchar* end;
+	const gchar* p;
+
+	if (literal_len > len)
+		return NULL;
+
+	first[0] = g_ascii_tolower (literal[0]);
+	first[1] = g_ascii_toupper (literal[0]);
+	end = text + len - literal_len + 1;
+	for (p = text; p < end;)
+	{
+		const gchar* lower = memchr (p, first[0], end - p);
+		const gchar* upper = first[0] == first[1] ? NULL : memchr (p, first[1], end - p);
+		const gchar* found;
+
+		if (lower == NULL)
+			found = upper;
+		else if (upper == NULL)
+			found = lower;
+		else
+			found = MIN (lower, upper);
+		if (found == NULL)
+			return NULL;
+
+		if (g_ascii_strncasecmp (found, literal, literal_len) == 0)
+			return found;
+		p = found + 1;
+	}
+
+	return NULL;
+}
+
+static gint
+search_files_command_count_matches (SearchFilesCommand* cmd,
+                                    const gchar* content, gsize len,
+                                    GError** error)
+{
+	GMatchInfo* match_info;
+	gint n_matches = 0;
+
+	/* Most files do not contain the pattern at all */
+	if (cmd->priv->literal != NULL)
+	{
+		const gchar* found;
+
+		if (cmd->priv->case_sensitive)
+			found = memmem (content, len, cmd->priv->literal, cmd->priv->literal_len);
+		else
+			found = search_files_command_find_caseless (content, len,
+			                                            cmd->priv->literal,
+			                                            cmd->priv->literal_len);
+		if (found == NULL)
+			return 0;
+	}
+
+	g_regex_match_full (cmd->priv->compiled, content, len, 0, 0, &match_info, error);
+	while (g_match_info_matches (match_info))
+	{
+		n_matches++;
+		g_match_info_next (match_info, NULL);
+	}
+	g_match_info_free (match_info);
+
+	return n_matches;
+}
+
+static void
+search_files_command_search_file (gpointer data, gpointer user_data)
+{
+	SearchFilesCommand* cmd = SEARCH_FILES_COMMAND (user_data);
+	guint index = GPOINTER_TO_UINT (data) - 1;
+	GFile* file = g_ptr_array_index (cmd->priv->files, index);
+	SearchFilesResult* result;
+	GError* error = NULL;
+	gchar* path;
+
+	result = g_slice_new0 (SearchFilesResult);
+	result->index = index;
+
+	/* Map local files, read the other ones */
+	path = g_file_get_path (file);
+	if (path != NULL)
+	{
+		GMappedFile* mapped;
+
+		mapped = g_mapped_file_new (path, FALSE, &error);
+		if (mapped != NULL)
+		{
+			gsize len = g_mapped_file_get_length (mapped);
+
+			if (len > 0)
+				result->n_matches =
+					search_files_command_count_matches (cmd,
+					                                    g_mapped_file_get_contents (mapped),
+					                                    len, &error);
+			g_mapped_file_unref (mapped);
+		}
+		g_free (path);
+	}
+	else
+	{
+		gchar* content;
+		gsize len;
+
+		if (g_file_load_contents (file, NULL, &content, &len, NULL, &error))
+		{
+			result->n_matches =
+				search_files_command_count_matches (cmd, content, len, &error);
+			g_free (content);
+		}
+	}
+
+	if (error)
+	{
+		result->error_code = error->code ? error->code : 1;
+		result->error_message = g_strdup (error->message);
+		g_error_free (error);
+	}
+
+	/* Hand over the results in the order of the files */
+	anjuta_async_command_lock (ANJUTA_ASYNC_COMMAND (cmd));
+	cmd->priv->pending[index] = result;
+	while (cmd->priv->next_result < cmd->priv->files->len &&
+	       cmd->priv->pending[cmd->priv->next_result] != NULL)
+	{
+		g_queue_push_tail (cmd->priv->result_queue,
+		                   cmd->priv->pending[cmd->priv->next_result]);
+		cmd->priv->pending[cmd->priv->next_result] = NULL;
+		cmd->priv->next_result++;
+	}
+	anjuta_async_command_unlock (ANJUTA_ASYNC_COMMAND (cmd));
+
+	anjuta_command_notify_data_arrived (ANJUTA_COMMAND (cmd));
+}
+
+static guint
+search_files_command_run (AnjutaCommand* anjuta_cmd)
+{
+	SearchFilesCommand* cmd = SEARCH_FILES_COMMAND (anjuta_cmd);
+	GRegexCompileFlags flags = G_REGEX_MULTILINE;
+	GError* error = NULL;
+	GThreadPool* pool;
+	gchar* pattern;
+	guint i;
+
+	g_return_val_if_fail (cmd->priv->pattern != NULL, 1);
+
+	if (!cmd->priv->regex)
+	{
+		pattern = g_regex_escape_string (cmd->priv->pattern, -1);
+		cmd->priv->literal = g_strdup (cmd->priv->pattern);
+	}
+	else
+	{
+		pattern = g_strdup (cmd->priv->pattern);
+		cmd->priv->literal = search_files_command_get_regex_literal (pattern);
+	}
+
+	if (!cmd->priv->case_sensitive)
+	{
+		const gchar* p;
+
+		flags |= G_REGEX_CASELESS;
+
+		/* Non ASCII characters have case variants of other lengths, it
+		 * includes k and s matching the KELVIN SIGN and the LONG S */
+		for (p = cmd->priv->literal; p != NULL && *p != '\0'; p++)
+		{
+			if ((guchar)*p >= 0x80 || strchr ("kKsS", *p))
+			{
+				g_free (cmd->priv->literal);
+				cmd->priv->literal = NULL;
+				break;
+			}
+		}
+	}
+	if (cmd->priv->literal != NULL && *cmd->priv->literal == '\0')
+	{
+		g_free (cmd->priv->literal);
+		cmd->priv->literal = NULL;
+	}
+	cmd->priv->literal_len = cmd->priv->literal ? strlen (cmd->priv->literal) : 0;
+
+	cmd->priv->compiled = g_regex_new (pattern, flags | G_REGEX_OPTIMIZE, 0, &error);
+	g_free (pattern);
+	if (error)
+	{
+		anjuta_async_command_set_error_message (anjuta_cmd, error->message);
+		g_error_free (error);
+		return 1;
+	}
+
+	cmd->priv->pending = g_new0 (SearchFilesResult*, cmd->priv->files->len);
+	cmd->priv->next_result = 0;
+
+	pool = g_thread_pool_new (search_files_command_search_file, cmd,
+	                          SEARCH_THREADS_MAX, FALSE, NULL);
+	for (i = 0; i < cmd->priv->files->len; i++)
+		g_thread_pool_push (pool, GUINT_TO_POINTER (i + 1), NULL);
+
+	/* Wait for all files */
+	g_thread_pool_free (pool, FALSE, TRUE);
+
+	return 0;
+}
+
+static void
+search_files_command_init (SearchFilesCommand *cmd)
+{
+	cmd->priv = G_TYPE_INSTANCE_GET_PRIVATE (cmd, SEARCH_TYPE_FILES_COMMAND, SearchFilesCommandPrivate);
+
+	cmd->priv->files = g_ptr_array_new_with_free_func (g_object_unref);
+	cmd->priv->result_queue = g_queue_new ();
+}
+
+static void
+search_files_command_finalize (GObject *object)
+{
+	SearchFilesCommand* cmd = SEARCH_FILES_COMMAND (object);
+
+	if (cmd->priv->pending)
+	{
+		guint i;
+
+		for (i = 0; i < cmd->priv->files->len; i++)
+		{
+			if (cmd->priv->pending[i])
+				search_files_result_free (cmd->priv->pending[i]);
+		}
+		g_free (cmd->priv->pending);
+	}
+	g_queue_free_full (cmd->priv->result_queue, (GDestroyNotify)search_files_result_free);
+	g_ptr_array_unref (cmd->priv->files);
+	if (cmd->priv->compiled)
+		g_regex_unref (cmd->priv->compiled);
+	g_free (cmd->priv->literal);
+	g_free (cmd->priv->pattern);
+
+	G_OBJECT_CLASS (search_files_command_parent_class)->finalize (object);
+}
+
+static void
+search_files_command_class_init (SearchFilesCommandClass *klass)
+{
+	GObjectClass* object_class = G_OBJECT_CLASS (klass);
+	AnjutaCommandClass* command_class = ANJUTA_COMMAND_CLASS(klass);
+
+	object_class->finalize = search_files_command_finalize;
+
+	command_class->run = search_files_command_run;
+
+	g_type_class_add_private (klass, sizeof(SearchFilesCommandPrivate));
+}
+
+/*
+ * search_files_command_new:
+ * @files: (element-type GFile): The files to search in.
+ *
+ * Search @pattern in all @files, several files at a time. The results are
+ * queued in the order of @files, each time "data-arrived" is emitted.
+ */
+SearchFilesCommand*
+search_files_command_new (GList* files, const gchar* pattern,
+                          gboolean case_sensitive, gboolean regex)
+{
+	SearchFilesCommand* cmd;
+	GList* node;
+
+	cmd = SEARCH_FILES_COMMAND (g_object_new (SEARCH_TYPE_FILES_COMMAND, NULL));
+	for (node = files; node != NULL; node = g_list_next (node))
+		g_ptr_array_add (cmd->priv->files, g_object_ref (node->data));
+	cmd->priv->pattern = g_strdup (pattern);
+	cmd->priv->case_sensitive = case_sensitive;
+	cmd->priv->regex = regex;
+
+	return cmd;
+}
+
+GQueue*
+search_files_command_get_result_queue (SearchFilesCommand* cmd)
+{
+	g_return_val_if_fail (cmd != NULL && SEARCH_IS_FILES_COMMAND (cmd), NULL);
+
+	return cmd->priv->result_queue;
+}
@@ -0,0 +1,72 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * anjuta
+ * Copyright (C) Johannes Schmid 2012 <jhs@gnome.org>
+ *
+ * anjuta is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * anjuta is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SEARCH_FILES_COMMAND_H_
+#define _SEARCH_FILES_COMMAND_H_
+
+#include <libanjuta/anjuta-async-command.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define SEARCH_TYPE_FILES_COMMAND             (search_files_command_get_type ())
+#define SEARCH_FILES_COMMAND(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), SEARCH_TYPE_FILES_COMMAND, SearchFilesCommand))
+#define SEARCH_FILES_COMMAND_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), SEARCH_TYPE_FILES_COMMAND, SearchFilesCommandClass))
+#define SEARCH_IS_FILES_COMMAND(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), SEARCH_TYPE_FILES_COMMAND))
+#define SEARCH_IS_FILES_COMMAND_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), SEARCH_TYPE_FILES_COMMAND))
+#define SEARCH_FILES_COMMAND_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), SEARCH_TYPE_FILES_COMMAND, SearchFilesCommandClass))
+
+typedef struct _SearchFilesCommandClass SearchFilesCommandClass;
+typedef struct _SearchFilesCommand SearchFilesCommand;
+typedef struct _SearchFilesCommandPrivate SearchFilesCommandPrivate;
+typedef struct _SearchFilesResult SearchFilesResult;
+
+struct _SearchFilesCommandClass
+{
+	AnjutaAsyncCommandClass parent_class;
+};
+
+struct _SearchFilesCommand
+{
+	AnjutaAsyncCommand parent_instance;
+
+	SearchFilesCommandPrivate* priv;
+};
+
+/* Outcome of the search in one file, index is the position of the file
+ * in the list given to search_files_command_new () */
+struct _SearchFilesResult
+{
+	guint index;
+	gint n_matches;
+	guint error_code;
+	gchar* error_message;
+};
+
+GType search_files_command_get_type (void) G_GNUC_CONST;
+SearchFilesCommand* search_files_command_new (GList* files,
+                                              const gchar* pattern,
+                                              gboolean case_sensitive,
+                                              gboolean regex);
+GQueue* search_files_command_get_result_queue (SearchFilesCommand* cmd);
+void search_files_result_free (SearchFilesResult* result);
+
+G_END_DECLS
+
+#endif /* _SEARCH_FILES_COMMAND_H_ */
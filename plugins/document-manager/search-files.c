@@ -19,6 +19,7 @@
 
 #include "search-files.h"
 #include "search-file-command.h"
+#include "search-files-command.h"
 #include "search-filter-file-command.h"
 #include <libanjuta/anjuta-command-queue.h>
 #include <libanjuta/interfaces/ianjuta-project-manager.h>
@@ -169,12 +170,11 @@ search_files_check_column_toggled (GtkCellRendererToggle* renderer,
 }
 
 static void
-search_files_finished (SearchFiles* sf, AnjutaCommandQueue* queue)
+search_files_set_idle (SearchFiles* sf)
 {
 	GtkAdjustment* h_adj;
 	GtkAdjustment* v_adj;
 
-	g_object_unref (queue);
 	sf->priv->busy = FALSE;
 
 	/* Scroll to first item */
@@ -188,6 +188,13 @@ search_files_finished (SearchFiles* sf, AnjutaCommandQueue* queue)
 	search_files_update_ui(sf);
 }
 
+static void
+search_files_finished (SearchFiles* sf, AnjutaCommandQueue* queue)
+{
+	g_object_unref (queue);
+	search_files_set_idle (sf);
+}
+
 static void
 search_files_command_finished (SearchFileCommand* cmd,
                                guint return_code,
@@ -224,6 +231,77 @@ search_files_command_finished (SearchFileCommand* cmd,
 	g_object_unref (cmd);
 }
 
+static void
+search_files_results_arrived (SearchFilesCommand* cmd,
+                              SearchFiles* sf)
+{
+	GPtrArray* refs;
+	GQueue* results;
+	SearchFilesResult* result;
+
+	refs = g_object_get_data (G_OBJECT (cmd), "__tree_refs");
+	results = search_files_command_get_result_queue (cmd);
+
+	while ((result = g_queue_pop_head (results)) != NULL)
+	{
+		GtkTreeIter iter;
+		GtkTreePath* path;
+
+		path = gtk_tree_row_reference_get_path (g_ptr_array_index (refs, result->index));
+		if (path != NULL)
+		{
+			gtk_tree_model_get_iter(sf->priv->files_model, &iter, path);
+			gtk_list_store_set (GTK_LIST_STORE (sf->priv->files_model),
+			                    &iter,
+			                    COLUMN_COUNT, result->n_matches,
+			                    COLUMN_ERROR_CODE, result->error_code,
+			                    COLUMN_ERROR_TOOLTIP, result->error_message,
+			                    -1);
+			gtk_tree_path_free(path);
+		}
+		search_files_result_free (result);
+	}
+}
+
+static void
+search_files_search_finished (SearchFilesCommand* cmd,
+                              guint return_code,
+                              SearchFiles* sf)
+{
+	search_files_results_arrived (cmd, sf);
+
+	/* The pattern is wrong, report it on all files */
+	if (return_code)
+	{
+		GPtrArray* refs;
+		gchar* message;
+		guint i;
+
+		refs = g_object_get_data (G_OBJECT (cmd), "__tree_refs");
+		message = anjuta_command_get_error_message (ANJUTA_COMMAND (cmd));
+		for (i = 0; i < refs->len; i++)
+		{
+			GtkTreeIter iter;
+			GtkTreePath* path;
+
+			path = gtk_tree_row_reference_get_path (g_ptr_array_index (refs, i));
+			if (path == NULL)
+				continue;
+			gtk_tree_model_get_iter(sf->priv->files_model, &iter, path);
+			gtk_list_store_set (GTK_LIST_STORE (sf->priv->files_model),
+			                    &iter,
+			                    COLUMN_ERROR_CODE, return_code,
+			                    COLUMN_ERROR_TOOLTIP, message,
+			                    -1);
+			gtk_tree_path_free(path);
+		}
+		g_free (message);
+	}
+
+	g_object_unref (cmd);
+	search_files_set_idle (sf);
+}
+
 static void
 search_files_search (SearchFiles* sf)
 {
@@ -231,9 +309,13 @@ search_files_search (SearchFiles* sf)
 
 	if (gtk_tree_model_get_iter_first(sf->priv->files_model, &iter))
 	{
-		AnjutaCommandQueue* queue = anjuta_command_queue_new(ANJUTA_COMMAND_QUEUE_EXECUTE_MANUAL);
+		SearchFilesCommand* cmd;
+		GList* files = NULL;
+		GPtrArray* refs;
 		const gchar* pattern =
 			gtk_entry_get_text (GTK_ENTRY (sf->priv->search_entry));
+
+		refs = g_ptr_array_new_with_free_func ((GDestroyNotify)gtk_tree_row_reference_free);
 		do
 		{
 			GFile* file;
@@ -263,28 +345,30 @@ search_files_search (SearchFiles* sf)
 				                                 path);
 				gtk_tree_path_free(path);
 
-
-				SearchFileCommand* cmd = search_file_command_new(file,
-				                                                 pattern,
-				                                                 NULL,
-				                                                 sf->priv->case_sensitive,
-				                                                 sf->priv->regex);
-				g_object_set_data (G_OBJECT (cmd), "__tree_ref",
-				                   ref);
-
-				g_signal_connect (cmd, "command-finished",
-				                  G_CALLBACK(search_files_command_finished), sf);
-
-				anjuta_command_queue_push(queue,
-				                          ANJUTA_COMMAND(cmd));
+				files = g_list_prepend (files, g_object_ref (file));
+				g_ptr_array_add (refs, ref);
 			}
 			g_object_unref (file);
 		}
 		while (gtk_tree_model_iter_next(sf->priv->files_model, &iter));
 
-		g_signal_connect_swapped (queue, "finished", G_CALLBACK (search_files_finished), sf);
-
-		anjuta_command_queue_start (queue);
+		/* All files are searched by one command, the pattern is compiled
+		 * once and several files are scanned at the same time */
+		files = g_list_reverse (files);
+		cmd = search_files_command_new (files,
+		                                pattern,
+		                                sf->priv->case_sensitive,
+		                                sf->priv->regex);
+		g_list_free_full (files, g_object_unref);
+		g_object_set_data_full (G_OBJECT (cmd), "__tree_refs",
+		                        refs, (GDestroyNotify)g_ptr_array_unref);
+
+		g_signal_connect (cmd, "data-arrived",
+		                  G_CALLBACK (search_files_results_arrived), sf);
+		g_signal_connect (cmd, "command-finished",
+		                  G_CALLBACK (search_files_search_finished), sf);
+
+		anjuta_command_start (ANJUTA_COMMAND (cmd));
 		gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE (sf->priv->files_model),
 		                                     COLUMN_COUNT,
 		                                     GTK_SORT_DESCENDING);
@@ -233,13 +233,13 @@ file_model_get_vcs_status (FileModel* model,
 		g_signal_connect_swapped (G_OBJECT (notify), "finished", 
 								  G_CALLBACK (file_model_free_vcs_data), data);
 
-		ianjuta_vcs_query_status(priv->ivcs,
-								 file,
-								 file_model_vcs_status_callback,
-								 data,
-								 NULL,
-								 notify,
-								 NULL);
+		ianjuta_vcs_query_directory_status (priv->ivcs,
+		                                    file,
+		                                    file_model_vcs_status_callback,
+		                                    data,
+		                                    NULL,
+		                                    notify,
+		                                    NULL);
 	}						 
 	gtk_tree_path_free (path);	
 }
@@ -338,11 +338,12 @@ file_model_update_file_foreach_func (GtkTreeModel* model,
 		return FALSE;
 	}
 	
+	/* The status is queried once for each directory afterwards */
 	file_model_update_file (FILE_MODEL (model), 
 	                        iter,
 	                        file,
 	                        info,
-	                        FALSE);
+	                        TRUE);
 	g_object_unref (info);
 	g_object_unref (file);
 	
@@ -350,6 +351,36 @@ file_model_update_file_foreach_func (GtkTreeModel* model,
 	return FALSE;
 }
 
+static gboolean
+file_model_get_vcs_status_foreach_func (GtkTreeModel* model,
+                                        GtkTreePath* path,
+                                        GtkTreeIter* iter,
+                                        gpointer user_data)
+{
+	GFile* dir;
+	gboolean is_dir;
+	GtkTreeIter child;
+	gboolean dummy;
+
+	gtk_tree_model_get (model, iter,
+	                    COLUMN_FILE, &dir,
+	                    COLUMN_IS_DIR, &is_dir, -1);
+
+	/* Only directories whose content has been loaded */
+	if (dir && is_dir && gtk_tree_model_iter_children (model, &child, iter))
+	{
+		gtk_tree_model_get (model, &child,
+		                    COLUMN_DUMMY, &dummy, -1);
+		if (!dummy)
+			file_model_get_vcs_status (FILE_MODEL (model), iter, dir);
+	}
+	if (dir)
+		g_object_unref (dir);
+
+	/* Continue iterating */
+	return FALSE;
+}
+
 static void
 file_model_add_file (FileModel* model,
 					 GtkTreeIter* parent,
@@ -370,6 +401,8 @@ void file_model_update_vcs_status (FileModel* model)
 {
     gtk_tree_model_foreach (GTK_TREE_MODEL(model), 
                             file_model_update_file_foreach_func, NULL);
+    gtk_tree_model_foreach (GTK_TREE_MODEL(model), 
+                            file_model_get_vcs_status_foreach_func, NULL);
 }
 
 static void
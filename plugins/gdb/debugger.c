@@ -61,6 +61,8 @@
 									 * returned by debugger */
 #define SUMMARY_MAX_LENGTH   90	 /* Should be smaller than 4K to be displayed
 				  * in GtkCellRendererCell */
+#define MAX_SENT_COMMANDS	16		/* Limit the number of concurrent
+									 * commands sent to gdb */
 
 enum {
 	DEBUGGER_NONE,
@@ -117,6 +119,8 @@ struct _DebuggerPriv
 	/* GDB command queue */
 	GList *cmd_queqe;
 	DebuggerCommand current_cmd;
+	GList *sent_cmds;	/* Sent after current_cmd, waiting for their result */
+	guint next_token;
 	gboolean skip_next_prompt;
 	gboolean command_output_sent;
 	
@@ -292,6 +296,8 @@ debugger_initialize (Debugger *debugger)
 	debugger->priv->current_cmd.parser = NULL;
 	
 	debugger->priv->cmd_queqe = NULL;
+	debugger->priv->sent_cmds = NULL;
+	debugger->priv->next_token = 1;
 	debugger->priv->cli_lines = NULL;
 	debugger->priv->solib_event = FALSE;
 	
@@ -573,50 +579,71 @@ debugger_clear_buffers (Debugger *debugger)
 	debugger->priv->cli_lines = NULL;
 }
 
-static DebuggerCommand *
-debugger_queue_get_next_command (Debugger *debugger)
+static void
+debugger_command_free (DebuggerCommand *dc)
 {
-	DebuggerCommand *dc;
+	g_free (dc->cmd);
+	g_free (dc);
+}
 
-	DEBUG_PRINT ("%s", "In function: debugger_get_next_command()");
-	
-	if (debugger->priv->cmd_queqe)
-	{
-		dc = g_list_nth_data (debugger->priv->cmd_queqe, 0);
-		debugger->priv->cmd_queqe = g_list_remove (debugger->priv->cmd_queqe, dc);
-	}
-	else
-		dc = NULL;
-	return dc;
+/* Make dc the command whose output is read now */
+static void
+debugger_queue_set_current_command (Debugger *debugger, DebuggerCommand *dc)
+{
+	DEBUG_PRINT ("%s", "In function: debugger_set_current_command()");
+
+	g_free (debugger->priv->current_cmd.cmd);
+	debugger->priv->current_cmd = *dc;
+	debugger->priv->command_output_sent = FALSE;
+	g_free (dc);
 }
 
-static gboolean
-debugger_queue_set_next_command (Debugger *debugger)
+/* Results normally come in the order the commands have been sent but use
+ * the token to find the right command anyway */
+static void
+debugger_queue_select_command (Debugger *debugger, guint token)
 {
-	DebuggerCommand *dc;
+	GList *node;
+	DebuggerCommand *current;
 
-	DEBUG_PRINT ("%s", "In function: debugger_set_next_command()");
-	
-	dc = debugger_queue_get_next_command (debugger);
-	if (!dc)
-	{
-		debugger->priv->current_cmd.cmd = NULL;
-		debugger->priv->current_cmd.parser = NULL;
-		debugger->priv->current_cmd.callback = NULL;
-		debugger->priv->current_cmd.user_data = NULL;
-		debugger->priv->current_cmd.flags = 0;
+	if ((token == 0) || (debugger->priv->current_cmd.token == token))
+		return;
 
-		return FALSE;
+	for (node = debugger->priv->sent_cmds; node != NULL; node = g_list_next (node))
+	{
+		if (((DebuggerCommand *)node->data)->token == token)
+			break;
 	}
-	g_free (debugger->priv->current_cmd.cmd);
-	debugger->priv->current_cmd.cmd = dc->cmd;
-	debugger->priv->current_cmd.parser = dc->parser;
-	debugger->priv->current_cmd.callback = dc->callback;
-	debugger->priv->current_cmd.user_data = dc->user_data;
-	debugger->priv->current_cmd.flags = dc->flags;
-	g_free (dc);
+	if (node == NULL)
+		return;
 
-	return TRUE;
+	DEBUG_PRINT ("Result of command %d before the one of %d", token, debugger->priv->current_cmd.token);
+
+	/* Put back the current command, it is still waiting for its result */
+	current = g_new (DebuggerCommand, 1);
+	*current = debugger->priv->current_cmd;
+	debugger->priv->current_cmd.cmd = NULL;
+	debugger->priv->sent_cmds = g_list_remove_link (debugger->priv->sent_cmds, node);
+	debugger->priv->sent_cmds = g_list_prepend (debugger->priv->sent_cmds, current);
+
+	debugger_queue_set_current_command (debugger, (DebuggerCommand *)node->data);
+	g_list_free (node);
+}
+
+/* A command can be sent before the previous ones are completed only if all
+ * of them are MI commands which do not change the debugger state */
+static gboolean
+debugger_queue_can_send_command (Debugger *debugger, const DebuggerCommand *dc)
+{
+	if (!debugger->priv->debugger_is_busy)
+		return TRUE;
+
+	return (dc->flags & DEBUGGER_COMMAND_CONCURRENT) &&
+		(dc->cmd[0] == '-') &&
+		(debugger->priv->current_cmd.cmd != NULL) &&
+		(debugger->priv->current_cmd.flags & DEBUGGER_COMMAND_CONCURRENT) &&
+		(debugger->priv->debugger_is_busy == g_list_length (debugger->priv->sent_cmds) + 1) &&
+		(debugger->priv->debugger_is_busy < MAX_SENT_COMMANDS);
 }
 
 static void
@@ -666,24 +693,39 @@ debugger_queue_clear (Debugger *debugger)
 	}
 	g_list_free (debugger->priv->cmd_queqe);
 	debugger->priv->cmd_queqe = NULL;
+	g_list_foreach (debugger->priv->sent_cmds, (GFunc)debugger_command_free, NULL);
+	g_list_free (debugger->priv->sent_cmds);
+	debugger->priv->sent_cmds = NULL;
 	g_free (debugger->priv->current_cmd.cmd);
 	debugger->priv->current_cmd.cmd = NULL;
 	debugger->priv->current_cmd.parser = NULL;
 	debugger->priv->current_cmd.callback = NULL;
 	debugger->priv->current_cmd.user_data = NULL;
 	debugger->priv->current_cmd.flags = 0;
+	debugger->priv->current_cmd.token = 0;
 	debugger_clear_buffers (debugger);
 }
 
 static void
-debugger_execute_command (Debugger *debugger, const gchar *command)
+debugger_execute_command (Debugger *debugger, DebuggerCommand *dc)
 {
 	gchar *cmd;
 	
-	DEBUG_PRINT ("In function: debugger_execute_command(%s) %d\n",command, debugger->priv->debugger_is_busy);
+	DEBUG_PRINT ("In function: debugger_execute_command(%s) %d\n",dc->cmd, debugger->priv->debugger_is_busy);
 	debugger->priv->debugger_is_busy++;
-	debugger->priv->command_output_sent = FALSE;
-	cmd = g_strconcat (command, "\n", NULL);
+
+	/* Tag MI commands, the token is repeated in the result */
+	if (dc->cmd[0] == '-')
+	{
+		dc->token = debugger->priv->next_token++;
+		if (debugger->priv->next_token == 0) debugger->priv->next_token = 1;
+		cmd = g_strdup_printf ("%u%s\n", dc->token, dc->cmd);
+	}
+	else
+	{
+		dc->token = 0;
+		cmd = g_strconcat (dc->cmd, "\n", NULL);
+	}
 	debugger_log_command (debugger, cmd);
 	anjuta_launcher_send_stdin (debugger->priv->launcher, cmd);
 	g_free (cmd);
@@ -694,12 +736,25 @@ debugger_queue_execute_command (Debugger *debugger)
 {
 	DEBUG_PRINT ("%s", "In function: debugger_queue_execute_command()");
 
-	if (!debugger->priv->debugger_is_busy &&
-		g_list_length (debugger->priv->cmd_queqe) >= 1)
+	while ((debugger->priv->cmd_queqe != NULL) &&
+		debugger_queue_can_send_command (debugger, debugger->priv->cmd_queqe->data))
 	{
-		debugger_clear_buffers (debugger);
-		if (debugger_queue_set_next_command (debugger))
-		debugger_execute_command (debugger, debugger->priv->current_cmd.cmd);
+		DebuggerCommand *dc = debugger->priv->cmd_queqe->data;
+
+		debugger->priv->cmd_queqe = g_list_delete_link (debugger->priv->cmd_queqe,
+														debugger->priv->cmd_queqe);
+		if (!debugger->priv->debugger_is_busy)
+		{
+			debugger_clear_buffers (debugger);
+			debugger_queue_set_current_command (debugger, dc);
+			debugger_execute_command (debugger, &debugger->priv->current_cmd);
+		}
+		else
+		{
+			/* Send it now, its output will be read after the current one */
+			debugger_execute_command (debugger, dc);
+			debugger->priv->sent_cmds = g_list_append (debugger->priv->sent_cmds, dc);
+		}
 	}
 }
 
@@ -1574,6 +1629,18 @@ debugger_parse_prompt (Debugger *debugger)
 	}
 	
 	debugger->priv->debugger_is_busy--;
+
+	/* Output of the next command already sent */
+	if (debugger->priv->sent_cmds != NULL)
+	{
+		DebuggerCommand *dc = debugger->priv->sent_cmds->data;
+
+		debugger->priv->sent_cmds = g_list_delete_link (debugger->priv->sent_cmds,
+														debugger->priv->sent_cmds);
+		debugger_clear_buffers (debugger);
+		debugger_queue_set_current_command (debugger, dc);
+	}
+
 	debugger_queue_execute_command (debugger);	/* Next command. Go. */
 	debugger_emit_ready (debugger);
 }
@@ -1711,6 +1778,19 @@ debugger_stdo_flush (Debugger *debugger)
 	{
 		return;
 	}
+	if (g_ascii_isdigit (*line))
+	{
+		/* Remove the token of result and asynchronous records */
+		gchar *end;
+		guint token = strtoul (line, &end, 10);
+
+		if ((*end == '^') || (*end == '*') || (*end == '+') || (*end == '='))
+		{
+			g_string_erase (debugger->priv->stdo_line, 0, end - line);
+			line = debugger->priv->stdo_line->str;
+			if (*line == '^') debugger_queue_select_command (debugger, token);
+		}
+	}
 	if (strncasecmp (line, "^error", 6) == 0)
 	{
 		/* GDB reported error */
@@ -1881,6 +1961,9 @@ on_gdb_terminated (AnjutaLauncher *launcher,
 	debugger->priv->prog_is_remote = FALSE;
 	debugger->priv->debugger_is_busy = 0;
 	debugger->priv->skip_next_prompt = FALSE;
+	g_list_foreach (debugger->priv->sent_cmds, (GFunc)debugger_command_free, NULL);
+	g_list_free (debugger->priv->sent_cmds);
+	debugger->priv->sent_cmds = NULL;
 
 	if (!debugger->priv->terminating)
 	{
@@ -2961,9 +3044,9 @@ debugger_list_local (Debugger *debugger, IAnjutaDebuggerGListCallback callback,
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
 	buff = g_strdup_printf("-stack-list-arguments 0 %d %d", debugger->priv->current_frame, debugger->priv->current_frame);
-	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_KEEP_RESULT, NULL, NULL, NULL);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_KEEP_RESULT | DEBUGGER_COMMAND_CONCURRENT, NULL, NULL, NULL);
 	g_free (buff);
-	debugger_queue_command (debugger, "-stack-list-locals 0", DEBUGGER_COMMAND_NO_ERROR, debugger_list_local_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, "-stack-list-locals 0", DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_CONCURRENT, debugger_list_local_finish, (IAnjutaDebuggerCallback)callback, user_data);
 }
 
 static void
@@ -3017,7 +3100,7 @@ debugger_list_argument (Debugger *debugger, IAnjutaDebuggerGListCallback callbac
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
 	buff = g_strdup_printf("-stack-list-arguments 0 %d %d", debugger->priv->current_frame, debugger->priv->current_frame);
-	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_NO_ERROR, debugger_list_argument_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_CONCURRENT, debugger_list_argument_finish, (IAnjutaDebuggerCallback)callback, user_data);
 	g_free (buff);
 }
 
@@ -3139,7 +3222,7 @@ debugger_inspect_memory (Debugger *debugger, gulong address, guint length, IAnju
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
 	buff = g_strdup_printf ("-data-read-memory 0x%lx x 1 1 %d", address, length);
-	debugger_queue_command (debugger, buff, 0, debugger_read_memory_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_CONCURRENT, debugger_read_memory_finish, (IAnjutaDebuggerCallback)callback, user_data);
 	g_free (buff);
 }
 
@@ -3240,7 +3323,7 @@ debugger_disassemble (Debugger *debugger, gulong address, guint length, IAnjutaD
 	/* Handle overflow */
 	end = (address + length < address) ? G_MAXULONG : address + length;
 	buff = g_strdup_printf ("-data-disassemble -s 0x%lx -e 0x%lx  -- 0", address, end);
-	debugger_queue_command (debugger, buff, 0, debugger_disassemble_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_CONCURRENT, debugger_disassemble_finish, (IAnjutaDebuggerCallback)callback, user_data);
 	g_free (buff);
 }
 
@@ -3335,12 +3418,12 @@ set_func_args (const GDBMIValue *frame_hash, GList** node)
 			if (!name)
 				continue;
 		
+			/* Values of structures and arrays are missing when listed
+			 * with --simple-values, display them like gdb does */
 			literal = gdbmi_value_hash_lookup (arg_hash, "value");
-			if (!literal)
-				continue;
-			value = gdbmi_value_literal_get (literal);
+			value = literal ? gdbmi_value_literal_get (literal) : NULL;
 			if (!value)
-				continue;
+				value = "...";
 			args_str = g_string_append (args_str, name);
 			args_str = g_string_append (args_str, "=");
 			args_str = g_string_append (args_str, value);
@@ -3410,8 +3493,27 @@ debugger_list_frame (Debugger *debugger, IAnjutaDebuggerGListCallback callback,
 
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
-	debugger_queue_command (debugger, "-stack-list-frames", DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_KEEP_RESULT, NULL, NULL, NULL);
-	debugger_queue_command (debugger, "-stack-list-arguments 1", DEBUGGER_COMMAND_NO_ERROR, debugger_stack_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, "-stack-list-frames", DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_KEEP_RESULT | DEBUGGER_COMMAND_CONCURRENT, NULL, NULL, NULL);
+	debugger_queue_command (debugger, "-stack-list-arguments 1", DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_CONCURRENT, debugger_stack_finish, (IAnjutaDebuggerCallback)callback, user_data);
+}
+
+void
+debugger_list_frame_range (Debugger *debugger, guint first, guint last, gboolean all_values, IAnjutaDebuggerGListCallback callback, gpointer user_data)
+{
+	gchar *buff;
+
+	DEBUG_PRINT ("%s", "In function: debugger_list_frame_range()");
+
+	g_return_if_fail (IS_DEBUGGER (debugger));
+
+	buff = g_strdup_printf ("-stack-list-frames %u %u", first, last);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_KEEP_RESULT | DEBUGGER_COMMAND_CONCURRENT, NULL, NULL, NULL);
+	g_free (buff);
+	/* Skip the values of structures and arrays if possible, they can be
+	 * very long */
+	buff = g_strdup_printf ("-stack-list-arguments %d %u %u", all_values ? 1 : 2, first, last);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_CONCURRENT, debugger_stack_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	g_free (buff);
 }
 
 static void
@@ -3544,7 +3646,7 @@ debugger_list_thread (Debugger *debugger, IAnjutaDebuggerGListCallback callback,
 
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
-	debugger_queue_command (debugger, "-thread-list-ids", DEBUGGER_COMMAND_NO_ERROR, debugger_list_thread_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, "-thread-list-ids", DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_CONCURRENT, debugger_list_thread_finish, (IAnjutaDebuggerCallback)callback, user_data);
 }
 
 static void
@@ -3736,7 +3838,7 @@ debugger_list_register (Debugger *debugger, IAnjutaDebuggerGListCallback callbac
 
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
-	debugger_queue_command (debugger, "-data-list-register-names", DEBUGGER_COMMAND_NO_ERROR, debugger_register_name_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, "-data-list-register-names", DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_CONCURRENT, debugger_register_name_finish, (IAnjutaDebuggerCallback)callback, user_data);
 }
 
 void
@@ -3746,7 +3848,7 @@ debugger_update_register (Debugger *debugger, IAnjutaDebuggerGListCallback callb
 
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
-	debugger_queue_command (debugger, "-data-list-register-values r", DEBUGGER_COMMAND_NO_ERROR, (DebuggerParserFunc)debugger_register_value_finish, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, "-data-list-register-values r", DEBUGGER_COMMAND_NO_ERROR | DEBUGGER_COMMAND_CONCURRENT, (DebuggerParserFunc)debugger_register_value_finish, (IAnjutaDebuggerCallback)callback, user_data);
 }
 
 void
@@ -3841,7 +3943,7 @@ debugger_evaluate_variable (Debugger *debugger, const gchar* name, IAnjutaDebugg
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
 	buff = g_strdup_printf ("-var-evaluate-expression %s", name);
-	debugger_queue_command (debugger, buff, 0, gdb_var_evaluate_expression, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_CONCURRENT, gdb_var_evaluate_expression, (IAnjutaDebuggerCallback)callback, user_data);
 	g_free (buff);
 }
 
@@ -3947,7 +4049,7 @@ void debugger_list_variable_children (Debugger *debugger, const gchar* name, gui
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
 	buff = g_strdup_printf ("-var-list-children --all-values %s %d %d", name, from, from + MAX_CHILDREN);
-	debugger_queue_command (debugger, buff, 0, gdb_var_list_children, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, buff, DEBUGGER_COMMAND_CONCURRENT, gdb_var_list_children, (IAnjutaDebuggerCallback)callback, user_data);
 	g_free (buff);
 }
 
@@ -4067,7 +4169,7 @@ void debugger_update_variable (Debugger *debugger, IAnjutaDebuggerGListCallback
 
 	g_return_if_fail (IS_DEBUGGER (debugger));
 
-	debugger_queue_command (debugger, "-var-update *", 0, gdb_var_update, (IAnjutaDebuggerCallback)callback, user_data);
+	debugger_queue_command (debugger, "-var-update *", DEBUGGER_COMMAND_CONCURRENT, gdb_var_update, (IAnjutaDebuggerCallback)callback, user_data);
 }
 
 GType
@@ -62,6 +62,7 @@ typedef enum
 	DEBUGGER_COMMAND_NO_ERROR = 1 << 0,
 	DEBUGGER_COMMAND_KEEP_RESULT = 1 << 1,
 	DEBUGGER_COMMAND_PREPEND = 1 << 2,
+	DEBUGGER_COMMAND_CONCURRENT = 1 << 3,
 } DebuggerCommandFlags;
 
 
@@ -72,6 +73,7 @@ struct _DebuggerCommand
 	DebuggerParserFunc parser;
 	IAnjutaDebuggerCallback callback;
 	gpointer user_data;
+	guint token;
 };
 
 struct _Debugger
@@ -177,6 +179,7 @@ void debugger_write_register (Debugger *debugger, const gchar *name, const gchar
 /* Stack */
 void debugger_list_argument (Debugger *debugger, IAnjutaDebuggerGListCallback func, gpointer user_data);
 void debugger_list_frame (Debugger *debugger, IAnjutaDebuggerGListCallback func, gpointer user_data);
+void debugger_list_frame_range (Debugger *debugger, guint first, guint last, gboolean all_values, IAnjutaDebuggerGListCallback func, gpointer user_data);
 void debugger_set_frame (Debugger *debugger, gsize frame);
 void debugger_dump_stack_trace (Debugger *debugger, IAnjutaDebuggerGListCallback func, gpointer user_data);
 
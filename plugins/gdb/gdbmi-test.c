@@ -23,6 +23,7 @@
 
 /* MI parser */
 #include <stdio.h>
+#include <string.h>
 #include <glib.h>
 #include <gtk/gtk.h>
 
@@ -32,6 +33,94 @@
 static gchar *gdb_test_line = 
 "^done,BreakpointTable={nr_rows=\"2\",nr_cols=\"6\",hdr=[{width=\"3\",alignment=\"-1\",col_name=\"number\",colhdr=\"Num\"},{width=\"14\",alignment=\"-1\",col_name=\"type\",colhdr=\"Type\"},{width=\"4\",alignment=\"-1\",col_name=\"disp\",colhdr=\"Disp\"},{width=\"3\",alignment=\"-1\",col_name=\"enabled\",colhdr=\"Enb\"},{width=\"10\",alignment=\"-1\",col_name=\"addr\",colhdr=\"Address\"},{width=\"40\",alignment=\"2\",col_name=\"what\",colhdr=\"What\"}],body=[bkpt={number=\"1\",type=\"breakpoint\",disp=\"keep\",enabled=\"y\",addr=\"0x08050f5d\",func=\"main\",file=\"main.c\",line=\"122\",times=\"1\"},bkpt={number=\"2\",type=\"breakpoint\",disp=\"keep\",enabled=\"y\",addr=\"0x0096fbae\",func=\"anjuta_plugin_activate\",file=\"anjuta-plugin.c\",line=\"395\",times=\"1\"}]}";
 
+#define GDB_TEST_CHILDREN		50000
+#define GDB_TEST_MEMORY_ROWS	8192
+#define GDB_TEST_DEPTH			100000
+
+/* Large records, like the ones returned for big arrays */
+static gchar *
+gdb_test_list_children_new (gint count)
+{
+	GString *line;
+	gint i;
+
+	line = g_string_new (NULL);
+	g_string_append_printf (line, "^done,numchild=\"%d\",children=[", count);
+	for (i = 0; i < count; i++)
+	{
+		g_string_append_printf (line, "%schild={name=\"var1.[%d]\",exp=\"[%d]\",numchild=\"0\",value=\"%d\",type=\"int\"}",
+								i == 0 ? "" : ",", i, i, i * 2);
+	}
+	g_string_append (line, "]");
+
+	return g_string_free (line, FALSE);
+}
+
+static gchar *
+gdb_test_read_memory_new (gint rows)
+{
+	GString *line;
+	gint i;
+
+	line = g_string_new (NULL);
+	g_string_append_printf (line, "^done,addr=\"0x1000\",nr-bytes=\"%d\",total-bytes=\"%d\",next-row=\"0x%x\",prev-row=\"0x%x\",next-page=\"0x%x\",prev-page=\"0x%x\",memory=[",
+							rows * 8, rows * 8, 0x1000 + rows * 8, 0x1000 - 8, 0x1000 + rows * 8, 0x1000 - rows * 8);
+	for (i = 0; i < rows; i++)
+	{
+		g_string_append_printf (line, "%s{addr=\"0x%x\",data=[\"0x00\",\"0x01\",\"0x02\",\"0x03\",\"0x04\",\"0x05\",\"0x06\",\"0x07\"],ascii=\"\\000\\001\\002\\003\\004\\005\\006\\a\"}",
+								i == 0 ? "" : ",", 0x1000 + i * 8);
+	}
+	g_string_append (line, "]");
+
+	return g_string_free (line, FALSE);
+}
+
+/* Deeply nested record, it must not overflow the stack */
+static gchar *
+gdb_test_nested_new (gint depth)
+{
+	GString *line;
+	gint i;
+
+	line = g_string_new ("^done,value=");
+	for (i = 0; i < depth; i++) g_string_append_c (line, '[');
+	for (i = 0; i < depth; i++) g_string_append_c (line, ']');
+
+	return g_string_free (line, FALSE);
+}
+
+static gboolean
+gdb_test_benchmark (const gchar *name, const gchar *line, const gchar *key, gint size)
+{
+	GDBMIValue *val;
+	const GDBMIValue *list;
+	GTimer *timer;
+	gboolean ok;
+	gint i;
+
+	timer = g_timer_new ();
+	val = gdbmi_value_parse (line);
+	g_timer_stop (timer);
+
+	ok = val != NULL;
+	if (ok)
+	{
+		/* Read all elements in order */
+		list = gdbmi_value_hash_lookup (val, key);
+		ok = (list != NULL) && (gdbmi_value_get_size (list) == size);
+		for (i = 0; ok && (i < size); i++)
+		{
+			ok = gdbmi_value_list_get_nth (list, i) != NULL;
+		}
+		gdbmi_value_free (val);
+	}
+	printf ("%s: %lu bytes parsed in %.3f ms, %s\n", name, (gulong)strlen (line),
+			g_timer_elapsed (timer, NULL) * 1000, ok ? "successful" : "failed");
+	g_timer_destroy (timer);
+
+	return ok;
+}
+
 #if 0
 static void
 output_callback (Debugger *debugger, DebuggerOutputType type,
@@ -100,6 +189,18 @@ main(int argc, char **argv)
 	{
 		printf ("GDB MI parse test failed\n");
 	}
+
+	printf ("GDB MI parse benchmarks:\n");
+	ptr = gdb_test_list_children_new (GDB_TEST_CHILDREN);
+	gdb_test_benchmark ("-var-list-children", ptr, "children", GDB_TEST_CHILDREN);
+	g_free (ptr);
+	ptr = gdb_test_read_memory_new (GDB_TEST_MEMORY_ROWS);
+	gdb_test_benchmark ("-data-read-memory", ptr, "memory", GDB_TEST_MEMORY_ROWS);
+	g_free (ptr);
+	ptr = gdb_test_nested_new (GDB_TEST_DEPTH);
+	gdb_test_benchmark ("Nested lists", ptr, "value", 1);
+	g_free (ptr);
+
 	printf ("Testing debugger\n");
 	gtk_init (&argc, &argv);
 
@@ -22,6 +22,16 @@
  */
 
 /* GDB MI parser */
+
+/*
+ * A record is copied once in an arena and parsed in place: names and
+ * literal values are slices of this copy, ended by overwriting the separator
+ * following them, and values are allocated in the arena too. Everything is
+ * freed at once with the root value.
+ * Children of hash and list values are kept in a linked list. A hash table
+ * is built to find hash elements only when a big hash is searched.
+ *---------------------------------------------------------------------------*/
+
 #include <stdio.h>
 #include <ctype.h>
 #include <string.h>
@@ -30,74 +40,182 @@
 
 #define GDBMI_DUMP_INDENT_SIZE 4
 
+/* Minimum size of arena blocks */
+#define GDBMI_ARENA_BLOCK_SIZE 4096
+
+/* Hash having more elements are indexed */
+#define GDBMI_HASH_INDEX_MIN 8
+
+typedef struct _GDBMIArena GDBMIArena;
+
+struct _GDBMIArena
+{
+	GDBMIValue *root;
+	GSList *blocks;
+	gchar *free;
+	gsize left;
+	GSList *indexes;		/* Hash tables used to find hash elements */
+	GSList *foreign;		/* Values from another arena added to a value */
+};
+
 struct _GDBMIValue
 {
 	GDBMIDataType type;
 	gchar *name;
+	GDBMIArena *arena;
+	GDBMIValue *next;		/* Next element in parent hash or list */
 	union {
-		GHashTable *hash;
-		GQueue *list;
-		GString *literal;
+		struct {
+			GDBMIValue *first;
+			GDBMIValue *last;
+			gint size;
+			GHashTable *index;
+			/* Last element got by position, to read lists in order */
+			GDBMIValue *cursor;
+			gint cursor_pos;
+		} children;
+		gchar *literal;
 	} data;
 };
 
-struct _GDBMIForeachHashData
+/* Arena functions
+ *---------------------------------------------------------------------------*/
+
+static GDBMIArena *
+gdbmi_arena_new (gsize size)
 {
-	GFunc user_callback;
-	gpointer user_data;
-};
+	GDBMIArena *arena = g_new0 (GDBMIArena, 1);
+	gchar *block;
 
-static guint GDBMI_deleted_hash_value = 0;
+	size = MAX (size, GDBMI_ARENA_BLOCK_SIZE);
+	block = g_malloc (size);
+	arena->blocks = g_slist_prepend (NULL, block);
+	arena->free = block;
+	arena->left = size;
 
-void
-gdbmi_value_free (GDBMIValue *val)
+	return arena;
+}
+
+static void
+gdbmi_arena_free (GDBMIArena *arena)
 {
-	g_return_if_fail (val != NULL);
-	
-	if (val->type == GDBMI_DATA_LITERAL)
+	g_slist_foreach (arena->foreign, (GFunc)gdbmi_value_free, NULL);
+	g_slist_free (arena->foreign);
+	g_slist_foreach (arena->indexes, (GFunc)g_hash_table_destroy, NULL);
+	g_slist_free (arena->indexes);
+	g_slist_foreach (arena->blocks, (GFunc)g_free, NULL);
+	g_slist_free (arena->blocks);
+	g_free (arena);
+}
+
+static gpointer
+gdbmi_arena_alloc (GDBMIArena *arena, gsize size)
+{
+	gpointer mem;
+
+	size = (size + sizeof (gpointer) - 1) & ~(sizeof (gpointer) - 1);
+	if (size > arena->left)
 	{
-		g_string_free (val->data.literal, TRUE);
+		/* Allocate bigger blocks as the arena grows */
+		gsize block_size = MAX (size, GDBMI_ARENA_BLOCK_SIZE << MIN (g_slist_length (arena->blocks), 4));
+
+		arena->free = g_malloc (block_size);
+		arena->blocks = g_slist_prepend (arena->blocks, arena->free);
+		arena->left = block_size;
 	}
-	else if (val->type == GDBMI_DATA_LIST)
+	mem = arena->free;
+	arena->free += size;
+	arena->left -= size;
+
+	return mem;
+}
+
+static gchar *
+gdbmi_arena_strdup (GDBMIArena *arena, const gchar *str)
+{
+	gsize len;
+	gchar *copy;
+
+	if (str == NULL) return NULL;
+
+	len = strlen (str) + 1;
+	copy = gdbmi_arena_alloc (arena, len);
+	memcpy (copy, str, len);
+
+	return copy;
+}
+
+static GDBMIValue *
+gdbmi_arena_value_new (GDBMIArena *arena, GDBMIDataType data_type, gchar *name)
+{
+	GDBMIValue *val = gdbmi_arena_alloc (arena, sizeof (GDBMIValue));
+
+	memset (val, 0, sizeof (GDBMIValue));
+	val->type = data_type;
+	val->name = name;
+	val->arena = arena;
+
+	return val;
+}
+
+/* Add value at the end of a hash or a list */
+static void
+gdbmi_value_append_child (GDBMIValue *val, GDBMIValue *value)
+{
+	if (value->arena != val->arena)
+	{
+		/* Free it with the parent */
+		val->arena->foreign = g_slist_prepend (val->arena->foreign, value);
+	}
+
+	value->next = NULL;
+	if (val->data.children.last == NULL)
 	{
-		gdbmi_value_foreach (val, (GFunc)gdbmi_value_free, NULL);
-		g_queue_free (val->data.list);
+		val->data.children.first = value;
 	}
 	else
 	{
-		g_hash_table_destroy (val->data.hash);
+		val->data.children.last->next = value;
 	}
-	g_free (val->name);
-	g_free (val);
+	val->data.children.last = value;
+	val->data.children.size++;
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+void
+gdbmi_value_free (GDBMIValue *val)
+{
+	g_return_if_fail (val != NULL);
+	g_return_if_fail (val->arena->root == val);
+
+	gdbmi_arena_free (val->arena);
 }
 
 GDBMIValue *
 gdbmi_value_new (GDBMIDataType data_type, const gchar *name)
 {
-	GDBMIValue *val = g_new0 (GDBMIValue, 1);
-	
-	val->type = data_type;
-	if (name)
-		val->name = g_strdup (name);
-	
+	GDBMIArena *arena;
+	GDBMIValue *val;
+
 	switch (data_type)
 	{
 		case GDBMI_DATA_HASH:
-			val->data.hash =
-				g_hash_table_new_full (g_str_hash, g_str_equal,
-									   (GDestroyNotify)g_free,
-									   (GDestroyNotify)gdbmi_value_free);
-			break;
 		case GDBMI_DATA_LIST:
-			val->data.list = g_queue_new ();
-			break;
 		case GDBMI_DATA_LITERAL:
-			val->data.literal = g_string_new (NULL);
 			break;
 		default:
 			g_warning ("Unknow MI data type. Should not reach here");
 			return NULL;
 	}
+
+	arena = gdbmi_arena_new (0);
+	val = gdbmi_arena_value_new (arena, data_type, gdbmi_arena_strdup (arena, name));
+	if (data_type == GDBMI_DATA_LITERAL)
+		val->data.literal = gdbmi_arena_strdup (arena, "");
+	arena->root = val;
+
 	return val;
 }
 
@@ -128,8 +246,7 @@ gdbmi_value_set_name (GDBMIValue *val, const gchar *name)
 {
 	g_return_if_fail (val != NULL);
 	g_return_if_fail (name != NULL);
-	g_free (val->name);
-	val->name = g_strdup (name);
+	val->name = gdbmi_arena_strdup (val->arena, name);
 }
 
 gint
@@ -139,44 +256,33 @@ gdbmi_value_get_size (const GDBMIValue* val)
 	
 	if (val->type == GDBMI_DATA_LITERAL)
 	{
-		if (val->data.literal->str)
+		if (val->data.literal)
 			return 1;
 		else
 			return 0;
 	}
-	else if (val->type == GDBMI_DATA_LIST)
-		return g_queue_get_length (val->data.list);
-	else if (val->type == GDBMI_DATA_HASH)
-		return g_hash_table_size (val->data.hash);
+	else if ((val->type == GDBMI_DATA_LIST) || (val->type == GDBMI_DATA_HASH))
+		return val->data.children.size;
 	else
 		return 0;
 }
 
-static void
-gdbmi_value_hash_foreach (const gchar *key, GDBMIValue* val,
-						  struct _GDBMIForeachHashData *hash_data)
-{
-	hash_data->user_callback (val, hash_data->user_data);
-}
-
 void
 gdbmi_value_foreach (const GDBMIValue* val, GFunc func, gpointer user_data)
 {
+	GDBMIValue *child;
+	GDBMIValue *next;
+
 	g_return_if_fail (val != NULL);
 	g_return_if_fail (func != NULL);
 	
-	if (val->type == GDBMI_DATA_LIST)
+	if ((val->type == GDBMI_DATA_LIST) || (val->type == GDBMI_DATA_HASH))
 	{
-		g_queue_foreach (val->data.list, func, user_data);
-	}
-	else if (val->type == GDBMI_DATA_HASH)
-	{
-		struct _GDBMIForeachHashData hash_data = {NULL, NULL};
-		
-		hash_data.user_callback = func;
-		hash_data.user_data = user_data;
-		g_hash_table_foreach (val->data.hash, (GHFunc)gdbmi_value_hash_foreach,
-							  &hash_data);
+		for (child = val->data.children.first; child != NULL; child = next)
+		{
+			next = child->next;
+			func (child, user_data);
+		}
 	}
 	else
 	{
@@ -190,7 +296,7 @@ gdbmi_value_literal_set (GDBMIValue* val, const gchar *data)
 {
 	g_return_if_fail (val != NULL);
 	g_return_if_fail (val->type == GDBMI_DATA_LITERAL);
-	g_string_assign (val->data.literal, data);
+	val->data.literal = gdbmi_arena_strdup (val->arena, data != NULL ? data : "");
 }
 
 const gchar*
@@ -198,46 +304,62 @@ gdbmi_value_literal_get (const GDBMIValue* val)
 {
 	g_return_val_if_fail (val != NULL, NULL);
 	g_return_val_if_fail (val->type == GDBMI_DATA_LITERAL, NULL);
-	return val->data.literal->str;
+	return val->data.literal;
 }
 
 /* Hash operations */
 void
 gdbmi_value_hash_insert (GDBMIValue* val, const gchar *key, GDBMIValue *value)
 {
-	gpointer orig_key;
-	gpointer orig_value;
-
 	g_return_if_fail (val != NULL);
 	g_return_if_fail (key != NULL);
 	g_return_if_fail (value != NULL);
 	g_return_if_fail (val->type == GDBMI_DATA_HASH);
 
+	if ((value->name == NULL) || (strcmp (value->name, key) != 0))
+		value->name = gdbmi_arena_strdup (value->arena, key);
+
 	/* GDBMI hash table could contains several data with the same
 	 * key (output of -thread-list-ids)
-	 * Keep old value under a random name, we get them using
-	 * foreach function */
-	if (g_hash_table_lookup_extended (val->data.hash, key, &orig_key, &orig_value))
-	{
-		/* Key already exist, remove it and insert value with
-		 * another name */
-		g_hash_table_steal (val->data.hash, key);
-		g_free (orig_key);
-		gchar *new_key = g_strdup_printf("[%d]", GDBMI_deleted_hash_value++);
-		g_hash_table_insert (val->data.hash, new_key, orig_value);
-
-	}
-	g_hash_table_insert (val->data.hash, g_strdup (key), value);
+	 * All are kept, we get them using foreach function, and the last
+	 * one is found by lookup */
+	gdbmi_value_append_child (val, value);
+	if (val->data.children.index != NULL)
+		g_hash_table_insert (val->data.children.index, value->name, value);
 }
 
 const GDBMIValue*
 gdbmi_value_hash_lookup (const GDBMIValue* val, const gchar *key)
 {
+	GDBMIValue *child;
+	GDBMIValue *found;
+
 	g_return_val_if_fail (val != NULL, NULL);
 	g_return_val_if_fail (key != NULL, NULL);
 	g_return_val_if_fail (val->type == GDBMI_DATA_HASH, NULL);
-	
-	return g_hash_table_lookup (val->data.hash, key);
+
+	if ((val->data.children.index == NULL) &&
+		(val->data.children.size > GDBMI_HASH_INDEX_MIN))
+	{
+		GHashTable *index;
+
+		index = g_hash_table_new (g_str_hash, g_str_equal);
+		for (child = val->data.children.first; child != NULL; child = child->next)
+			g_hash_table_insert (index, child->name, child);
+		val->arena->indexes = g_slist_prepend (val->arena->indexes, index);
+		((GDBMIValue *)val)->data.children.index = index;
+	}
+
+	if (val->data.children.index != NULL)
+		return g_hash_table_lookup (val->data.children.index, key);
+
+	found = NULL;
+	for (child = val->data.children.first; child != NULL; child = child->next)
+	{
+		if (strcmp (child->name, key) == 0) found = child;
+	}
+
+	return found;
 }
 
 /* List operations */
@@ -248,19 +370,38 @@ gdbmi_value_list_append (GDBMIValue* val, GDBMIValue *value)
 	g_return_if_fail (value != NULL);
 	g_return_if_fail (val->type == GDBMI_DATA_LIST);
 	
-	g_queue_push_tail (val->data.list, value);
+	gdbmi_value_append_child (val, value);
 }
 
 const GDBMIValue*
 gdbmi_value_list_get_nth (const GDBMIValue* val, gint idx)
 {
+	GDBMIValue *child;
+	gint pos;
+
 	g_return_val_if_fail (val != NULL, NULL);
 	g_return_val_if_fail (val->type == GDBMI_DATA_LIST, NULL);
 	
-	if (idx >= 0)
-		return g_queue_peek_nth (val->data.list, idx);
+	if ((idx < 0) || (idx >= val->data.children.size))
+		return idx < 0 ? val->data.children.last : NULL;
+
+	/* Start from the previous position if possible */
+	if ((val->data.children.cursor != NULL) && (val->data.children.cursor_pos <= idx))
+	{
+		child = val->data.children.cursor;
+		pos = val->data.children.cursor_pos;
+	}
 	else
-		return g_queue_peek_tail (val->data.list);
+	{
+		child = val->data.children.first;
+		pos = 0;
+	}
+	for (; pos < idx; pos++) child = child->next;
+
+	((GDBMIValue *)val)->data.children.cursor = child;
+	((GDBMIValue *)val)->data.children.cursor_pos = pos;
+
+	return child;
 }
 
 static void
@@ -284,7 +425,7 @@ gdbmi_value_dump (const GDBMIValue *val, gint indent_level)
 	{
 		gchar *v;
 		
-		v = g_strescape (val->data.literal->str, NULL);
+		v = g_strescape (val->data.literal, NULL);
 		if (val->name)
 			printf ("%s = \"%s\",\n", val->name, v);
 		else
@@ -317,191 +458,195 @@ gdbmi_value_dump (const GDBMIValue *val, gint indent_level)
 	}
 }
 
-static GDBMIValue*
-gdbmi_value_parse_real (gchar **ptr)
+/* Parser
+ *---------------------------------------------------------------------------*/
+
+/* Remove quotes and escape sequences of the literal starting at *ptr in
+ * place, like g_strcompress, and returns it */
+static gchar *
+gdbmi_value_parse_literal (gchar **ptr)
 {
-	GDBMIValue *val = NULL;
-	
-	if (**ptr == '\0')
-	{
-		/* End of stream */
-		g_warning ("Parse error: Reached end of stream");
-	}
-	else if (**ptr == '"')
-	{
-		/* Value is literal */
-		gboolean escaped;
-		GString *buff;
-		gchar *p;
-		gchar *value, *compressed_value;
-		gint i;
-		
-		*ptr = g_utf8_next_char (*ptr);
-		escaped = FALSE;
-		buff = g_string_new ("");
-		while (escaped || **ptr != '"')
-		{
-			if (**ptr == '\0')
-			{
-				g_warning ("Parse error: Invalid literal value");
-				return NULL;
-			}
-			if (escaped)
-			{
-				escaped = FALSE;
-			}
-			else if (**ptr == '\\')
-			{
-				escaped = TRUE;
-			}
-			p = g_utf8_next_char (*ptr);
-			for (i = 0; i < (p - *ptr); i++)
-				g_string_append_c (buff, *(*ptr + i));
-			*ptr = p;
-		}
-		/* Get pass the closing quote */
-		*ptr = g_utf8_next_char (*ptr);
-		
-		value = g_string_free (buff, FALSE);
-		compressed_value = g_strcompress (value);
-		val = gdbmi_value_literal_new (NULL, compressed_value);
-		g_free (value);
-		g_free (compressed_value);
-	}
-	else if (isalpha (**ptr))
+	gchar *src;
+	gchar *dst;
+	gchar *literal;
+
+	literal = dst = src = *ptr + 1;
+	while (*src != '"')
 	{
-		/* Value is assignment */
-		gchar *name;
-		gchar *p;
-		
-		/* Get assignment name */
-		p = *ptr;
-		while (**ptr != '=')
+		if (*src == '\0')
 		{
-			if (**ptr == '\0')
-			{
-				g_warning ("Parse error: Invalid assignment name");
-				return NULL;
-			}
-			*ptr = g_utf8_next_char (*ptr);
+			g_warning ("Parse error: Invalid literal value");
+			return NULL;
 		}
-		name = g_strndup (p, *ptr - p);
-		
-		/* Skip pass assignment operator */
-		*ptr = g_utf8_next_char (*ptr);
-		
-		/* Retrieve assignment value */
-		val = gdbmi_value_parse_real (ptr);
-		if (val)
+		else if (*src != '\\')
 		{
-			gdbmi_value_set_name (val, name);
+			*dst++ = *src++;
+			continue;
 		}
-		else
+
+		src++;
+		switch (*src)
 		{
-			g_warning ("Parse error: From parent");
+		case '\0':
+			g_warning ("Parse error: Invalid literal value");
+			return NULL;
+		case '0': case '1': case '2': case '3':
+		case '4': case '5': case '6': case '7':
+			{
+				gint digits;
+
+				*dst = 0;
+				for (digits = 0; (digits < 3) && (*src >= '0') && (*src <= '7'); digits++)
+					*dst = (*dst * 8) + (*src++ - '0');
+				dst++;
+			}
+			continue;
+		case 'b':
+			*dst++ = '\b';
+			break;
+		case 'f':
+			*dst++ = '\f';
+			break;
+		case 'n':
+			*dst++ = '\n';
+			break;
+		case 'r':
+			*dst++ = '\r';
+			break;
+		case 't':
+			*dst++ = '\t';
+			break;
+		case 'v':
+			*dst++ = '\v';
+			break;
+		default:
+			*dst++ = *src;
+			break;
 		}
-		g_free (name);
+		src++;
 	}
-	else if (**ptr == '{')
+	*dst = '\0';
+	/* Get pass the closing quote */
+	*ptr = src + 1;
+
+	return literal;
+}
+
+static gchar
+gdbmi_value_get_closing (const GDBMIValue *val)
+{
+	return val->type == GDBMI_DATA_HASH ? '}' : ']';
+}
+
+/* Parse the hash or list elements starting at ptr until its end, the parent
+ * containers are kept in a stack instead of using recursion, so deep values
+ * cannot overflow the C stack */
+static gboolean
+gdbmi_value_parse_elements (GDBMIValue *root, gchar *ptr, gchar end)
+{
+	GPtrArray *parents;
+	GDBMIValue *parent;
+	gboolean error = FALSE;
+
+	parents = g_ptr_array_new ();
+	parent = root;
+	while (!error)
 	{
-		/* Value is hash */
-		gboolean error = FALSE;
-		
-		*ptr = g_utf8_next_char (*ptr);
-		val = gdbmi_value_new (GDBMI_DATA_HASH, NULL);
-		while (**ptr != '}')
+		GDBMIValue *element;
+		gchar *name = NULL;
+		gchar closing;
+
+		/* Check end of container */
+		closing = parent == root ? end : gdbmi_value_get_closing (parent);
+		if (*ptr != closing)
 		{
-			GDBMIValue *element;
-			element = gdbmi_value_parse_real (ptr);
-			if (element == NULL)
+			if (g_ascii_isalpha (*ptr))
 			{
-				g_warning ("Parse error: From parent");
-				error = TRUE;
-				break;
+				/* Value is assignment, get assignment name */
+				name = ptr;
+				ptr = strchr (ptr, '=');
+				if (ptr == NULL)
+				{
+					g_warning ("Parse error: Invalid assignment name");
+					error = TRUE;
+					break;
+				}
+				/* Skip pass assignment operator */
+				*ptr++ = '\0';
 			}
-			if (gdbmi_value_get_name(element) == NULL)
+			else if (parent->type == GDBMI_DATA_HASH)
 			{
 				g_warning ("Parse error: Hash element has no name => '%s'",
-						   *ptr);
+						   ptr);
 				error = TRUE;
-				gdbmi_value_free (element);
 				break;
 			}
-			if (**ptr != ',' && **ptr != '}')
+
+			if (*ptr == '"')
 			{
-				g_warning ("Parse error: Invalid element separator => '%s'",
-						   *ptr);
-				error = TRUE;
-				gdbmi_value_free (element);
-				break;
+				/* Value is literal */
+				element = gdbmi_arena_value_new (root->arena, GDBMI_DATA_LITERAL, name);
+				element->data.literal = gdbmi_value_parse_literal (&ptr);
+				if (element->data.literal == NULL)
+				{
+					error = TRUE;
+					break;
+				}
+				gdbmi_value_append_child (parent, element);
 			}
-			gdbmi_value_hash_insert (val, gdbmi_value_get_name (element),
-									 element);
-			
-			/* Get pass the comma separator */
-			if (**ptr == ',')
-				*ptr = g_utf8_next_char (*ptr);
-		}
-		if (error)
-		{
-			gdbmi_value_free (val);
-			val = NULL;
-		}
-		/* Get pass the closing hash */
-		*ptr = g_utf8_next_char (*ptr);
-	}
-	else if (**ptr == '[')
-	{
-		/* Value is list */
-		gboolean error = FALSE;
-		
-		*ptr = g_utf8_next_char (*ptr);
-		val = gdbmi_value_new (GDBMI_DATA_LIST, NULL);
-		while (**ptr != ']')
-		{
-			GDBMIValue *element;
-			element = gdbmi_value_parse_real (ptr);
-			if (element == NULL)
+			else if ((*ptr == '{') || (*ptr == '['))
 			{
-				g_warning ("Parse error: From parent");
-				error = TRUE;
-				break;
+				/* Value is hash or list, read its elements */
+				element = gdbmi_arena_value_new (root->arena, *ptr == '{' ? GDBMI_DATA_HASH : GDBMI_DATA_LIST, name);
+				gdbmi_value_append_child (parent, element);
+				g_ptr_array_add (parents, parent);
+				parent = element;
+				ptr++;
+				continue;
 			}
-			if (**ptr != ',' && **ptr != ']')
+			else
 			{
-				g_warning ("Parse error: Invalid element separator => '%s'",
-						   *ptr);
+				/* Should not be here -- Error */
+				g_warning ("Parse error: Should not be here => '%s'", ptr);
 				error = TRUE;
-				gdbmi_value_free (element);
 				break;
 			}
-			gdbmi_value_list_append (val, element);
-			
-			/* Get pass the comma separator */
-			if (**ptr == ',')
-				*ptr = g_utf8_next_char (*ptr);
 		}
-		if (error)
+		else
 		{
-			gdbmi_value_free (val);
-			val = NULL;
+			/* End of container */
+			if (parent == root) break;
+			ptr++;
+			parent = g_ptr_array_index (parents, parents->len - 1);
+			g_ptr_array_remove_index (parents, parents->len - 1);
+			closing = parent == root ? end : gdbmi_value_get_closing (parent);
+		}
+
+		/* Get pass the comma separator */
+		if (*ptr == ',')
+		{
+			ptr++;
+		}
+		else if (*ptr != closing)
+		{
+			g_warning ("Parse error: Invalid element separator => '%s'",
+					   ptr);
+			error = TRUE;
 		}
-		/* Get pass the closing list */
-		*ptr = g_utf8_next_char (*ptr);
-	}
-	else
-	{
-		/* Should not be here -- Error */
-		g_warning ("Parse error: Should not be here => '%s'", *ptr);
 	}
-	return val;
+	g_ptr_array_free (parents, TRUE);
+
+	return !error;
 }
 
 G_MODULE_EXPORT GDBMIValue*
 gdbmi_value_parse (const gchar *message)
 {
+	GDBMIArena *arena;
 	GDBMIValue *val;
-	gchar *msg, *ptr;
+	const gchar *results;
+	gsize len;
+	gchar *msg;
 	
 	g_return_val_if_fail (message != NULL, NULL);
 	
@@ -511,13 +656,24 @@ gdbmi_value_parse (const gchar *message)
 		return NULL; /* No message */
 	}
 	
-	val = NULL;
-	if (strchr (message, ','))
+	results = strchr (message, ',');
+	if (results == NULL)
+		return NULL;
+
+	/* Copy results in the arena, values are parsed in place */
+	results++;
+	len = strlen (results) + 1;
+	arena = gdbmi_arena_new (len + len / 2);
+	msg = gdbmi_arena_alloc (arena, len);
+	memcpy (msg, results, len);
+
+	val = gdbmi_arena_value_new (arena, GDBMI_DATA_HASH, NULL);
+	arena->root = val;
+	if (!gdbmi_value_parse_elements (val, msg, '\0'))
 	{
-		msg = g_strconcat ("{", strchr (message, ',') + 1, "}", NULL);
-		ptr = msg;
-		val = gdbmi_value_parse_real (&ptr);
-		g_free (msg);
+		gdbmi_value_free (val);
+		val = NULL;
 	}
+
 	return val;
 }
@@ -40,6 +40,11 @@ struct GiggleGraphRendererPrivate {
 	gint            n_paths;
 	GHashTable     *paths_info;
 	GitRevision *revision;
+
+	/* incremental layout state, see giggle_graph_renderer_validate_revision() */
+	GHashTable     *visible_paths;
+	GHashTable     *pending_parents;
+	gint            n_color;
 };
 
 typedef struct GiggleGraphRendererPathState GiggleGraphRendererPathState;
@@ -168,6 +173,11 @@ giggle_graph_renderer_finalize (GObject *object)
 		g_hash_table_destroy (priv->paths_info);
 	}
 
+	if (priv->visible_paths) {
+		g_hash_table_destroy (priv->visible_paths);
+		g_hash_table_destroy (priv->pending_parents);
+	}
+
 	G_OBJECT_CLASS (giggle_graph_renderer_parent_class)->finalize (object);
 }
 
@@ -305,7 +315,8 @@ giggle_graph_renderer_render (GtkCellRenderer *cell,
 		pos = GPOINTER_TO_INT (g_hash_table_lookup (priv->paths_info, children->data));
 		path_state = g_hash_table_lookup (table, GINT_TO_POINTER (pos));
 
-		if (path_state->upper_n_color != INVALID_COLOR) {
+		/* children not laid out yet have no path */
+		if (path_state && path_state->upper_n_color != INVALID_COLOR) {
 			gdk_cairo_set_source_color (cr, &colors[path_state->upper_n_color]);
 			cairo_move_to (cr,
 				       x + (cur_pos * PATH_SPACE (size)),
@@ -412,131 +423,122 @@ free_paths_state (GArray *array)
 	g_array_free (array, TRUE);
 }
 
-static void
-giggle_graph_renderer_calculate_revision_state (GiggleGraphRenderer *renderer,
-						GitRevision      *revision,
-						GHashTable          *visible_paths,
-						gint                *n_color)
+void
+giggle_graph_renderer_reset (GiggleGraphRenderer *renderer)
+{
+	GiggleGraphRendererPrivate *priv;
+
+	g_return_if_fail (GIGGLE_IS_GRAPH_RENDERER (renderer));
+
+	priv = renderer->_priv;
+
+	if (priv->paths_info) {
+		g_hash_table_destroy (priv->paths_info);
+	}
+
+	if (priv->visible_paths) {
+		g_hash_table_destroy (priv->visible_paths);
+		g_hash_table_destroy (priv->pending_parents);
+	}
+
+	priv->n_paths = 0;
+	priv->n_color = 0;
+	priv->paths_info = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->visible_paths = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->pending_parents = g_hash_table_new (g_direct_hash, g_direct_equal);
+}
+
+/* Lays out one more row below the ones already validated. This goes from
+ * the newest revision down, so rows can be laid out as they are fetched
+ * without the whole history. A path stays visible from a
+ * revision down to the last of its parents, where the parent takes it over
+ * or it ends.
+ */
+void
+giggle_graph_renderer_validate_revision (GiggleGraphRenderer *renderer,
+					 GitRevision         *revision)
 {
-	GiggleGraphRendererPathState  path_state;
 	GiggleGraphRendererPrivate   *priv;
-	GitRevision               *rev;
+	GiggleGraphRendererPathState *path_state;
 	GArray                       *paths_state;
 	GList                        *children;
-	gboolean                      current_path_reused = FALSE;
-	gboolean                      update_color;
-	gint                          n_path, i;
+	gint                          n_path = 0;
+	gint                          child_path, n_pending, i;
+	guint                         n_parents;
+
+	g_return_if_fail (GIGGLE_IS_GRAPH_RENDERER (renderer));
 
 	priv = renderer->_priv;
-	children = git_revision_get_children (revision);
-	update_color = (g_list_length (children) > 1);
-	paths_state = get_initial_status (visible_paths);
 
-	while (children) {
-		rev = GIT_REVISION (children->data);
-		n_path = GPOINTER_TO_INT (g_hash_table_lookup (priv->paths_info, rev));
+	if (!priv->visible_paths) {
+		giggle_graph_renderer_reset (renderer);
+	}
 
-		if (!n_path) {
-			/* there wasn't a path for this revision, choose one */
-			if (!current_path_reused) {
-				n_path = GPOINTER_TO_INT (g_hash_table_lookup (priv->paths_info, revision));
-				current_path_reused = TRUE;
-			} else {
-				find_free_path (visible_paths, &priv->n_paths, &n_path);
-			}
+	/* every visible path comes from the rows above */
+	paths_state = get_initial_status (priv->visible_paths);
 
-			g_hash_table_insert (priv->paths_info, rev, GINT_TO_POINTER (n_path));
-			path_state.lower_n_color =
-				GPOINTER_TO_INT (g_hash_table_lookup (visible_paths, GINT_TO_POINTER (n_path)));
+	for (children = git_revision_get_children (revision); children; children = children->next) {
+		child_path = GPOINTER_TO_INT (g_hash_table_lookup (priv->paths_info, children->data));
 
-			if (update_color) {
-				path_state.upper_n_color = *n_color = NEXT_COLOR (*n_color);
-			} else {
-				path_state.upper_n_color = path_state.lower_n_color;
-			}
-		} else {
-			path_state.lower_n_color =
-				GPOINTER_TO_INT (g_hash_table_lookup (visible_paths, GINT_TO_POINTER (n_path)));
+		if (!child_path) {
+			continue;
+		}
 
-			path_state.upper_n_color = path_state.lower_n_color;
+		n_pending = GPOINTER_TO_INT (g_hash_table_lookup (priv->pending_parents, children->data)) - 1;
+
+		if (n_pending > 0) {
+			/* the child still has parents below */
+			g_hash_table_insert (priv->pending_parents, children->data, GINT_TO_POINTER (n_pending));
+			continue;
 		}
 
-		path_state.n_path = n_path;
-		g_hash_table_insert (visible_paths, GINT_TO_POINTER (n_path), GINT_TO_POINTER ((gint) path_state.upper_n_color));
-		g_array_append_val (paths_state, path_state);
+		g_hash_table_remove (priv->pending_parents, children->data);
 
-		children = children->next;
-	}
+		if (!n_path) {
+			/* continue the path of the child */
+			n_path = child_path;
+			continue;
+		}
 
-	if (!current_path_reused) {
-		/* current path is a dead end, remove it from the visible paths table */
-		n_path = GPOINTER_TO_INT (g_hash_table_lookup (priv->paths_info, revision));
-		g_hash_table_remove (visible_paths, GINT_TO_POINTER (n_path));
+		/* the path of the child ends here */
+		g_hash_table_remove (priv->visible_paths, GINT_TO_POINTER (child_path));
 
 		for (i = 0; i < paths_state->len; i++) {
-			path_state = g_array_index (paths_state, GiggleGraphRendererPathState, i);
+			path_state = & g_array_index (paths_state, GiggleGraphRendererPathState, i);
 
-			if (path_state.n_path == n_path) {
-				path_state.upper_n_color = INVALID_COLOR;
-				((GiggleGraphRendererPathState *) paths_state->data)[i] = path_state;
+			if (path_state->n_path == child_path) {
+				path_state->lower_n_color = INVALID_COLOR;
 				break;
 			}
 		}
 	}
 
-	g_object_set_qdata_full (G_OBJECT (revision), revision_paths_state_quark,
-				 paths_state, (GDestroyNotify) free_paths_state);
-}
-
-void
-giggle_graph_renderer_validate_model (GiggleGraphRenderer *renderer,
-				      GtkTreeModel        *model,
-				      gint                 column)
-{
-	GiggleGraphRendererPrivate *priv;
-	GtkTreeIter                 iter;
-	gint                        n_children;
-	gint                        n_color = 0;
-	GitRevision             *revision;
-	GHashTable                 *visible_paths;
-	GType                       contained_type;
-	gint                        n_path;
-
-	g_return_if_fail (GIGGLE_IS_GRAPH_RENDERER (renderer));
-	g_return_if_fail (GTK_IS_TREE_MODEL (model));
+	if (!n_path) {
+		/* first revision of a branch, start a new path */
+		GiggleGraphRendererPathState new_path_state;
 
-	priv = renderer->_priv;
-	contained_type = gtk_tree_model_get_column_type (model, column);
+		find_free_path (priv->visible_paths, &priv->n_paths, &n_path);
+		priv->n_color = NEXT_COLOR (priv->n_color);
 
-	/*g_return_if_fail (contained_type == GIT_TYPE_REVISION);*/
+		new_path_state.n_path = n_path;
+		new_path_state.upper_n_color = INVALID_COLOR;
+		new_path_state.lower_n_color = priv->n_color;
+		g_array_append_val (paths_state, new_path_state);
 
-	if (priv->paths_info) {
-		g_hash_table_destroy (priv->paths_info);
+		g_hash_table_insert (priv->visible_paths, GINT_TO_POINTER (n_path), GINT_TO_POINTER (priv->n_color));
 	}
 
-	priv->n_paths = 0;
-	priv->paths_info = g_hash_table_new (g_direct_hash, g_direct_equal);
-	visible_paths = g_hash_table_new (g_direct_hash, g_direct_equal);
-	n_children = gtk_tree_model_iter_n_children (model, NULL);
-
-	while (n_children) {
-		/* need to calculate state backwards for proper color asignment */
-		n_children--;
-		gtk_tree_model_iter_nth_child (model, &iter, NULL, n_children);
-		gtk_tree_model_get (model, &iter, column, &revision, -1);
-
-		if (revision) {
-			if (!git_revision_has_parents (revision)) {
-				n_color = NEXT_COLOR (n_color);
-				find_free_path (visible_paths, &priv->n_paths, &n_path);
-				g_hash_table_insert (priv->paths_info, revision, GINT_TO_POINTER (n_path));
-				g_hash_table_insert (visible_paths, GINT_TO_POINTER (n_path), GINT_TO_POINTER (n_color));
-			}
+	g_hash_table_insert (priv->paths_info, revision, GINT_TO_POINTER (n_path));
 
-			giggle_graph_renderer_calculate_revision_state (renderer, revision, visible_paths, &n_color);
-			g_object_unref (revision);
-		}
+	n_parents = git_revision_get_n_parents (revision);
+
+	if (n_parents > 0) {
+		g_hash_table_insert (priv->pending_parents, revision, GINT_TO_POINTER (n_parents));
+	} else {
+		/* root revision, the path ends here */
+		g_hash_table_remove (priv->visible_paths, GINT_TO_POINTER (n_path));
 	}
 
-	g_hash_table_destroy (visible_paths);
+	g_object_set_qdata_full (G_OBJECT (revision), revision_paths_state_quark,
+				 paths_state, (GDestroyNotify) free_paths_state);
 }
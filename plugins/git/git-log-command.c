@@ -46,7 +46,7 @@ G_DEFINE_TYPE (GitLogCommand, git_log_command, GIT_TYPE_COMMAND);
 static void
 on_data_command_data_arrived (AnjutaCommand *command, GitLogCommand *self)
 {
-	anjuta_command_notify_data_arrived (command);
+	anjuta_command_notify_data_arrived (ANJUTA_COMMAND (self));
 }
 
 static void
@@ -79,7 +79,10 @@ git_log_command_finalize (GObject *object)
 	GitLogCommand *self;
 	
 	self = GIT_LOG_COMMAND (object);
-	
+
+	/* Let the processing thread end if the command is dropped while git is
+	 * still running */
+	git_log_data_command_push_line (self->priv->data_command, "");
 	g_object_unref (self->priv->data_command);
 	g_free (self->priv->author);
 	g_free (self->priv->grep);
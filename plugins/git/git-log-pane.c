@@ -47,6 +47,9 @@ enum
 	BRANCH_COL_NAME
 };
 
+/* Number of revisions added to the view at once */
+#define LOG_BATCH_SIZE 500
+
 /* DnD source targets */
 static GtkTargetEntry drag_source_targets[] =
 {
@@ -96,6 +99,11 @@ struct _GitLogPanePriv
 	GitBranchListCommand *branch_list_command;
 	GitLogMessageCommand *log_message_command;
 	GitLogCommand        *log_command;
+
+	/* Revisions read from the log command and not added to the view yet,
+	 * they are added LOG_BATCH_SIZE at a time in idle time */
+	GQueue *pending_revisions;
+	guint append_idle_id;
 };
 
 G_DEFINE_TYPE (GitLogPane, git_log_pane, GIT_TYPE_PANE);
@@ -271,21 +279,72 @@ git_log_pane_set_view_mode (GitLogPane *self, LogViewMode mode)
 	gtk_notebook_set_current_page (loading_notebook, mode);
 }
 
-static void
-on_log_command_finished (AnjutaCommand *command, guint return_code, 
-						 GitLogPane *self)
+static gboolean
+append_pending_revisions (GitLogPane *self)
 {
-	GtkTreeView *log_view;
-	GQueue *queue;
 	GtkTreeIter iter;
 	GitRevision *revision;
+	gint i;
+
+	for (i = 0; i < LOG_BATCH_SIZE && 
+	     (revision = g_queue_pop_head (self->priv->pending_revisions)); i++)
+	{
+		gtk_list_store_append (self->priv->log_model, &iter);
+		gtk_list_store_set (self->priv->log_model, &iter, LOG_COL_REVISION, 
+		                    revision, -1);
+
+		/* The graph isn't shown for the log of a path */
+		if (!self->priv->path)
+		{
+			giggle_graph_renderer_validate_revision (GIGGLE_GRAPH_RENDERER (self->priv->graph_renderer),
+			                                         revision);
+		}
+
+		g_object_unref (revision);
+	}
 
-	/* Show the actual log view */
+	/* Show the actual log view as soon as there is something in it */
 	git_log_pane_set_view_mode (self, LOG_VIEW_NORMAL);
 
-	log_view = GTK_TREE_VIEW (gtk_builder_get_object (self->priv->builder, 
-	                                                  "log_view"));
-	
+	if (g_queue_is_empty (self->priv->pending_revisions))
+	{
+		self->priv->append_idle_id = 0;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+on_log_command_data_arrived (AnjutaCommand *command, GitLogPane *self)
+{
+	GQueue *queue;
+
+	/* Take the revisions out of the command right away, so that it can go on
+	 * reading the log while they are added to the view */
+	queue = git_log_command_get_output_queue (GIT_LOG_COMMAND (command));
+
+	while (g_queue_peek_head (queue))
+	{
+		g_queue_push_tail (self->priv->pending_revisions, 
+		                   g_queue_pop_head (queue));
+	}
+
+	if (self->priv->append_idle_id == 0 &&
+	    !g_queue_is_empty (self->priv->pending_revisions))
+	{
+		self->priv->append_idle_id = 
+			g_idle_add ((GSourceFunc) append_pending_revisions, self);
+	}
+}
+
+static void
+on_log_command_finished (AnjutaCommand *command, guint return_code, 
+						 GitLogPane *self)
+{
+	/* Get what the last data-arrived couldn't deliver */
+	on_log_command_data_arrived (command, self);
+
 	if (return_code != 0)
 	{
 		/* Don't report erros in the log view as this is usually no user requested
@@ -296,52 +355,65 @@ on_log_command_finished (AnjutaCommand *command, guint return_code,
 		git_pane_report_errors (command, return_code,
 		                        ANJUTA_PLUGIN_GIT (anjuta_dock_pane_get_plugin (ANJUTA_DOCK_PANE (self))));
 #endif
-		goto out;
 	}
-	
-	queue = git_log_command_get_output_queue (GIT_LOG_COMMAND (command));
-	
-	while (g_queue_peek_head (queue))
-	{
-		revision = g_queue_pop_head (queue);
-		
-		gtk_list_store_append (self->priv->log_model, &iter);
-		gtk_list_store_set (self->priv->log_model, &iter, LOG_COL_REVISION, 
-		                    revision, -1);
 
-		g_object_unref (revision);
-	}
-	
-	giggle_graph_renderer_validate_model (GIGGLE_GRAPH_RENDERER (self->priv->graph_renderer),
-										  GTK_TREE_MODEL (self->priv->log_model),
-										  0);
-	gtk_tree_view_set_model (GTK_TREE_VIEW (log_view), 
-							 GTK_TREE_MODEL (self->priv->log_model));
+	/* An empty log has nothing to add */
+	if (self->priv->append_idle_id == 0)
+		git_log_pane_set_view_mode (self, LOG_VIEW_NORMAL);
 
-out:
 	g_clear_object (&self->priv->log_command);
 }
 
+static void
+clear_pending_revisions (GitLogPane *self)
+{
+	if (self->priv->append_idle_id > 0)
+	{
+		g_source_remove (self->priv->append_idle_id);
+		self->priv->append_idle_id = 0;
+	}
+
+	g_queue_foreach (self->priv->pending_revisions, (GFunc) g_object_unref, 
+	                 NULL);
+	g_queue_clear (self->priv->pending_revisions);
+}
+
 static void
 refresh_log (GitLogPane *self)
 {
 	Git *plugin;
-	GtkTreeView *log_view;
 	GtkTreeViewColumn *graph_column;
 
 	plugin = ANJUTA_PLUGIN_GIT (anjuta_dock_pane_get_plugin (ANJUTA_DOCK_PANE (self)));
-	log_view = GTK_TREE_VIEW (gtk_builder_get_object (self->priv->builder,
-	                                                  "log_view"));
 	graph_column = GTK_TREE_VIEW_COLUMN (gtk_builder_get_object (self->priv->builder,
 	                                                             "graph_column"));
 
-	/* Unref the previous command if it's still running. */
+	/* Drop the previous command if it's still running, its revisions
+	 * don't belong to the new log. */
 	if (self->priv->log_command)
-		g_object_unref (self->priv->log_command);
+	{
+		g_signal_handlers_disconnect_by_data (G_OBJECT (self->priv->log_command),
+		                                      self);
+		g_clear_object (&self->priv->log_command);
+	}
 
-	gtk_tree_view_set_model (log_view, NULL);
+	clear_pending_revisions (self);
 
-	/* We don't support filters for now */
+	/* Hide the graph column if we're looking at the log of a path. The graph
+	 * won't be correct in this case. */
+	if (self->priv->path)
+		gtk_tree_view_column_set_visible (graph_column, FALSE);
+	else
+		gtk_tree_view_column_set_visible (graph_column, TRUE);
+
+	gtk_list_store_clear (self->priv->log_model);
+	giggle_graph_renderer_reset (GIGGLE_GRAPH_RENDERER (self->priv->graph_renderer));
+
+	/* Show the loading spinner until the first revisions arrive */
+	git_log_pane_set_view_mode (self, LOG_VIEW_LOADING);
+
+	/* A single rev-list reads the whole log, its revisions are added to the
+	 * view as they are read */
 	self->priv->log_command = git_log_command_new (plugin->project_root_directory,
 	                                               self->priv->selected_branch,
 	                                               self->priv->path,
@@ -352,22 +424,14 @@ refresh_log (GitLogPane *self)
 	                                               NULL,
 	                                               NULL);
 
-	/* Hide the graph column if we're looking at the log of a path. The graph
-	 * won't be correct in this case. */
-	if (self->priv->path)
-		gtk_tree_view_column_set_visible (graph_column, FALSE);
-	else
-		gtk_tree_view_column_set_visible (graph_column, TRUE);
+	g_signal_connect_object (G_OBJECT (self->priv->log_command), "data-arrived",
+	                         G_CALLBACK (on_log_command_data_arrived),
+	                         self, 0);
 
 	g_signal_connect_object (G_OBJECT (self->priv->log_command), "command-finished",
 	                         G_CALLBACK (on_log_command_finished),
 	                         self, 0);
 
-	gtk_list_store_clear (self->priv->log_model);
-
-	/* Show the loading spinner */
-	git_log_pane_set_view_mode (self, LOG_VIEW_LOADING);
-
 	anjuta_command_start (ANJUTA_COMMAND (self->priv->log_command));
 }
 
@@ -903,6 +967,7 @@ git_log_pane_init (GitLogPane *self)
 
 	/* Set up the log model */
 	self->priv->log_model = gtk_list_store_new (1, GIT_TYPE_REVISION);
+	self->priv->pending_revisions = g_queue_new ();
 
 	/* Ref icon column */
 	gtk_tree_view_column_set_cell_data_func (ref_icon_column, ref_icon_renderer,
@@ -1044,6 +1109,9 @@ git_log_pane_finalize (GObject *object)
 	g_clear_object (&self->priv->log_message_command);
 	g_clear_object (&self->priv->log_command);
 
+	clear_pending_revisions (self);
+	g_queue_free (self->priv->pending_revisions);
+
 	/* Remove spin timer source. */
 	if (self->priv->spin_timer_id > 0)
 		g_source_remove (self->priv->spin_timer_id);
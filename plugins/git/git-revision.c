@@ -32,6 +32,7 @@ struct _GitRevisionPriv
 	gchar *short_log;
 	GList *children;
 	gboolean has_parents;
+	guint n_parents;
 };
 
 G_DEFINE_TYPE (GitRevision, git_revision, G_TYPE_OBJECT);
@@ -206,6 +207,7 @@ git_revision_add_child (GitRevision *self, GitRevision *child)
 {
 	self->priv->children = g_list_prepend (self->priv->children,
 										  child);
+	child->priv->n_parents++;
 	git_revision_set_has_parents (child, TRUE);
 }
 
@@ -226,3 +228,9 @@ git_revision_has_parents (GitRevision *self)
 {
 	return self->priv->has_parents;
 }
+
+guint
+git_revision_get_n_parents (GitRevision *self)
+{
+	return self->priv->n_parents;
+}
@@ -67,6 +67,7 @@ void git_revision_add_child (GitRevision *self, GitRevision *child);
 GList *git_revision_get_children (GitRevision *self);
 void git_revision_set_has_parents (GitRevision *self, gboolean has_parents);
 gboolean git_revision_has_parents (GitRevision *self);
+guint git_revision_get_n_parents (GitRevision *self);
 
 G_END_DECLS
 
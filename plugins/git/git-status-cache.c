@@ -0,0 +1,409 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * anjuta
+ * Copyright (C) James Liggett 2012 <jrliggett@cox.net>
+ *
+ * anjuta is free software.
+ *
+ * You may redistribute it and/or modify it under the terms of the
+ * GNU General Public License, as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * anjuta is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with anjuta.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#include <string.h>
+#include <libanjuta/anjuta-debug.h>
+#include "git-status-cache.h"
+#include "git-status-command.h"
+
+typedef struct
+{
+	gchar *path;
+	AnjutaVcsStatus status;
+} GitStatusCacheEntry;
+
+typedef struct
+{
+	gchar *directory;
+	IAnjutaVcsStatusCallback callback;
+	gpointer user_data;
+	GCancellable *cancel;
+	AnjutaAsyncNotify *notify;
+} GitStatusCacheRequest;
+
+struct _GitStatusCache
+{
+	gchar *working_directory;
+
+	/* Directory path -> GPtrArray of the GitStatusCacheEntry of its
+	 * direct children. Only files with a status other than clean show up
+	 * in git status, so this stays small even on large trees. */
+	GHashTable *directories;
+	gboolean valid;
+
+	/* Refresh in progress, the requests coming in meanwhile wait for it */
+	GitStatusCommand *command;
+	GHashTable *refreshing;
+	gboolean stale;
+	GList *requests;
+
+	GFileMonitor *head_monitor;
+	GFileMonitor *index_monitor;
+	GHashTable *monitors;
+};
+
+static void
+git_status_cache_entry_free (GitStatusCacheEntry *entry)
+{
+	g_free (entry->path);
+	g_slice_free (GitStatusCacheEntry, entry);
+}
+
+static GHashTable *
+git_status_cache_directories_new (void)
+{
+	return g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                              (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+git_status_cache_request_free (GitStatusCacheRequest *request)
+{
+	g_free (request->directory);
+	if (request->cancel)
+		g_object_unref (request->cancel);
+	if (request->notify)
+		g_object_unref (request->notify);
+	g_slice_free (GitStatusCacheRequest, request);
+}
+
+static void
+git_status_cache_answer (GitStatusCache *self, GitStatusCacheRequest *request)
+{
+	GPtrArray *entries;
+	guint i;
+
+	entries = g_hash_table_lookup (self->directories, request->directory);
+
+	for (i = 0; entries != NULL && i < entries->len; i++)
+	{
+		GitStatusCacheEntry *entry;
+		GFile *file;
+
+		if (request->cancel && g_cancellable_is_cancelled (request->cancel))
+			break;
+
+		entry = g_ptr_array_index (entries, i);
+		file = g_file_new_for_path (entry->path);
+		request->callback (file, entry->status, request->user_data);
+		g_object_unref (file);
+	}
+
+	if (request->notify)
+		anjuta_async_notify_notify_finished (request->notify);
+
+	git_status_cache_request_free (request);
+}
+
+static void
+git_status_cache_invalidate (GitStatusCache *self)
+{
+	self->valid = FALSE;
+
+	/* The refresh running now may have read the tree before the change */
+	if (self->command)
+		self->stale = TRUE;
+}
+
+static void
+on_monitor_changed (GFileMonitor *monitor, GFile *file, GFile *other_file,
+                    GFileMonitorEvent event, GitStatusCache *self)
+{
+	if (event != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
+		git_status_cache_invalidate (self);
+}
+
+static GFileMonitor *
+git_status_cache_monitor_git_file (GitStatusCache *self, const gchar *name)
+{
+	gchar *path;
+	GFile *file;
+	GFileMonitor *monitor;
+
+	path = g_build_filename (self->working_directory, ".git", name, NULL);
+	file = g_file_new_for_path (path);
+	monitor = g_file_monitor_file (file, 0, NULL, NULL);
+
+	if (monitor)
+	{
+		g_signal_connect (G_OBJECT (monitor), "changed",
+		                  G_CALLBACK (on_monitor_changed),
+		                  self);
+	}
+
+	g_object_unref (file);
+	g_free (path);
+
+	return monitor;
+}
+
+static void
+git_status_cache_monitor_directory (GitStatusCache *self, GFile *directory,
+                                    const gchar *path)
+{
+	GFileMonitor *monitor;
+
+	if (g_hash_table_lookup_extended (self->monitors, path, NULL, NULL))
+		return;
+
+	monitor = g_file_monitor_directory (directory, 0, NULL, NULL);
+
+	if (monitor)
+	{
+		g_signal_connect (G_OBJECT (monitor), "changed",
+		                  G_CALLBACK (on_monitor_changed),
+		                  self);
+	}
+
+	/* Keep failed monitors too, so they are not tried again */
+	g_hash_table_insert (self->monitors, g_strdup (path), monitor);
+}
+
+static void
+git_status_cache_cancel_monitor (GFileMonitor *monitor)
+{
+	if (monitor)
+	{
+		g_file_monitor_cancel (monitor);
+		g_object_unref (monitor);
+	}
+}
+
+static void
+on_refresh_data_arrived (AnjutaCommand *command, GitStatusCache *self)
+{
+	GQueue *status_queue;
+	GitStatus *status;
+	gchar *path;
+	gsize length;
+	GitStatusCacheEntry *entry;
+	gchar *directory;
+	GPtrArray *entries;
+
+	status_queue = git_status_command_get_status_queue (GIT_STATUS_COMMAND (command));
+
+	while (g_queue_peek_head (status_queue))
+	{
+		status = g_queue_pop_head (status_queue);
+		path = git_status_get_path (status);
+
+		/* Untracked directories are listed with a trailing slash */
+		length = strlen (path);
+		if (length > 1 && path[length - 1] == G_DIR_SEPARATOR)
+			path[length - 1] = '\0';
+
+		entry = g_slice_new (GitStatusCacheEntry);
+		entry->path = g_build_filename (self->working_directory, path, NULL);
+		entry->status = git_status_get_vcs_status (status);
+
+		directory = g_path_get_dirname (entry->path);
+		entries = g_hash_table_lookup (self->refreshing, directory);
+
+		if (!entries)
+		{
+			entries = g_ptr_array_new_with_free_func ((GDestroyNotify) git_status_cache_entry_free);
+			g_hash_table_insert (self->refreshing, directory, entries);
+		}
+		else
+			g_free (directory);
+
+		g_ptr_array_add (entries, entry);
+
+		g_free (path);
+		g_object_unref (status);
+	}
+}
+
+static void
+on_refresh_finished (AnjutaCommand *command, guint return_code,
+                     GitStatusCache *self)
+{
+	GList *requests;
+	GList *current_request;
+
+	g_hash_table_destroy (self->directories);
+
+	if (return_code == 0)
+	{
+		self->directories = self->refreshing;
+		self->valid = !self->stale;
+	}
+	else
+	{
+		DEBUG_PRINT ("git status failed in %s", self->working_directory);
+
+		g_hash_table_destroy (self->refreshing);
+		self->directories = git_status_cache_directories_new ();
+		self->valid = FALSE;
+	}
+
+	self->refreshing = NULL;
+	self->stale = FALSE;
+	g_object_unref (self->command);
+	self->command = NULL;
+
+	/* Callbacks may queue new requests, take the current ones first */
+	requests = g_list_reverse (self->requests);
+	self->requests = NULL;
+
+	for (current_request = requests; current_request;
+	     current_request = g_list_next (current_request))
+	{
+		git_status_cache_answer (self, current_request->data);
+	}
+
+	g_list_free (requests);
+}
+
+static void
+git_status_cache_refresh (GitStatusCache *self)
+{
+	self->refreshing = git_status_cache_directories_new ();
+	self->stale = FALSE;
+	self->command = git_status_command_new (self->working_directory);
+
+	g_signal_connect (G_OBJECT (self->command), "data-arrived",
+	                  G_CALLBACK (on_refresh_data_arrived),
+	                  self);
+
+	g_signal_connect (G_OBJECT (self->command), "command-finished",
+	                  G_CALLBACK (on_refresh_finished),
+	                  self);
+
+	anjuta_command_start (ANJUTA_COMMAND (self->command));
+}
+
+GitStatusCache *
+git_status_cache_new (const gchar *working_directory)
+{
+	GitStatusCache *self;
+
+	self = g_slice_new0 (GitStatusCache);
+	self->working_directory = g_strdup (working_directory);
+	self->directories = git_status_cache_directories_new ();
+	self->monitors = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                        (GDestroyNotify) git_status_cache_cancel_monitor);
+
+	/* Commits, checkouts and staging only touch the git directory */
+	self->head_monitor = git_status_cache_monitor_git_file (self, "HEAD");
+	self->index_monitor = git_status_cache_monitor_git_file (self, "index");
+
+	return self;
+}
+
+void
+git_status_cache_free (GitStatusCache *self)
+{
+	GList *current_request;
+
+	if (self->command)
+	{
+		/* Let the command finish on its own, nobody waits for it anymore */
+		g_signal_handlers_disconnect_by_func (G_OBJECT (self->command),
+		                                      G_CALLBACK (on_refresh_data_arrived),
+		                                      self);
+		g_signal_handlers_disconnect_by_func (G_OBJECT (self->command),
+		                                      G_CALLBACK (on_refresh_finished),
+		                                      self);
+		g_signal_connect (G_OBJECT (self->command), "command-finished",
+		                  G_CALLBACK (g_object_unref),
+		                  NULL);
+		g_hash_table_destroy (self->refreshing);
+	}
+
+	for (current_request = self->requests; current_request;
+	     current_request = g_list_next (current_request))
+	{
+		GitStatusCacheRequest *request = current_request->data;
+
+		if (request->notify)
+			anjuta_async_notify_notify_finished (request->notify);
+		git_status_cache_request_free (request);
+	}
+	g_list_free (self->requests);
+
+	git_status_cache_cancel_monitor (self->head_monitor);
+	git_status_cache_cancel_monitor (self->index_monitor);
+	g_hash_table_destroy (self->monitors);
+	g_hash_table_destroy (self->directories);
+	g_free (self->working_directory);
+
+	g_slice_free (GitStatusCache, self);
+}
+
+/**
+ * git_status_cache_query_directory:
+ * @self: A #GitStatusCache
+ * @directory: Directory to query
+ * @callback: Called once for each child of @directory that has a status
+ * @user_data: User data passed to @callback
+ * @cancel: An optional #GCancellable object, or NULL
+ * @notify: An optional #AnjutaAsyncNotify, notified when all statuses
+ * are given
+ *
+ * Gives the status of the direct children of @directory. The answer comes
+ * from the cache when it is up to date, else it waits for a new git status
+ * of the whole working tree, shared by all the requests made meanwhile.
+ */
+void
+git_status_cache_query_directory (GitStatusCache *self,
+                                  GFile *directory,
+                                  IAnjutaVcsStatusCallback callback,
+                                  gpointer user_data,
+                                  GCancellable *cancel,
+                                  AnjutaAsyncNotify *notify)
+{
+	GitStatusCacheRequest *request;
+
+	request = g_slice_new0 (GitStatusCacheRequest);
+	request->directory = g_file_get_path (directory);
+	request->callback = callback;
+	request->user_data = user_data;
+	request->cancel = cancel ? g_object_ref (cancel) : NULL;
+	request->notify = notify ? g_object_ref (notify) : NULL;
+
+	if (!request->directory)
+	{
+		/* Not a local directory, nothing to report */
+		if (request->notify)
+			anjuta_async_notify_notify_finished (request->notify);
+		git_status_cache_request_free (request);
+
+		return;
+	}
+
+	git_status_cache_monitor_directory (self, directory, request->directory);
+
+	if (self->valid && !self->command)
+	{
+		git_status_cache_answer (self, request);
+	}
+	else
+	{
+		self->requests = g_list_prepend (self->requests, request);
+
+		if (!self->command)
+			git_status_cache_refresh (self);
+	}
+}
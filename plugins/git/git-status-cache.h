@@ -0,0 +1,49 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * anjuta
+ * Copyright (C) James Liggett 2012 <jrliggett@cox.net>
+ *
+ * anjuta is free software.
+ *
+ * You may redistribute it and/or modify it under the terms of the
+ * GNU General Public License, as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * anjuta is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with anjuta.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _GIT_STATUS_CACHE_H_
+#define _GIT_STATUS_CACHE_H_
+
+#include <gio/gio.h>
+#include <libanjuta/anjuta-async-notify.h>
+#include <libanjuta/interfaces/ianjuta-vcs.h>
+
+G_BEGIN_DECLS
+
+/* Status of the whole working tree, read with a single git status and kept
+ * until the index, HEAD or one of the queried directories changes. */
+typedef struct _GitStatusCache GitStatusCache;
+
+GitStatusCache *git_status_cache_new (const gchar *working_directory);
+void git_status_cache_free (GitStatusCache *self);
+void git_status_cache_query_directory (GitStatusCache *self,
+                                       GFile *directory,
+                                       IAnjutaVcsStatusCallback callback,
+                                       gpointer user_data,
+                                       GCancellable *cancel,
+                                       AnjutaAsyncNotify *notify);
+
+G_END_DECLS
+
+#endif /* _GIT_STATUS_CACHE_H_ */
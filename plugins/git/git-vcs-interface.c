@@ -31,6 +31,7 @@ git_ivcs_iface_init (IAnjutaVcsIface *iface)
 	iface->checkout = git_ivcs_checkout;
 	iface->diff = git_ivcs_diff;
 	iface->query_status = git_ivcs_query_status;
+	iface->query_directory_status = git_ivcs_query_directory_status;
 	iface->remove = git_ivcs_remove;
 }
 
@@ -274,6 +275,31 @@ git_ivcs_query_status (IAnjutaVcs *obj, GFile *file,
 	                           ANJUTA_COMMAND (status_command));
 }
 
+void
+git_ivcs_query_directory_status (IAnjutaVcs *obj, GFile *directory,
+                                 IAnjutaVcsStatusCallback callback,
+                                 gpointer user_data, GCancellable *cancel,
+                                 AnjutaAsyncNotify *notify, GError **err)
+{
+	Git *plugin;
+
+	plugin = ANJUTA_PLUGIN_GIT (obj);
+
+	if (!plugin->project_root_directory)
+	{
+		if (notify)
+			anjuta_async_notify_notify_finished (notify);
+
+		return;
+	}
+
+	if (!plugin->status_cache)
+		plugin->status_cache = git_status_cache_new (plugin->project_root_directory);
+
+	git_status_cache_query_directory (plugin->status_cache, directory,
+	                                  callback, user_data, cancel, notify);
+}
+
 void 
 git_ivcs_remove (IAnjutaVcs *obj, GList *files, 
 				 AnjutaAsyncNotify *notify, GError **err)
@@ -51,6 +51,10 @@ void git_ivcs_query_status (IAnjutaVcs *obj, GFile *file,
 							IAnjutaVcsStatusCallback callback,
 							gpointer user_data, GCancellable *cancel,
 							AnjutaAsyncNotify *notify, GError **err);
+void git_ivcs_query_directory_status (IAnjutaVcs *obj, GFile *directory,
+                                      IAnjutaVcsStatusCallback callback,
+                                      gpointer user_data, GCancellable *cancel,
+                                      AnjutaAsyncNotify *notify, GError **err);
 void git_ivcs_remove (IAnjutaVcs *obj, GList *files, 
 					  AnjutaAsyncNotify *notify, GError **err);
 
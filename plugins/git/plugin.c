@@ -621,6 +621,11 @@ on_project_root_added (AnjutaPlugin *plugin, const gchar *name,
 	
 	git_plugin = ANJUTA_PLUGIN_GIT (plugin);
 	
+	if (git_plugin->status_cache)
+	{
+		git_status_cache_free (git_plugin->status_cache);
+		git_plugin->status_cache = NULL;
+	}
 	g_free (git_plugin->project_root_directory);
 	project_root_uri = g_value_dup_string (value);
 	file = g_file_new_for_uri (project_root_uri);
@@ -685,6 +690,11 @@ on_project_root_removed (AnjutaPlugin *plugin, const gchar *name,
 	anjuta_command_stop_automatic_monitor (ANJUTA_COMMAND (git_plugin->stash_list_command));
 	anjuta_command_stop_automatic_monitor (ANJUTA_COMMAND (git_plugin->ref_command));
 	
+	if (git_plugin->status_cache)
+	{
+		git_status_cache_free (git_plugin->status_cache);
+		git_plugin->status_cache = NULL;
+	}
 	g_free (git_plugin->project_root_directory);
 	git_plugin->project_root_directory = NULL;
 
@@ -1020,6 +1030,12 @@ git_deactivate_plugin (AnjutaPlugin *plugin)
 	g_object_unref (git_plugin->tag_list_command);
 	g_object_unref (git_plugin->stash_list_command);
 	g_object_unref (git_plugin->ref_command);
+
+	if (git_plugin->status_cache)
+	{
+		git_status_cache_free (git_plugin->status_cache);
+		git_plugin->status_cache = NULL;
+	}
 	
 	g_free (git_plugin->project_root_directory);
 	g_free (git_plugin->current_editor_filename);
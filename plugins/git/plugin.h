@@ -37,6 +37,7 @@
 #include <libanjuta/anjuta-command-queue.h>
 #include "git-branch-list-command.h"
 #include "git-status-command.h"
+#include "git-status-cache.h"
 #include "git-remote-list-command.h"
 #include "git-tag-list-command.h"
 #include "git-stash-list-command.h"
@@ -95,6 +96,10 @@ struct _Git
 	GitTagListCommand *tag_list_command;
 	GitStashListCommand *stash_list_command;
 	GitRefCommand *ref_command;
+
+	/* Working tree status for IAnjutaVcs directory queries, created on
+	 * first use */
+	GitStatusCache *status_cache;
 	
 	IAnjutaMessageView *message_view;
 	AnjutaCommandQueue *command_queue;
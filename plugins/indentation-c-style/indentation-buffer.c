@@ -0,0 +1,435 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * indentation-buffer.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "indentation-buffer.h"
+
+/* Lexer state between two characters */
+enum
+{
+	LEX_CODE,
+	LEX_BLOCK_COMMENT,
+	LEX_LINE_COMMENT,
+	LEX_STRING,
+	LEX_CHAR
+};
+
+typedef struct _IndentCState IndentCState;
+struct _IndentCState
+{
+	guint8 lex;
+	/* Depth of parentheses, brackets and braces, preprocessor lines are
+	 * not counted */
+	gint depth;
+	/* The previous line ends with a backslash */
+	gboolean continuation;
+	/* The previous line is part of a preprocessor directive */
+	gboolean preprocessor;
+};
+
+typedef struct _IndentCLine IndentCLine;
+struct _IndentCLine
+{
+	gsize offset;
+	gsize length;
+	IndentCState start;
+	gboolean preprocessor;
+	/* Lowest depth at the start of the line or after one of its characters */
+	gint min_depth;
+};
+
+struct _IndentCBuffer
+{
+	GString *text;
+	GArray *lines;
+	/* State after the last line read */
+	IndentCState end;
+
+	/* Classes of the characters of one line */
+	gint classes_line;
+	GByteArray *classes;
+};
+
+IndentCBuffer *
+indent_c_buffer_new (void)
+{
+	IndentCBuffer *buffer = g_new0 (IndentCBuffer, 1);
+
+	buffer->text = g_string_new (NULL);
+	buffer->lines = g_array_new (FALSE, FALSE, sizeof (IndentCLine));
+	buffer->classes = g_byte_array_new ();
+
+	return buffer;
+}
+
+void
+indent_c_buffer_free (IndentCBuffer *buffer)
+{
+	g_string_free (buffer->text, TRUE);
+	g_array_free (buffer->lines, TRUE);
+	g_byte_array_free (buffer->classes, TRUE);
+	g_free (buffer);
+}
+
+/* Forget line and all following lines, they will be read again from the
+ * editor when needed */
+void
+indent_c_buffer_invalidate (IndentCBuffer *buffer, gint line)
+{
+	if (line < 1)
+		line = 1;
+	if (buffer->classes_line >= line)
+		buffer->classes_line = 0;
+	if (line > buffer->lines->len)
+		return;
+
+	IndentCLine *first = &g_array_index (buffer->lines, IndentCLine, line - 1);
+	buffer->end = first->start;
+	g_string_truncate (buffer->text, first->offset);
+	g_array_set_size (buffer->lines, line - 1);
+}
+
+/* Run the lexer on a line starting with state. If classes is not NULL, it
+ * gets the class of each character, if depths is not NULL, it gets the depth
+ * before each character. */
+static void
+indent_c_lex (const gchar *text, gsize length, gboolean preprocessor,
+              IndentCState *state, gint *min_depth,
+              guint8 *classes, gint *depths)
+{
+	gsize i;
+	gsize last = length;
+
+	*min_depth = state->depth;
+
+	for (i = 0; i < length; i++)
+	{
+		guint8 class = INDENT_C_CODE;
+		gchar ch = text[i];
+
+		if (depths)
+			depths[i] = state->depth;
+
+		switch (state->lex)
+		{
+		case LEX_CODE:
+			if ((ch == '/') && (i + 1 < length) && (text[i + 1] == '*'))
+			{
+				state->lex = LEX_BLOCK_COMMENT;
+				class = INDENT_C_COMMENT;
+				if (classes) classes[i] = class;
+				if (depths) depths[i + 1] = state->depth;
+				i++;
+			}
+			else if ((ch == '/') && (i + 1 < length) && (text[i + 1] == '/'))
+			{
+				state->lex = LEX_LINE_COMMENT;
+				class = INDENT_C_COMMENT;
+			}
+			else if (ch == '"')
+			{
+				state->lex = LEX_STRING;
+				class = INDENT_C_STRING;
+			}
+			else if (ch == '\'')
+			{
+				state->lex = LEX_CHAR;
+				class = INDENT_C_STRING;
+			}
+			else if (!preprocessor && ((ch == '(') || (ch == '[') || (ch == '{')))
+			{
+				state->depth++;
+			}
+			else if (!preprocessor && ((ch == ')') || (ch == ']') || (ch == '}')))
+			{
+				state->depth--;
+				if (state->depth < *min_depth)
+					*min_depth = state->depth;
+			}
+			break;
+		case LEX_BLOCK_COMMENT:
+			class = INDENT_C_COMMENT;
+			if ((ch == '*') && (i + 1 < length) && (text[i + 1] == '/'))
+			{
+				state->lex = LEX_CODE;
+				if (classes) classes[i] = class;
+				if (depths) depths[i + 1] = state->depth;
+				i++;
+			}
+			break;
+		case LEX_LINE_COMMENT:
+			class = INDENT_C_COMMENT;
+			break;
+		case LEX_STRING:
+		case LEX_CHAR:
+			class = INDENT_C_STRING;
+			if ((ch == '\\') && (i + 1 < length))
+			{
+				if (classes) classes[i] = class;
+				if (depths) depths[i + 1] = state->depth;
+				i++;
+			}
+			else if (ch == (state->lex == LEX_STRING ? '"' : '\''))
+			{
+				state->lex = LEX_CODE;
+			}
+			break;
+		}
+		if (classes)
+			classes[i] = class;
+	}
+
+	/* Find the last character, ignoring trailing spaces */
+	while ((last > 0) && ((text[last - 1] == ' ') || (text[last - 1] == '\t')))
+		last--;
+	state->continuation = (last > 0) && (text[last - 1] == '\\');
+	state->preprocessor = preprocessor;
+
+	/* Only block comments and escaped strings continue on the next line */
+	if ((state->lex != LEX_BLOCK_COMMENT) && !state->continuation)
+		state->lex = LEX_CODE;
+}
+
+static void
+indent_c_buffer_add_line (IndentCBuffer *buffer, const gchar *text, gsize length)
+{
+	IndentCLine line;
+	gsize i;
+
+	line.offset = buffer->text->len;
+	line.length = length;
+	line.start = buffer->end;
+
+	/* A directive starts with # and continues on escaped lines */
+	if (line.start.continuation)
+	{
+		line.preprocessor = line.start.preprocessor;
+	}
+	else
+	{
+		for (i = 0; (i < length) && ((text[i] == ' ') || (text[i] == '\t')); i++);
+		line.preprocessor = (line.start.lex == LEX_CODE) && (i < length) && (text[i] == '#');
+	}
+
+	indent_c_lex (text, length, line.preprocessor, &buffer->end, &line.min_depth, NULL, NULL);
+
+	g_string_append_len (buffer->text, text, length);
+	g_string_append_c (buffer->text, '\n');
+	g_array_append_val (buffer->lines, line);
+}
+
+/* Read the lines up to line from the editor, returns FALSE if the line
+ * does not exist */
+static gboolean
+indent_c_buffer_read (IndentCBuffer *buffer, IAnjutaEditor *editor, gint line)
+{
+	IAnjutaIterable *begin;
+	IAnjutaIterable *end;
+	gint first;
+	gchar *text;
+	const gchar *pos;
+	const gchar *eol;
+
+	if (line < 1)
+		return FALSE;
+	if (line <= buffer->lines->len)
+		return TRUE;
+
+	/* Get all missing lines at once */
+	first = buffer->lines->len + 1;
+	begin = ianjuta_editor_get_line_begin_position (editor, first, NULL);
+	end = ianjuta_editor_get_line_end_position (editor, line, NULL);
+	text = ianjuta_editor_get_text (editor, begin, end, NULL);
+	g_object_unref (begin);
+	g_object_unref (end);
+
+	for (pos = text != NULL ? text : ""; buffer->lines->len < line; pos = eol)
+	{
+		for (eol = pos; (*eol != '\0') && (*eol != '\n') && (*eol != '\r'); eol++);
+		indent_c_buffer_add_line (buffer, pos, eol - pos);
+		if (*eol == '\0')
+			break;
+		if ((eol[0] == '\r') && (eol[1] == '\n'))
+			eol++;
+		eol++;
+	}
+	g_free (text);
+
+	return line <= buffer->lines->len;
+}
+
+static IndentCLine *
+indent_c_buffer_get_info (IndentCBuffer *buffer, IAnjutaEditor *editor, gint line)
+{
+	if (!indent_c_buffer_read (buffer, editor, line))
+		return NULL;
+
+	return &g_array_index (buffer->lines, IndentCLine, line - 1);
+}
+
+/* Returns the text of the line without the end of line character. It is
+ * valid until the line is changed in the editor. */
+const gchar *
+indent_c_buffer_get_line (IndentCBuffer *buffer, IAnjutaEditor *editor,
+                          gint line, gsize *length)
+{
+	IndentCLine *info = indent_c_buffer_get_info (buffer, editor, line);
+
+	if (info == NULL)
+	{
+		*length = 0;
+		return "";
+	}
+	*length = info->length;
+
+	return buffer->text->str + info->offset;
+}
+
+/* Returns an IndentCClass for each character of the line. It is valid until
+ * the next call to one of the buffer functions. */
+const guint8 *
+indent_c_buffer_get_classes (IndentCBuffer *buffer, IAnjutaEditor *editor,
+                             gint line)
+{
+	IndentCLine *info;
+	IndentCState state;
+	gint min_depth;
+
+	if (buffer->classes_line == line)
+		return buffer->classes->data;
+
+	info = indent_c_buffer_get_info (buffer, editor, line);
+	if (info == NULL)
+		return NULL;
+
+	g_byte_array_set_size (buffer->classes, info->length + 1);
+	state = info->start;
+	indent_c_lex (buffer->text->str + info->offset, info->length,
+	              info->preprocessor, &state, &min_depth,
+	              buffer->classes->data, NULL);
+	buffer->classes_line = line;
+
+	return buffer->classes->data;
+}
+
+/* Returns the class of the beginning of the line, it is not code if a
+ * comment or a string continues from the previous line */
+IndentCClass
+indent_c_buffer_get_line_class (IndentCBuffer *buffer, IAnjutaEditor *editor,
+                                gint line)
+{
+	IndentCLine *info = indent_c_buffer_get_info (buffer, editor, line);
+
+	if (info == NULL)
+		return INDENT_C_CODE;
+
+	switch (info->start.lex)
+	{
+	case LEX_BLOCK_COMMENT:
+		return INDENT_C_COMMENT;
+	case LEX_STRING:
+	case LEX_CHAR:
+		return INDENT_C_STRING;
+	default:
+		return INDENT_C_CODE;
+	}
+}
+
+/* Returns TRUE if the previous line ends with a backslash */
+gboolean
+indent_c_buffer_is_continuation (IndentCBuffer *buffer, IAnjutaEditor *editor,
+                                 gint line)
+{
+	IndentCLine *info = indent_c_buffer_get_info (buffer, editor, line);
+
+	return (info != NULL) && info->start.continuation;
+}
+
+/* Returns TRUE if the line is part of a preprocessor directive */
+gboolean
+indent_c_buffer_is_preprocessor (IndentCBuffer *buffer, IAnjutaEditor *editor,
+                                 gint line)
+{
+	IndentCLine *info = indent_c_buffer_get_info (buffer, editor, line);
+
+	return (info != NULL) && info->preprocessor;
+}
+
+/* Move line and index from a closing brace to the matching opening brace.
+ * Lines which do not go below the depth of the opening brace are skipped
+ * without looking at their characters. */
+gboolean
+indent_c_buffer_find_opening_brace (IndentCBuffer *buffer, IAnjutaEditor *editor,
+                                    gint *line, gsize *index)
+{
+	IndentCLine *info;
+	IndentCState state;
+	gint min_depth;
+	gint *depths;
+	gint target;
+	gint cur;
+	gboolean found = FALSE;
+
+	info = indent_c_buffer_get_info (buffer, editor, *line);
+	if ((info == NULL) || (*index >= info->length) || info->preprocessor)
+		return FALSE;
+
+	depths = g_new (gint, info->length + 1);
+	state = info->start;
+	indent_c_lex (buffer->text->str + info->offset, info->length,
+	              FALSE, &state, &min_depth, NULL, depths);
+	target = depths[*index] - 1;
+
+	for (cur = *line; (cur >= 1) && !found; cur--)
+	{
+		const guint8 *classes;
+		const gchar *text;
+		gsize i;
+
+		info = &g_array_index (buffer->lines, IndentCLine, cur - 1);
+		if (info->preprocessor || (info->min_depth > target))
+			continue;
+
+		classes = indent_c_buffer_get_classes (buffer, editor, cur);
+		text = buffer->text->str + info->offset;
+		if (cur != *line)
+		{
+			depths = g_renew (gint, depths, info->length + 1);
+			state = info->start;
+			indent_c_lex (text, info->length, FALSE, &state, &min_depth, NULL, depths);
+		}
+
+		for (i = (cur == *line) ? *index : info->length; i > 0; i--)
+		{
+			gchar ch = text[i - 1];
+
+			if ((classes[i - 1] == INDENT_C_CODE) && (depths[i - 1] == target)
+			    && ((ch == '(') || (ch == '[') || (ch == '{')))
+			{
+				*line = cur;
+				*index = i - 1;
+				found = TRUE;
+				break;
+			}
+		}
+	}
+	g_free (depths);
+
+	return found;
+}
@@ -0,0 +1,69 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * indentation-buffer.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INDENTATION_BUFFER_H_
+#define _INDENTATION_BUFFER_H_
+
+#include <libanjuta/interfaces/ianjuta-editor.h>
+
+G_BEGIN_DECLS
+
+/* Lexical class of a character */
+typedef enum
+{
+	INDENT_C_CODE,
+	INDENT_C_COMMENT,
+	INDENT_C_STRING
+} IndentCClass;
+
+/* A copy of the beginning of the editor text, split in lines, with the
+ * lexical state at the start of each line. Lines are read from the editor
+ * when they are needed and kept until the editor changes them, so the
+ * indentation of a line can be computed without going through the editor
+ * for each character. Lines are numbered from 1 like in the editor. */
+typedef struct _IndentCBuffer IndentCBuffer;
+
+IndentCBuffer *indent_c_buffer_new (void);
+void indent_c_buffer_free (IndentCBuffer *buffer);
+
+void indent_c_buffer_invalidate (IndentCBuffer *buffer, gint line);
+
+const gchar *indent_c_buffer_get_line (IndentCBuffer *buffer,
+                                       IAnjutaEditor *editor,
+                                       gint line,
+                                       gsize *length);
+const guint8 *indent_c_buffer_get_classes (IndentCBuffer *buffer,
+                                           IAnjutaEditor *editor,
+                                           gint line);
+IndentCClass indent_c_buffer_get_line_class (IndentCBuffer *buffer,
+                                             IAnjutaEditor *editor,
+                                             gint line);
+gboolean indent_c_buffer_is_continuation (IndentCBuffer *buffer,
+                                          IAnjutaEditor *editor,
+                                          gint line);
+gboolean indent_c_buffer_is_preprocessor (IndentCBuffer *buffer,
+                                          IAnjutaEditor *editor,
+                                          gint line);
+gboolean indent_c_buffer_find_opening_brace (IndentCBuffer *buffer,
+                                             IAnjutaEditor *editor,
+                                             gint *line,
+                                             gsize *index);
+
+G_END_DECLS
+
+#endif /* _INDENTATION_BUFFER_H_ */
@@ -33,6 +33,7 @@
 #include <libanjuta/interfaces/ianjuta-language.h>
 
 #include "indentation.h"
+#include "indentation-buffer.h"
 
 #define PREF_INDENT_BRACE_SIZE "indent-brace-size"
 #define PREF_INDENT_PARENTHESIS_LINEUP "indent-parenthesis-lineup"
@@ -93,108 +94,52 @@ skip_iter_to_newline_head (IAnjutaIterable *iter, gchar ch)
 	return ret_val;
 }
 
-/* Returns TRUE if iter was moved */
-static gboolean
-skip_iter_to_newline_tail (IAnjutaIterable *iter, gchar ch)
-{
-	gboolean ret_val = FALSE;
-
-	if (ch == '\r')
-	{
-		/* Possibly at head */
-		if (ianjuta_iterable_previous (iter, NULL))
-		{
-			ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (iter),
-											0, NULL);
-			if (ch != '\n')
-				/* Already at tail, undo iter */
-				ianjuta_iterable_next (iter, NULL);
-			else
-				/* Correctly at tail */
-				ret_val = TRUE;
-		}
-	}
-	return ret_val;
-}
-
-/* Jumps to the reverse matching brace of the given brace character */
-
 static gint
-get_line_indentation (IAnjutaEditor *editor, gint line_num)
+get_line_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line_num)
 {
-	IAnjutaIterable *line_begin, *line_end;
-	gchar *line_string, *idx;
-	gint line_indent = 0, left_braces = 0, right_braces = 0;
-	gchar ch;
-
-	line_end = ianjuta_editor_get_line_end_position (editor, line_num, NULL);
+	const gchar *text;
+	const guint8 *classes;
+	gsize length, i;
+	gint line;
+	gint line_indent = 0;
 
 	/* Find first right brace going backwards from end of current line that is before a closing bracket */
-	while (ianjuta_iterable_previous (line_end, NULL))
+	for (line = line_num; line >= 1; line--)
 	{
-		ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (line_end), 0, NULL);
-		if (ch == ')')
-		{
-			right_braces++;
-			break;
-		}
-		else if (ch =='}')
+		text = indent_c_buffer_get_line (plugin->buffer, editor, line, &length);
+		classes = indent_c_buffer_get_classes (plugin->buffer, editor, line);
+		if (classes == NULL)
 			break;
-	}
 
-	/* Find the line which contains the left brace matching the right brace we found */
-	if (right_braces > 0)
-	{
-		while (ianjuta_iterable_previous (line_end, NULL) && right_braces > left_braces)
+		for (i = length; i > 0; i--)
 		{
-			ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (line_end), 0, NULL);
-			if (ch == ')')
-				right_braces++;
-			else if (ch == '(')
-				left_braces++;
+			if (classes[i - 1] != INDENT_C_CODE)
+				continue;
+			if (text[i - 1] == ')' || text[i - 1] == '}')
+				break;
 		}
+		if (i > 0)
+		{
+			gsize index = i - 1;
 
-		line_num = ianjuta_editor_get_line_from_position (editor, line_end, NULL);
-	}
-
-	g_object_unref (line_end);
-	line_begin = ianjuta_editor_get_line_begin_position (editor, line_num, NULL);
-	line_end = ianjuta_editor_get_line_end_position (editor, line_num, NULL);
-
-	/*
-	DEBUG_PRINT ("%s: line begin = %d, line end = %d", __FUNCTION__,
-				 line_begin, line_end);
-	*/
-	if (ianjuta_iterable_compare (line_begin, line_end, NULL) == 0)
-	{
-		g_object_unref (line_begin);
-		g_object_unref (line_end);
-		return 0;
+			/* Use the line which contains the left brace matching the right brace we found */
+			if ((text[index] == ')') &&
+			    indent_c_buffer_find_opening_brace (plugin->buffer, editor, &line, &index))
+				line_num = line;
+			break;
+		}
 	}
 
-	line_string = ianjuta_editor_get_text (editor, line_begin, line_end,
-												NULL);
-	g_object_unref (line_begin);
-	g_object_unref (line_end);
-
-	/* DEBUG_PRINT ("line_string = '%s'", line_string); */
-
-	if (!line_string)
-		return 0;
-
-	idx = line_string;
+	text = indent_c_buffer_get_line (plugin->buffer, editor, line_num, &length);
 
 	/* Find first non-white space */
-	while (*idx != '\0' && isspace (*idx))
+	for (i = 0; (i < length) && isspace (text[i]); i++)
 	{
-		if (*idx == '\t')
+		if (text[i] == '\t')
 			line_indent += TAB_SIZE;
 		else
 			line_indent++;
-		idx++; /* Since we are looking for first non-space char, simple
-				* increment of the utf8 chars would do */
 	}
-	g_free (line_string);
 	return line_indent;
 }
 
@@ -239,241 +184,31 @@ get_line_indentation_string (IndentCPlugin *plugin, IAnjutaEditor *editor, gint
 	return indent_string;
 }
 
-/* Sets the iter to line end of previous line and TRUE is returned.
- * If there is no previous line, iter is set to first character in the
- * buffer and FALSE is returned.
- */
-static gboolean
-skip_iter_to_previous_line (IAnjutaEditor *editor, IAnjutaIterable *iter)
-{
-	gboolean found = FALSE;
-	gchar ch;
-
-	while (ianjuta_iterable_previous (iter, NULL))
-	{
-		ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (iter), 0, NULL);
-		if (iter_is_newline (iter, ch))
-		{
-			skip_iter_to_newline_head (iter, ch);
-			found = TRUE;
-			break;
-		}
-	}
-	return found;
-}
-
-/* Returns TRUE if the line is continuation of previous line (that is, it is
- * part of the same logical line).
- */
-static gboolean
-line_is_continuation (IAnjutaEditor *editor, IAnjutaIterable *iter)
-{
-	int is_continuation = FALSE;
-
-	IAnjutaIterable *new_iter = ianjuta_iterable_clone (iter, NULL);
-	if (skip_iter_to_previous_line (editor, new_iter))
-	{
-		while (ianjuta_iterable_previous (new_iter, NULL))
-		{
-			gchar ch = ianjuta_editor_cell_get_char
-				(IANJUTA_EDITOR_CELL (new_iter), 0, NULL);
-			if (ch == ' ' || ch == '\t')
-				continue;
-
-			if (ch == '\\')
-			{
-				is_continuation = TRUE;
-				break;
-			}
-
-			if (iter_is_newline (new_iter, ch))
-				break;
-		}
-	}
-	g_object_unref (new_iter);
-	return is_continuation;
-}
-
-/* Sets the iter to line end of previous logical line and TRUE is returned.
- * If there is no previous logical line, iter is set to first character in the
- * buffer and FALSE is returned. logical line is defined as one or more
- * real lines that are joined with line escapes ('\' at the end of real
- * lines.
- */
-static gboolean
-skip_iter_to_previous_logical_line (IAnjutaEditor *editor,
-									IAnjutaIterable *iter)
-{
-	gboolean found = TRUE;
-
-	while (line_is_continuation (editor, iter))
-	{
-		/*
-		DEBUG_PRINT ("Line %d is continuation line .. Skipping",
-					 ianjuta_editor_get_line_from_position (editor, iter, NULL));
-		*/
-		found = skip_iter_to_previous_line (editor, iter);
-		if (!found)
-			break;
-	}
-	/*
-	DEBUG_PRINT ("Line %d is *not* continuation line .. Breaking",
-				 ianjuta_editor_get_line_from_position (editor, iter, NULL));
-	*/
-	if (found)
-		found = skip_iter_to_previous_line (editor, iter);
-	/*
-	DEBUG_PRINT ("Line %d is next logical line",
-				 ianjuta_editor_get_line_from_position (editor, iter, NULL));
-	*/
-	return found;
-}
-
-static gboolean
-line_is_preprocessor (IAnjutaEditor *editor, IAnjutaIterable *iter)
-{
-	gboolean is_preprocessor = FALSE;
-	IAnjutaIterable *new_iter = ianjuta_iterable_clone (iter, NULL);
-
-	if (skip_iter_to_previous_logical_line (editor, new_iter))
-	{
-		/* Forward the newline char and point to line begin of next line */
-		gchar ch;
-		ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (new_iter),
-										   0, NULL);
-		skip_iter_to_newline_tail (new_iter, ch);
-		ianjuta_iterable_next (new_iter, NULL);
-	}
-	/* else, line is already pointed at first char of the line */
-
-	do
-	{
-		gchar ch;
-		ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (new_iter),
-										   0, NULL);
-		if (ch == '#')
-		{
-			is_preprocessor = TRUE;
-			break;
-		}
-		if (iter_is_newline (new_iter, ch) || !isspace (ch))
-			break;
-	}
-	while (ianjuta_iterable_next (new_iter, NULL));
-
-	g_object_unref (new_iter);
-
-	return is_preprocessor;
-}
-
-/* Skips to the end-of-line of previous non-preprocessor line. Any multiple
- * preprocessor lines are skipped. If current
- * line is not preprocessor line, nothing happens. If there is no previous
- * non-preprocessor line (we are at first line of the document which happens
- * to be preprocessor line), iter is set to the first character in the
- * document. It returns TRUE if the line is preprocessor line, otherwise
- * FALSE.
- */
-static gboolean
-skip_preprocessor_lines (IAnjutaEditor *editor, IAnjutaIterable *iter)
-{
-	gboolean line_found = FALSE;
-	gboolean preprocessor_found = FALSE;
-	IAnjutaIterable *new_iter = ianjuta_iterable_clone (iter, NULL);
-
-	do
-	{
-		gboolean is_preprocessor = FALSE;
-		if (skip_iter_to_previous_logical_line (editor, new_iter))
-		{
-			gchar ch;
-			ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (new_iter),
-											   0, NULL);
-			skip_iter_to_newline_tail (new_iter, ch);
-			ianjuta_iterable_next (new_iter, NULL);
-		}
-		do
-		{
-			gchar ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (new_iter),
-													 0, NULL);
-			if (ch == '#')
-			{
-				is_preprocessor = TRUE;
-				/*
-				DEBUG_PRINT ("Line %d is preprocessor line .. Skipping",
-							 ianjuta_editor_get_line_from_position
-							 (editor, new_iter, NULL));
-				*/
-				break;
-			}
-			if (iter_is_newline (new_iter, ch) || !isspace (ch))
-			{
-				skip_iter_to_newline_tail (new_iter, ch);
-				break;
-			}
-		}
-		while (ianjuta_iterable_next (new_iter, NULL));
-
-		if (is_preprocessor)
-		{
-			line_found = skip_iter_to_previous_line (editor, new_iter);
-			ianjuta_iterable_assign (iter, new_iter, NULL);
-			preprocessor_found = TRUE;
-		}
-		else
-		{
-			/*
-			DEBUG_PRINT ("Line %d is *not* preprocessor line .. Breaking",
-						 ianjuta_editor_get_line_from_position
-							(editor, new_iter, NULL));
-			*/
-			break;
-		}
-	}
-	while (line_found);
-
-	g_object_unref (new_iter);
-	return preprocessor_found;
-}
-
 static gint
 set_line_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line_num, gint indentation, gint parenthesis_indentation)
 {
-	IAnjutaIterable *line_begin, *line_end, *indent_position;
+	IAnjutaIterable *line_begin, *indent_position;
 	IAnjutaIterable *current_pos;
 	gint carat_offset, nchars = 0;
 	gchar *old_indent_string = NULL, *indent_string = NULL;
+	const gchar *line_string;
+	gsize length, indent_length;
 
 	/* DEBUG_PRINT ("In %s()", __FUNCTION__); */
 	line_begin = ianjuta_editor_get_line_begin_position (editor, line_num, NULL);
-	line_end = ianjuta_editor_get_line_end_position (editor, line_num, NULL);
 
-	/*
-	DEBUG_PRINT ("line begin = %d, line end = %d, current_pos = %d",
-				 line_begin, line_end, current_pos);
-	*/
-	indent_position = ianjuta_iterable_clone (line_begin, NULL);
+	/* Find first non-white space, the indentation contains only single
+	 * byte characters */
+	line_string = indent_c_buffer_get_line (plugin->buffer, editor, line_num, &length);
+	for (indent_length = 0; (indent_length < length) && isspace (line_string[indent_length]); indent_length++);
+	if (indent_length > 0)
+		old_indent_string = g_strndup (line_string, indent_length);
 
-	if (ianjuta_iterable_compare (line_end, line_begin, NULL) > 0)
-	{
-		gchar *idx;
-		gchar *line_string = ianjuta_editor_get_text (editor, line_begin,
-														   line_end, NULL);
-
-		//DEBUG_PRINT ("line_string = '%s'", line_string);
-		if (line_string)
-		{
-			idx = line_string;
+	indent_position = ianjuta_iterable_clone (line_begin, NULL);
+	ianjuta_iterable_set_position (indent_position,
+	                               ianjuta_iterable_get_position (line_begin, NULL) + indent_length,
+	                               NULL);
 
-			/* Find first non-white space */
-			while (*idx != '\0' && isspace (*idx))
-			{
-				idx = g_utf8_find_next_char (idx, NULL);
-				ianjuta_iterable_next (indent_position, NULL);
-			}
-			g_free (line_string);
-		}
-	}
 	/* Indent iter defined at this point, Identify how much is current
 	 * position is beyound this point. We need to restore it later after
 	 * indentation
@@ -491,16 +226,6 @@ set_line_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line_nu
 		/* Only indent if there is something to indent with */
 		if (indent_string)
 		{
-			/* Get existing indentation */
-			if (ianjuta_iterable_compare (indent_position, line_begin, NULL) > 0)
-			{
-				old_indent_string =
-					ianjuta_editor_get_text (editor, line_begin,
-												  indent_position, NULL);
-
-				//DEBUG_PRINT ("old_indent_string = '%s'", old_indent_string);
-			}
-
 			/* Only indent if there was no indentation before or old
 			 * indentation string was different from the new indent string
 			 */
@@ -524,16 +249,10 @@ set_line_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line_nu
 	 */
 	if ((indentation + parenthesis_indentation) == 0)
 	{
-		/* Get existing indentation */
-		if (ianjuta_iterable_compare (indent_position, line_begin, NULL) > 0)
-		{
-			old_indent_string =
-				ianjuta_editor_get_text (editor, line_begin,
-											  indent_position, NULL);
-		}
 		if (old_indent_string)
 			ianjuta_editor_erase (editor, line_begin, indent_position, NULL);
 	}
+	indent_c_buffer_invalidate (plugin->buffer, line_num);
 
 	/* Restore current position */
 	if (carat_offset >= 0)
@@ -541,10 +260,10 @@ set_line_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line_nu
 		/* If the cursor was not before the first non-space character in
 		 * the line, restore it's position after indentation.
 		 */
-		gint i;
 		IAnjutaIterable *pos = ianjuta_editor_get_line_begin_position (editor, line_num, NULL);
-		for (i = 0; i < nchars + carat_offset; i++)
-			ianjuta_iterable_next (pos, NULL);
+		ianjuta_iterable_set_position (pos,
+		                               ianjuta_iterable_get_position (pos, NULL) + nchars + carat_offset,
+		                               NULL);
 		ianjuta_document_begin_undo_action (IANJUTA_DOCUMENT(editor), NULL);
 		ianjuta_editor_goto_position (editor, pos, NULL);
 		ianjuta_document_end_undo_action (IANJUTA_DOCUMENT(editor), NULL);
@@ -556,10 +275,10 @@ set_line_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line_nu
 		 * home the cursor to first non-space character in the line (or
 		 * end of line if there is no non-space characters in the line.
 		 */
-		gint i;
 		IAnjutaIterable *pos = ianjuta_editor_get_line_begin_position (editor, line_num, NULL);
-		for (i = 0; i < nchars; i++)
-			ianjuta_iterable_next (pos, NULL);
+		ianjuta_iterable_set_position (pos,
+		                               ianjuta_iterable_get_position (pos, NULL) + nchars,
+		                               NULL);
 		ianjuta_document_begin_undo_action (IANJUTA_DOCUMENT(editor), NULL);
 		ianjuta_editor_goto_position (editor, pos, NULL);
 		ianjuta_document_end_undo_action (IANJUTA_DOCUMENT(editor), NULL);
@@ -569,7 +288,6 @@ set_line_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line_nu
 	g_object_unref (current_pos);
 	g_object_unref (indent_position);
 	g_object_unref (line_begin);
-	g_object_unref (line_end);
 
 	g_free (old_indent_string);
 	g_free (indent_string);
@@ -589,19 +307,18 @@ get_line_indentation_base (IndentCPlugin *plugin,
 						   gint *parenthesis_indentation,
 						   gboolean *colon_indent)
 {
-	IAnjutaIterable *iter;
+	IndentCBuffer *buffer = plugin->buffer;
+	const gchar *text;
+	const guint8 *classes;
+	gsize length;
+	gsize index;
+	gint line;
 	gchar point_ch;
 	gint line_indent = 0;
 	gint extra_indent = 0;
-	gboolean looking_at_just_next_line = TRUE;
-	gboolean current_line_is_preprocessor = FALSE;
-	gboolean current_line_is_continuation = FALSE;
-	gboolean line_checked_for_comment = FALSE;
 
     /* Determine whether or not to add multi-line comment asterisks */
 	const gchar *comment_continued = " * ";
-	IAnjutaIterable *line_begin = ianjuta_editor_get_line_begin_position (editor, line_num, NULL);
-	IAnjutaIterable  *line_end = ianjuta_editor_get_line_end_position (editor, line_num, NULL);
 
 	*incomplete_statement = -1;
 	*parenthesis_indentation = 0;
@@ -611,205 +328,73 @@ get_line_indentation_base (IndentCPlugin *plugin,
 
 	/* DEBUG_PRINT ("In %s()", __FUNCTION__); */
 
-	iter = ianjuta_editor_get_line_begin_position (editor, line_num, NULL);
-
-	current_line_is_preprocessor = line_is_preprocessor (editor, iter);
-	current_line_is_continuation =
-		line_is_continuation (editor, iter);
-	/*
-	DEBUG_PRINT ("Current line is preprocessor = %d",
-				 current_line_is_preprocessor);
-	DEBUG_PRINT ("Current line is continuation = %d",
-				 current_line_is_continuation);
-	*/
-	/* line_indent = get_line_indentation (editor, line_num - 1); */
-
-	if (current_line_is_preprocessor && current_line_is_continuation)
+	if (indent_c_buffer_is_preprocessor (buffer, editor, line_num) &&
+	    indent_c_buffer_is_continuation (buffer, editor, line_num))
 	{
 		/* Continuation of preprocessor line -- just maintain indentation */
-		g_object_unref (iter);
-		return get_line_indentation (editor, line_num - 1);
+		return get_line_indentation (plugin, editor, line_num - 1);
 	}
-	else if (current_line_is_preprocessor)
+	else if (indent_c_buffer_is_preprocessor (buffer, editor, line_num))
 	{
 		/* Preprocessor line -- indentation should be 0 */
-		g_object_unref (iter);
 		return 0;
 	}
 
-	while (ianjuta_iterable_previous (iter, NULL))
+	/* Check if we are inside a comment */
+	if (indent_c_buffer_get_line_class (buffer, editor, line_num) == INDENT_C_COMMENT)
 	{
-		/* Skip strings */
-		IAnjutaEditorAttribute attrib =
-			ianjuta_editor_cell_get_attribute (IANJUTA_EDITOR_CELL (iter), NULL);
-		if (attrib == IANJUTA_EDITOR_STRING)
-			continue;
+		extra_indent++;
 
-		point_ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (iter), 0,
-												 NULL);
-
-		/* DEBUG_PRINT("point_ch = %c", point_ch); */
-
-		/* Check for line comment comment */
-		if (!line_checked_for_comment && !isspace(point_ch))
+		/* If a multiline comment is continuing, check the next line and insert " * "
+		 * only if it does not already exist there. The purpose of this fix is to avoid
+		 * extra " * " on auto-indent. */
+		indent_c_buffer_get_line (buffer, editor, line_num, &length);
+		if ((g_settings_get_boolean (plugin->settings, PREF_COMMENT_LEADING_ASTERISK)) &&
+			(length == 0))
 		{
-			gboolean comment = FALSE;
-			IAnjutaIterable* new_iter = ianjuta_iterable_clone (iter, NULL);
-			do
-			{
-				gchar c;
-
-				/* Skip strings */
-				if (ianjuta_editor_cell_get_attribute (IANJUTA_EDITOR_CELL (new_iter), NULL) == IANJUTA_EDITOR_STRING)
-					continue;
+			IAnjutaIterable *line_begin = ianjuta_editor_get_line_begin_position (editor, line_num, NULL);
+			ianjuta_editor_insert (editor, line_begin, comment_continued, -1, NULL);
+			indent_c_buffer_invalidate (buffer, line_num);
+			g_object_unref (line_begin);
+		}
 
-				c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (new_iter), 0,
-												  NULL);
+		/* In the middle of a comment we can't know
+		 * if the statement is incomplete
+		 */
+		*incomplete_statement = -1;
+	}
 
-				if (iter_is_newline (new_iter, c))
-				{
-					line_checked_for_comment = TRUE;
-					break;
-				}
-				if (c == '/')
-				{
-					IAnjutaIterable* tmp_iter = ianjuta_iterable_clone (new_iter, NULL);
-					if (!ianjuta_iterable_previous (tmp_iter, NULL))
-					{
-						g_object_unref (tmp_iter);
-						break;
-					}
-					c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (tmp_iter), 0,
-													  NULL);
-					if (c == '/')
-					{
-						/* is a line comment, skip until begin of comment */
-						comment = TRUE;
-						g_object_unref (tmp_iter);
-						break;
-					}
-					g_object_unref (tmp_iter);
-				}
-			} while (ianjuta_iterable_previous (new_iter, NULL));
-			if (comment)
-			{
-				ianjuta_iterable_assign (iter, new_iter, NULL);
-				ianjuta_iterable_previous (iter, NULL);
-				g_object_unref (new_iter);
-				continue;
-			}
-			g_object_unref (new_iter);
-		}
-		/* Check if we are inside a comment */
-		if (point_ch == '/' || point_ch == '*')
+	/* Look at the characters before the line, from the last one, skipping
+	 * comments and strings */
+	line = line_num;
+	index = 0;
+	for (;;)
+	{
+		if (index == 0)
 		{
-			gboolean comment = FALSE;
-			gboolean comment_end = FALSE;
-			IAnjutaIterable* new_iter = ianjuta_iterable_clone (iter, NULL);
+			/* We just crossed a line boundary. Skip any preprocessor lines.
+			 */
 			do
-			{
-				gchar c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL(new_iter),
-												  0, NULL);
-				if (!comment_end && iter_is_newline (new_iter, c))
-				{
-					break;
-				}
-				if (c == '*')
-				{
-					IAnjutaIterable* prev = ianjuta_iterable_clone (new_iter, NULL);
-					IAnjutaIterable* next = ianjuta_iterable_clone (new_iter, NULL);
-					ianjuta_iterable_previous (prev, NULL);
-					ianjuta_iterable_next (next, NULL);
-					gchar prev_c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (prev), 0,
-													  NULL);
-					gchar next_c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (next), 0,
-													  NULL);
-					if (prev_c == '/')
-					{
-						/* starts comment */
-						comment = TRUE;
-						if (!comment_end)
-						{
-							extra_indent++;
-
-							/* If a multiline comment is continuing, check the next line and insert " * "
-							 * only if it does not already exist there. The purpose of this fix is to avoid
-							 * extra " * " on auto-indent. */
-
-							if ((g_settings_get_boolean (plugin->settings, PREF_COMMENT_LEADING_ASTERISK)) &&
-								(ianjuta_iterable_compare (line_end, line_begin, NULL)) == 0)
-							{
-								ianjuta_editor_insert (editor, line_begin, comment_continued, -1, NULL);
-							}
+				line--;
+			while ((line >= 1) && indent_c_buffer_is_preprocessor (buffer, editor, line));
+			if (line < 1)
+				break;
+			indent_c_buffer_get_line (buffer, editor, line, &index);
+			continue;
+		}
+		text = indent_c_buffer_get_line (buffer, editor, line, &length);
+		classes = indent_c_buffer_get_classes (buffer, editor, line);
+		index--;
+		if (classes[index] != INDENT_C_CODE)
+			continue;
 
-							/* In the middle of a comment we can't know
-						     * if the statement is incomplete
-							 */
-							*incomplete_statement = -1;
+		point_ch = text[index];
 
-							/* ":" have to be ignored inside comments */
-							if (*colon_indent)
-							{
-								*colon_indent = FALSE;
-								extra_indent -= INDENT_SIZE;
-							}
-						}
-						g_object_unref (prev);
-						g_object_unref (next);
-						break;
+		/* DEBUG_PRINT("point_ch = %c", point_ch); */
 
-					}
-					else if (next_c == '/')
-					{
-						/* ends comment: */
-						comment_end = TRUE;
-						g_object_unref (prev);
-						g_object_unref (next);
-						continue;
-					}
-					/* Possibly continued comment */
-					else if (isspace(prev_c))
-					{
-						gboolean possible_comment = FALSE;
-						while (ianjuta_iterable_previous (prev, NULL))
-						{
-							prev_c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (prev), 0,
-															  	   NULL);
-							if (!isspace(prev_c))
-								break;
-							if (iter_is_newline (prev, prev_c))
-							{
-								possible_comment = TRUE;
-								break;
-							}
-						}
-						if (possible_comment)
-						{
-							ianjuta_iterable_assign (new_iter, prev, NULL);
-							g_object_unref (prev);
-							g_object_unref (next);
-							continue;
-						}
-					}
-					g_object_unref (prev);
-					g_object_unref (next);
-				}
-			} while (ianjuta_iterable_previous (new_iter, NULL));
-			if (comment)
-			{
-				ianjuta_iterable_assign (iter, new_iter, NULL);
-				ianjuta_iterable_previous (iter, NULL);
-				g_object_unref (new_iter);
-				continue;
-			}
-			g_object_unref (new_iter);
-		}
 		if (point_ch == ')' || point_ch == ']' || point_ch == '}')
 		{
-			gint line_saved;
-
-			line_saved = ianjuta_editor_get_line_from_position (editor, iter,
-																NULL);
+			gint line_saved = line;
 
 			/* If we encounter a block-end before anything else, the
 			 * statement could hardly be incomplte.
@@ -820,7 +405,7 @@ get_line_indentation_base (IndentCPlugin *plugin,
 			/* If at level 0 indentation, encoutered a
 			 * block end, don't bother going further
 			 */
-			if (point_ch == '}' && get_line_indentation (editor, line_saved) <= 0)
+			if (point_ch == '}' && get_line_indentation (plugin, editor, line_saved) <= 0)
 			{
 				line_indent = 0;
 				line_indent += extra_indent;
@@ -828,18 +413,16 @@ get_line_indentation_base (IndentCPlugin *plugin,
 			}
 
 			/* Find matching brace and continue */
-			if (!anjuta_util_jump_to_matching_brace (iter, point_ch, -1))
+			if (!indent_c_buffer_find_opening_brace (buffer, editor, &line, &index))
 			{
-				line_indent = get_line_indentation (editor, line_saved);
+				line_indent = get_line_indentation (plugin, editor, line_saved);
 				line_indent += extra_indent;
 				break;
 			}
 		}
 		else if (point_ch == '{')
 		{
-			gint line_for_indent =
-				ianjuta_editor_get_line_from_position (editor, iter, NULL);
-			line_indent = get_line_indentation (editor, line_for_indent);
+			line_indent = get_line_indentation (plugin, editor, line);
 			/* Increase line indentation */
 			line_indent += INDENT_SIZE;
 			line_indent += extra_indent;
@@ -858,18 +441,13 @@ get_line_indentation_base (IndentCPlugin *plugin,
 			if (g_settings_get_boolean (plugin->settings,
 			                            PREF_INDENT_PARENTHESIS_LINEUP))
 			{
-				while (ianjuta_iterable_previous (iter, NULL))
+				gsize i;
+
+				for (i = 0; i < index; i++)
 				{
-					gchar dummy_ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (iter), 0,
-					                                               NULL);
-					if (iter_is_newline (iter, dummy_ch))
-					{
-						skip_iter_to_newline_head (iter, dummy_ch);
-						break;
-					}
-					if (dummy_ch == '\t')
+					if (text[i] == '\t')
 						line_indent += TAB_SIZE;
-					else
+					else if ((text[i] & 0xC0) != 0x80)
 						(*parenthesis_indentation)++;
 				}
 				(*parenthesis_indentation)++;
@@ -877,9 +455,7 @@ get_line_indentation_base (IndentCPlugin *plugin,
 			}
 			else
 			{
-				gint line_for_indent =
-					ianjuta_editor_get_line_from_position (editor, iter, NULL);
-				line_indent = get_line_indentation (editor, line_for_indent);
+				line_indent = get_line_indentation (plugin, editor, line);
 				line_indent += extra_indent;
 
 				(*parenthesis_indentation) += g_settings_get_int (plugin->settings,
@@ -909,60 +485,28 @@ get_line_indentation_base (IndentCPlugin *plugin,
 			 * a ':'
 			 * If current line indentation is zero, that we don't indent
 			 */
-			IAnjutaIterable* new_iter = ianjuta_iterable_clone (iter, NULL);
-			IAnjutaIterable* line_begin;
-			gboolean indent = FALSE;
-			gchar c;
+			gboolean indent = TRUE;
+			gsize i;
 
 			/* Is the last non-whitespace in line */
-			while (ianjuta_iterable_next (new_iter, NULL))
+			for (i = index + 1; i < length; i++)
 			{
-				c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (new_iter),
-													   0, NULL);
-				if (!isspace(c))
-					break;
-				if (iter_is_newline (new_iter, c))
+				if (!isspace (text[i]))
 				{
-					indent = TRUE;
+					indent = FALSE;
 					break;
 				}
 			}
-			line_begin = ianjuta_editor_get_line_begin_position(editor,
-																ianjuta_editor_get_line_from_position(editor, iter, NULL),
-																NULL);
-			c = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (line_begin),
-														0, NULL);
 			if (indent)
 			{
 				*colon_indent = TRUE;
 				if (*incomplete_statement == -1)
 					*incomplete_statement = 0;
 			}
-			if (indent && isspace(c))
+			if (indent && isspace (text[0]))
 			{
 				extra_indent += INDENT_SIZE;
 			}
-			g_object_unref (new_iter);
-			g_object_unref (line_begin);
-		}
-		else if (iter_is_newline (iter, point_ch))
-		{
-			skip_iter_to_newline_head (iter, point_ch);
-
-			/* We just crossed a line boundary. Skip any preprocessor lines,
-			 * and ensure that line_indent is updated with correct real
-			 * previous non-preprocessor line.
-			 */
-			if (skip_preprocessor_lines (editor, iter) &&
-				looking_at_just_next_line)
-			{
-				/*
-				gint line = ianjuta_editor_get_line_from_position (editor, iter, NULL);
-				line_indent = get_line_indentation (editor, line);
-				*/
-			}
-			looking_at_just_next_line = FALSE;
-			line_checked_for_comment = FALSE;
 		}
 		else if (!isspace (point_ch))
 		{
@@ -978,79 +522,16 @@ get_line_indentation_base (IndentCPlugin *plugin,
 	{
 		line_indent += extra_indent;
 	}
-	g_object_unref (iter);
 
 	return line_indent;
 }
 
-/* Check if iter is inside string. Begining of string
- * is not counted as inside.
- */
-static gboolean
-is_iter_inside_string (IAnjutaIterable *iter)
-{
-	IAnjutaEditorAttribute attrib;
-
-	attrib = ianjuta_editor_cell_get_attribute (IANJUTA_EDITOR_CELL (iter),
-												NULL);
-	/* Check if we are *inside* string. Begining
-	 * of string does not count as inside.
-	 */
-	if (attrib == IANJUTA_EDITOR_STRING)
-	{
-		/* Peek previous attrib and see what it was */
-		if (ianjuta_iterable_previous (iter, NULL))
-		{
-			attrib = ianjuta_editor_cell_get_attribute (IANJUTA_EDITOR_CELL
-														(iter),	NULL);
-			if (attrib == IANJUTA_EDITOR_STRING)
-			{
-				/* We are inside string */
-				return TRUE;
-			}
-			else
-			{
-				/* The string just began, not inside.
-				 * Restore iter from the peek
-				 */
-				ianjuta_iterable_next (iter, NULL);
-			}
-		}
-		/* else, there is no previous and so we can't be inside string
-		 */
-	}
-	return FALSE;
-}
-
-static gboolean
-spaces_only (IAnjutaEditor* editor, IAnjutaIterable* begin, IAnjutaIterable* end)
-{
-	gboolean empty = TRUE;
-	gchar* idx;
-	gchar* text = ianjuta_editor_get_text (editor, begin, end, NULL);
-
-	if (text == NULL)
-		return TRUE;
-
-
-	for (idx = text; *idx != '\0'; idx++)
-	{
-		if (!isspace(*idx))
-		{
-			empty = FALSE;
-			break;
-		}
-	}
-	g_free(text);
-	return empty;
-}
-
 static gint
 get_line_auto_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor,
 						   gint line, gint *parenthesis_indentation)
 {
-	IAnjutaIterable *iter;
-	IAnjutaIterable *end_iter;
+	const gchar *text;
+	gsize length, i;
 	gint line_indent = 0;
 	gint incomplete_statement = -1;
 	gboolean colon_indent = FALSE;
@@ -1068,78 +549,52 @@ get_line_auto_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor,
 	}
 	else
 	{
-		IAnjutaIterable* begin = ianjuta_editor_get_line_begin_position (editor, line -1 , NULL);
-		IAnjutaIterable* end = ianjuta_editor_get_line_end_position (editor, line -1 , NULL);
-
-		if (spaces_only (editor, begin, end))
+		text = indent_c_buffer_get_line (plugin->buffer, editor, line - 1, &length);
+		for (i = 0; (i < length) && isspace (text[i]); i++);
+		if (i == length)
 		{
 			set_line_indentation (plugin, editor, line -1, 0, 0);
 		}
-		g_object_unref (begin);
-		g_object_unref (end);
 	}
 
-	iter = ianjuta_editor_get_line_begin_position (editor, line, NULL);
-
-	if (is_iter_inside_string (iter))
-	{
-		line_indent = get_line_indentation (editor, line - 1);
-	}
-	else
+	/* Check if we are *inside* string. Begining of string does not count
+	 * as inside. If inside, just align with previous indentation.
+	 */
+	if (indent_c_buffer_get_line_class (plugin->buffer, editor, line) == INDENT_C_STRING)
 	{
-		line_indent = get_line_indentation_base (plugin, editor, line,
-												 &incomplete_statement,
-												 parenthesis_indentation,
-												 &colon_indent);
+		return get_line_indentation (plugin, editor, line - 1);
 	}
 
+	line_indent = get_line_indentation_base (plugin, editor, line,
+											 &incomplete_statement,
+											 parenthesis_indentation,
+											 &colon_indent);
+
+	text = indent_c_buffer_get_line (plugin->buffer, editor, line, &length);
 	if (colon_indent)
 	{
 		/* If the last non-whitespace character in the line is ":" then
 		 * we remove the extra colon_indent
 		 */
-		end_iter = ianjuta_editor_get_line_end_position (editor, line, NULL);
-		gchar ch;
-		while (ianjuta_iterable_previous (end_iter, NULL))
-		{
-			ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (end_iter),
-			                                   0, NULL);
-			if (ch == ':')
-			{
-				line_indent -= INDENT_SIZE;
-				break;
-			}
-			if (!isspace(ch) || iter_is_newline (end_iter, ch))
-				break;
-		}
-		g_object_unref (end_iter);
+		for (i = length; (i > 0) && isspace (text[i - 1]); i--);
+		if ((i > 0) && (text[i - 1] == ':'))
+			line_indent -= INDENT_SIZE;
 	}
 
 	/* Determine what the first non-white char in the line is */
-	do
+	for (i = 0; ; i++)
 	{
 		gchar ch;
-		/* Check if we are *inside* comment or string. Begining of comment
-		 * or string does not count as inside. If inside, just align with
-		 * previous indentation.
-		 */
-		if (is_iter_inside_string (iter))
-		{
-			line_indent = get_line_indentation (editor, line - 1);
-			break;
-		}
-		ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (iter),
-										   0, NULL);
-		if (iter_is_newline (iter, ch))
-		{
-			skip_iter_to_newline_tail (iter, ch);
 
+		if (i == length)
+		{
 			/* First levels are excused from incomplete statement indent */
 			if (incomplete_statement == 1 && line_indent > 0)
 				line_indent += INDENT_SIZE;
 			break;
 		}
 
+		ch = text[i];
 		if (ch == '{')
 		{
 			if (line_indent > 0)
@@ -1159,13 +614,12 @@ get_line_auto_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor,
 		}
 		else if (ch == '}')
 		{
-			ianjuta_iterable_previous (iter, NULL);
-			if (anjuta_util_jump_to_matching_brace (iter, ch, -1))
+			gint brace_line = line;
+			gsize index = i;
+
+			if (indent_c_buffer_find_opening_brace (plugin->buffer, editor, &brace_line, &index))
 			{
-				gint line = ianjuta_editor_get_line_from_position (editor,
-																   iter,
-																   NULL);
-				line_indent = get_line_indentation (editor, line);
+				line_indent = get_line_indentation (plugin, editor, brace_line);
 			}
 			break;
 		}
@@ -1182,8 +636,6 @@ get_line_auto_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor,
 			break;
 		}
 	}
-	while (ianjuta_iterable_next (iter, NULL));
-	g_object_unref (iter);
 
 	return line_indent;
 }
@@ -1205,7 +657,6 @@ cpp_java_indentation_char_added (IAnjutaEditor *editor,
                                  gchar ch,
                                  IndentCPlugin *plugin)
 {
-	IAnjutaEditorAttribute attrib;
 	IAnjutaIterable *iter;
 	gboolean should_auto_indent = FALSE;
 
@@ -1214,6 +665,10 @@ cpp_java_indentation_char_added (IAnjutaEditor *editor,
 	/* If autoindent is enabled*/
 	if (plugin->smart_indentation)
 	{
+		gint line = ianjuta_editor_get_line_from_position (editor, iter, NULL);
+
+		/* The "changed" signal for this character comes later */
+		indent_c_buffer_invalidate (plugin->buffer, line);
 
 		/* DEBUG_PRINT ("Char added at position %d: '%c'", insert_pos, ch); */
 
@@ -1225,40 +680,27 @@ cpp_java_indentation_char_added (IAnjutaEditor *editor,
 		}
 		else if (ch == '{' || ch == '}' || ch == '#')
 		{
+			IAnjutaIterable *line_begin;
+			const gchar *text;
+			const guint8 *classes;
+			gsize length, index, i;
+
 			/* Indent only when it's the first non-white space char in the line */
+			line_begin = ianjuta_editor_get_line_begin_position (editor, line, NULL);
+			index = ianjuta_iterable_diff (line_begin, iter, NULL);
+			g_object_unref (line_begin);
+
+			text = indent_c_buffer_get_line (plugin->buffer, editor, line, &length);
+			classes = indent_c_buffer_get_classes (plugin->buffer, editor, line);
+			index = g_utf8_offset_to_pointer (text, index) - text;
 
 			/* Don't bother if we are inside string */
-			attrib = ianjuta_editor_cell_get_attribute (IANJUTA_EDITOR_CELL (iter),
-			                                            NULL);
-			if (attrib != IANJUTA_EDITOR_STRING)
+			if ((index < length) && (classes[index] != INDENT_C_STRING))
 			{
-				/* Iterate backwards till the begining of the line and disable
-				 * indenting if any non-white space char is encountered
-				 */
-
-				/* Begin by assuming it should be indented */
-				should_auto_indent = TRUE;
-
-				while (ianjuta_iterable_previous (iter, NULL))
-				{
-					ch = ianjuta_editor_cell_get_char (IANJUTA_EDITOR_CELL (iter),
-					                                   0, NULL);
-
-					//DEBUG_PRINT ("Looking at char '%c'", ch);
-
-					/* Break on begining of line (== end of previous line) */
-					if (iter_is_newline (iter, ch))
-					{
-						skip_iter_to_newline_head (iter, ch);
-						break;
-					}
-					/* If a non-white space char is encountered, disabled indenting */
-					if (!isspace (ch))
-					{
-						should_auto_indent = FALSE;
-						break;
-					}
-				}
+				/* Disable indenting if any non-white space char is
+				 * before in the line */
+				for (i = 0; (i < index) && isspace (text[i]); i++);
+				should_auto_indent = (i == index);
 			}
 		}
 		if (should_auto_indent)
@@ -1375,6 +817,8 @@ erase_editor_blocked (IAnjutaEditor* editor,
 	g_signal_handlers_block_by_func (editor, cpp_java_indentation_changed, plugin);
 	ianjuta_editor_erase (editor, start, end, NULL);
 	g_signal_handlers_unblock_by_func (editor, cpp_java_indentation_changed, plugin);
+	indent_c_buffer_invalidate (plugin->buffer,
+	                            ianjuta_editor_get_line_from_position (editor, start, NULL));
 }
 
 void
@@ -1386,6 +830,10 @@ cpp_java_indentation_changed (IAnjutaEditor *editor,
                               const gchar *text,
                               IndentCPlugin* plugin)
 {
+	/* Lines after the change have to be read again */
+	indent_c_buffer_invalidate (plugin->buffer,
+	                            ianjuta_editor_get_line_from_position (editor, position, NULL));
+
 	/* If autoindent is enabled*/
 	if (plugin->smart_indentation)
 	{
@@ -1444,6 +892,10 @@ cpp_auto_indentation (IAnjutaEditor *editor,
 			line_start = ianjuta_editor_get_line_from_position (editor, start, NULL);
 			line_end = ianjuta_editor_get_line_from_position (editor, end, NULL);
 	}
+	/* Changes are not followed if the language is not supported */
+	if (!lang_plugin->support_installed)
+		indent_c_buffer_invalidate (lang_plugin->buffer, 1);
+
 	ianjuta_document_begin_undo_action (IANJUTA_DOCUMENT(editor), NULL);
 
 	for (insert_line = line_start; insert_line <= line_end; insert_line++)
@@ -108,6 +108,9 @@ install_support (IndentCPlugin *lang_plugin)
     if (lang_plugin->support_installed)
         return;
 
+    /* The editor might have been changed while it was not followed */
+    indent_c_buffer_invalidate (lang_plugin->buffer, 1);
+
     lang_plugin->current_language =
         ianjuta_language_get_name_from_editor (lang_manager,
                                                IANJUTA_EDITOR_LANGUAGE (lang_plugin->current_editor), NULL);
@@ -303,7 +306,10 @@ indent_c_plugin_deactivate_plugin (AnjutaPlugin *plugin)
 static void
 indent_c_plugin_finalize (GObject *obj)
 {
+    IndentCPlugin* plugin = ANJUTA_PLUGIN_INDENT_C (obj);
+
     /* Finalization codes here */
+    indent_c_buffer_free (plugin->buffer);
     G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
@@ -329,6 +335,7 @@ indent_c_plugin_instance_init (GObject *obj)
     plugin->uiid = 0;
     plugin->settings = g_settings_new (PREF_SCHEMA);
     plugin->editor_settings = g_settings_new (ANJUTA_PREF_SCHEMA_PREFIX IANJUTA_EDITOR_PREF_SCHEMA);
+    plugin->buffer = indent_c_buffer_new ();
 }
 
 static void
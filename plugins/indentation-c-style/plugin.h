@@ -25,6 +25,8 @@
 #include <libanjuta/interfaces/ianjuta-editor.h>
 #include <libanjuta/interfaces/ianjuta-symbol-manager.h>
 
+#include "indentation-buffer.h"
+
 extern GType indent_c_plugin_get_type (GTypeModule *module);
 #define ANJUTA_TYPE_PLUGIN_INDENT_C         (indent_c_plugin_get_type (NULL))
 #define ANJUTA_PLUGIN_INDENT_C(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), ANJUTA_TYPE_PLUGIN_INDENT_C, IndentCPlugin))
@@ -55,6 +57,9 @@ struct _IndentCPlugin {
 	gint param_label_indentation;
 	gboolean smart_indentation;
 
+	/* Text of the current editor */
+	IndentCBuffer *buffer;
+
 	/* Preferences */
 	GtkBuilder* bxml;
 };
@@ -80,6 +80,11 @@ struct Task
 		{
 			gchar *name;
 		}VareableListChildren;
+		struct
+		{
+			guint first;
+			guint last;
+		}FrameRange;
 	}this_data;
 	gchar *name;
 };
@@ -236,6 +241,7 @@ list_frame (DebuggerJs* object, struct Task *task)
 	IAnjutaDebuggerFrame* frame;
 	GList *var = NULL;
 	gint i, size;
+	guint level = 0;
 	gchar *k;
 	gchar *line = debugger_server_get_line (priv->server);
 
@@ -260,7 +266,14 @@ list_frame (DebuggerJs* object, struct Task *task)
 			frame->function = NULL;
 			frame->library = NULL;
 			frame->thread = 123;
-			var = g_list_append (var, frame);
+			frame->level = level++;
+			if (frame->level >= task->this_data.FrameRange.first && frame->level <= task->this_data.FrameRange.last)
+				var = g_list_append (var, frame);
+			else
+			{
+				g_free (frame->file);
+				g_free (frame);
+			}
 			k = line + i + 1;
 		}
 	}
@@ -421,7 +434,9 @@ on_data_arrived (DebuggerServer *server, gpointer user_data)
 					g_assert_not_reached ();
 					break;
 			}
-			priv->busy = FALSE;
+			/* Ready only when all tasks are done, the debug manager can
+			 * send several tasks before the first reply */
+			priv->busy = priv->task_queue->next != NULL;
 			g_signal_emit_by_name (priv->data, "debugger-ready", debugger_js_get_state (object));
 
 			priv->task_queue = g_list_delete_link (priv->task_queue, priv->task_queue);
@@ -761,6 +776,12 @@ debugger_js_list_thread (DebuggerJs *object, IAnjutaDebuggerGListCallback callba
 
 void
 debugger_js_list_frame (DebuggerJs *object, IAnjutaDebuggerGListCallback callback, gpointer user_data)
+{
+	debugger_js_list_frame_range (object, 0, G_MAXUINT, callback, user_data);
+}
+
+void
+debugger_js_list_frame_range (DebuggerJs *object, guint first, guint last, IAnjutaDebuggerGListCallback callback, gpointer user_data)
 {
 	DebuggerJsPrivate *priv = DEBUGGER_JS_PRIVATE(object);
 
@@ -772,6 +793,8 @@ debugger_js_list_frame (DebuggerJs *object, IAnjutaDebuggerGListCallback callbac
 	task->callback = (IAnjutaDebuggerCallback)callback;
 	task->line_required = 1;
 	task->task_type = LIST_FRAME;
+	task->this_data.FrameRange.first = first;
+	task->this_data.FrameRange.last = last;
 
 	debugger_server_send_line (priv->server, "stacktrace");
 
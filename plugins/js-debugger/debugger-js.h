@@ -65,6 +65,7 @@ void debugger_js_signal (DebuggerJs *object, IAnjutaDebuggerCallback callback, g
 void debugger_js_list_local (DebuggerJs *object, IAnjutaDebuggerGListCallback callback, gpointer user_data);
 void debugger_js_list_thread (DebuggerJs *object, IAnjutaDebuggerGListCallback callback, gpointer user_data);
 void debugger_js_list_frame (DebuggerJs *object, IAnjutaDebuggerGListCallback callback, gpointer user_data);
+void debugger_js_list_frame_range (DebuggerJs *object, guint first, guint last, IAnjutaDebuggerGListCallback callback, gpointer user_data);
 void debugger_js_info_thread (DebuggerJs *object, IAnjutaDebuggerGListCallback callback, gint thread, gpointer user_data);
 void debugger_js_variable_create (DebuggerJs *object, IAnjutaDebuggerVariableCallback callback, const gchar *name, gpointer user_data);
 
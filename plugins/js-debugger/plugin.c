@@ -438,6 +438,15 @@ idebugger_list_frame (IAnjutaDebugger *plugin, IAnjutaDebuggerGListCallback call
 	return TRUE;
 }
 
+static gboolean
+idebugger_list_frame_range (IAnjutaDebugger *plugin, guint first, guint last, gboolean all_values, IAnjutaDebuggerGListCallback callback , gpointer user_data, GError **err)
+{
+	DEBUG_PRINT ("%s", "list_frame_range: Implemented");
+	JSDbg *self = ANJUTA_PLUGIN_JSDBG (plugin);
+	debugger_js_list_frame_range (self->debugger, first, last, callback, user_data);
+	return TRUE;
+}
+
 static gboolean
 idebugger_set_thread (IAnjutaDebugger *plugin, gint thread, GError **err)
 {
@@ -539,6 +548,7 @@ idebugger_iface_init (IAnjutaDebuggerIface *iface)
 	iface->info_variables = idebugger_info_variables;
 	iface->handle_signal = idebugger_handle_signal;
 	iface->list_frame = idebugger_list_frame;
+	iface->list_frame_range = idebugger_list_frame_range;
 	iface->set_frame = idebugger_set_frame;
 	iface->list_thread = idebugger_list_thread;
 	iface->set_thread = idebugger_set_thread;
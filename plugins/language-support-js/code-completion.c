@@ -21,6 +21,7 @@
 #include <libanjuta/anjuta-debug.h>
 #include <libanjuta/interfaces/ianjuta-document-manager.h>
 #include <libanjuta/interfaces/ianjuta-editor-assist.h>
+#include <libanjuta/interfaces/ianjuta-file.h>
 #include <ctype.h>
 #include <glib.h>
 
@@ -65,20 +66,16 @@ file_completion (IAnjutaEditor *editor, gint *cur_depth)
 		if (text[i] == '}')
 			j--;
 		if (j < 0)
+		{
+			g_free (text);
 			return NULL;/*ERROR*/
+		}
 	}
-	gchar *tmp = g_new (gchar, j + 1);
-	for (i = 0; i < j; i++)
-		tmp[i] = '}';
-	tmp [j] = '\0';
-	tmp = g_strconcat (text, tmp, NULL);
+	gchar *braces = g_strnfill (j, '}');
+	gchar *tmp = g_strconcat (text, braces, NULL);
+	g_free (braces);
 	g_free (text);
-	text = tmp;
-	gchar *tmp_file = tmpnam (NULL);
-	FILE *f1 = fopen (tmp_file, "w");
-	fprintf (f1, "%s", text);
-	fclose (f1);
-	return tmp_file;
+	return tmp;
 }
 
 gchar*
@@ -218,14 +215,26 @@ code_completion_is_symbol_func (JSLang *plugin, const gchar *var_name)
 }
 
 GList*
-code_completion_get_list (JSLang *plugin, const gchar *tmp_file, const gchar *var_name, gint depth_level)
+code_completion_get_list (JSLang *plugin, const gchar *text, const gchar *var_name, gint depth_level)
 {
 	GList *suggestions = NULL;
+	gchar *filename = NULL;
 	if (plugin->symbol == NULL)
 		plugin->symbol = database_symbol_new ();
 	if (plugin->symbol == NULL)
 		return NULL;
-	database_symbol_set_file (plugin->symbol, tmp_file);
+	if (IANJUTA_IS_FILE (plugin->current_editor))
+	{
+		GFile *file = ianjuta_file_get_file (IANJUTA_FILE (plugin->current_editor), NULL);
+		if (file)
+		{
+			filename = g_file_get_path (file);
+			g_object_unref (file);
+		}
+	}
+	if (text)
+		database_symbol_set_text (plugin->symbol, G_OBJECT (plugin->current_editor), text, filename);
+	g_free (filename);
 
 	if (!var_name || strlen (var_name) == 0)
 		return database_symbol_list_member_with_line (plugin->symbol,
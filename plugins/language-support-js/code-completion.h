@@ -22,7 +22,7 @@
 
 #include "plugin.h"
 
-GList* code_completion_get_list (JSLang *plugin, const gchar *tmp_file, const gchar *var_name, gint depth_level);
+GList* code_completion_get_list (JSLang *plugin, const gchar *text, const gchar *var_name, gint depth_level);
 gchar* code_completion_get_str (IAnjutaEditor *editor, gboolean last_dot);
 gboolean code_completion_is_symbol_func (JSLang *plugin, const gchar *var_name);
 gchar* code_completion_get_func_tooltip (JSLang *plugin, const gchar *var_name);
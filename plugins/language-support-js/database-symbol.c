@@ -34,6 +34,7 @@ static const gchar * database_symbol_get_name (IJsSymbol *obj);
 static GList* database_symbol_list_member (IJsSymbol *obj);
 
 static IJsSymbol* find (const gchar* name, IJsSymbol *sym);
+static void database_symbol_buffer_free (gpointer data);
 
 typedef struct _DatabaseSymbolPrivate DatabaseSymbolPrivate;
 struct _DatabaseSymbolPrivate
@@ -41,6 +42,16 @@ struct _DatabaseSymbolPrivate
 	GList *symbols;
 	LocalSymbol *local;
 	StdSymbol *global;
+	GHashTable *buffers;
+};
+
+/* Parsed statements and symbols of an open buffer, kept until the buffer
+ * is destroyed */
+typedef struct _DatabaseSymbolBuffer DatabaseSymbolBuffer;
+struct _DatabaseSymbolBuffer
+{
+	JSNodeCache *nodes;
+	LocalSymbol *local;
 };
 
 #define DATABASE_SYMBOL_PRIVATE(o)  (G_TYPE_INSTANCE_GET_PRIVATE ((o), DATABASE_TYPE_SYMBOL, DatabaseSymbolPrivate))
@@ -56,6 +67,33 @@ database_symbol_init (DatabaseSymbol *object)
 	priv->symbols = NULL;
 	priv->local = NULL;
 	priv->global = NULL;
+	priv->buffers = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+	                                       database_symbol_buffer_free);
+}
+
+static void
+database_symbol_buffer_free (gpointer data)
+{
+	DatabaseSymbolBuffer *buffer = (DatabaseSymbolBuffer *)data;
+
+	if (buffer->local)
+		g_object_unref (buffer->local);
+	js_node_cache_free (buffer->nodes);
+	g_free (buffer);
+}
+
+static void
+on_buffer_destroyed (gpointer data, GObject *object)
+{
+	DatabaseSymbolPrivate *priv = DATABASE_SYMBOL_PRIVATE (data);
+
+	g_hash_table_remove (priv->buffers, object);
+}
+
+static void
+database_symbol_unwatch_buffer (gpointer key, gpointer value, gpointer data)
+{
+	g_object_weak_unref (G_OBJECT (key), on_buffer_destroyed, data);
 }
 
 static void
@@ -63,7 +101,10 @@ database_symbol_finalize (GObject *object)
 {
 	DatabaseSymbolPrivate *priv = DATABASE_SYMBOL_PRIVATE(object);
 
-	g_object_unref (priv->local);
+	g_hash_table_foreach (priv->buffers, database_symbol_unwatch_buffer, object);
+	g_hash_table_destroy (priv->buffers);
+	if (priv->local)
+		g_object_unref (priv->local);
 	g_object_unref (priv->global);
 	g_list_foreach (priv->symbols, (GFunc)g_object_unref, NULL);
 	g_list_free (priv->symbols);
@@ -98,6 +139,42 @@ database_symbol_set_file (DatabaseSymbol *object, const gchar* filename)
 	highlight_lines (missed);
 }
 
+/* Use the content of buffer, the statements and the symbols found in a
+ * previous call for the same buffer are reused if they have not changed */
+void
+database_symbol_set_text (DatabaseSymbol *object, GObject *buffer, const gchar *text, const gchar *filename)
+{
+	DatabaseSymbolBuffer *cache;
+	GList *missed;
+	g_assert (DATABASE_IS_SYMBOL (object));
+	DatabaseSymbolPrivate *priv = DATABASE_SYMBOL_PRIVATE (object);
+
+	cache = g_hash_table_lookup (priv->buffers, buffer);
+	if (!cache)
+	{
+		cache = g_new0 (DatabaseSymbolBuffer, 1);
+		cache->nodes = js_node_cache_new ();
+		g_hash_table_insert (priv->buffers, buffer, cache);
+		g_object_weak_ref (buffer, on_buffer_destroyed, object);
+	}
+
+	/* The chunks of the parse cache are compared to the text, without copying
+	 * it */
+	if (!cache->local || !js_node_cache_has_text (cache->nodes, text))
+	{
+		if (cache->local)
+			g_object_unref (cache->local);
+		cache->local = local_symbol_new_from_text (cache->nodes, text, filename);
+	}
+
+	if (priv->local)
+		g_object_unref (priv->local);
+	priv->local = g_object_ref (cache->local);
+
+	missed = local_symbol_get_missed_semicolons (priv->local);
+	highlight_lines (missed);
+}
+
 DatabaseSymbol*
 database_symbol_new ()
 {
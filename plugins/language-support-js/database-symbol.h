@@ -49,6 +49,7 @@ struct _DatabaseSymbol
 GType database_symbol_get_type (void) G_GNUC_CONST;
 DatabaseSymbol* database_symbol_new (void);
 void database_symbol_set_file (DatabaseSymbol *object, const gchar* filename);
+void database_symbol_set_text (DatabaseSymbol *object, GObject *buffer, const gchar *text, const gchar *filename);
 GList* database_symbol_list_local_member (DatabaseSymbol *object, gint line);
 GList* database_symbol_list_member_with_line (DatabaseSymbol *object, gint line);
 
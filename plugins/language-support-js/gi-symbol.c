@@ -39,7 +39,8 @@ G_DEFINE_TYPE_WITH_CODE (GiSymbol, gi_symbol, G_TYPE_OBJECT,
 typedef struct _GiSymbolPrivate GiSymbolPrivate;
 struct _GiSymbolPrivate
 {
-	GList *member;
+	/* GIR file of each namespace already found */
+	GHashTable *paths;
 };
 
 #define GI_SYMBOL_PRIVATE(o)  (G_TYPE_INSTANCE_GET_PRIVATE ((o), GI_TYPE_SYMBOL, GiSymbolPrivate))
@@ -48,7 +49,7 @@ static void
 gi_symbol_init (GiSymbol *object)
 {
 	GiSymbolPrivate *priv = GI_SYMBOL_PRIVATE(object);
-	priv->member = NULL;
+	priv->paths = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 }
 
 static void
@@ -56,8 +57,7 @@ gi_symbol_finalize (GObject *object)
 {
 	GiSymbolPrivate *priv = GI_SYMBOL_PRIVATE(object);
 
-	g_list_foreach (priv->member, (GFunc)g_object_unref, NULL);
-	g_list_free (priv->member);
+	g_hash_table_destroy (priv->paths);
 	G_OBJECT_CLASS (gi_symbol_parent_class)->finalize (object);
 }
 
@@ -114,8 +114,6 @@ gi_symbol_get_func_ret_type (IJsSymbol *obj)
 static IJsSymbol*
 gi_symbol_get_member (IJsSymbol *obj, const gchar * name)
 {
-	GList *i;
-
 	GiSymbol *object = GI_SYMBOL (obj);
 	GiSymbolPrivate *priv = GI_SYMBOL_PRIVATE (object);
 
@@ -126,14 +124,14 @@ gi_symbol_get_member (IJsSymbol *obj, const gchar * name)
 
 	if (!name)
 		return NULL;
-	for (i = priv->member; i; i = g_list_next (i))
+	/* The namespaces are loaded only once in gir_symbol_new */
+	const gchar *found = g_hash_table_lookup (priv->paths, name);
+	if (found)
 	{
-		IJsSymbol *lib = IJS_SYMBOL (i->data);
-		if (g_strcmp0 (name, ijs_symbol_get_name (lib)) == 0)
-		{
-			g_object_ref (lib);
+		IJsSymbol *lib = gir_symbol_new (found, name);
+		if (lib)
 			return lib;
-		}
+		g_hash_table_remove (priv->paths, name);
 	}
 
 	GFileInfo *info;
@@ -160,19 +158,21 @@ gi_symbol_get_member (IJsSymbol *obj, const gchar * name)
 				IJsSymbol *n = NULL;
 				if (g_file_test (path, G_FILE_TEST_IS_REGULAR | G_FILE_TEST_EXISTS))
 					n = gir_symbol_new (path, lib_name);
-				g_free (path);
 				if (n)
-				{
-					priv->member = g_list_append (priv->member, n);
-					g_object_ref (n);
-				}
+					g_hash_table_insert (priv->paths, g_strdup (lib_name), path);
+				else
+					g_free (path);
+				g_object_unref (file);
+				g_object_unref (info);
 				g_object_unref (enumerator);
+				g_object_unref (dir);
 				return n;
 			}
 			g_object_unref (info);
 		}
 		g_object_unref (enumerator);
 	}
+	g_object_unref (dir);
 	return NULL;
 }
 
@@ -21,6 +21,8 @@
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <string.h>
+#include <gio/gio.h>
+#include <libanjuta/anjuta-utils.h>
 
 #include "gir-symbol.h"
 #include "ijs-symbol.h"
@@ -44,6 +46,10 @@ struct _GirSymbolPrivate
 {
 	GList *member;
 	gchar *name;
+
+	/* Node of a namespace loaded from the binary cache */
+	GMappedFile *file;
+	guint32 node;
 };
 
 static IJsSymbol* parse_node (xmlNode *node);
@@ -56,6 +62,8 @@ gir_symbol_init (GirSymbol *object)
 	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (object);
 	priv->name = NULL;
 	priv->member = NULL;
+	priv->file = NULL;
+	priv->node = 0;
 }
 
 static void
@@ -66,6 +74,8 @@ gir_symbol_finalize (GObject *object)
 	g_free (priv->name);
 	g_list_foreach (priv->member, (GFunc)g_object_unref, NULL);
 	g_list_free (priv->member);
+	if (priv->file)
+		g_mapped_file_unref (priv->file);
 	G_OBJECT_CLASS (gir_symbol_parent_class)->finalize (object);
 }
 
@@ -80,39 +90,337 @@ gir_symbol_class_init (GirSymbolClass *klass)
 	object_class->finalize = gir_symbol_finalize;
 }
 
-static gchar *cur_gir = NULL;
+/* Binary cache
+ *
+ * A parsed namespace is saved in the user cache directory, so it can be
+ * mapped in memory instead of parsing the GIR file again. The file starts
+ * with a header followed by an array of nodes, an array of references and
+ * the strings. The members of a node are a range of references to other
+ * nodes, its return types and arguments are ranges of references to
+ * strings. The first node is the namespace itself. Symbols are created only
+ * when they are requested.
+ *---------------------------------------------------------------------------*/
+
+#define GIR_CACHE_MAGIC "AJSGIR\0\1"
+#define GIR_CACHE_BYTE_ORDER 0x01020304
+
+typedef struct _GirCacheHeader GirCacheHeader;
+struct _GirCacheHeader
+{
+	gchar magic[8];
+	guint32 byte_order;
+	guint32 n_nodes;
+	guint32 n_refs;
+	guint32 strings_size;
+	guint64 mtime;
+	guint32 path;
+	guint32 reserved;
+};
 
-IJsSymbol*
-gir_symbol_new (const gchar *filename, const gchar *lib_name)
+typedef struct _GirCacheNode GirCacheNode;
+struct _GirCacheNode
+{
+	guint32 name;
+	gint32 type;
+	guint32 member;
+	guint32 n_member;
+	guint32 ret_type;
+	guint32 n_ret_type;
+	guint32 args;
+	guint32 n_args;
+};
+
+static const GirCacheHeader*
+gir_cache_get_header (GMappedFile *file)
+{
+	return (const GirCacheHeader *)g_mapped_file_get_contents (file);
+}
+
+static const GirCacheNode*
+gir_cache_get_node (GMappedFile *file, guint32 node)
+{
+	const GirCacheHeader *header = gir_cache_get_header (file);
+
+	if (node >= header->n_nodes)
+		return NULL;
+
+	return (const GirCacheNode *)(header + 1) + node;
+}
+
+static guint32
+gir_cache_get_ref (GMappedFile *file, guint32 ref)
+{
+	const GirCacheHeader *header = gir_cache_get_header (file);
+	const guint32 *refs = (const guint32 *)((const GirCacheNode *)(header + 1) + header->n_nodes);
+
+	if (ref >= header->n_refs)
+		return G_MAXUINT32;
+
+	return refs[ref];
+}
+
+static const gchar*
+gir_cache_get_string (GMappedFile *file, guint32 offset)
+{
+	const GirCacheHeader *header = gir_cache_get_header (file);
+	const gchar *strings = g_mapped_file_get_contents (file)
+		+ g_mapped_file_get_length (file) - header->strings_size;
+
+	/* The last string is terminated by the end of the file */
+	if (offset >= header->strings_size)
+		return "";
+
+	return strings + offset;
+}
+
+static gchar*
+gir_cache_get_filename (const gchar *filename)
+{
+	gchar *checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, filename, -1);
+	gchar *name = g_strconcat (checksum, ".cache", NULL);
+	GFile *file = anjuta_util_get_user_cache_file ("js-gir", name, NULL);
+	gchar *path = NULL;
+
+	g_free (checksum);
+	g_free (name);
+	if (file)
+	{
+		path = g_file_get_path (file);
+		g_object_unref (file);
+	}
+
+	return path;
+}
+
+static IJsSymbol*
+gir_symbol_new_from_cache (GMappedFile *file, guint32 node)
 {
 	GirSymbol* symbol = g_object_new (GIR_TYPE_SYMBOL, NULL);
 	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (symbol);
 
-	g_assert (lib_name != NULL);
+	priv->file = g_mapped_file_ref (file);
+	priv->node = node;
 
-	if (!lib_name)
-	{
-		g_object_unref (symbol);
+	return IJS_SYMBOL (symbol);
+}
+
+static IJsSymbol*
+gir_symbol_load (const gchar *filename, guint64 mtime)
+{
+	gchar *path = gir_cache_get_filename (filename);
+	GMappedFile *file;
+	const GirCacheHeader *header;
+	gsize length;
+	IJsSymbol *symbol = NULL;
+
+	if (!path)
+		return NULL;
+	file = g_mapped_file_new (path, FALSE, NULL);
+	g_free (path);
+	if (!file)
 		return NULL;
+
+	header = gir_cache_get_header (file);
+	length = g_mapped_file_get_length (file);
+	if ((length >= sizeof (GirCacheHeader))
+	    && (memcmp (header->magic, GIR_CACHE_MAGIC, sizeof (header->magic)) == 0)
+	    && (header->byte_order == GIR_CACHE_BYTE_ORDER)
+	    && (header->mtime == mtime)
+	    && (header->n_nodes > 0)
+	    && (header->strings_size > 0)
+	    && ((guint64)header->n_nodes * sizeof (GirCacheNode)
+	        + (guint64)header->n_refs * sizeof (guint32)
+	        + header->strings_size + sizeof (GirCacheHeader) == length)
+	    && (g_mapped_file_get_contents (file)[length - 1] == '\0')
+	    && (strcmp (gir_cache_get_string (file, header->path), filename) == 0))
+	{
+		symbol = gir_symbol_new_from_cache (file, 0);
 	}
-	priv->member = NULL;
-	priv->name = g_strdup (lib_name);
+	g_mapped_file_unref (file);
 
-	cur_gir = g_strdup_printf ("imports.gi.%s.", priv->name);
-	if (!g_file_test (filename, G_FILE_TEST_EXISTS | G_FILE_TEST_IS_REGULAR))
+	return symbol;
+}
+
+typedef struct _GirCacheWriter GirCacheWriter;
+struct _GirCacheWriter
+{
+	GArray *nodes;
+	GArray *refs;
+	GString *strings;
+	GHashTable *offsets;
+};
+
+static guint32
+gir_cache_add_string (GirCacheWriter *writer, const gchar *str)
+{
+	gpointer offset;
+
+	if (!str)
+		str = "";
+	if (g_hash_table_lookup_extended (writer->offsets, str, NULL, &offset))
+		return GPOINTER_TO_UINT (offset);
+
+	offset = GUINT_TO_POINTER (writer->strings->len);
+	g_hash_table_insert (writer->offsets, (gpointer)str, offset);
+	g_string_append_len (writer->strings, str, strlen (str) + 1);
+
+	return GPOINTER_TO_UINT (offset);
+}
+
+static gboolean
+gir_symbol_save (GirSymbol *symbol, const gchar *filename, guint64 mtime)
+{
+	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (symbol);
+	GirCacheWriter writer;
+	GirCacheHeader header;
+	GPtrArray *symbols;
+	GirCacheNode empty;
+	GString *contents;
+	gchar *path;
+	gboolean ok;
+	guint i;
+
+	path = gir_cache_get_filename (filename);
+	if (!path)
+		return FALSE;
+
+	writer.nodes = g_array_new (FALSE, FALSE, sizeof (GirCacheNode));
+	writer.refs = g_array_new (FALSE, FALSE, sizeof (guint32));
+	writer.strings = g_string_new (NULL);
+	writer.offsets = g_hash_table_new (g_str_hash, g_str_equal);
+
+	/* Nodes are added breadth first, so the members of a node are
+	 * consecutive and i is the node of the symbol at the same index */
+	symbols = g_ptr_array_new ();
+	g_ptr_array_add (symbols, NULL);
+	memset (&empty, 0, sizeof (empty));
+	g_array_append_val (writer.nodes, empty);
+
+	for (i = 0; i < symbols->len; i++)
 	{
-		g_object_unref (symbol);
-		return NULL;
+		SimpleSymbol *child = g_ptr_array_index (symbols, i);
+		GList *member = child ? child->member : priv->member;
+		GirCacheNode node = g_array_index (writer.nodes, GirCacheNode, i);
+		GList *j;
+
+		if (!child)
+		{
+			node.name = gir_cache_add_string (&writer, priv->name);
+			node.type = BASE_CLASS;
+		}
+		else
+		{
+			node.name = gir_cache_add_string (&writer, child->name);
+			node.type = child->type;
+
+			node.ret_type = writer.refs->len;
+			node.n_ret_type = g_list_length (child->ret_type);
+			for (j = child->ret_type; j; j = g_list_next (j))
+			{
+				guint32 offset = gir_cache_add_string (&writer, (const gchar *)j->data);
+				g_array_append_val (writer.refs, offset);
+			}
+
+			node.args = writer.refs->len;
+			node.n_args = g_list_length (child->args);
+			for (j = child->args; j; j = g_list_next (j))
+			{
+				guint32 offset = gir_cache_add_string (&writer, ((Argument *)j->data)->name);
+				g_array_append_val (writer.refs, offset);
+			}
+		}
+
+		node.member = writer.refs->len;
+		node.n_member = 0;
+		for (j = member; j; j = g_list_next (j))
+		{
+			guint32 index = writer.nodes->len;
+
+			/* Only simple symbols are created by the parser */
+			if (!SIMPLE_IS_SYMBOL (j->data))
+				continue;
+			g_ptr_array_add (symbols, j->data);
+			g_array_append_val (writer.nodes, empty);
+			g_array_append_val (writer.refs, index);
+			node.n_member++;
+		}
+		g_array_index (writer.nodes, GirCacheNode, i) = node;
 	}
+	g_ptr_array_free (symbols, TRUE);
+
+	memset (&header, 0, sizeof (header));
+	memcpy (header.magic, GIR_CACHE_MAGIC, sizeof (header.magic));
+	header.byte_order = GIR_CACHE_BYTE_ORDER;
+	header.n_nodes = writer.nodes->len;
+	header.n_refs = writer.refs->len;
+	header.mtime = mtime;
+	header.path = gir_cache_add_string (&writer, filename);
+	header.strings_size = writer.strings->len;
+
+	contents = g_string_sized_new (sizeof (header)
+	                               + writer.nodes->len * sizeof (GirCacheNode)
+	                               + writer.refs->len * sizeof (guint32)
+	                               + writer.strings->len);
+	g_string_append_len (contents, (const gchar *)&header, sizeof (header));
+	g_string_append_len (contents, writer.nodes->data, writer.nodes->len * sizeof (GirCacheNode));
+	g_string_append_len (contents, writer.refs->data, writer.refs->len * sizeof (guint32));
+	g_string_append_len (contents, writer.strings->str, writer.strings->len);
+
+	ok = g_file_set_contents (path, contents->str, contents->len, NULL);
+
+	g_string_free (contents, TRUE);
+	g_array_free (writer.nodes, TRUE);
+	g_array_free (writer.refs, TRUE);
+	g_string_free (writer.strings, TRUE);
+	g_hash_table_destroy (writer.offsets);
+	g_free (path);
+
+	return ok;
+}
+
+/* Prefix of the return types, only set while a file is parsed */
+static gchar *cur_gir = NULL;
+
+/* All namespaces loaded in the process, indexed by file name. A namespace is
+ * loaded again only if its file has been modified. */
+typedef struct _GirSymbolCache GirSymbolCache;
+struct _GirSymbolCache
+{
+	IJsSymbol *symbol;
+	gchar *lib_name;
+	guint64 mtime;
+};
+
+static GHashTable *gir_cache = NULL;
+
+static void
+gir_symbol_cache_free (gpointer data)
+{
+	GirSymbolCache *cache = (GirSymbolCache *)data;
+
+	g_object_unref (cache->symbol);
+	g_free (cache->lib_name);
+	g_free (cache);
+}
+
+static IJsSymbol*
+gir_symbol_parse (const gchar *filename, const gchar *lib_name)
+{
+	GirSymbol* symbol = g_object_new (GIR_TYPE_SYMBOL, NULL);
+	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (symbol);
 	xmlDocPtr doc = xmlParseFile(filename);
 	xmlNode *root;
 	xmlNode *i;
 
+	priv->member = NULL;
+	priv->name = g_strdup (lib_name);
+
 	if (doc == NULL) {
 		g_warning ("could not parse file");
 		g_object_unref (symbol);
 		return NULL;
 	}
+	cur_gir = g_strdup_printf ("imports.gi.%s.", priv->name);
 	root = xmlDocGetRootElement (doc);
 	for (i = root->children; i; i = i->next)
 	{
@@ -129,10 +437,94 @@ gir_symbol_new (const gchar *filename, const gchar *lib_name)
 			priv->member = g_list_append (priv->member, n);
 		}
 	}
+	g_free (cur_gir);
+	cur_gir = NULL;
 	xmlFreeDoc (doc);
 	return IJS_SYMBOL (symbol);
 }
 
+IJsSymbol*
+gir_symbol_new (const gchar *filename, const gchar *lib_name)
+{
+	GirSymbolCache *cache;
+	GFile *file;
+	GFileInfo *info;
+	guint64 mtime;
+
+	g_assert (lib_name != NULL);
+
+	if (!lib_name)
+		return NULL;
+
+	file = g_file_new_for_path (filename);
+	info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+	                          G_FILE_ATTRIBUTE_TIME_MODIFIED,
+	                          G_FILE_QUERY_INFO_NONE, NULL, NULL);
+	g_object_unref (file);
+	if (!info)
+		return NULL;
+	if (g_file_info_get_file_type (info) != G_FILE_TYPE_REGULAR)
+	{
+		g_object_unref (info);
+		return NULL;
+	}
+	mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+	g_object_unref (info);
+
+	if (!gir_cache)
+		gir_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+		                                   gir_symbol_cache_free);
+
+	cache = g_hash_table_lookup (gir_cache, filename);
+	if (cache && (cache->mtime == mtime) && (g_strcmp0 (cache->lib_name, lib_name) == 0))
+		return g_object_ref (cache->symbol);
+
+	IJsSymbol *symbol = gir_symbol_load (filename, mtime);
+	if (symbol && (g_strcmp0 (ijs_symbol_get_name (symbol), lib_name) != 0))
+	{
+		g_object_unref (symbol);
+		symbol = NULL;
+	}
+	if (!symbol)
+	{
+		symbol = gir_symbol_parse (filename, lib_name);
+		/* Use the saved namespace, it takes much less memory */
+		if (symbol && gir_symbol_save (GIR_SYMBOL (symbol), filename, mtime))
+		{
+			IJsSymbol *saved = gir_symbol_load (filename, mtime);
+			if (saved)
+			{
+				g_object_unref (symbol);
+				symbol = saved;
+			}
+		}
+	}
+	if (!symbol)
+	{
+		g_hash_table_remove (gir_cache, filename);
+		return NULL;
+	}
+
+	cache = g_new (GirSymbolCache, 1);
+	cache->symbol = g_object_ref (symbol);
+	cache->lib_name = g_strdup (lib_name);
+	cache->mtime = mtime;
+	g_hash_table_insert (gir_cache, g_strdup (filename), cache);
+
+	return symbol;
+}
+
+/* Release all the namespaces loaded, they are loaded again when needed */
+void
+gir_symbol_clear_cache (void)
+{
+	if (gir_cache)
+	{
+		g_hash_table_destroy (gir_cache);
+		gir_cache = NULL;
+	}
+}
+
 static void
 gir_symbol_interface_init (IJsSymbolIface *iface)
 {
@@ -144,24 +536,51 @@ gir_symbol_interface_init (IJsSymbolIface *iface)
 	iface->list_member = gir_symbol_list_member;
 }
 
+/* Returns the strings referenced from first */
+static GList*
+gir_symbol_get_cache_strings (GMappedFile *file, guint32 first, guint32 n)
+{
+	GList *ret = NULL;
+	guint32 i;
+
+	for (i = 0; i < n; i++)
+		ret = g_list_prepend (ret, g_strdup (gir_cache_get_string (file, gir_cache_get_ref (file, first + i))));
+
+	return g_list_reverse (ret);
+}
+
 static GList*
 gir_symbol_get_arg_list (IJsSymbol *obj)
 {
-	g_assert_not_reached ();
-	return NULL;
+	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (obj);
+	const GirCacheNode *node;
+
+	g_assert (priv->file != NULL);
+
+	node = gir_cache_get_node (priv->file, priv->node);
+	return gir_symbol_get_cache_strings (priv->file, node->args, node->n_args);
 }
 
 static gint
 gir_symbol_get_base_type (IJsSymbol *obj)
 {
+	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (obj);
+
+	if (priv->file)
+		return gir_cache_get_node (priv->file, priv->node)->type;
 	return BASE_CLASS;
 }
 
 static GList*
 gir_symbol_get_func_ret_type (IJsSymbol *obj)
 {
-	g_assert_not_reached ();
-	return NULL;
+	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (obj);
+	const GirCacheNode *node;
+
+	g_assert (priv->file != NULL);
+
+	node = gir_cache_get_node (priv->file, priv->node);
+	return gir_symbol_get_cache_strings (priv->file, node->ret_type, node->n_ret_type);
 }
 
 static IJsSymbol*
@@ -170,6 +589,22 @@ gir_symbol_get_member (IJsSymbol *obj, const gchar * name)
 	GList *i;
 	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (obj);
 
+	if (priv->file)
+	{
+		const GirCacheNode *node = gir_cache_get_node (priv->file, priv->node);
+		guint32 j;
+
+		for (j = 0; j < node->n_member; j++)
+		{
+			guint32 member = gir_cache_get_ref (priv->file, node->member + j);
+			const GirCacheNode *child = gir_cache_get_node (priv->file, member);
+
+			if (child && (g_strcmp0 (name, gir_cache_get_string (priv->file, child->name)) == 0))
+				return gir_symbol_new_from_cache (priv->file, member);
+		}
+		return NULL;
+	}
+
 	for (i = priv->member; i; i = g_list_next (i))
 	{
 		IJsSymbol* t = IJS_SYMBOL (i->data);
@@ -187,6 +622,9 @@ gir_symbol_get_name (IJsSymbol *obj)
 {
 	GirSymbol* symbol = GIR_SYMBOL (obj);
 	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (symbol);
+
+	if (priv->file)
+		return gir_cache_get_string (priv->file, gir_cache_get_node (priv->file, priv->node)->name);
 	return priv->name;
 }
 
@@ -197,6 +635,21 @@ gir_symbol_list_member (IJsSymbol *obj)
 	GList *ret = NULL;
 	GirSymbolPrivate *priv = GIR_SYMBOL_PRIVATE (obj);
 
+	if (priv->file)
+	{
+		const GirCacheNode *node = gir_cache_get_node (priv->file, priv->node);
+		guint32 j;
+
+		for (j = 0; j < node->n_member; j++)
+		{
+			const GirCacheNode *child = gir_cache_get_node (priv->file, gir_cache_get_ref (priv->file, node->member + j));
+
+			if (child)
+				ret = g_list_prepend (ret, g_strdup (gir_cache_get_string (priv->file, child->name)));
+		}
+		return g_list_reverse (ret);
+	}
+
 	for (i = priv->member; i; i = g_list_next (i))
 	{
 		IJsSymbol* t = IJS_SYMBOL (i->data);
@@ -47,6 +47,7 @@ struct _GirSymbol
 
 GType gir_symbol_get_type (void) G_GNUC_CONST;
 IJsSymbol* gir_symbol_new (const gchar *filename, const gchar *lib_name);
+void gir_symbol_clear_cache (void);
 
 G_END_DECLS
 
@@ -17,6 +17,7 @@
     Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
 */
 #include "stdio.h"
+#include <string.h>
 
 #include "js-node.h"
 #include "js-parser-y-tab.h"
@@ -170,29 +171,471 @@ js_node_get_member_from_rc (JSNode* node, const gchar *mname)
 extern JSNode *global;
 extern GList *line_missed_semicolon;
 
+/* Parse the current lexer buffer, missed semicolons are returned in missed */
+static JSNode*
+js_node_parse (GList **missed)
+{
+	line_missed_semicolon = NULL;
+	global = NULL;
+
+	yyparse ();
+
+	*missed = line_missed_semicolon;
+	line_missed_semicolon = NULL;
+
+	return global;
+}
+
 JSNode*
 js_node_new_from_file (const gchar *name)
 {
 	FILE *f = fopen (name, "r");
 	JSNodePrivate *priv;
+	JSNode *node;
+	GList *missed;
 
-	line_missed_semicolon = NULL;
-	global = NULL;
 	yyset_lineno (1);
 	YY_BUFFER_STATE b = yy_create_buffer (f, 10000);
 	yy_switch_to_buffer (b);
 
-	yyparse ();
+	node = js_node_parse (&missed);
 
 	fclose (f);
 
 	yy_delete_buffer (b);
-	if (!global)
+	if (!node)
+	{
+		g_list_free (missed);
 		return g_object_new (JS_TYPE_NODE, NULL);
-	priv = JS_NODE_GET_PRIVATE (global);
+	}
+	priv = JS_NODE_GET_PRIVATE (node);
 
-	priv->missed = line_missed_semicolon;
-	return global;
+	priv->missed = missed;
+	return node;
+}
+
+/* Incremental parsing
+ *
+ * The text is cut in chunks of top level statements ending at the end of a
+ * line. Each chunk is parsed alone and kept with its text, so only the chunks
+ * which have changed are parsed again. The lines of a chunk which has moved
+ * are shifted. The statements of all chunks are linked together in a new
+ * program node.
+ *---------------------------------------------------------------------------*/
+
+typedef struct _JSNodeChunk JSNodeChunk;
+struct _JSNodeChunk
+{
+	gint line;
+	gchar *text;
+	gsize length;
+	JSNode *head;
+	JSNode *tail;
+	GList *missed;
+	JSNodeChunk *same;		/* Next chunk with the same text */
+};
+
+struct _JSNodeCache
+{
+	GHashTable *chunks;
+	GPtrArray *order;		/* Chunks of the last text, in order */
+};
+
+static guint
+js_node_chunk_hash (gconstpointer key)
+{
+	const JSNodeChunk *chunk = (const JSNodeChunk *)key;
+	guint hash = 5381;
+	gsize i;
+
+	/* Like g_str_hash, but the text of a key is not nul terminated */
+	for (i = 0; i < chunk->length; i++)
+		hash = (hash << 5) + hash + (guchar)chunk->text[i];
+
+	return hash;
+}
+
+static gboolean
+js_node_chunk_equal (gconstpointer a, gconstpointer b)
+{
+	const JSNodeChunk *chunk_a = (const JSNodeChunk *)a;
+	const JSNodeChunk *chunk_b = (const JSNodeChunk *)b;
+
+	return (chunk_a->length == chunk_b->length) && (memcmp (chunk_a->text, chunk_b->text, chunk_a->length) == 0);
+}
+
+static void
+js_node_set_next (JSNode *node, JSNode *next)
+{
+	if (next)
+		g_object_ref (next);
+	if (node->pn_next)
+		g_object_unref (node->pn_next);
+	node->pn_next = next;
+}
+
+static void
+js_node_chunk_free (JSNodeChunk *chunk)
+{
+	while (chunk != NULL)
+	{
+		JSNodeChunk *same = chunk->same;
+
+		/* The statements stay alive as long as a program node links to them */
+		if (chunk->head)
+			g_object_unref (chunk->head);
+		g_list_free (chunk->missed);
+		g_free (chunk->text);
+		g_free (chunk);
+		chunk = same;
+	}
+}
+
+static void js_node_shift_list (JSNode *node, glong delta, GHashTable *shifted);
+
+/* Move node and all its children by delta lines */
+static void
+js_node_shift_lines (JSNode *node, glong delta, GHashTable *shifted)
+{
+	if (!node || g_hash_table_contains (shifted, node))
+		return;
+	g_hash_table_add (shifted, node);
+
+	/* 0 is an unknown position */
+	if (node->pn_pos.begin)
+		node->pn_pos.begin += delta;
+	if (node->pn_pos.end)
+		node->pn_pos.end += delta;
+
+	switch (node->pn_arity)
+	{
+	case PN_FUNC:
+		js_node_shift_list (node->pn_u.func.body, delta, shifted);
+		js_node_shift_list (node->pn_u.func.name, delta, shifted);
+		js_node_shift_list (node->pn_u.func.args, delta, shifted);
+		break;
+	case PN_LIST:
+		js_node_shift_list (node->pn_u.list.head, delta, shifted);
+		break;
+	case PN_BINARY:
+		js_node_shift_list (node->pn_u.binary.left, delta, shifted);
+		js_node_shift_list (node->pn_u.binary.right, delta, shifted);
+		break;
+	case PN_UNARY:
+		js_node_shift_list (node->pn_u.unary.kid, delta, shifted);
+		break;
+	case PN_NAME:
+		js_node_shift_list (node->pn_u.name.expr, delta, shifted);
+		/* The name is a string except in a member access */
+		if (node->pn_type == TOK_DOT)
+			js_node_shift_list (node->pn_u.name.name, delta, shifted);
+		break;
+	}
+}
+
+static void
+js_node_shift_list (JSNode *node, glong delta, GHashTable *shifted)
+{
+	for (; node != NULL; node = node->pn_next)
+		js_node_shift_lines (node, delta, shifted);
+}
+
+/* Move the statements of a chunk to line */
+static void
+js_node_chunk_move (JSNodeChunk *chunk, gint line)
+{
+	glong delta = line - chunk->line;
+	GHashTable *shifted;
+	JSNode *node;
+	GList *item;
+
+	if (delta == 0)
+		return;
+
+	/* The last statement is linked to the next chunk */
+	shifted = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (node = chunk->head; node != NULL; node = node->pn_next)
+	{
+		js_node_shift_lines (node, delta, shifted);
+		if (node == chunk->tail)
+			break;
+	}
+	g_hash_table_destroy (shifted);
+
+	for (item = chunk->missed; item != NULL; item = g_list_next (item))
+		item->data = GINT_TO_POINTER (GPOINTER_TO_INT (item->data) + delta);
+	chunk->line = line;
+}
+
+/* Remove a chunk having text from chunks, returns NULL if there is none */
+static JSNodeChunk*
+js_node_chunk_take (GHashTable *chunks, const gchar *text, gsize length)
+{
+	JSNodeChunk key;
+	JSNodeChunk *chunk;
+
+	key.text = (gchar *)text;
+	key.length = length;
+	chunk = g_hash_table_lookup (chunks, &key);
+	if (chunk)
+	{
+		g_hash_table_steal (chunks, chunk);
+		if (chunk->same)
+			g_hash_table_add (chunks, chunk->same);
+		chunk->same = NULL;
+	}
+
+	return chunk;
+}
+
+static void
+js_node_chunk_add (GHashTable *chunks, JSNodeChunk *chunk)
+{
+	JSNodeChunk *first = g_hash_table_lookup (chunks, chunk);
+
+	if (first)
+	{
+		chunk->same = first->same;
+		first->same = chunk;
+	}
+	else
+	{
+		g_hash_table_add (chunks, chunk);
+	}
+}
+
+static JSNodeChunk*
+js_node_chunk_new (const gchar *text, gsize length, gint line)
+{
+	JSNodeChunk *chunk = g_new0 (JSNodeChunk, 1);
+	JSNode *node;
+	YY_BUFFER_STATE b;
+
+	chunk->line = line;
+	chunk->text = g_strndup (text, length);
+	chunk->length = length;
+
+	yyset_lineno (line);
+	b = yy_scan_bytes (text, length);
+	node = js_node_parse (&chunk->missed);
+	yy_delete_buffer (b);
+
+	if (node)
+	{
+		/* Keep only the statements */
+		chunk->head = node->pn_u.list.head;
+		node->pn_u.list.head = NULL;
+		g_object_unref (node);
+		if (chunk->head)
+			for (chunk->tail = chunk->head; chunk->tail->pn_next; chunk->tail = chunk->tail->pn_next);
+	}
+
+	return chunk;
+}
+
+/* Returns TRUE if the statement can continue after a new line at pos */
+static gboolean
+js_node_continue_statement (const gchar *pos)
+{
+	static const gchar * const keywords[] = {"else", "catch", "finally", "while", NULL};
+	const gchar * const *keyword;
+
+	while (g_ascii_isspace (*pos))
+		pos++;
+
+	if ((pos[0] == '/') && ((pos[1] == '/') || (pos[1] == '*')))
+		return FALSE;
+	if ((*pos != '\0') && (strchr ("([.,+-*/%=?:&|^<>!", *pos) != NULL))
+		return TRUE;
+	for (keyword = keywords; *keyword != NULL; keyword++)
+	{
+		gsize len = strlen (*keyword);
+
+		if ((strncmp (pos, *keyword, len) == 0) && !g_ascii_isalnum (pos[len]) && (pos[len] != '_'))
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Returns the length of the first chunk of text */
+static gsize
+js_node_get_chunk_length (const gchar *text)
+{
+	const gchar *pos;
+	gint depth = 0;
+	gchar quote = '\0';
+	gchar last = '\0';
+	gboolean line_comment = FALSE;
+	gboolean block_comment = FALSE;
+
+	for (pos = text; *pos != '\0'; pos++)
+	{
+		if (line_comment)
+		{
+			if (*pos != '\n') continue;
+			line_comment = FALSE;
+		}
+		else if (block_comment)
+		{
+			if ((pos[0] == '*') && (pos[1] == '/'))
+			{
+				block_comment = FALSE;
+				pos++;
+			}
+			continue;
+		}
+		else if (quote != '\0')
+		{
+			if ((*pos == '\\') && (pos[1] != '\0'))
+				pos++;
+			else if ((*pos == quote) || ((*pos == '\n') && (quote != '`')))
+				quote = '\0';
+			continue;
+		}
+
+		switch (*pos)
+		{
+		case '\n':
+			if ((depth == 0) && ((last == ';') || (last == '}'))
+			    && !js_node_continue_statement (pos + 1))
+				return pos + 1 - text;
+			continue;
+		case '/':
+			if (pos[1] == '/')
+			{
+				line_comment = TRUE;
+				continue;
+			}
+			if (pos[1] == '*')
+			{
+				block_comment = TRUE;
+				pos++;
+				continue;
+			}
+			/* A regular expression can only be where a value is expected */
+			if ((last == '\0') || (strchr ("(,=:[!&|?{};+-*%<>~^", last) != NULL))
+				quote = '/';
+			break;
+		case '"':
+		case '\'':
+		case '`':
+			quote = *pos;
+			break;
+		case '{':
+		case '(':
+		case '[':
+			depth++;
+			break;
+		case '}':
+		case ')':
+		case ']':
+			if (depth > 0) depth--;
+			break;
+		}
+		if (!g_ascii_isspace (*pos))
+			last = *pos;
+	}
+
+	return pos - text;
+}
+
+JSNodeCache*
+js_node_cache_new (void)
+{
+	JSNodeCache *cache = g_new0 (JSNodeCache, 1);
+
+	cache->chunks = g_hash_table_new_full (js_node_chunk_hash, js_node_chunk_equal,
+	                                       (GDestroyNotify)js_node_chunk_free, NULL);
+	cache->order = g_ptr_array_new ();
+
+	return cache;
+}
+
+void
+js_node_cache_free (JSNodeCache *cache)
+{
+	g_ptr_array_free (cache->order, TRUE);
+	g_hash_table_destroy (cache->chunks);
+	g_free (cache);
+}
+
+/* Returns TRUE if text is the text of the last call to js_node_cache_parse */
+gboolean
+js_node_cache_has_text (JSNodeCache *cache, const gchar *text)
+{
+	const gchar *pos = text;
+	guint i;
+
+	for (i = 0; i < cache->order->len; i++)
+	{
+		JSNodeChunk *chunk = (JSNodeChunk *)g_ptr_array_index (cache->order, i);
+
+		if (strncmp (pos, chunk->text, chunk->length) != 0)
+			return FALSE;
+		pos += chunk->length;
+	}
+
+	return *pos == '\0';
+}
+
+/* Returns a new program node for text, reusing the statements of the previous
+ * call which have not changed */
+JSNode*
+js_node_cache_parse (JSNodeCache *cache, const gchar *text)
+{
+	GHashTable *chunks;
+	JSNode *node;
+	JSNode *tail = NULL;
+	GList *missed = NULL;
+	const gchar *pos;
+	gint line = 1;
+
+	chunks = g_hash_table_new_full (js_node_chunk_hash, js_node_chunk_equal,
+	                                (GDestroyNotify)js_node_chunk_free, NULL);
+	g_ptr_array_set_size (cache->order, 0);
+	node = g_object_new (JS_TYPE_NODE, NULL);
+	node->pn_type = TOK_LC;
+	node->pn_arity = PN_LIST;
+
+	for (pos = text; *pos != '\0';)
+	{
+		gsize length = js_node_get_chunk_length (pos);
+		JSNodeChunk *chunk;
+		gsize i;
+
+		chunk = js_node_chunk_take (cache->chunks, pos, length);
+		if (chunk)
+			js_node_chunk_move (chunk, line);
+		else
+			chunk = js_node_chunk_new (pos, length, line);
+		js_node_chunk_add (chunks, chunk);
+		g_ptr_array_add (cache->order, chunk);
+
+		if (chunk->head)
+		{
+			if (tail)
+				js_node_set_next (tail, chunk->head);
+			else
+				node->pn_u.list.head = g_object_ref (chunk->head);
+			tail = chunk->tail;
+		}
+		missed = g_list_concat (missed, g_list_copy (chunk->missed));
+
+		for (i = 0; i < length; i++)
+			if (pos[i] == '\n') line++;
+		pos += length;
+	}
+	if (tail)
+		js_node_set_next (tail, NULL);
+
+	/* Free the chunks which are not used anymore */
+	g_hash_table_destroy (cache->chunks);
+	cache->chunks = chunks;
+
+	JS_NODE_GET_PRIVATE (node)->missed = missed;
+
+	return node;
 }
 
 GList*
@@ -35,6 +35,7 @@ G_BEGIN_DECLS
 
 typedef struct _JSNodeClass JSNodeClass;
 typedef struct _JSNode JSNode;
+typedef struct _JSNodeCache JSNodeCache;
 
 struct _JSNodeClass
 {
@@ -87,6 +88,11 @@ GList* js_node_get_list_member_from_rc (JSNode* node);
 JSNode* js_node_get_member_from_rc (JSNode* node, const gchar *mname);
 GList* js_node_get_lines_missed_semicolon (JSNode *node);
 
+JSNodeCache* js_node_cache_new (void);
+void js_node_cache_free (JSNodeCache *cache);
+JSNode* js_node_cache_parse (JSNodeCache *cache, const gchar *text);
+gboolean js_node_cache_has_text (JSNodeCache *cache, const gchar *text);
+
 G_END_DECLS
 
 #endif /* _JS_NODE_H_ */
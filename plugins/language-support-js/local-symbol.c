@@ -90,28 +90,45 @@ local_symbol_class_init (LocalSymbolClass *klass)
 }
 
 
-LocalSymbol*
-local_symbol_new (const gchar *filename)
+static LocalSymbol*
+local_symbol_new_from_node (JSNode *node, const gchar *filename)
 {
 	LocalSymbol* ret = LOCAL_SYMBOL (g_object_new (LOCAL_TYPE_SYMBOL, NULL));
 	LocalSymbolPrivate *priv = LOCAL_SYMBOL_PRIVATE (ret);
 
-	priv->node = js_node_new_from_file (filename);
+	priv->node = node;
 	if (priv->node)
 	{
 		priv->missed_semicolon = js_node_get_lines_missed_semicolon (priv->node);
 		priv->calls = NULL;
 		priv->my_cx = js_context_new_from_node (priv->node, &priv->calls);
 
-		GFile *file = g_file_new_for_path (filename);
-		priv->self_name = g_file_get_basename (file);
-		g_object_unref (file);
-		if (strcmp (priv->self_name + strlen (priv->self_name) - 3, ".js") == 0)
-			priv->self_name[strlen (priv->self_name) - 3] = '\0';
+		if (filename)
+		{
+			GFile *file = g_file_new_for_path (filename);
+			priv->self_name = g_file_get_basename (file);
+			g_object_unref (file);
+			if (strlen (priv->self_name) > 3 && strcmp (priv->self_name + strlen (priv->self_name) - 3, ".js") == 0)
+				priv->self_name[strlen (priv->self_name) - 3] = '\0';
+		}
 	}
 	return ret;
 }
 
+LocalSymbol*
+local_symbol_new (const gchar *filename)
+{
+	return local_symbol_new_from_node (js_node_new_from_file (filename), filename);
+}
+
+/* Parse text using cache, only the top level statements changed since the
+ * previous call with the same cache are parsed again */
+LocalSymbol*
+local_symbol_new_from_text (JSNodeCache *cache, const gchar *text, const gchar *filename)
+{
+	return local_symbol_new_from_node (js_node_cache_parse (cache, text), filename);
+}
+
 GList*
 local_symbol_get_missed_semicolons (LocalSymbol* object)
 {
@@ -22,6 +22,8 @@
 
 #include <glib-object.h>
 
+#include "js-node.h"
+
 G_BEGIN_DECLS
 
 #define LOCAL_TYPE_SYMBOL             (local_symbol_get_type ())
@@ -46,6 +48,7 @@ struct _LocalSymbol
 
 GType local_symbol_get_type (void) G_GNUC_CONST;
 LocalSymbol* local_symbol_new (const gchar *filename);
+LocalSymbol* local_symbol_new_from_text (JSNodeCache *cache, const gchar *text, const gchar *filename);
 GList* local_symbol_list_member_with_line (LocalSymbol* object, gint line);
 GList* local_symbol_get_missed_semicolons (LocalSymbol* object);
 
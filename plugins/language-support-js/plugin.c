@@ -38,6 +38,7 @@
 #include "code-completion.h"
 
 #include "gi-symbol.h"
+#include "gir-symbol.h"
 
 #define PREFS_BUILDER ANJUTA_GLADE_DIR"/anjuta-language-javascript.ui"
 #define ICON_FILE "anjuta-language-cpp-java-plugin.png"
@@ -102,6 +103,7 @@ js_support_plugin_dispose (GObject *obj)
 	g_assert (self != NULL);
 
 	g_clear_object (&self->symbol);
+	gir_symbol_clear_cache ();
 
 	G_OBJECT_CLASS (parent_class)->dispose (obj);
 }
@@ -486,7 +488,7 @@ ilanguage_provider_populate (IAnjutaLanguageProvider* obj,
 		return start_iter;
 
 	g_assert (plugin->prefs);
-	gchar *file = file_completion (IANJUTA_EDITOR (plugin->current_editor), &depth);
+	gchar *text = file_completion (IANJUTA_EDITOR (plugin->current_editor), &depth);
 
 	if (strlen (str) < g_settings_get_int (plugin->prefs, MIN_CODECOMPLETE))
 	{
@@ -494,12 +496,13 @@ ilanguage_provider_populate (IAnjutaLanguageProvider* obj,
 		                                    NULL, NULL, TRUE);
 
 		/* Highlight missed semicolon */
-		code_completion_get_list (plugin, file, NULL, depth);
+		code_completion_get_list (plugin, text, NULL, depth);
+		g_free (text);
 		return start_iter;
 	}
 
 	gint i;
-	DEBUG_PRINT ("JSLang: Auto complete for %s (TMFILE=%s)", str, file);
+	DEBUG_PRINT ("JSLang: Auto complete for %s", str);
 	for (i = strlen (str) - 1; i; i--)
 	{
 		if (str[i] == '.')
@@ -507,9 +510,10 @@ ilanguage_provider_populate (IAnjutaLanguageProvider* obj,
 	}
 	/* TODO: Use anjuta_language_provider_get_pre_word in the future */
 	if (i > 0)
-		suggestions = code_completion_get_list (plugin, file, g_strndup (str, i), depth);
+		suggestions = code_completion_get_list (plugin, text, g_strndup (str, i), depth);
 	else
-		suggestions = code_completion_get_list (plugin, file, NULL, depth);
+		suggestions = code_completion_get_list (plugin, text, NULL, depth);
+	g_free (text);
 	if (suggestions)
 	{
 		GList *nsuggest = NULL;
@@ -1,15 +1,25 @@
 import getopt
 import sys
+import select
+import time
 from collections import namedtuple
-from rope.base.project import Project 
-from rope.contrib import codeassist
-from rope.contrib import autoimport
+try:
+	from rope.base.project import Project
+	from rope.contrib import codeassist
+	from rope.contrib import autoimport
+except ImportError:
+	pass
 import os, re
 import pkg_resources
 from distutils.version import LooseVersion as V
 
 BUILDER_EXTENSION = '.ui'
 ROPE_VERSION = ''
+MISSING_ROPE = '|Missing python-rope module!|.|.|.|.|'
+
+# In server mode, the files of a project are checked for changes
+# at most every VALIDATE_DELAY seconds
+VALIDATE_DELAY = 5
 
 CompletionItem = namedtuple('CompletionItem', 'name info type scope location')
 def new_completion_item(**i):
@@ -54,16 +64,20 @@ class BuilderComplete(object):
 		return ret
 
 class RopeComplete(object):
-	def __init__(self, project_path, source_code, resource_path, code_point):
-		self.project = Project(project_path)
-		self.project.pycore._init_python_files()
-		
+	def __init__(self, project_path, source_code, resource_path, code_point, project=None):
+		self.own_project = project is None
+		if self.own_project:
+			project = Project(project_path)
+			project.pycore._init_python_files()
+		self.project = project
+
 		self.resource = self.project.get_resource(resource_path)
 		self.source_code = source_code
 		self.code_point = code_point
 
 	def __del__(self):
-		self.project.close()
+		if self.own_project:
+			self.project.close()
 
 	def get_proposals(self):
 		ret = []
@@ -83,6 +97,11 @@ class RopeComplete(object):
 		calltip = codeassist.get_doc(self.project, self.source_code, self.code_point, resource=self.resource, maxfixes=10)
 		return calltip
 
+def get_paths(project_arg, res_arg):
+	""" Returns the project path and the resource path relative to it """
+	project_path = str.replace(project_arg, 'file://', '') if project_arg.startswith('file://') else project_arg
+	return project_path, os.path.relpath(res_arg, project_path)
+
 def parse_arguments(args):
 	""" Returns a dictionary containing all the parsed args
 	and a string containing the source_code """
@@ -104,8 +123,7 @@ def parse_arguments(args):
 			builder_files_arg = arg
 
 	ret['option'] = option_arg;
-	ret['project_path'] = str.replace(project_arg, 'file://', '') if project_arg.startswith('file://') else project_arg
-	ret['resource_path'] = os.path.relpath(res_arg, ret['project_path'])
+	ret['project_path'], ret['resource_path'] = get_paths(project_arg, res_arg)
 	if ret['option'] != 'calltip':
 		ret['project_files'] = builder_files_arg.split('|')
 	ret['position'] = int(offset_arg)
@@ -116,32 +134,138 @@ def parse_arguments(args):
 
 	return ret
 
+def run(args, project=None):
+	""" Returns the output for the parsed args """
+	suggestions = []
+	calltip = ''
+	if args['option'] == 'autocomplete':
+		#get any completions Rope offers us
+		comp = RopeComplete(args['project_path'], args['source_code'], args['resource_path'], args['position'], project)
+		suggestions.extend(comp.get_proposals())
+		#see if we've typed get_object(' and if so, offer completions based upon the builder ui files in the project
+		comp = BuilderComplete(args['project_path'], args['resource_path'], args['source_code'], args['position'], args['project_files'])
+		suggestions.extend(comp.get_proposals())
+	elif args['option'] == 'calltip':
+		calltip_obj = RopeComplete(args['project_path'], args['source_code'], args['resource_path'], args['position'], project)
+		calltip = calltip_obj.get_calltip()
+
+	output = ''
+	for s in suggestions:
+		output += "|{0}|{1}|{2}|{3}|{4}|\n".format(s.name, s.scope, s.type, s.location, s.info)
+	if isinstance(calltip, unicode):
+		calltip = calltip.encode('utf-8')
+	output += "{0}\n".format(calltip)
+	return output
+
+class Server(object):
+	""" Answer the requests read on stdin, see python-worker.c for the
+	format. The rope projects and the edited buffer are kept between
+	requests. """
+	def __init__(self):
+		self.input = ''
+		self.requests = []
+		self.cancelled = set()
+		self.source_code = ''
+		self.projects = {}
+
+	def read(self, block):
+		""" Read the available frames, returns False at the end of input """
+		if not block and not select.select([0], [], [], 0)[0]:
+			return True
+		data = os.read(0, 65536)
+		if not data:
+			return False
+		self.input += data
+		while True:
+			end = self.input.find('\n')
+			if end < 0:
+				break
+			request_id, kind, length = self.input[:end].split(' ')
+			start = end + 1
+			end = start + int(length)
+			if len(self.input) < end:
+				break
+			if kind == 'cancel':
+				self.cancelled.add(int(request_id))
+			else:
+				self.requests.append((int(request_id), kind, self.input[start:end]))
+			self.input = self.input[end:]
+		return True
+
+	def write(self, request_id, output):
+		sys.stdout.write("{0} {1}\n".format(request_id, len(output)))
+		sys.stdout.write(output)
+		sys.stdout.flush()
+
+	def get_project(self, project_path):
+		project, validated = self.projects.get(project_path, (None, 0))
+		if project is None:
+			project = Project(project_path)
+			project.pycore._init_python_files()
+		elif time.time() - validated > VALIDATE_DELAY:
+			project.validate()
+		else:
+			return project
+		self.projects[project_path] = (project, time.time())
+		return project
+
+	def parse_request(self, body):
+		""" Apply the edit of the request and returns its arguments """
+		option, project_arg, res_arg, offset, builder_files, start, removed, text = body.split('\0', 7)
+		start = int(start)
+		removed = int(removed)
+		if removed < 0:
+			self.source_code = text
+		else:
+			self.source_code = self.source_code[:start] + text + self.source_code[start + removed:]
+
+		ret = {}
+		ret['option'] = option
+		ret['project_path'], ret['resource_path'] = get_paths(project_arg, res_arg)
+		ret['project_files'] = builder_files.split('|')
+		ret['position'] = int(offset)
+		ret['source_code'] = self.source_code
+		return ret
+
+	def serve(self):
+		while True:
+			if not self.requests:
+				if not self.read(True):
+					break
+				continue
+			#get all requests already sent, to skip the stale ones
+			while select.select([0], [], [], 0)[0] and self.read(False):
+				pass
+			request_id, kind, body = self.requests.pop(0)
+			args = self.parse_request(body)
+			if request_id in self.cancelled:
+				pass
+			elif [r for r in self.requests if r[1] == kind and r[0] not in self.cancelled]:
+				#superseded by a newer request
+				self.write(request_id, '')
+			elif not ROPE_VERSION:
+				self.write(request_id, MISSING_ROPE + '\n')
+			else:
+				try:
+					output = run(args, self.get_project(args['project_path']))
+				except:
+					output = ''
+				self.write(request_id, output)
+			self.cancelled = set(i for i in self.cancelled if i > request_id)
+
 if __name__ == '__main__':
 	try:
 		ROPE_VERSION = pkg_resources.get_distribution('rope').version
 	except:
-		print '|Missing python-rope module!|.|.|.|.|'
-		sys.exit(1)
+		if sys.argv[1:] != ['--server']:
+			print MISSING_ROPE
+			sys.exit(1)
+	if sys.argv[1:] == ['--server']:
+		Server().serve()
+		sys.exit(0)
 	try:
 		args = parse_arguments(sys.argv[1:])
-
-		suggestions = []
-		calltip = ''
-		if args['option'] == 'autocomplete':
-			#get any completions Rope offers us
-			comp = RopeComplete(args['project_path'], args['source_code'], args['resource_path'], args['position'])
-			suggestions.extend(comp.get_proposals())
-			#see if we've typed get_object(' and if so, offer completions based upon the builder ui files in the project
-			comp = BuilderComplete(args['project_path'], args['resource_path'], args['source_code'], args['position'], args['project_files'])
-			suggestions.extend(comp.get_proposals())
-		elif args['option'] == 'calltip':
-			calltip_obj = RopeComplete(args['project_path'], args['source_code'], args['resource_path'], args['position'])
-			calltip = calltip_obj.get_calltip()
-
-		for s in suggestions:
-			print "|{0}|{1}|{2}|{3}|{4}|".format(s.name, s.scope, s.type, s.location, s.info)
-		print calltip
+		sys.stdout.write(run(args))
 	except:
 		pass
 
-
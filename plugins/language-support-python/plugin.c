@@ -279,6 +279,7 @@ install_support (PythonPlugin *lang_plugin)
 		                                         sym_manager,
 		                                         lang_plugin->settings,
 		                                         plugin,
+		                                         lang_plugin->worker,
 		                                         project_root);
 	}
 
@@ -432,6 +433,9 @@ python_plugin_activate (AnjutaPlugin *plugin)
 											plugin);
 	python_plugin->uiid = anjuta_ui_merge (ui, UI_FILE);
 
+	/* Completion worker, started on the first request */
+	python_plugin->worker = python_worker_new (python_plugin->settings);
+
 	/* Add watches */
 	python_plugin->project_root_watch_id = anjuta_plugin_add_watch (plugin,
 									IANJUTA_PROJECT_MANAGER_PROJECT_ROOT_URI,
@@ -467,6 +471,9 @@ python_plugin_deactivate (AnjutaPlugin *plugin)
 	anjuta_ui_remove_action_group (ui, ANJUTA_PLUGIN_PYTHON(plugin)->action_group);
 	anjuta_ui_unmerge (ui, ANJUTA_PLUGIN_PYTHON(plugin)->uiid);
 
+	python_worker_free (lang_plugin->worker);
+	lang_plugin->worker = NULL;
+
 	return TRUE;
 }
 
@@ -500,6 +507,7 @@ python_plugin_instance_init (GObject *obj)
 	plugin->editor_watch_id = 0;
 	plugin->uiid = 0;
 	plugin->assist = NULL;
+	plugin->worker = NULL;
 	plugin->settings = g_settings_new (PREF_SCHEMA);
 }
 
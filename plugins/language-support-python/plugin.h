@@ -63,6 +63,7 @@ struct _PythonPlugin{
 	
 	/* Assist */
 	PythonAssist *assist;
+	PythonWorker *worker;
 
 	/* Preferences */
 	GtkBuilder* bxml;
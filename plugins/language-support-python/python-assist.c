@@ -24,12 +24,10 @@
 
 #include <ctype.h>
 #include <string.h>
-#include <unistd.h>
 #include <glib/gi18n.h>
 #include <libanjuta/anjuta-completion.h>
 #include <libanjuta/anjuta-debug.h>
 #include <libanjuta/anjuta-language-provider.h>
-#include <libanjuta/anjuta-launcher.h>
 #include <libanjuta/anjuta-plugin.h>
 #include <libanjuta/anjuta-utils.h>
 #include <libanjuta/interfaces/ianjuta-file.h>
@@ -41,14 +39,12 @@
 #include <libanjuta/interfaces/ianjuta-symbol.h>
 #include <libanjuta/interfaces/ianjuta-project-manager.h>
 #include "python-assist.h"
+#include "python-worker.h"
 
-#define PREF_INTERPRETER_PATH "interpreter-path"
 #define MAX_COMPLETIONS 30
 #define BRACE_SEARCH_LIMIT 500
 #define SCOPE_BRACE_JUMP_LIMIT 50
 
-#define AUTOCOMPLETE_SCRIPT SCRIPTS_DIR"/anjuta-python-autocomplete.py"
-
 #define AUTOCOMPLETE_REGEX_IN_GET_OBJECT "get_object\\s*\\(\\s*['\"]\\w*$"
 #define FILE_LIST_DELIMITER "|"
 #define SCOPE_CONTEXT_CHARACTERS ".0"
@@ -70,8 +66,7 @@ struct _PythonAssistPriv {
 	IAnjutaEditorAssist* iassist;
 	IAnjutaEditorTip* itip;
 	AnjutaLanguageProvider* lang_prov;
-	AnjutaLauncher* launcher;
-	AnjutaLauncher* calltip_launcher;	
+	PythonWorker* worker;
 	AnjutaPlugin* plugin;
 
 	const gchar* project_root;
@@ -82,13 +77,13 @@ struct _PythonAssistPriv {
 	gchar *pre_word;
 	
 	gint cache_position;
-	GString* rope_cache;
+	guint completion_id;
 
 	/* Calltips */
 	gchar* calltip_context;
 	IAnjutaIterable* calltip_iter;
 	GList* tips;
-	GString* calltip_cache;
+	guint calltip_id;
 };
 
 static const gchar*
@@ -120,10 +115,10 @@ python_assist_tag_destroy (AnjutaLanguageProposalData *tag)
 static void
 python_assist_cancel_queries (PythonAssist* assist)
 {
-	if (assist->priv->launcher)
+	if (assist->priv->completion_id)
 	{
-		g_object_unref (assist->priv->launcher);
-		assist->priv->launcher = NULL;
+		python_worker_cancel (assist->priv->worker, assist->priv->completion_id);
+		assist->priv->completion_id = 0;
 	}
 }
 
@@ -132,12 +127,6 @@ python_assist_clear_completion_cache (PythonAssist *assist)
 {
 	python_assist_cancel_queries (assist);
 	anjuta_completion_clear (assist->priv->completion_cache);
-
-	if (assist->priv->rope_cache)
-	{
-		g_string_free (assist->priv->rope_cache, TRUE);
-		assist->priv->rope_cache = NULL;
-	}
 }
 
 static void free_proposal (IAnjutaEditorAssistProposal* proposal)
@@ -186,72 +175,17 @@ python_assist_update_autocomplete (PythonAssist *assist)
 	g_list_free (suggestions);
 }
 
-/* Returns NULL if creation fails */
-static gchar*
-create_tmp_file (const gchar* source)
-{
-	gchar* tmp_file;
-	gint tmp_fd;
-	GError* err = NULL;
-
-	tmp_fd = g_file_open_tmp (NULL, &tmp_file, &err);
-	if (tmp_fd >= 0)
-	{
-		FILE *rope_file = fdopen (tmp_fd, "w");
-		if (rope_file)
-		{
-			fprintf (rope_file, "%s", source);
-			fclose (rope_file);
-			close (tmp_fd);
-			return tmp_file;
-		}
-	}
-
-	/* Error */
-	g_warning ("Creating tmp_file failed: %s", err->message);
-	g_error_free (err);
-	return NULL;
-}
-
-static void 
-on_autocomplete_output (AnjutaLauncher *launcher,
-                        AnjutaLauncherOutputType output_type,
-                        const gchar *chars,
-                        gpointer user_data)
-{
-	PythonAssist* assist = PYTHON_ASSIST (user_data);
-	if (output_type == ANJUTA_LAUNCHER_OUTPUT_STDOUT)
-	{
-		DEBUG_PRINT ("chars from script: %s", chars);
-		if (assist->priv->rope_cache)
-		{
-			g_string_append (assist->priv->rope_cache, chars);
-		}
-		else
-		{
-			assist->priv->rope_cache = g_string_new (chars);
-		}
-	}
-	if (output_type == ANJUTA_LAUNCHER_OUTPUT_STDERR)
-	{
-		g_warning ("Problem in python script: %s", chars);
-	}
-}
-
 static void
-on_autocomplete_finished (AnjutaLauncher* launcher,
-                          int child_pid, int exit_status,
-                          gulong time, gpointer user_data)
+on_autocomplete_finished (const gchar *output, gpointer user_data)
 {
 	PythonAssist* assist = PYTHON_ASSIST (user_data);
-	DEBUG_PRINT ("Python-Complete took %lu seconds and returned %d", time, exit_status);
+	DEBUG_PRINT ("chars from script: %s", output);
 
-	g_object_unref (launcher);
-	assist->priv->launcher = NULL;
+	assist->priv->completion_id = 0;
 	
-	if (assist->priv->rope_cache)
+	if (output)
 	{
-		GStrv completions = g_strsplit (assist->priv->rope_cache->str, "\n", -1);
+		GStrv completions = g_strsplit (output, "\n", -1);
 		GStrv cur_comp;
 		GList* suggestions = NULL;
 		GError *err = NULL;
@@ -320,9 +254,6 @@ on_autocomplete_finished (AnjutaLauncher* launcher,
 		g_regex_unref (regex);
 		g_strfreev (completions);
 
-		g_string_free (assist->priv->rope_cache, TRUE);
-		assist->priv->rope_cache = NULL;
-
 		g_list_free (suggestions);
 
 		/* Show autocompletion */
@@ -337,28 +268,16 @@ python_assist_create_word_completion_cache (PythonAssist *assist, IAnjutaIterabl
 	const gchar *cur_filename;
 	gint offset = ianjuta_iterable_get_position (cursor, NULL);
 	const gchar *project = assist->priv->project_root;
-	gchar *interpreter_path;
-	gchar *ropecommand;
-	GString *builder_file_paths = g_string_new("");
+	GString *builder_file_paths;
 	GList *project_files_list, *node;
 	gchar *python_content_type;
-
-	gchar *source = ianjuta_editor_get_text_all (editor, NULL);
-	gchar *tmp_file;
+	gchar *source;
 
 	cur_filename = assist->priv->editor_filename;
+	if (!cur_filename)
+		return FALSE;
 	if (!project)
 		project = g_get_tmp_dir ();
-	
-	/* Create rope command and temporary source file */
-	interpreter_path = g_settings_get_string (assist->priv->settings,
-	                                          PREF_INTERPRETER_PATH);
-
-	tmp_file = create_tmp_file (source);
-	g_free (source);
-
-	if (!tmp_file)
-		return FALSE;
 
 	/* Get a list of all the builder files in the project */
 	IAnjutaProjectManager *manager = anjuta_shell_get_interface (ANJUTA_PLUGIN (assist->priv->plugin)->shell,
@@ -367,6 +286,7 @@ python_assist_create_word_completion_cache (PythonAssist *assist, IAnjutaIterabl
 	project_files_list = ianjuta_project_manager_get_elements (IANJUTA_PROJECT_MANAGER (manager), 
 								   ANJUTA_PROJECT_SOURCE, 
 								   NULL);
+	builder_file_paths = g_string_new("");
 	python_content_type = g_content_type_from_mime_type ("text/x-python");
 	for (node = project_files_list; node != NULL; node = g_list_next (node))
 	{
@@ -390,63 +310,36 @@ python_assist_create_word_completion_cache (PythonAssist *assist, IAnjutaIterabl
 	g_list_free (project_files_list);
 	g_free (python_content_type);
 	
-	ropecommand = g_strdup_printf("%s %s -o autocomplete -p \"%s\" -r \"%s\" -s \"%s\" -f %d -b \"%s\"", 
-	                              interpreter_path, AUTOCOMPLETE_SCRIPT, project, 
-	                              cur_filename, tmp_file, offset, builder_file_paths->str);
+	/* Send the request to the worker and wait for results */
+	source = ianjuta_editor_get_text_all (editor, NULL);
+	assist->priv->completion_id = python_worker_query (assist->priv->worker,
+	                                                   "autocomplete", project,
+	                                                   cur_filename,
+	                                                   builder_file_paths->str,
+	                                                   source, offset,
+	                                                   on_autocomplete_finished,
+	                                                   assist);
+	g_free (source);
 	g_string_free (builder_file_paths, TRUE);
-	g_free (tmp_file);
-
-	DEBUG_PRINT("%s", ropecommand);
 
-	/* Exec command and wait for results */
-	assist->priv->launcher = anjuta_launcher_new ();
-	g_signal_connect (assist->priv->launcher, "child-exited",
-	                  G_CALLBACK(on_autocomplete_finished), assist);
-	anjuta_launcher_execute (assist->priv->launcher, ropecommand,
-	                         on_autocomplete_output,
-	                         assist);
-	g_free (ropecommand);
+	if (!assist->priv->completion_id)
+		return FALSE;
 
 	assist->priv->cache_position = offset;
 
 	return TRUE;
 }
 
-static void 
-on_calltip_output (AnjutaLauncher *launcher,
-                   AnjutaLauncherOutputType output_type,
-                   const gchar *chars,
-                   gpointer user_data)
-{
-	PythonAssist* assist = PYTHON_ASSIST (user_data);
-	if (output_type == ANJUTA_LAUNCHER_OUTPUT_STDOUT)
-	{
-		if (assist->priv->calltip_cache)
-		{
-			g_string_append (assist->priv->calltip_cache, chars);
-		}
-		else
-		{
-			assist->priv->calltip_cache = g_string_new (chars);
-		}
-	}
-}
-
 static void
-on_calltip_finished (AnjutaLauncher* launcher,
-                     int child_pid, int exit_status,
-                     gulong time, gpointer user_data)
+on_calltip_finished (const gchar *output, gpointer user_data)
 {
 	PythonAssist* assist = PYTHON_ASSIST (user_data);
-	DEBUG_PRINT ("Python-Complete took %lu seconds and returned %d", time, exit_status);
 
-	g_object_unref (launcher);
-	assist->priv->calltip_launcher = NULL;
+	assist->priv->calltip_id = 0;
 
-	if (assist->priv->calltip_cache)
+	if (output)
 	{
-		GString* calltip_text = g_string_new (assist->priv->calltip_cache->str);
-		assist->priv->tips = g_list_prepend (NULL, calltip_text->str);
+		assist->priv->tips = g_list_prepend (NULL, g_strdup (output));
 		if (g_ascii_strncasecmp ("None", assist->priv->tips->data, 4))
 		{
 			ianjuta_editor_tip_show (IANJUTA_EDITOR_TIP(assist->priv->itip),
@@ -454,8 +347,6 @@ on_calltip_finished (AnjutaLauncher* launcher,
 				                     assist->priv->calltip_iter,
 				                     NULL);
 		}
-		g_string_free (assist->priv->calltip_cache, TRUE);
-		assist->priv->calltip_cache = NULL;
 	}
 }
 
@@ -485,42 +376,25 @@ python_assist_query_calltip (PythonAssist* assist, const gchar *call_context)
 	
 	gint offset = python_assist_get_calltip_context_position (assist);
 	
-	gchar *interpreter_path;
 	const gchar *cur_filename;
-	gchar *source = ianjuta_editor_get_text_all (editor, NULL);
+	gchar *source;
 	const gchar *project = assist->priv->project_root;
-	gchar *tmp_file;
-	gchar *ropecommand;
 
 	cur_filename = assist->priv->editor_filename;
+	if (!cur_filename)
+		return;
 	if (!project)
 		project = g_get_tmp_dir ();
-	
-	interpreter_path = g_settings_get_string (assist->priv->settings,
-	                                          PREF_INTERPRETER_PATH);
 
-	tmp_file = create_tmp_file (source);
+	/* Send the request to the worker and wait for results */
+	source = ianjuta_editor_get_text_all (editor, NULL);
+	assist->priv->calltip_id = python_worker_query (assist->priv->worker,
+	                                                "calltip", project,
+	                                                cur_filename, NULL,
+	                                                source, offset,
+	                                                on_calltip_finished,
+	                                                assist);
 	g_free (source);
-
-	if (!tmp_file)
-		return;
-	
-	ropecommand = g_strdup_printf("%s %s -o calltip -p \"%s\" -r \"%s\" -s \"%s\" -f %d", 
-								interpreter_path, AUTOCOMPLETE_SCRIPT, project, 
-								cur_filename, tmp_file, offset);
-
-	DEBUG_PRINT ("%s", ropecommand);
-
-	g_free (tmp_file);
-
-	/* Exec command and wait for results */
-	assist->priv->calltip_launcher = anjuta_launcher_new ();
-	g_signal_connect (assist->priv->calltip_launcher, "child-exited",
-	                  G_CALLBACK(on_calltip_finished), assist);
-	anjuta_launcher_execute (assist->priv->calltip_launcher, ropecommand,
-	                         on_calltip_output,
-	                         assist);
-	g_free (ropecommand);	
 }
 
 static void
@@ -535,11 +409,11 @@ python_assist_create_calltip_context (PythonAssist* assist,
 static void
 python_assist_clear_calltip_context (PythonAssist* assist)
 {
-	if (assist->priv->calltip_launcher)
+	if (assist->priv->calltip_id)
 	{
-		g_object_unref (assist->priv->calltip_launcher);
-	}	
-	assist->priv->calltip_launcher = NULL;
+		python_worker_cancel (assist->priv->worker, assist->priv->calltip_id);
+		assist->priv->calltip_id = 0;
+	}
 	
 	g_list_foreach (assist->priv->tips, (GFunc) g_free, NULL);
 	g_list_free (assist->priv->tips);
@@ -766,11 +640,13 @@ python_assist_new (IAnjutaEditor *ieditor,
                    IAnjutaSymbolManager *isymbol_manager,
                    GSettings* settings,
                    AnjutaPlugin *plugin,
+                   PythonWorker *worker,
                    const gchar *project_root)
 {
 	PythonAssist *assist = g_object_new (TYPE_PYTHON_ASSIST, NULL);
 	assist->priv->lang_prov = g_object_new (ANJUTA_TYPE_LANGUAGE_PROVIDER, NULL);
 	assist->priv->settings = settings;
+	assist->priv->worker = worker;
 	assist->priv->plugin = plugin;
 	assist->priv->project_root = project_root;
 		
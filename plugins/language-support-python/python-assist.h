@@ -29,6 +29,7 @@
 #include <libanjuta/interfaces/ianjuta-editor-assist.h>
 #include <libanjuta/interfaces/ianjuta-symbol-manager.h>
 #include <libanjuta/interfaces/ianjuta-project-manager.h>
+#include "python-worker.h"
 
 G_BEGIN_DECLS
 
@@ -61,6 +62,7 @@ python_assist_new                             (IAnjutaEditor *ieditor,
                                                IAnjutaSymbolManager *isymbol_manager,
                                                GSettings* settings,
                                                AnjutaPlugin *plugin,
+                                               PythonWorker *worker,
                                                const gchar *project_root);
 
 G_END_DECLS
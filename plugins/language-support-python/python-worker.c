@@ -0,0 +1,513 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * python-worker.c
+ *
+ * anjuta is free software.
+ *
+ * You may redistribute it and/or modify it under the terms of the
+ * GNU General Public License, as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * anjuta is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with anjuta.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+/*
+ * The worker reads frames made of a header line "<id> <kind> <length>"
+ * followed by length bytes. kind is the option of the script (autocomplete
+ * or calltip) or cancel. The body of a query has the option, the project,
+ * the resource, the offset, the builder files, the start of the edit, the
+ * number of replaced bytes (-1 for the whole buffer) and the inserted text,
+ * separated by '\0'. The answers are a header line "<id> <length>" followed
+ * by the output of the command line mode.
+ *---------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gi18n.h>
+#include <libanjuta/anjuta-debug.h>
+#include "python-worker.h"
+
+#define PREF_INTERPRETER_PATH "interpreter-path"
+
+#define AUTOCOMPLETE_SCRIPT SCRIPTS_DIR"/anjuta-python-autocomplete.py"
+
+#define READ_SIZE 4096
+
+typedef struct
+{
+	guint id;
+	PythonWorkerCallback callback;
+	gpointer user_data;
+} PythonWorkerRequest;
+
+struct _PythonWorker
+{
+	GSettings *settings;
+	gchar *interpreter;
+
+	/* Running process, pid is 0 if there is none */
+	GPid pid;
+	/* Incremented each time the process is stopped */
+	guint generation;
+	guint child_watch;
+	gint in_fd;
+	gint out_fd;
+	guint in_watch;
+	guint out_watch;
+	GString *send_buffer;
+	GString *receive_buffer;
+
+	/* Buffer as known by the worker, NULL if it has to be sent in full */
+	gchar *resource;
+	gchar *document;
+
+	guint next_id;
+	GList *requests;
+};
+
+/* Process
+ *---------------------------------------------------------------------------*/
+
+static void
+on_worker_reaped (GPid pid, gint status, gpointer user_data)
+{
+	g_spawn_close_pid (pid);
+}
+
+/* Closing the input makes the worker exit once it has finished the current
+ * request, the pending requests are answered with NULL. */
+static void
+python_worker_stop (PythonWorker *worker)
+{
+	GList *requests;
+	GList *node;
+
+	if (worker->pid != 0)
+	{
+		if (worker->child_watch != 0)
+		{
+			g_source_remove (worker->child_watch);
+			g_child_watch_add (worker->pid, on_worker_reaped, NULL);
+		}
+		else
+		{
+			g_spawn_close_pid (worker->pid);
+		}
+		worker->child_watch = 0;
+		worker->pid = 0;
+	}
+	worker->generation++;
+	if (worker->in_watch != 0) g_source_remove (worker->in_watch);
+	worker->in_watch = 0;
+	if (worker->out_watch != 0) g_source_remove (worker->out_watch);
+	worker->out_watch = 0;
+	if (worker->in_fd >= 0) close (worker->in_fd);
+	worker->in_fd = -1;
+	if (worker->out_fd >= 0) close (worker->out_fd);
+	worker->out_fd = -1;
+
+	g_string_truncate (worker->send_buffer, 0);
+	g_string_truncate (worker->receive_buffer, 0);
+	g_free (worker->resource);
+	worker->resource = NULL;
+	g_free (worker->document);
+	worker->document = NULL;
+
+	/* Callbacks can send new requests */
+	requests = worker->requests;
+	worker->requests = NULL;
+	for (node = requests; node != NULL; node = g_list_next (node))
+	{
+		PythonWorkerRequest *request = (PythonWorkerRequest *)node->data;
+
+		request->callback (NULL, request->user_data);
+		g_free (request);
+	}
+	g_list_free (requests);
+}
+
+static void
+on_worker_exited (GPid pid, gint status, gpointer user_data)
+{
+	PythonWorker *worker = (PythonWorker *)user_data;
+
+	DEBUG_PRINT ("Python worker exited with status %d", status);
+	g_spawn_close_pid (pid);
+	worker->child_watch = 0;
+	worker->pid = 0;
+	python_worker_stop (worker);
+}
+
+/* The worker can die at any time, writing to it must not kill Anjuta with
+ * a SIGPIPE */
+static gssize
+python_worker_write (gint fd, const gchar *data, gsize length)
+{
+	sigset_t pipe_set;
+	sigset_t old_set;
+	gssize written;
+
+	sigemptyset (&pipe_set);
+	sigaddset (&pipe_set, SIGPIPE);
+	pthread_sigmask (SIG_BLOCK, &pipe_set, &old_set);
+	written = write (fd, data, length);
+	if ((written < 0) && (errno == EPIPE))
+	{
+		struct timespec no_wait = {0, 0};
+
+		sigtimedwait (&pipe_set, NULL, &no_wait);
+		errno = EPIPE;
+	}
+	pthread_sigmask (SIG_SETMASK, &old_set, NULL);
+
+	return written;
+}
+
+/* Returns FALSE if the worker has been stopped */
+static gboolean
+python_worker_flush (PythonWorker *worker)
+{
+	while (worker->send_buffer->len > 0)
+	{
+		gssize written;
+
+		written = python_worker_write (worker->in_fd, worker->send_buffer->str,
+		                               worker->send_buffer->len);
+		if (written < 0)
+		{
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN) break;
+
+			g_warning ("Unable to send request to python worker: %s",
+			           g_strerror (errno));
+			python_worker_stop (worker);
+			return FALSE;
+		}
+		g_string_erase (worker->send_buffer, 0, written);
+	}
+
+	return TRUE;
+}
+
+static gboolean
+on_worker_input (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	PythonWorker *worker = (PythonWorker *)user_data;
+
+	if (!python_worker_flush (worker)) return FALSE;
+	if (worker->send_buffer->len > 0) return TRUE;
+
+	worker->in_watch = 0;
+	return FALSE;
+}
+
+static void
+python_worker_send (PythonWorker *worker, guint id, const gchar *kind,
+                    const gchar *body, gsize length)
+{
+	g_string_append_printf (worker->send_buffer, "%u %s %" G_GSIZE_FORMAT "\n",
+	                        id, kind, length);
+	g_string_append_len (worker->send_buffer, body, length);
+
+	/* Wait for the worker to read if the pipe is full */
+	if ((worker->in_watch == 0) && python_worker_flush (worker)
+	    && (worker->send_buffer->len > 0))
+	{
+		GIOChannel *channel = g_io_channel_unix_new (worker->in_fd);
+
+		worker->in_watch = g_io_add_watch (channel, G_IO_OUT | G_IO_ERR | G_IO_HUP,
+		                                   on_worker_input, worker);
+		g_io_channel_unref (channel);
+	}
+}
+
+/* Call the callback of all complete answers, returns FALSE if the worker
+ * has been stopped meanwhile */
+static gboolean
+python_worker_parse_answers (PythonWorker *worker)
+{
+	guint generation = worker->generation;
+	gsize start = 0;
+
+	while (worker->pid != 0)
+	{
+		gchar *data = worker->receive_buffer->str + start;
+		gchar *header_end;
+		gchar *end;
+		guint id;
+		gsize length;
+		GList *node;
+
+		header_end = memchr (data, '\n', worker->receive_buffer->len - start);
+		if (header_end == NULL) break;
+		id = strtoul (data, &end, 10);
+		length = g_ascii_strtoull (end, NULL, 10);
+		if (header_end + 1 + length > worker->receive_buffer->str + worker->receive_buffer->len) break;
+		start = header_end + 1 + length - worker->receive_buffer->str;
+
+		/* Answers to cancelled requests are dropped */
+		for (node = worker->requests; node != NULL; node = g_list_next (node))
+		{
+			PythonWorkerRequest *request = (PythonWorkerRequest *)node->data;
+
+			if (request->id == id)
+			{
+				gchar *output = g_strndup (header_end + 1, length);
+
+				worker->requests = g_list_delete_link (worker->requests, node);
+				request->callback (output, request->user_data);
+				g_free (output);
+				g_free (request);
+				break;
+			}
+		}
+
+		/* A callback can have restarted the worker with a new buffer */
+		if (worker->generation != generation) return FALSE;
+	}
+
+	if (worker->pid != 0) g_string_erase (worker->receive_buffer, 0, start);
+
+	return worker->pid != 0;
+}
+
+static gboolean
+on_worker_output (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	PythonWorker *worker = (PythonWorker *)user_data;
+	gint fd = worker->out_fd;
+	gssize count;
+	gint saved_errno;
+
+	do
+	{
+		gsize len = worker->receive_buffer->len;
+
+		g_string_set_size (worker->receive_buffer, len + READ_SIZE);
+		count = read (fd, worker->receive_buffer->str + len, READ_SIZE);
+		g_string_set_size (worker->receive_buffer, len + MAX (count, 0));
+	}
+	while ((count == READ_SIZE) || ((count < 0) && (errno == EINTR)));
+	saved_errno = errno;
+
+	/* A callback can have stopped or restarted the worker */
+	if (!python_worker_parse_answers (worker)) return FALSE;
+
+	if ((count == 0) || ((count < 0) && (saved_errno != EAGAIN)))
+	{
+		/* The worker has closed its output */
+		worker->out_watch = 0;
+		python_worker_stop (worker);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+python_worker_start (PythonWorker *worker)
+{
+	gchar *command;
+	gchar **argv;
+	GIOChannel *channel;
+	GError *err = NULL;
+
+	g_free (worker->interpreter);
+	worker->interpreter = g_settings_get_string (worker->settings,
+	                                             PREF_INTERPRETER_PATH);
+	command = g_strdup_printf ("%s %s --server", worker->interpreter,
+	                           AUTOCOMPLETE_SCRIPT);
+	DEBUG_PRINT ("%s", command);
+	if (!g_shell_parse_argv (command, NULL, &argv, &err))
+	{
+		g_warning ("Unable to parse python command: %s", err->message);
+		g_error_free (err);
+		g_free (command);
+		return FALSE;
+	}
+	g_free (command);
+
+	if (!g_spawn_async_with_pipes (NULL, argv, NULL,
+	                               G_SPAWN_SEARCH_PATH | G_SPAWN_DO_NOT_REAP_CHILD,
+	                               NULL, NULL, &worker->pid,
+	                               &worker->in_fd, &worker->out_fd, NULL, &err))
+	{
+		g_warning ("Unable to start python worker: %s", err->message);
+		g_error_free (err);
+		g_strfreev (argv);
+		worker->pid = 0;
+		return FALSE;
+	}
+	g_strfreev (argv);
+
+	fcntl (worker->in_fd, F_SETFL, fcntl (worker->in_fd, F_GETFL) | O_NONBLOCK);
+	fcntl (worker->out_fd, F_SETFL, fcntl (worker->out_fd, F_GETFL) | O_NONBLOCK);
+
+	worker->child_watch = g_child_watch_add (worker->pid, on_worker_exited, worker);
+	channel = g_io_channel_unix_new (worker->out_fd);
+	worker->out_watch = g_io_add_watch (channel, G_IO_IN | G_IO_ERR | G_IO_HUP,
+	                                    on_worker_output, worker);
+	g_io_channel_unref (channel);
+
+	return TRUE;
+}
+
+/* Append the part of source which differs from the buffer known by the
+ * worker */
+static void
+python_worker_append_edit (PythonWorker *worker, GString *body,
+                           const gchar *resource, const gchar *source)
+{
+	gsize new_length = strlen (source);
+
+	if ((worker->document == NULL) || (g_strcmp0 (worker->resource, resource) != 0))
+	{
+		g_string_append (body, "0");
+		g_string_append_c (body, '\0');
+		g_string_append (body, "-1");
+		g_string_append_c (body, '\0');
+		g_string_append_len (body, source, new_length);
+
+		g_free (worker->resource);
+		worker->resource = g_strdup (resource);
+	}
+	else
+	{
+		gsize old_length = strlen (worker->document);
+		gsize prefix = 0;
+		gsize suffix = 0;
+
+		while ((prefix < old_length) && (prefix < new_length)
+		       && (worker->document[prefix] == source[prefix]))
+			prefix++;
+		while ((suffix < old_length - prefix) && (suffix < new_length - prefix)
+		       && (worker->document[old_length - 1 - suffix] == source[new_length - 1 - suffix]))
+			suffix++;
+
+		g_string_append_printf (body, "%" G_GSIZE_FORMAT, prefix);
+		g_string_append_c (body, '\0');
+		g_string_append_printf (body, "%" G_GSIZE_FORMAT, old_length - prefix - suffix);
+		g_string_append_c (body, '\0');
+		g_string_append_len (body, source + prefix, new_length - prefix - suffix);
+	}
+
+	g_free (worker->document);
+	worker->document = g_strdup (source);
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+PythonWorker *
+python_worker_new (GSettings *settings)
+{
+	PythonWorker *worker;
+
+	worker = g_new0 (PythonWorker, 1);
+	worker->settings = g_object_ref (settings);
+	worker->in_fd = -1;
+	worker->out_fd = -1;
+	worker->send_buffer = g_string_new (NULL);
+	worker->receive_buffer = g_string_new (NULL);
+	worker->next_id = 1;
+
+	return worker;
+}
+
+void
+python_worker_free (PythonWorker *worker)
+{
+	python_worker_stop (worker);
+	g_string_free (worker->send_buffer, TRUE);
+	g_string_free (worker->receive_buffer, TRUE);
+	g_free (worker->interpreter);
+	g_object_unref (worker->settings);
+	g_free (worker);
+}
+
+/* Returns the identifier of the request, to use with python_worker_cancel(),
+ * or 0 if the worker cannot be started */
+guint
+python_worker_query (PythonWorker *worker,
+                     const gchar *option,
+                     const gchar *project,
+                     const gchar *resource,
+                     const gchar *builder_files,
+                     const gchar *source,
+                     gint offset,
+                     PythonWorkerCallback callback,
+                     gpointer user_data)
+{
+	PythonWorkerRequest *request;
+	GString *body;
+	gchar *interpreter;
+
+	/* Restart the worker if the interpreter has been changed */
+	interpreter = g_settings_get_string (worker->settings, PREF_INTERPRETER_PATH);
+	if ((worker->pid != 0) && (g_strcmp0 (interpreter, worker->interpreter) != 0))
+		python_worker_stop (worker);
+	g_free (interpreter);
+
+	if ((worker->pid == 0) && !python_worker_start (worker)) return 0;
+
+	request = g_new (PythonWorkerRequest, 1);
+	request->id = worker->next_id++;
+	if (worker->next_id == 0) worker->next_id = 1;
+	request->callback = callback;
+	request->user_data = user_data;
+	worker->requests = g_list_append (worker->requests, request);
+
+	body = g_string_new (option);
+	g_string_append_c (body, '\0');
+	g_string_append (body, project);
+	g_string_append_c (body, '\0');
+	g_string_append (body, resource);
+	g_string_append_c (body, '\0');
+	g_string_append_printf (body, "%d", offset);
+	g_string_append_c (body, '\0');
+	if (builder_files != NULL) g_string_append (body, builder_files);
+	g_string_append_c (body, '\0');
+	python_worker_append_edit (worker, body, resource, source);
+
+	python_worker_send (worker, request->id, option, body->str, body->len);
+	g_string_free (body, TRUE);
+
+	/* The worker could have died while sending the request */
+	return worker->pid != 0 ? request->id : 0;
+}
+
+/* The callback of a cancelled request is not called, the worker skips it if
+ * it has not started it yet */
+void
+python_worker_cancel (PythonWorker *worker, guint id)
+{
+	GList *node;
+
+	for (node = worker->requests; node != NULL; node = g_list_next (node))
+	{
+		PythonWorkerRequest *request = (PythonWorkerRequest *)node->data;
+
+		if (request->id == id)
+		{
+			worker->requests = g_list_delete_link (worker->requests, node);
+			g_free (request);
+			if (worker->pid != 0) python_worker_send (worker, id, "cancel", "", 0);
+			break;
+		}
+	}
+}
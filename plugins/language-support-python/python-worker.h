@@ -0,0 +1,57 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * python-worker.h
+ *
+ * anjuta is free software.
+ *
+ * You may redistribute it and/or modify it under the terms of the
+ * GNU General Public License, as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * anjuta is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with anjuta.  If not, write to:
+ * 	The Free Software Foundation, Inc.,
+ * 	51 Franklin Street, Fifth Floor
+ * 	Boston, MA  02110-1301, USA.
+ */
+
+#ifndef _PYTHON_WORKER_H_
+#define _PYTHON_WORKER_H_
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/* A single anjuta-python-autocomplete.py process running in server mode,
+ * shared by all editors. It keeps the rope projects loaded between requests
+ * and only receives the part of the buffer which has changed since the
+ * previous request. */
+typedef struct _PythonWorker PythonWorker;
+
+/* output is the text the script writes in command line mode, or NULL if the
+ * worker has died before answering */
+typedef void (*PythonWorkerCallback) (const gchar *output, gpointer user_data);
+
+PythonWorker *python_worker_new (GSettings *settings);
+void python_worker_free (PythonWorker *worker);
+
+guint python_worker_query (PythonWorker *worker,
+                           const gchar *option,
+                           const gchar *project,
+                           const gchar *resource,
+                           const gchar *builder_files,
+                           const gchar *source,
+                           gint offset,
+                           PythonWorkerCallback callback,
+                           gpointer user_data);
+void python_worker_cancel (PythonWorker *worker, guint id);
+
+G_END_DECLS
+
+#endif /* _PYTHON_WORKER_H_ */
@@ -0,0 +1,690 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * message-view-model.c
+ * Copyright (C) Johannes Schmid 2012
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * List model holding the messages of a message view.
+ *
+ * Messages are stored in fixed size chunks which are never moved, so
+ * appending does not copy anything and a message keeps its address. Each
+ * chunk has a bitmap per message type, the rows shown by the model are the
+ * union of the bitmaps of the selected types: changing the filter does not
+ * look at the messages at all.
+ *
+ * The markup and the colors are computed only when a row is displayed.
+ * Appended messages are added to the views in an idle callback, so a burst
+ * of messages is handled once per frame instead of once per message.
+ */
+
+#include "message-view-model.h"
+
+#define MESSAGE_VIEW_MODEL_CHUNK_SIZE	1024
+#define MESSAGE_VIEW_MODEL_CHUNK_WORDS	(MESSAGE_VIEW_MODEL_CHUNK_SIZE / 64)
+
+/* Messages with an unknown type are always shown */
+#define MESSAGE_VIEW_MODEL_OTHER_TYPE	4
+#define MESSAGE_VIEW_MODEL_N_TYPES		5
+#define MESSAGE_VIEW_MODEL_ALL_FLAGS	((1 << MESSAGE_VIEW_MODEL_OTHER_TYPE) - 1)
+
+typedef struct
+{
+	Message messages[MESSAGE_VIEW_MODEL_CHUNK_SIZE];
+	guint64 bits[MESSAGE_VIEW_MODEL_N_TYPES][MESSAGE_VIEW_MODEL_CHUNK_WORDS];
+	guint counts[MESSAGE_VIEW_MODEL_N_TYPES];
+
+	/* Number of shown messages in all previous chunks */
+	guint shown_before;
+} MessageViewModelChunk;
+
+struct _MessageViewModelPriv
+{
+	GPtrArray *chunks;
+	guint n_messages;
+
+	/* Messages already added to the views and the shown ones among them */
+	guint n_committed;
+	guint n_shown;
+	guint commit_idle;
+
+	/* One bit per shown message type */
+	guint flags;
+	gint stamp;
+
+	gboolean highlite;
+	gchar *colors[MESSAGE_VIEW_MODEL_N_TYPES];
+};
+
+static void message_view_model_tree_model_init (GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MessageViewModel, message_view_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                message_view_model_tree_model_init));
+
+/* Bitmap functions
+ *---------------------------------------------------------------------------*/
+
+static guint
+message_view_model_bit_count (guint64 word)
+{
+	word = word - ((word >> 1) & G_GUINT64_CONSTANT (0x5555555555555555));
+	word = (word & G_GUINT64_CONSTANT (0x3333333333333333)) +
+		((word >> 2) & G_GUINT64_CONSTANT (0x3333333333333333));
+	word = (word + (word >> 4)) & G_GUINT64_CONSTANT (0x0f0f0f0f0f0f0f0f);
+
+	return (word * G_GUINT64_CONSTANT (0x0101010101010101)) >> 56;
+}
+
+static guint
+message_view_model_type_index (IAnjutaMessageViewType type)
+{
+	return (guint)type < MESSAGE_VIEW_MODEL_OTHER_TYPE ? (guint)type : MESSAGE_VIEW_MODEL_OTHER_TYPE;
+}
+
+static gboolean
+message_view_model_is_shown (MessageViewModel *model, guint type_index)
+{
+	return (type_index == MESSAGE_VIEW_MODEL_OTHER_TYPE) ||
+		(model->priv->flags & (1 << type_index));
+}
+
+static guint64
+message_view_model_chunk_get_shown (MessageViewModel *model,
+									MessageViewModelChunk *chunk, guint word)
+{
+	guint64 shown = 0;
+	guint type;
+
+	for (type = 0; type < MESSAGE_VIEW_MODEL_N_TYPES; type++)
+	{
+		if (message_view_model_is_shown (model, type))
+			shown |= chunk->bits[type][word];
+	}
+
+	return shown;
+}
+
+static guint
+message_view_model_chunk_count_shown (MessageViewModel *model,
+									  MessageViewModelChunk *chunk)
+{
+	guint count = 0;
+	guint type;
+
+	for (type = 0; type < MESSAGE_VIEW_MODEL_N_TYPES; type++)
+	{
+		if (message_view_model_is_shown (model, type))
+			count += chunk->counts[type];
+	}
+
+	return count;
+}
+
+static MessageViewModelChunk *
+message_view_model_get_chunk (MessageViewModel *model, guint message)
+{
+	return g_ptr_array_index (model->priv->chunks,
+							  message / MESSAGE_VIEW_MODEL_CHUNK_SIZE);
+}
+
+/* Find the first shown message starting from message */
+static gboolean
+message_view_model_find_shown (MessageViewModel *model, guint message,
+							   guint *found)
+{
+	while (message < model->priv->n_committed)
+	{
+		MessageViewModelChunk *chunk = message_view_model_get_chunk (model, message);
+		guint offset = message % MESSAGE_VIEW_MODEL_CHUNK_SIZE;
+
+		if (message_view_model_chunk_count_shown (model, chunk) != 0)
+		{
+			guint word;
+
+			for (word = offset / 64; word < MESSAGE_VIEW_MODEL_CHUNK_WORDS; word++)
+			{
+				guint64 shown = message_view_model_chunk_get_shown (model, chunk, word);
+
+				if (word == offset / 64)
+					shown &= G_MAXUINT64 << (offset % 64);
+				if (shown != 0)
+				{
+					*found = message - offset + word * 64 +
+						message_view_model_bit_count ((shown & -shown) - 1);
+					return TRUE;
+				}
+			}
+		}
+		message = message - offset + MESSAGE_VIEW_MODEL_CHUNK_SIZE;
+	}
+
+	return FALSE;
+}
+
+/* Find the nth shown message */
+static gboolean
+message_view_model_get_nth_shown (MessageViewModel *model, guint n,
+								  guint *found)
+{
+	MessageViewModelChunk *chunk;
+	guint first, last;
+	guint word;
+
+	if (n >= model->priv->n_shown)
+		return FALSE;
+
+	/* Last chunk having less shown messages before it */
+	first = 0;
+	last = (model->priv->n_committed - 1) / MESSAGE_VIEW_MODEL_CHUNK_SIZE;
+	while (first < last)
+	{
+		guint middle = (first + last + 1) / 2;
+
+		chunk = g_ptr_array_index (model->priv->chunks, middle);
+		if (chunk->shown_before <= n)
+			first = middle;
+		else
+			last = middle - 1;
+	}
+
+	chunk = g_ptr_array_index (model->priv->chunks, first);
+	n -= chunk->shown_before;
+	for (word = 0; word < MESSAGE_VIEW_MODEL_CHUNK_WORDS; word++)
+	{
+		guint64 shown = message_view_model_chunk_get_shown (model, chunk, word);
+		guint count = message_view_model_bit_count (shown);
+
+		if (n < count)
+		{
+			for (; n > 0; n--)
+				shown &= shown - 1;
+			*found = first * MESSAGE_VIEW_MODEL_CHUNK_SIZE + word * 64 +
+				message_view_model_bit_count ((shown & -shown) - 1);
+			return TRUE;
+		}
+		n -= count;
+	}
+
+	return FALSE;
+}
+
+/* Position of a shown message in the model */
+static guint
+message_view_model_get_position (MessageViewModel *model, guint message)
+{
+	MessageViewModelChunk *chunk = message_view_model_get_chunk (model, message);
+	guint offset = message % MESSAGE_VIEW_MODEL_CHUNK_SIZE;
+	guint position = chunk->shown_before;
+	guint word;
+
+	for (word = 0; word < offset / 64; word++)
+	{
+		position += message_view_model_bit_count (
+			message_view_model_chunk_get_shown (model, chunk, word));
+	}
+	position += message_view_model_bit_count (
+		message_view_model_chunk_get_shown (model, chunk, word) &
+		((G_GUINT64_CONSTANT (1) << (offset % 64)) - 1));
+
+	return position;
+}
+
+/* Private functions
+ *---------------------------------------------------------------------------*/
+
+static gboolean
+message_view_model_commit (gpointer user_data)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (user_data);
+	MessageViewModelPriv *priv = model->priv;
+
+	priv->commit_idle = 0;
+
+	while (priv->n_committed < priv->n_messages)
+	{
+		MessageViewModelChunk *chunk;
+		guint message = priv->n_committed;
+		guint offset = message % MESSAGE_VIEW_MODEL_CHUNK_SIZE;
+		guint type;
+
+		chunk = message_view_model_get_chunk (model, message);
+		if (offset == 0)
+			chunk->shown_before = priv->n_shown;
+
+		type = message_view_model_type_index (chunk->messages[offset].type);
+		chunk->bits[type][offset / 64] |= G_GUINT64_CONSTANT (1) << (offset % 64);
+		chunk->counts[type]++;
+		priv->n_committed++;
+
+		if (message_view_model_is_shown (model, type))
+		{
+			GtkTreePath *path;
+			GtkTreeIter iter;
+
+			priv->n_shown++;
+			iter.stamp = priv->stamp;
+			iter.user_data = GUINT_TO_POINTER (message);
+			path = gtk_tree_path_new_from_indices (priv->n_shown - 1, -1);
+			gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+			gtk_tree_path_free (path);
+		}
+	}
+
+	return FALSE;
+}
+
+static void
+message_view_model_free_messages (MessageViewModel *model)
+{
+	MessageViewModelPriv *priv = model->priv;
+	guint message;
+
+	if (priv->commit_idle)
+	{
+		g_source_remove (priv->commit_idle);
+		priv->commit_idle = 0;
+	}
+
+	for (message = 0; message < priv->n_messages; message++)
+	{
+		MessageViewModelChunk *chunk = message_view_model_get_chunk (model, message);
+		Message *msg = &chunk->messages[message % MESSAGE_VIEW_MODEL_CHUNK_SIZE];
+
+		g_free (msg->summary);
+		g_free (msg->details);
+	}
+	g_ptr_array_set_size (priv->chunks, 0);
+
+	priv->n_messages = 0;
+	priv->n_committed = 0;
+	priv->n_shown = 0;
+	priv->stamp++;
+}
+
+/* GtkTreeModel implementation
+ *---------------------------------------------------------------------------*/
+
+static gboolean
+message_view_model_iter_is_valid (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (tree_model);
+
+	return (iter != NULL) && (iter->stamp == model->priv->stamp) &&
+		(GPOINTER_TO_UINT (iter->user_data) < model->priv->n_committed);
+}
+
+static GtkTreeModelFlags
+message_view_model_get_flags (GtkTreeModel *tree_model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY | GTK_TREE_MODEL_ITERS_PERSIST;
+}
+
+static gint
+message_view_model_get_n_columns (GtkTreeModel *tree_model)
+{
+	return N_COLUMNS;
+}
+
+static GType
+message_view_model_get_column_type (GtkTreeModel *tree_model, gint index)
+{
+	g_return_val_if_fail (index >= 0 && index < N_COLUMNS, G_TYPE_INVALID);
+
+	return index == COLUMN_MESSAGE ? G_TYPE_POINTER : G_TYPE_STRING;
+}
+
+static gboolean
+message_view_model_iter_nth_child (GtkTreeModel *tree_model,
+								   GtkTreeIter *iter,
+								   GtkTreeIter *parent,
+								   gint n)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (tree_model);
+	guint message;
+
+	if ((parent != NULL) || (n < 0) ||
+		!message_view_model_get_nth_shown (model, n, &message))
+		return FALSE;
+
+	iter->stamp = model->priv->stamp;
+	iter->user_data = GUINT_TO_POINTER (message);
+
+	return TRUE;
+}
+
+static gboolean
+message_view_model_get_iter (GtkTreeModel *tree_model,
+							 GtkTreeIter *iter,
+							 GtkTreePath *path)
+{
+	if (gtk_tree_path_get_depth (path) != 1)
+		return FALSE;
+
+	return message_view_model_iter_nth_child (tree_model, iter, NULL,
+											  gtk_tree_path_get_indices (path)[0]);
+}
+
+static GtkTreePath *
+message_view_model_get_path (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (tree_model);
+	guint position;
+
+	g_return_val_if_fail (message_view_model_iter_is_valid (tree_model, iter), NULL);
+
+	position = message_view_model_get_position (model,
+												GPOINTER_TO_UINT (iter->user_data));
+
+	return gtk_tree_path_new_from_indices (position, -1);
+}
+
+static void
+message_view_model_get_value (GtkTreeModel *tree_model,
+							  GtkTreeIter *iter,
+							  gint column,
+							  GValue *value)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (tree_model);
+	const Message *message;
+	guint type;
+
+	g_return_if_fail (message_view_model_iter_is_valid (tree_model, iter));
+	g_return_if_fail (column >= 0 && column < N_COLUMNS);
+
+	message = message_view_model_get_message (model,
+											  GPOINTER_TO_UINT (iter->user_data));
+	type = message_view_model_type_index (message->type);
+	g_value_init (value, message_view_model_get_column_type (tree_model, column));
+
+	switch (column)
+	{
+	case COLUMN_COLOR:
+		if (model->priv->highlite)
+			g_value_set_string (value, model->priv->colors[type]);
+		break;
+	case COLUMN_SUMMARY:
+	{
+		gchar *markup;
+
+		markup = g_markup_escape_text (message->summary != NULL ? message->summary : "", -1);
+		if (message->details && (*message->details != '\0'))
+		{
+			gchar *bold = g_strdup_printf ("<b>%s</b>", markup);
+			g_free (markup);
+			markup = bold;
+		}
+		g_value_take_string (value, markup);
+		break;
+	}
+	case COLUMN_MESSAGE:
+		g_value_set_pointer (value, (gpointer)message);
+		break;
+	case COLUMN_PIXBUF:
+		if (!model->priv->highlite)
+			break;
+		switch (message->type)
+		{
+		case IANJUTA_MESSAGE_VIEW_TYPE_INFO:
+			g_value_set_static_string (value, GTK_STOCK_INFO);
+			break;
+		case IANJUTA_MESSAGE_VIEW_TYPE_WARNING:
+			/* FIXME: There is no GTK_STOCK_WARNING which would fit better here */
+			g_value_set_static_string (value, GTK_STOCK_DIALOG_WARNING);
+			break;
+		case IANJUTA_MESSAGE_VIEW_TYPE_ERROR:
+			g_value_set_static_string (value, GTK_STOCK_STOP);
+			break;
+		default:
+			break;
+		}
+		break;
+	}
+}
+
+static gboolean
+message_view_model_iter_next (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (tree_model);
+	guint message;
+
+	g_return_val_if_fail (message_view_model_iter_is_valid (tree_model, iter), FALSE);
+
+	if (!message_view_model_find_shown (model,
+										GPOINTER_TO_UINT (iter->user_data) + 1,
+										&message))
+		return FALSE;
+
+	iter->user_data = GUINT_TO_POINTER (message);
+
+	return TRUE;
+}
+
+static gboolean
+message_view_model_iter_children (GtkTreeModel *tree_model,
+								  GtkTreeIter *iter,
+								  GtkTreeIter *parent)
+{
+	return message_view_model_iter_nth_child (tree_model, iter, parent, 0);
+}
+
+static gboolean
+message_view_model_iter_has_child (GtkTreeModel *tree_model,
+								   GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint
+message_view_model_iter_n_children (GtkTreeModel *tree_model,
+									GtkTreeIter *iter)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (tree_model);
+
+	return iter == NULL ? model->priv->n_shown : 0;
+}
+
+static gboolean
+message_view_model_iter_parent (GtkTreeModel *tree_model,
+								GtkTreeIter *iter,
+								GtkTreeIter *child)
+{
+	return FALSE;
+}
+
+static void
+message_view_model_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = message_view_model_get_flags;
+	iface->get_n_columns = message_view_model_get_n_columns;
+	iface->get_column_type = message_view_model_get_column_type;
+	iface->get_iter = message_view_model_get_iter;
+	iface->get_path = message_view_model_get_path;
+	iface->get_value = message_view_model_get_value;
+	iface->iter_next = message_view_model_iter_next;
+	iface->iter_children = message_view_model_iter_children;
+	iface->iter_has_child = message_view_model_iter_has_child;
+	iface->iter_n_children = message_view_model_iter_n_children;
+	iface->iter_nth_child = message_view_model_iter_nth_child;
+	iface->iter_parent = message_view_model_iter_parent;
+}
+
+/* GObject functions
+ *---------------------------------------------------------------------------*/
+
+static void
+message_view_model_finalize (GObject *object)
+{
+	MessageViewModel *model = MESSAGE_VIEW_MODEL (object);
+	guint type;
+
+	message_view_model_free_messages (model);
+	g_ptr_array_free (model->priv->chunks, TRUE);
+	for (type = 0; type < MESSAGE_VIEW_MODEL_N_TYPES; type++)
+		g_free (model->priv->colors[type]);
+
+	G_OBJECT_CLASS (message_view_model_parent_class)->finalize (object);
+}
+
+static void
+message_view_model_init (MessageViewModel *model)
+{
+	model->priv = G_TYPE_INSTANCE_GET_PRIVATE (model, MESSAGE_TYPE_VIEW_MODEL,
+											   MessageViewModelPriv);
+	model->priv->chunks = g_ptr_array_new_with_free_func (g_free);
+	model->priv->flags = MESSAGE_VIEW_MODEL_ALL_FLAGS;
+	model->priv->stamp = g_random_int ();
+}
+
+static void
+message_view_model_class_init (MessageViewModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	object_class->finalize = message_view_model_finalize;
+
+	g_type_class_add_private (klass, sizeof (MessageViewModelPriv));
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+MessageViewModel *
+message_view_model_new (void)
+{
+	return g_object_new (MESSAGE_TYPE_VIEW_MODEL, NULL);
+}
+
+void
+message_view_model_append (MessageViewModel *model,
+						   IAnjutaMessageViewType type,
+						   const gchar *summary,
+						   const gchar *details)
+{
+	MessageViewModelPriv *priv;
+	MessageViewModelChunk *chunk;
+	Message *message;
+
+	g_return_if_fail (MESSAGE_IS_VIEW_MODEL (model));
+
+	priv = model->priv;
+	if (priv->n_messages % MESSAGE_VIEW_MODEL_CHUNK_SIZE == 0)
+		g_ptr_array_add (priv->chunks, g_new0 (MessageViewModelChunk, 1));
+
+	chunk = message_view_model_get_chunk (model, priv->n_messages);
+	message = &chunk->messages[priv->n_messages % MESSAGE_VIEW_MODEL_CHUNK_SIZE];
+	message->type = type;
+	message->summary = g_strdup (summary);
+	message->details = g_strdup (details);
+	priv->n_messages++;
+
+	/* Run before the views are redrawn */
+	if (!priv->commit_idle)
+	{
+		priv->commit_idle = g_idle_add_full (G_PRIORITY_HIGH_IDLE + 10,
+											 message_view_model_commit,
+											 model, NULL);
+	}
+}
+
+/* Removing the rows one by one from the views takes as much time as adding
+ * them, this function does not emit any signal so the model has to be
+ * removed from its views before calling it. */
+void
+message_view_model_clear (MessageViewModel *model)
+{
+	g_return_if_fail (MESSAGE_IS_VIEW_MODEL (model));
+
+	message_view_model_free_messages (model);
+}
+
+/* Returns all messages, shown or not */
+guint
+message_view_model_get_n_messages (MessageViewModel *model)
+{
+	g_return_val_if_fail (MESSAGE_IS_VIEW_MODEL (model), 0);
+
+	return model->priv->n_messages;
+}
+
+const Message *
+message_view_model_get_message (MessageViewModel *model, guint n)
+{
+	MessageViewModelChunk *chunk;
+
+	g_return_val_if_fail (MESSAGE_IS_VIEW_MODEL (model), NULL);
+	g_return_val_if_fail (n < model->priv->n_messages, NULL);
+
+	chunk = message_view_model_get_chunk (model, n);
+
+	return &chunk->messages[n % MESSAGE_VIEW_MODEL_CHUNK_SIZE];
+}
+
+guint
+message_view_model_get_flags (MessageViewModel *model)
+{
+	g_return_val_if_fail (MESSAGE_IS_VIEW_MODEL (model), 0);
+
+	return model->priv->flags;
+}
+
+/* Show only the messages whose type bit is set in flags. As with
+ * message_view_model_clear() no signal is emitted, the model has to be
+ * removed from its views before calling it. */
+void
+message_view_model_set_flags (MessageViewModel *model, guint flags)
+{
+	MessageViewModelPriv *priv;
+	guint i;
+
+	g_return_if_fail (MESSAGE_IS_VIEW_MODEL (model));
+
+	priv = model->priv;
+	priv->flags = flags & MESSAGE_VIEW_MODEL_ALL_FLAGS;
+	priv->n_shown = 0;
+	for (i = 0; i * MESSAGE_VIEW_MODEL_CHUNK_SIZE < priv->n_committed; i++)
+	{
+		MessageViewModelChunk *chunk = g_ptr_array_index (priv->chunks, i);
+
+		chunk->shown_before = priv->n_shown;
+		priv->n_shown += message_view_model_chunk_count_shown (model, chunk);
+	}
+	priv->stamp++;
+}
+
+/* Colors and icons are used only if highlite is set */
+void
+message_view_model_set_highlite (MessageViewModel *model, gboolean highlite)
+{
+	g_return_if_fail (MESSAGE_IS_VIEW_MODEL (model));
+
+	model->priv->highlite = highlite;
+}
+
+void
+message_view_model_set_color (MessageViewModel *model,
+							  IAnjutaMessageViewType type,
+							  const gchar *color)
+{
+	guint index;
+
+	g_return_if_fail (MESSAGE_IS_VIEW_MODEL (model));
+
+	index = message_view_model_type_index (type);
+	g_free (model->priv->colors[index]);
+	model->priv->colors[index] = g_strdup (color);
+}
@@ -0,0 +1,94 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * message-view-model.h
+ * Copyright (C) Johannes Schmid 2012
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Library General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _MESSAGE_VIEW_MODEL_H_
+#define _MESSAGE_VIEW_MODEL_H_
+
+#include <glib-object.h>
+#include <gtk/gtk.h>
+#include <libanjuta/interfaces/ianjuta-message-view.h>
+
+G_BEGIN_DECLS
+
+#define MESSAGE_TYPE_VIEW_MODEL             (message_view_model_get_type ())
+#define MESSAGE_VIEW_MODEL(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), MESSAGE_TYPE_VIEW_MODEL, MessageViewModel))
+#define MESSAGE_VIEW_MODEL_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), MESSAGE_TYPE_VIEW_MODEL, MessageViewModelClass))
+#define MESSAGE_IS_VIEW_MODEL(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), MESSAGE_TYPE_VIEW_MODEL))
+#define MESSAGE_IS_VIEW_MODEL_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), MESSAGE_TYPE_VIEW_MODEL))
+
+typedef struct _MessageViewModel MessageViewModel;
+typedef struct _MessageViewModelClass MessageViewModelClass;
+typedef struct _MessageViewModelPriv MessageViewModelPriv;
+
+struct _MessageViewModel
+{
+	GObject parent;
+
+	/* private */
+	MessageViewModelPriv *priv;
+};
+
+struct _MessageViewModelClass
+{
+	GObjectClass parent_class;
+};
+
+typedef struct
+{
+	IAnjutaMessageViewType type;
+	gchar *summary;
+	gchar *details;
+} Message;
+
+/* The message column holds a pointer to the Message kept in the model, it
+ * stays valid until the model is cleared. */
+enum
+{
+	COLUMN_COLOR = 0,
+	COLUMN_SUMMARY,
+	COLUMN_MESSAGE,
+	COLUMN_PIXBUF,
+	N_COLUMNS
+};
+
+GType message_view_model_get_type (void);
+MessageViewModel *message_view_model_new (void);
+
+void message_view_model_append (MessageViewModel *model,
+								IAnjutaMessageViewType type,
+								const gchar *summary,
+								const gchar *details);
+void message_view_model_clear (MessageViewModel *model);
+
+guint message_view_model_get_n_messages (MessageViewModel *model);
+const Message *message_view_model_get_message (MessageViewModel *model,
+											   guint n);
+
+guint message_view_model_get_flags (MessageViewModel *model);
+void message_view_model_set_flags (MessageViewModel *model, guint flags);
+void message_view_model_set_highlite (MessageViewModel *model,
+									  gboolean highlite);
+void message_view_model_set_color (MessageViewModel *model,
+								   IAnjutaMessageViewType type,
+								   const gchar *color);
+
+G_END_DECLS
+
+#endif /* _MESSAGE_VIEW_MODEL_H_ */
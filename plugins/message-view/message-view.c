@@ -21,7 +21,7 @@
 #include <libanjuta/interfaces/ianjuta-message-view.h>
 
 #include "message-view.h"
-#define MESSAGE_TYPE message_get_type()
+#include "message-view-model.h"
 
 #define PREFERENCES_SCHEMA "org.gnome.anjuta.plugins.message-manager"
 #define COLOR_ERROR "color-error"
@@ -34,14 +34,12 @@ struct _MessageViewPrivate
 
 	GtkWidget *tree_view;
 	GtkTreeModel *model;
-	GtkTreeModel *filter;
 
 	GtkWidget *popup_menu;
 
 	gint adj_chgd_hdlr;
 
 	/* Messages filter */
-	MessageViewFlags flags;
 	gint normal_count;
 	gint warn_count;
 	gint error_count;
@@ -55,23 +53,6 @@ struct _MessageViewPrivate
 	GSettings* settings;
 };
 
-typedef struct
-{
-	IAnjutaMessageViewType type;
-	gchar *summary;
-	gchar *details;
-
-} Message;
-
-enum
-{
-	COLUMN_COLOR = 0,
-	COLUMN_SUMMARY,
-	COLUMN_MESSAGE,
-	COLUMN_PIXBUF,
-	N_COLUMNS
-};
-
 enum
 {
 	MV_PROP_ID = 0,
@@ -85,12 +66,7 @@ static gpointer parent_class;
 static void prefs_init (MessageView *mview);
 static void prefs_finalize (MessageView *mview);
 
-static gboolean
-message_view_tree_view_filter (GtkTreeModel *model,
-							   GtkTreeIter  *iter,
-							   gpointer      data);
-
-/* Message object creation, copy and freeing */
+/* Message object creation and freeing */
 static Message*
 message_new (IAnjutaMessageViewType type, const gchar *summary,
 			 const gchar *details)
@@ -105,12 +81,6 @@ message_new (IAnjutaMessageViewType type, const gchar *summary,
 	return message;
 }
 
-static Message*
-message_copy (const Message *src)
-{
-	return message_new (src->type, src->summary, src->details);
-}
-
 static void
 message_free (Message *message)
 {
@@ -121,7 +91,7 @@ message_free (Message *message)
 }
 
 static gboolean
-message_serialize (Message *message, AnjutaSerializer *serializer)
+message_serialize (const Message *message, AnjutaSerializer *serializer)
 {
 	if (!anjuta_serializer_write_int (serializer, "type",
 									  message->type))
@@ -152,19 +122,6 @@ message_deserialize (Message *message, AnjutaSerializer *serializer)
 	return TRUE;
 }
 
-static GType
-message_get_type (void)
-{
-	static GType type = 0;
-	if (!type)
-	{
-		type = g_boxed_type_register_static ("MessageViewMessage",
-											 (GBoxedCopyFunc) message_copy,
-											 (GBoxedFreeFunc) message_free);
-	}
-	return type;
-}
-
 /* Utility functions */
 /* Adds the char c to the string str */
 static void
@@ -361,6 +318,8 @@ message_view_set_property (GObject * object,
 	case MV_PROP_HIGHLITE:
 	{
 		self->privat->highlite = g_value_get_boolean (value);
+		message_view_model_set_highlite (MESSAGE_VIEW_MODEL (self->privat->model),
+										 self->privat->highlite);
 		break;
 	}
 	default:
@@ -425,6 +384,7 @@ message_view_finalize (GObject *obj)
 	g_free (mview->privat->line_buffer);
 	g_free (mview->privat->label);
 	g_free (mview->privat->pixmap);
+	g_object_unref (mview->privat->model);
 	g_free (mview->privat);
 	G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -438,7 +398,6 @@ message_view_instance_init (MessageView * self)
 	GtkTreeViewColumn *column;
 	GtkTreeViewColumn *column_pixbuf;
 	GtkTreeSelection *select;
-	GtkListStore *model;
 	GtkAdjustment* adj;
 
 	g_return_if_fail(self != NULL);
@@ -446,21 +405,12 @@ message_view_instance_init (MessageView * self)
 
 	/* Init private data */
 	self->privat->line_buffer = g_strdup("");
-	self->privat->flags = 0xF;
-
-	/* Create the tree widget */
-	model = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING,
-								G_TYPE_STRING, MESSAGE_TYPE,  G_TYPE_STRING);
-	self->privat->model = GTK_TREE_MODEL (model);
 
-	/* message filter */
-	self->privat->filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (model), NULL);
-	gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (self->privat->filter),
-											message_view_tree_view_filter,
-											self, NULL);
+	/* Create the tree widget, the model does the filtering itself */
+	self->privat->model = GTK_TREE_MODEL (message_view_model_new ());
 
 	self->privat->tree_view =
-		gtk_tree_view_new_with_model (GTK_TREE_MODEL (self->privat->filter));
+		gtk_tree_view_new_with_model (self->privat->model);
 	gtk_widget_show (self->privat->tree_view);
 	gtk_tree_view_set_headers_visible (GTK_TREE_VIEW
 									   (self->privat->tree_view), FALSE);
@@ -582,8 +532,8 @@ message_view_new (GtkWidget* popup_menu)
 gboolean
 message_view_serialize (MessageView *view, AnjutaSerializer *serializer)
 {
-	GtkTreeModel *model;
-	GtkTreeIter iter;
+	MessageViewModel *model;
+	guint n_messages, i;
 
 	g_return_val_if_fail (view != NULL && MESSAGE_IS_VIEW (view), FALSE);
 
@@ -597,26 +547,18 @@ message_view_serialize (MessageView *view, AnjutaSerializer *serializer)
 									  view->privat->highlite))
 		return FALSE;
 
-	/* Serialize individual messages */
-	model = view->privat->model;
+	/* Serialize individual messages, including the filtered out ones */
+	model = MESSAGE_VIEW_MODEL (view->privat->model);
+	n_messages = message_view_model_get_n_messages (model);
 
-	if (!anjuta_serializer_write_int (serializer, "messages",
-									  gtk_tree_model_iter_n_children (model, NULL)))
+	if (!anjuta_serializer_write_int (serializer, "messages", n_messages))
 		return FALSE;
 
-	if (gtk_tree_model_get_iter_first (model, &iter))
+	for (i = 0; i < n_messages; i++)
 	{
-		do
-		{
-			Message *message;
-			gtk_tree_model_get (model, &iter, COLUMN_MESSAGE, &message, -1);
-			if (message)
-			{
-				if (!message_serialize (message, serializer))
-					return FALSE;
-			}
-		}
-		while (gtk_tree_model_iter_next (model, &iter));
+		if (!message_serialize (message_view_model_get_message (model, i),
+								serializer))
+			return FALSE;
 	}
 	return TRUE;
 }
@@ -624,7 +566,6 @@ message_view_serialize (MessageView *view, AnjutaSerializer *serializer)
 gboolean
 message_view_deserialize (MessageView *view, AnjutaSerializer *serializer)
 {
-	GtkTreeModel *model;
 	gint messages, i;
 
 	g_return_val_if_fail (view != NULL && MESSAGE_IS_VIEW (view), FALSE);
@@ -640,8 +581,7 @@ message_view_deserialize (MessageView *view, AnjutaSerializer *serializer)
 		return FALSE;
 
 	/* Create individual messages */
-	model = view->privat->model;
-	gtk_list_store_clear (GTK_LIST_STORE (model));
+	ianjuta_message_view_clear (IANJUTA_MESSAGE_VIEW (view), NULL);
 
 	if (!anjuta_serializer_read_int (serializer, "messages", &messages))
 		return FALSE;
@@ -763,36 +703,33 @@ void message_view_previous(MessageView* view)
 
 void message_view_copy_all(MessageView* view)
 {
-	GtkTreeIter iter;
-	GtkTreeModel *model;
+	MessageViewModel *model;
 	GString *messages;
+	guint n_messages, i;
 
 	g_return_if_fail (view != NULL && MESSAGE_IS_VIEW (view));
 
 	/* Copy all lines of message view */
-	model = view->privat->model;
+	model = MESSAGE_VIEW_MODEL (view->privat->model);
+	n_messages = message_view_model_get_n_messages (model);
 
 	messages = g_string_new (NULL);
-	gtk_tree_model_get_iter_first (model, &iter);
-	do
+	for (i = 0; i < n_messages; i++)
 	{
-		Message *message;
+		const Message *message;
 
-		gtk_tree_model_get (model, &iter, COLUMN_MESSAGE, &message, -1);
-		if (message)
+		message = message_view_model_get_message (model, i);
+		if (message->details && (strlen (message->details) > 0))
 		{
-			if (message->details && (strlen (message->details) > 0))
-			{
-				g_string_append (messages, message->details);
-				g_string_append_c (messages, '\n');
-			}
-			else
-			{
-				g_string_append (messages, message->summary);
-				g_string_append_c (messages, '\n');
-			}
+			g_string_append (messages, message->details);
+			g_string_append_c (messages, '\n');
+		}
+		else
+		{
+			g_string_append (messages, message->summary);
+			g_string_append_c (messages, '\n');
 		}
-	} while (gtk_tree_model_iter_next (model, &iter));
+	}
 	
 	if (messages->len != 0)
 	{
@@ -852,25 +789,15 @@ pref_change_color (MessageView *mview, IAnjutaMessageViewType type,
 				   const gchar *color_pref_key)
 {
 	gchar* color;
-	GtkListStore *store;
-	GtkTreeIter iter;
-	gboolean success;
 
+	/* Colors are read by the model when a row is drawn */
 	color = g_settings_get_string (mview->privat->settings, color_pref_key);
-	store = GTK_LIST_STORE (mview->privat->model);
-	success = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
-	while (success)
-	{
-		Message *message;
-		gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, COLUMN_MESSAGE,
-							&message, -1);
-		if (message && message->type == type)
-		{
-			gtk_list_store_set (store, &iter, COLUMN_COLOR, color, -1);
-		}
-		success = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
-	}
+	message_view_model_set_color (MESSAGE_VIEW_MODEL (mview->privat->model),
+								  type, color);
 	g_free(color);
+
+	if (mview->privat->tree_view)
+		gtk_widget_queue_draw (mview->privat->tree_view);
 }
 
 
@@ -896,6 +823,8 @@ prefs_init (MessageView *mview)
 	                  G_CALLBACK (on_notify_color), mview);
 	g_signal_connect (mview->privat->settings, "changed::" COLOR_WARNING,
 	                  G_CALLBACK (on_notify_color), mview);
+	pref_change_color (mview, IANJUTA_MESSAGE_VIEW_TYPE_ERROR, COLOR_ERROR);
+	pref_change_color (mview, IANJUTA_MESSAGE_VIEW_TYPE_WARNING, COLOR_WARNING);
 }
 
 static void
@@ -953,94 +882,40 @@ imessage_view_append (IAnjutaMessageView *message_view,
 					  const gchar *details,
 					  GError ** e)
 {
-	gchar* color;
-	GtkListStore *store;
-	GtkTreeIter iter;
-	gboolean highlite;
-	gchar *utf8_msg;
-	gchar *escaped_str;
-	gchar* stock_id = NULL;
-
 	MessageView *view;
-	Message *message;
 
 	g_return_if_fail (MESSAGE_IS_VIEW (message_view));
 
 	view = MESSAGE_VIEW (message_view);
 
-	message = message_new (type, summary, details);
-
-	g_object_get (G_OBJECT (view), "highlite", &highlite, NULL);
-	color = NULL;
-	if (highlite)
+	if (view->privat->highlite)
 	{
-		switch (message->type)
+		switch (type)
 		{
 			case IANJUTA_MESSAGE_VIEW_TYPE_INFO:
 				view->privat->info_count++;
-				stock_id = GTK_STOCK_INFO;
 				break;
 			case IANJUTA_MESSAGE_VIEW_TYPE_WARNING:
-				color = g_settings_get_string (view->privat->settings, COLOR_WARNING);
-				/* FIXME: There is no GTK_STOCK_WARNING which would fit better here */
 				view->privat->warn_count++;
-				stock_id = GTK_STOCK_DIALOG_WARNING;
 				break;
 			case IANJUTA_MESSAGE_VIEW_TYPE_ERROR:
-				color = g_settings_get_string (view->privat->settings, COLOR_ERROR);
 				view->privat->error_count++;
-				stock_id = GTK_STOCK_STOP;
 				break;
 			default:
-				color = NULL;
 				view->privat->normal_count++;
 		}
 	}
 
-	/* Add the message to the tree */
-	store = GTK_LIST_STORE (view->privat->model);
-	gtk_list_store_append (store, &iter);
-
-	/*
-	 * Must be normalized to compose representation to be
-	 * displayed correctly (Bug in gtk_list???)
-	 */
-	utf8_msg = g_utf8_normalize (message->summary, -1,
-								 G_NORMALIZE_DEFAULT_COMPOSE);
-	if (message->details && strlen (message->details) > 0)
-	{
-		gchar *summary;
-		summary = escape_string (message->summary);
-		escaped_str = g_strdup_printf ("<b>%s</b>", summary);
-		g_free (summary);
-	} else {
-		escaped_str = escape_string (message->summary);
-	}
-	gtk_list_store_set (store, &iter,
-							COLUMN_SUMMARY, escaped_str,
-							COLUMN_MESSAGE, message,
-							-1);
-	if (color)
-	{
-		gtk_list_store_set (store, &iter,
-							COLUMN_COLOR, color, -1);
-	}
-	if (stock_id)
-	{
-		gtk_list_store_set (store, &iter,
-							COLUMN_PIXBUF, stock_id, -1);
-	}
-	g_free(color);
-	message_free (message);
-	g_free (utf8_msg);
-	g_free (escaped_str);
+	/* Add the message to the tree, the markup, color and icon are computed
+	 * by the model only for the displayed rows */
+	message_view_model_append (MESSAGE_VIEW_MODEL (view->privat->model),
+							   type, summary, details);
 }
 
 /* Clear all messages from the message view */
 static void
 imessage_view_clear (IAnjutaMessageView *message_view, GError **e)
 {
-	GtkListStore *store;
 	MessageView *view;
 
 	g_return_if_fail (MESSAGE_IS_VIEW (message_view));
@@ -1052,8 +927,11 @@ imessage_view_clear (IAnjutaMessageView *message_view, GError **e)
 	view->privat->warn_count = 0;
 	view->privat->error_count = 0;
 
-	store = GTK_LIST_STORE (view->privat->model);
-	gtk_list_store_clear (store);
+	/* Detach the model, so the rows are not removed one by one */
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view->privat->tree_view), NULL);
+	message_view_model_clear (MESSAGE_VIEW_MODEL (view->privat->model));
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view->privat->tree_view),
+							 view->privat->model);
 }
 
 /* Move the selection to the next line. */
@@ -1133,25 +1011,20 @@ imessage_view_get_all_messages (IAnjutaMessageView * message_view,
 								GError ** e)
 {
 	MessageView *view;
-	GtkListStore *store;
-	GtkTreeIter iter;
-	Message *message;
+	MessageViewModel *model;
+	guint i;
 	GList *messages = NULL;
 
 	g_return_val_if_fail (MESSAGE_IS_VIEW (message_view), NULL);
 
 	view = MESSAGE_VIEW (message_view);
-	store = GTK_LIST_STORE (view->privat->model);
+	model = MESSAGE_VIEW_MODEL (view->privat->model);
 
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter))
+	for (i = 0; i < message_view_model_get_n_messages (model); i++)
 	{
-		do
-		{
-			gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-							    COLUMN_MESSAGE, &message);
-			messages = g_list_prepend (messages, message->details);
-		}
-		while (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter));
+		const Message *message = message_view_model_get_message (model, i);
+
+		messages = g_list_prepend (messages, message->details);
 	}
 	return messages;
 }
@@ -1168,43 +1041,24 @@ imessage_view_iface_init (IAnjutaMessageViewIface *iface)
 	iface->get_all_messages = imessage_view_get_all_messages;
 }
 
-static gboolean
-message_view_tree_view_filter (GtkTreeModel *model, GtkTreeIter  *iter,
-							   gpointer      data)
-{
-	Message *msg;
-	MessageView *msgview;
-
-	msgview = MESSAGE_VIEW (data);
-	gtk_tree_model_get (msgview->privat->model, iter, COLUMN_MESSAGE, &msg, -1);
-
-	if (msg != NULL) {
-		if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_NORMAL) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_NORMAL;
-		} else if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_INFO) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_INFO;
-		} else if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_WARNING) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_WARNING;
-		} else if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_ERROR) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_ERROR;
-		} else return TRUE;
-	} else return FALSE;
-}
-
 MessageViewFlags
 message_view_get_flags (MessageView* view)
 {
 	g_return_val_if_fail (view != NULL && MESSAGE_IS_VIEW (view), MESSAGE_VIEW_SHOW_NORMAL);
 
-	return view->privat->flags;
+	return message_view_model_get_flags (MESSAGE_VIEW_MODEL (view->privat->model));
 }
 
 void message_view_set_flags (MessageView* view, MessageViewFlags flags)
 {
 	g_return_if_fail (view != NULL && MESSAGE_IS_VIEW (view));
 
-	view->privat->flags = flags;
-	gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER(view->privat->filter));
+	/* The shown rows are recomputed by the model, detach it to avoid
+	 * signaling every row which appears or disappears */
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view->privat->tree_view), NULL);
+	message_view_model_set_flags (MESSAGE_VIEW_MODEL (view->privat->model), flags);
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view->privat->tree_view),
+							 view->privat->model);
 }
 
 gint message_view_get_count (MessageView* view, MessageViewFlags flags)
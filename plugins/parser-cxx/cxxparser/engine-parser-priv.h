@@ -22,6 +22,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 
 
 #ifdef __cplusplus
@@ -31,10 +32,38 @@ extern "C" {
 #endif
 
 #include "expression-result.h"
+#include "variable-result.h"
 #include "cpp-flex-tokenizer.h"
 
 using namespace std;
 
+/**
+ * State of optimizeScope () at the start of a line of the buffer. 
+ * Checkpoints are taken only at lines where the tokenizer is out of comments
+ * and preprocessor directives, so that scanning can resume from there.
+ */
+struct ScopeCheckpoint
+{
+	size_t offset;
+	vector<string> scope_stack;
+	string curr_scope;
+};
+
+/**
+ * Scope model of a buffer, kept between completion requests. When the text
+ * above the caret changes only the part after the first modified line is 
+ * scanned again.
+ */
+struct BufferScope
+{
+	string text;							/* above_text of the last request */
+	vector<ScopeCheckpoint> checkpoints;
+	string optimized_scope;					/* optimizeScope () of text */
+	VariableList variables;					/* local variables of optimized_scope */
+	string signature;						/* enclosing function signature */
+	VariableList signature_variables;
+};
+
 
 class EngineParser
 {
@@ -72,6 +101,15 @@ public:
     				  							const string& above_text,
     				  							const string& full_file_path, 
     				  							unsigned long linenum);
+
+	/* drops the scope model of a buffer */
+	void releaseBuffer (const string& full_file_path);
+
+	/* forgets the resolved members, the symbols they point to may be gone */
+	void clearMemberCache ();
+
+	/* forgets the resolved members going through symbol_id */
+	void forgetSymbol (int symbol_id);
 	
 protected:
 
@@ -99,6 +137,37 @@ private:
 	 */	
 	bool nextMainToken (string &out_token, string &out_delimiter);
 
+	/**
+	 * Return the cached scope model of full_file_path, updated to above_text.
+	 * The local variables are parsed again only if the optimized scope 
+	 * changed.
+	 */
+	BufferScope& getBufferScope (const string& full_file_path, 
+	                             const string& above_text);
+
+	/**
+	 * Resolve the container of member 'name' of scope, following the type of
+	 * a variable or the return type of a function. 
+	 * @return A new iterator or NULL. scope is left untouched.
+	 */
+	IAnjutaIterable * resolveMember (IAnjutaIterable *scope, const string& name,
+	                                 string &type_scope, vector<int> &symbols);
+
+	/* (scope id, member name) */
+	typedef pair<int, string> MemberKey;
+
+	/* a resolved member and the ids of the symbols it depends on */
+	struct MemberEntry
+	{
+		int container_id;
+		vector<int> symbols;
+	};
+
+	void addMember (int scope_id, const string& name, int container_id,
+	                const vector<int>& symbols);
+
+	void removeMember (const MemberKey& key);
+
 	/**
 	 * Trim a string using some default chars.
 	 * The code is expected to run quite performantly, as STL doesn't provide
@@ -112,8 +181,17 @@ private:
 	 * variables and the functions names. 
 	 * You can use this method to retrieve the type of a local variable, if it's
 	 * present in the passed buffer of course.
+	 * The scan resumes from the last checkpoint of buffer still valid for 
+	 * srcString and records new ones.
+	 */
+	string optimizeScope(const string& srcString, BufferScope &buffer);
+
+	/**
+	 * Scan srcString for optimizeScope (), starting from the given state. The
+	 * text must begin at a line start out of comments and directives.
 	 */
-	string optimizeScope(const string& srcString);
+	void scanScope (const string& srcString, vector<string> &scope_stack,
+	                string &currScope);
 	
 	/*
 	 * D A T A
@@ -127,6 +205,24 @@ private:
 	IAnjutaSymbolQuery *_query_search;
 	IAnjutaSymbolQuery *_query_search_in_scope;
 	IAnjutaSymbolQuery *_query_parent_scope;
+	IAnjutaSymbolQuery *_query_search_id;
+	IAnjutaSymbolQuery *_query_member_chain;
+
+	IAnjutaSymbolManager *_manager;
+
+	/* (scope id, member name) -> the resolved container */
+	map<MemberKey, MemberEntry> _member_cache;
+
+	/* symbol id -> the resolved members depending on it */
+	multimap<int, MemberKey> _member_cache_users;
+
+	/* (scope id, members joined by '.') -> id of the container reached by a
+	 * chain resolved in one query. The symbols in between are not known, so
+	 * these are dropped whenever a symbol changes */
+	map<MemberKey, int> _chain_cache;
+
+	/* file path -> scope model */
+	map<string, BufferScope> _buffer_scopes;
 };
 
 
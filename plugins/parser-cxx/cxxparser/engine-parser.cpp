@@ -19,6 +19,7 @@
  */
 
 #include <libanjuta/anjuta-debug.h>
+#include <string.h>
 #include <string>
 #include <vector>
 #include <libanjuta/interfaces/ianjuta-symbol-query.h>
@@ -32,7 +33,15 @@
 #include "variable-parser.h"
 #include "function-parser.h"
 
+/* lines of text between two checkpoints of a buffer scope */
+#define SCOPE_CHECKPOINT_LINES		64
 
+/* buffers whose scope model is kept */
+#define BUFFER_SCOPES_MAX			8
+
+/* longest member chain resolved in a single query, must not exceed the
+ * limit of the symbol query */
+#define MEMBER_CHAIN_MAX			8
 
 using namespace std;
 
@@ -52,6 +61,10 @@ EngineParser::EngineParser ()
 {	
 	_main_tokenizer = new CppTokenizer ();	
 	_extra_tokenizer = new CppTokenizer ();	
+
+	_query_search_id = NULL;
+	_query_member_chain = NULL;
+	_manager = NULL;
 }
 
 EngineParser::~EngineParser ()
@@ -116,9 +129,109 @@ EngineParser::parseExpression(const string &in)
 	return parse_expression (in.c_str ());	
 }
 
+static void
+on_symbol_scan_end (IAnjutaSymbolManager *manager, gint process_id,
+                    gpointer user_data)
+{
+	EngineParser::getInstance ()->clearMemberCache ();
+}
+
+static void
+on_symbol_changed (IAnjutaSymbolManager *manager, gint symbol_id,
+                   gpointer user_data)
+{
+	if (symbol_id < 0)
+		EngineParser::getInstance ()->clearMemberCache ();
+	else
+		EngineParser::getInstance ()->forgetSymbol (symbol_id);
+}
+
+void
+EngineParser::clearMemberCache ()
+{
+	_member_cache.clear ();
+	_member_cache_users.clear ();
+	_chain_cache.clear ();
+}
+
+void
+EngineParser::addMember (int scope_id, const string& name, int container_id,
+                         const vector<int>& symbols)
+{
+	MemberKey key = make_pair (scope_id, name);
+
+	removeMember (key);
+
+	MemberEntry &entry = _member_cache[key];
+
+	entry.container_id = container_id;
+	entry.symbols = symbols;
+	entry.symbols.push_back (scope_id);
+	entry.symbols.push_back (container_id);
+
+	for (size_t i = 0; i < entry.symbols.size (); i++)
+		_member_cache_users.insert (make_pair (entry.symbols[i], key));
+}
+
+void
+EngineParser::removeMember (const MemberKey& key)
+{
+	map<MemberKey, MemberEntry>::iterator entry = _member_cache.find (key);
+
+	if (entry == _member_cache.end ())
+		return;
+
+	for (size_t i = 0; i < entry->second.symbols.size (); i++)
+	{
+		pair<multimap<int, MemberKey>::iterator, multimap<int, MemberKey>::iterator> users =
+			_member_cache_users.equal_range (entry->second.symbols[i]);
+
+		for (multimap<int, MemberKey>::iterator user = users.first; 
+		     user != users.second; ++user)
+		{
+			if (user->second == key)
+			{
+				_member_cache_users.erase (user);
+				break;
+			}
+		}
+	}
+	_member_cache.erase (entry);
+}
+
+void
+EngineParser::forgetSymbol (int symbol_id)
+{
+	pair<multimap<int, MemberKey>::iterator, multimap<int, MemberKey>::iterator> users =
+		_member_cache_users.equal_range (symbol_id);
+	vector<MemberKey> keys;
+
+	for (multimap<int, MemberKey>::iterator user = users.first; 
+	     user != users.second; ++user)
+		keys.push_back (user->second);
+
+	for (size_t i = 0; i < keys.size (); i++)
+		removeMember (keys[i]);
+
+	/* the members a chain goes through are not known */
+	_chain_cache.clear ();
+}
+
 void
 EngineParser::unsetSymbolManager ()
 {
+	if (_manager)
+	{
+		g_signal_handlers_disconnect_by_func (_manager,
+		                                      (gpointer)on_symbol_scan_end,
+		                                      NULL);
+		g_signal_handlers_disconnect_by_func (_manager,
+		                                      (gpointer)on_symbol_changed,
+		                                      NULL);
+	}
+	_manager = NULL;
+	clearMemberCache ();
+
 	if (_query_scope)
 		g_object_unref (_query_scope);
 	_query_scope = NULL;
@@ -134,6 +247,14 @@ EngineParser::unsetSymbolManager ()
 	if (_query_parent_scope)
 		g_object_unref (_query_parent_scope);
 	_query_parent_scope = NULL;
+
+	if (_query_search_id)
+		g_object_unref (_query_search_id);
+	_query_search_id = NULL;
+
+	if (_query_member_chain)
+		g_object_unref (_query_member_chain);
+	_query_member_chain = NULL;
 }
 
 void 
@@ -192,6 +313,27 @@ EngineParser::setSymbolManager (IAnjutaSymbolManager *manager)
 	ianjuta_symbol_query_set_fields (_query_parent_scope,
 	                                 G_N_ELEMENTS (query_parent_scope_fields),
 	                                 query_parent_scope_fields, NULL);
+	_query_search_id =
+		ianjuta_symbol_manager_create_query (manager,
+		                                     IANJUTA_SYMBOL_QUERY_SEARCH_ID,
+		                                     IANJUTA_SYMBOL_QUERY_DB_PROJECT, NULL);
+	ianjuta_symbol_query_set_fields (_query_search_id,
+	                                 G_N_ELEMENTS (query_search_fields),
+	                                 query_search_fields, NULL);
+	_query_member_chain =
+		ianjuta_symbol_manager_create_query (manager,
+		                                     IANJUTA_SYMBOL_QUERY_SEARCH_MEMBER_CHAIN,
+		                                     IANJUTA_SYMBOL_QUERY_DB_PROJECT, NULL);
+	ianjuta_symbol_query_set_fields (_query_member_chain,
+	                                 G_N_ELEMENTS (query_search_fields),
+	                                 query_search_fields, NULL);
+
+	/* Resolved members are valid until the symbols they go through change */
+	_manager = manager;
+	g_signal_connect (manager, "prj-symbol-changed",
+	                  G_CALLBACK (on_symbol_changed), NULL);
+	g_signal_connect (manager, "sys-scan-end",
+	                  G_CALLBACK (on_symbol_scan_end), NULL);
 }
 
 void 
@@ -351,18 +493,16 @@ EngineParser::getTypeNameAndScopeByToken (ExpressionResult &result,
 		 */			
 		DEBUG_PRINT ("*** Found an identifier or local variable...");
 
-		/* optimize scope'll clear the scopes leaving the local variables */
-		string optimized_scope = optimizeScope(above_text);
-
-		VariableList li;
-		std::map<std::string, std::string> ignoreTokens;
-		get_variables(optimized_scope, li, ignoreTokens, false);
+		/* optimize scope'll clear the scopes leaving the local variables. The
+		 * buffer scope keeps them between the requests */
+		BufferScope &buffer = getBufferScope (full_file_path, above_text);
 
 		/* here the trick is to start from the end of the found variables
 		 * up to the begin. This because the local variable declaration should be found
 		 * just above to the statement line 
 		 */
-		for (VariableList::reverse_iterator iter = li.rbegin(); iter != li.rend(); iter++) 
+		for (VariableList::reverse_iterator iter = buffer.variables.rbegin(); 
+		     iter != buffer.variables.rend(); iter++) 
 		{
 			Variable var = (*iter);
 		
@@ -398,9 +538,18 @@ EngineParser::getTypeNameAndScopeByToken (ExpressionResult &result,
 			
 			DEBUG_PRINT ("Signature is %s", signature);
 
-			get_variables(signature, li, ignoreTokens, false);
+			if (buffer.signature != signature)
+			{
+				std::map<std::string, std::string> ignoreTokens;
+
+				buffer.signature = signature;
+				buffer.signature_variables.clear ();
+				get_variables (buffer.signature, buffer.signature_variables, 
+				               ignoreTokens, false);
+			}
 			
-			for (VariableList::reverse_iterator iter = li.rbegin(); iter != li.rend(); iter++) 
+			for (VariableList::reverse_iterator iter = buffer.signature_variables.rbegin(); 
+			     iter != buffer.signature_variables.rend(); iter++) 
 			{
 				Variable var = (*iter);
 			
@@ -536,6 +685,92 @@ EngineParser::switchMemberToContainer (IAnjutaIterable * test)
 	return test;
 }
 
+IAnjutaIterable *
+EngineParser::resolveMember (IAnjutaIterable *scope, const string& name,
+                             string &type_scope, vector<int> &symbols)
+{
+	IAnjutaSymbol *node;
+	IAnjutaIterable * iter;
+	gchar *sym_kind;
+
+	node = IANJUTA_SYMBOL (scope);
+	
+	/* check if the name of the result is valuable or not */
+	iter = ianjuta_symbol_query_search_in_scope (_query_search_in_scope,
+	                                             name.c_str (),
+	                                             node, NULL);
+	
+	if (iter == NULL)
+	{
+		DEBUG_PRINT ("Warning, the result.m_name %s "
+			"does not belong to scope (id %d)", name.c_str (), 
+		             ianjuta_symbol_get_int (node, IANJUTA_SYMBOL_FIELD_ID, NULL));
+		return NULL;
+	}
+
+	DEBUG_PRINT ("Good element %s", name.c_str ());
+	
+	node = IANJUTA_SYMBOL (iter);
+	symbols.push_back (ianjuta_symbol_get_int (node, IANJUTA_SYMBOL_FIELD_ID, NULL));
+	sym_kind = (gchar*)ianjuta_symbol_get_string (node, 
+	   										IANJUTA_SYMBOL_FIELD_KIND, NULL);
+	
+	DEBUG_PRINT (".. it has sym_kind \"%s\"", sym_kind);
+
+	/* the same check as in the engine-core on sdb_engine_add_new_sym_type () */
+	if (g_strcmp0 (sym_kind, "member") == 0 || 
+	    g_strcmp0 (sym_kind, "variable") == 0 || 
+	    g_strcmp0 (sym_kind, "field") == 0)
+	{
+		iter = switchMemberToContainer (iter);
+		node = IANJUTA_SYMBOL (iter);
+		symbols.push_back (ianjuta_symbol_get_int (node, IANJUTA_SYMBOL_FIELD_ID, NULL));
+		sym_kind = (gchar*)ianjuta_symbol_get_string (node, 
+	   										IANJUTA_SYMBOL_FIELD_KIND, NULL);				
+	}
+	
+	/* check for any typedef */
+	if (g_strcmp0 (ianjuta_symbol_get_string (node, 
+	   										IANJUTA_SYMBOL_FIELD_KIND, NULL),
+	   										"typedef") == 0)
+	{			
+		iter = switchTypedefToStruct (iter);
+		node = IANJUTA_SYMBOL (iter);
+		symbols.push_back (ianjuta_symbol_get_int (node, IANJUTA_SYMBOL_FIELD_ID, NULL));
+		sym_kind = (gchar*)ianjuta_symbol_get_string (node, 
+	   										IANJUTA_SYMBOL_FIELD_KIND, NULL);				
+	}
+	
+	/* is it a function or a method? */
+	if (g_strcmp0 (sym_kind, "function") == 0 ||
+	    g_strcmp0 (sym_kind, "method") == 0 ||
+	    g_strcmp0 (sym_kind, "prototype") == 0)
+	{
+
+		string func_ret_type_name = 
+			ianjuta_symbol_get_string (node, IANJUTA_SYMBOL_FIELD_RETURNTYPE, NULL);
+
+		string func_signature = 
+			ianjuta_symbol_get_string (node, IANJUTA_SYMBOL_FIELD_SIGNATURE, NULL);
+		
+		func_ret_type_name += " " + name + func_signature + "{}";
+
+		FunctionList li;
+		std::map<std::string, std::string> ignoreTokens;
+		get_functions (func_ret_type_name, li, ignoreTokens);
+
+		g_object_unref (iter);
+
+		DEBUG_PRINT ("Going to look for the following function ret type %s",
+					func_ret_type_name.c_str ());
+
+		iter = getCurrentSearchableScope (li.front().m_returnValue.m_type,
+		                                  type_scope);
+	}
+
+	return iter;
+}
+
 /* FIXME TODO: error processing. Find out a way to notify the caller of the occurred 
  * error. The "cout" method cannot be used
  */
@@ -601,6 +836,9 @@ EngineParser::processExpression(const string& stmt,
 	}	
 	
 	/* fine. Have we more tokens left? */
+	vector<string> members;
+	bool has_call = false;
+	
 	while (nextMainToken (current_token, op) == 1) 
 	{
 		DEBUG_PRINT("Next main token \"%s\" with op \"%s\"",current_token.c_str (), op.c_str ());
@@ -609,132 +847,254 @@ EngineParser::processExpression(const string& stmt,
 	 	 * ExpressionResult object
 	 	 */
 		result = parseExpression (current_token);
-		
-		if (process_res == false || curr_searchable_scope == NULL)
+		members.push_back (result.m_name);
+		if (result.m_isFunc)
+			has_call = true;
+	}
+
+	/* skip the members already resolved by a previous request */
+	size_t i = 0;
+	int curr_id = ianjuta_symbol_get_int (IANJUTA_SYMBOL (curr_searchable_scope),
+	                                      IANJUTA_SYMBOL_FIELD_ID, NULL);
+	while (i < members.size ())
+	{
+		map<MemberKey, MemberEntry>::iterator cached =
+			_member_cache.find (make_pair (curr_id, members[i]));
+
+		if (cached == _member_cache.end ())
+			break;
+		curr_id = cached->second.container_id;
+		i++;
+	}
+
+	/* the rest of the chain may have been resolved in one go before */
+	string chain;
+	for (size_t j = i; j < members.size (); j++)
+		chain.append (j > i ? "." : "").append (members[j]);
+
+	if (members.size () - i > 1)
+	{
+		map<MemberKey, int>::iterator cached =
+			_chain_cache.find (make_pair (curr_id, chain));
+
+		if (cached != _chain_cache.end ())
 		{
-			DEBUG_PRINT ("No luck with the NEXT token, the NEXT token failed and then "
-				"I cannot continue. ");
+			curr_id = cached->second;
+			i = members.size ();
+		}
+	}
 
-			if (curr_searchable_scope != NULL)
-				g_object_unref (curr_searchable_scope );
+	if (i > 0)
+	{
+		g_object_unref (curr_searchable_scope);
+		curr_searchable_scope = 
+			ianjuta_symbol_query_search_id (_query_search_id, curr_id, NULL);
+		if (curr_searchable_scope == NULL)
 			return NULL;
-		}
-		
-		/* check if the name of the result is valuable or not */
-		IAnjutaSymbol *node;
-		IAnjutaIterable * iter;
+	}
 
-		node = IANJUTA_SYMBOL (curr_searchable_scope);
+	/* a chain of plain variables is resolved by a single query, functions 
+	 * need their return type to be parsed so they take the long way */
+	if (i < members.size () && !has_call && members.size () - i <= MEMBER_CHAIN_MAX)
+	{
+		IAnjutaIterable *iter;
+		GList *names = NULL;
+
+		for (size_t j = i; j < members.size (); j++)
+			names = g_list_prepend (names, (gpointer)members[j].c_str ());
+		names = g_list_reverse (names);
 		
-		iter = ianjuta_symbol_query_search_in_scope (_query_search_in_scope,
-		                                             result.m_name.c_str (),
-		                                             node, NULL);
+		iter = ianjuta_symbol_query_search_member_chain (_query_member_chain,
+		                                                 IANJUTA_SYMBOL (curr_searchable_scope),
+		                                                 names, NULL);
+		g_list_free (names);
 		
-		if (iter == NULL)
+		if (iter != NULL)
 		{
-			DEBUG_PRINT ("Warning, the result.m_name %s "
-				"does not belong to scope (id %d)", result.m_name.c_str (), 
-			             ianjuta_symbol_get_int (node, IANJUTA_SYMBOL_FIELD_ID, NULL));
-			
-			if (curr_searchable_scope != NULL)
-				g_object_unref (curr_searchable_scope );
+			DEBUG_PRINT ("Resolved member chain %s in a single query", chain.c_str ());
 			
+			_chain_cache[make_pair (curr_id, chain)] =
+				ianjuta_symbol_get_int (IANJUTA_SYMBOL (iter), 
+				                        IANJUTA_SYMBOL_FIELD_ID, NULL);
+			g_object_unref (curr_searchable_scope);
+			return iter;
+		}
+	}
+
+	for (; i < members.size (); i++)
+	{
+		IAnjutaIterable *iter;
+		vector<int> symbols;
+
+		curr_id = ianjuta_symbol_get_int (IANJUTA_SYMBOL (curr_searchable_scope),
+		                                  IANJUTA_SYMBOL_FIELD_ID, NULL);
+		iter = resolveMember (curr_searchable_scope, members[i], type_scope,
+		                      symbols);
+		
+		/* remove the 'old' curr_searchable_scope and replace with 
+		 * this new one
+		 */			
+		g_object_unref (curr_searchable_scope);
+		curr_searchable_scope = iter;
+
+		if (curr_searchable_scope == NULL)
+		{
+			DEBUG_PRINT ("No luck with the NEXT token, the NEXT token failed and then "
+				"I cannot continue. ");
 			return NULL;
 		}
-		else 
+
+		addMember (curr_id, members[i],
+		           ianjuta_symbol_get_int (IANJUTA_SYMBOL (curr_searchable_scope),
+		                                   IANJUTA_SYMBOL_FIELD_ID, NULL),
+		           symbols);
+	}
+
+	DEBUG_PRINT ("END of expression processing. Returning curr_searchable_scope");
+	return curr_searchable_scope;
+}
+
+/**
+ * Return the offset of the first line start after at least 'lines' lines from
+ * 'from' where the tokenizer would be out of comments and preprocessor 
+ * directives, or string::npos if the text ends before. 'from' must be such 
+ * a line start too. The rules follow the ones of grammars/cpp.l.
+ */
+static size_t
+next_scope_checkpoint (const string& text, size_t from, int lines)
+{
+	enum { CODE, C_COMMENT, CPP_COMMENT, PREPR, WRAP_PREP } state = CODE;
+	size_t len = text.length ();
+	size_t i = from;
+	bool bol = true;
+	int n_lines = 0;
+
+	while (i < len)
+	{
+		char c = text[i];
+		char next = i + 1 < len ? text[i + 1] : '\0';
+
+		if (c == '\n')
 		{
-			gchar *sym_kind;
-			DEBUG_PRINT ("Good element %s", result.m_name.c_str ());
+			i++;
+			n_lines++;
+			bol = true;
 			
-			node = IANJUTA_SYMBOL (iter);
-			sym_kind = (gchar*)ianjuta_symbol_get_string (node, 
-		    										IANJUTA_SYMBOL_FIELD_KIND, NULL);
-			
-			DEBUG_PRINT (".. it has sym_kind \"%s\"", sym_kind);
+			if (state == WRAP_PREP)
+			{
+				state = PREPR;
+				continue;
+			}
+			if (state == C_COMMENT)
+				continue;
 
-			/* the same check as in the engine-core on sdb_engine_add_new_sym_type () */
-			if (g_strcmp0 (sym_kind, "member") == 0 || 
-	    		g_strcmp0 (sym_kind, "variable") == 0 || 
-	    		g_strcmp0 (sym_kind, "field") == 0)
+			state = CODE;
+			if (n_lines >= lines)
+				return i;
+			continue;
+		}
+
+		switch (state)
+		{
+		case CODE:
+			if (bol && (c == ' ' || c == '\t'))
 			{
-				iter = switchMemberToContainer (iter);
-				node = IANJUTA_SYMBOL (iter);
-				sym_kind = (gchar*)ianjuta_symbol_get_string (node, 
-		    										IANJUTA_SYMBOL_FIELD_KIND, NULL);				
+				i++;
+				continue;
 			}
-			
-			/* check for any typedef */
-			if (g_strcmp0 (ianjuta_symbol_get_string (node, 
-		    										IANJUTA_SYMBOL_FIELD_KIND, NULL),
-	    											"typedef") == 0)
-			{			
-				iter = switchTypedefToStruct (iter);
-				node = IANJUTA_SYMBOL (iter);
-				sym_kind = (gchar*)ianjuta_symbol_get_string (node, 
-		    										IANJUTA_SYMBOL_FIELD_KIND, NULL);				
+			if (bol && c == '#')
+			{
+				state = PREPR;
+				i++;
 			}
-			
-			/* is it a function or a method? */
-			if (g_strcmp0 (sym_kind, "function") == 0 ||
-			    g_strcmp0 (sym_kind, "method") == 0 ||
-			    g_strcmp0 (sym_kind, "prototype") == 0)
+			else if (c == '/' && next == '*')
 			{
-
-				string func_ret_type_name = 
-					ianjuta_symbol_get_string (node, IANJUTA_SYMBOL_FIELD_RETURNTYPE, NULL);
-
-				string func_signature = 
-					ianjuta_symbol_get_string (node, IANJUTA_SYMBOL_FIELD_SIGNATURE, NULL);
+				state = C_COMMENT;
+				i += 2;
+			}
+			else if (c == '/' && next == '/')
+			{
+				state = CPP_COMMENT;
+				i += 2;
+			}
+			else if (c == '"' || c == '\'')
+			{
+				/* literals don't span lines, skip them to not mistake their
+				 * contents for comments */
+				size_t j = i + 1;
+				size_t n_chars = 0;
+				bool closed = false;
 				
-				func_ret_type_name += " " + result.m_name + func_signature + "{}";
-
-				FunctionList li;
-				std::map<std::string, std::string> ignoreTokens;
-				get_functions (func_ret_type_name, li, ignoreTokens);
-
-				DEBUG_PRINT ("Functions found are...");
-/*				
-				for (FunctionList::reverse_iterator func_iter = li.rbegin(); 
-				     func_iter != li.rend(); 
-				     func_iter++) 
+				while (j < len && text[j] != '\n')
 				{
-					Function var = (*func_iter);
-					var.print ();			
+					if (text[j] == c)
+					{
+						closed = c == '"' || n_chars > 0;
+						break;
+					}
+					if (text[j] == '\\')
+					{
+						char e = j + 1 < len ? text[j + 1] : '\0';
+						if (strchr ("abfnrtv'\"?\\", e) != NULL && e != '\0')
+							j += 2;
+						else if (e >= '0' && e <= '7')
+						{
+							j += 2;
+							for (int k = 0; k < 2 && j < len && 
+							     text[j] >= '0' && text[j] <= '7'; k++)
+								j++;
+						}
+						else if (e == 'x' && j + 2 < len && 
+						         g_ascii_isxdigit (text[j + 2]))
+						{
+							j += 3;
+							while (j < len && g_ascii_isxdigit (text[j]))
+								j++;
+						}
+						else
+							break;
+					}
+					else
+						j++;
+					n_chars++;
 				}
-*/
+				i = closed ? j + 1 : i + 1;
+			}
+			else
+				i++;
+			break;
 			
-				g_object_unref (iter);
-
-				DEBUG_PRINT ("Going to look for the following function ret type %s",
-							func_ret_type_name.c_str ());
+		case C_COMMENT:
+			if (c == '*' && next == '/')
+			{
+				state = CODE;
+				i += 2;
+			}
+			else
+				i++;
+			break;
 
-				iter = getCurrentSearchableScope (li.front().m_returnValue.m_type,
-				                                  type_scope);
-			}			               
+		case PREPR:
+			/* any backslash makes the directive continue on the next line */
+			if (c == '\\')
+				state = WRAP_PREP;
+			i++;
+			break;
 			
-			/* remove the 'old' curr_searchable_scope and replace with 
-			 * this new one
-			 */			
-			g_object_unref (curr_searchable_scope);			
-			curr_searchable_scope = iter;
-			continue;
+		default:
+			i++;
+			break;
 		}
+		bol = false;
 	}
 
-	DEBUG_PRINT ("END of expression processing. Returning curr_searchable_scope");
-	return curr_searchable_scope;
+	return string::npos;
 }
 
-/**
- * @return The visible scope until pchStopWord is encountered
- */
-string 
-EngineParser::optimizeScope(const string& srcString)
+void
+EngineParser::scanScope (const string& srcString, vector<string> &scope_stack,
+                         string &currScope)
 {
-	string wxcurrScope;
-	std::vector<std::string> scope_stack;
-	std::string currScope;
-
 	int type;
 
 	/* Initialize the scanner with the string to search */
@@ -749,11 +1109,7 @@ EngineParser::optimizeScope(const string& srcString)
 
 		/* Eof ? */
 		if (type == 0) 
-		{
-			if (!currScope.empty())
-				scope_stack.push_back(currScope);
 			break;
-		}
 
 		/* eat up all tokens until next line */
 		if ( prepLine && _extra_tokenizer->lineno() == curline) 
@@ -822,6 +1178,64 @@ EngineParser::optimizeScope(const string& srcString)
 	}
 
 	_extra_tokenizer->reset();
+}
+
+/**
+ * @return The visible scope until pchStopWord is encountered
+ */
+string 
+EngineParser::optimizeScope(const string& srcString, BufferScope &buffer)
+{
+	std::vector<std::string> scope_stack;
+	std::string currScope;
+	size_t offset = 0;
+	size_t prefix = 0;
+	size_t len = MIN (srcString.length (), buffer.text.length ());
+
+	/* the checkpoints after the first change aren't valid anymore */
+	while (prefix < len && srcString[prefix] == buffer.text[prefix])
+		prefix++;
+	
+	while (!buffer.checkpoints.empty () && 
+	       buffer.checkpoints.back ().offset > prefix)
+		buffer.checkpoints.pop_back ();
+
+	if (!buffer.checkpoints.empty ())
+	{
+		const ScopeCheckpoint &checkpoint = buffer.checkpoints.back ();
+
+		scope_stack = checkpoint.scope_stack;
+		currScope = checkpoint.curr_scope;
+		offset = checkpoint.offset;
+	}
+
+	DEBUG_PRINT ("Scanning scope from offset %lu of %lu", 
+	             (unsigned long)offset, (unsigned long)srcString.length ());
+	while (offset < srcString.length ())
+	{
+		size_t next = next_scope_checkpoint (srcString, offset, 
+		                                     SCOPE_CHECKPOINT_LINES);
+		
+		if (next == string::npos)
+		{
+			scanScope (srcString.substr (offset), scope_stack, currScope);
+			break;
+		}
+
+		scanScope (srcString.substr (offset, next - offset), scope_stack, 
+		           currScope);
+
+		ScopeCheckpoint checkpoint;
+		checkpoint.offset = next;
+		checkpoint.scope_stack = scope_stack;
+		checkpoint.curr_scope = currScope;
+		buffer.checkpoints.push_back (checkpoint);
+		
+		offset = next;
+	}
+
+	if (!currScope.empty())
+		scope_stack.push_back(currScope);
 
 	if (scope_stack.empty())
 		return srcString;
@@ -840,6 +1254,46 @@ EngineParser::optimizeScope(const string& srcString)
 	return srcString;
 }
 
+BufferScope& 
+EngineParser::getBufferScope (const string& full_file_path, 
+                              const string& above_text)
+{
+	map<string, BufferScope>::iterator it = _buffer_scopes.find (full_file_path);
+
+	if (it == _buffer_scopes.end ())
+	{
+		if (_buffer_scopes.size () >= BUFFER_SCOPES_MAX)
+			_buffer_scopes.clear ();
+		
+		it = _buffer_scopes.insert (make_pair (full_file_path, BufferScope ())).first;
+	}
+
+	BufferScope &buffer = it->second;
+	if (buffer.text != above_text)
+	{
+		string optimized_scope = optimizeScope (above_text, buffer);
+
+		buffer.text = above_text;
+		if (optimized_scope != buffer.optimized_scope)
+		{
+			std::map<std::string, std::string> ignoreTokens;
+			
+			buffer.optimized_scope = optimized_scope;
+			buffer.variables.clear ();
+			get_variables (buffer.optimized_scope, buffer.variables, 
+			               ignoreTokens, false);
+		}
+	}
+	
+	return buffer;
+}
+
+void
+EngineParser::releaseBuffer (const string& full_file_path)
+{
+	_buffer_scopes.erase (full_file_path);
+}
+
 /************ C FUNCTIONS ************/
 
 void
@@ -873,3 +1327,9 @@ engine_parser_process_expression (const gchar *stmt, const gchar * above_text,
 		return NULL;
 	}
 }
+
+void
+engine_parser_release_buffer (const gchar *full_file_path)
+{
+	EngineParser::getInstance ()->releaseBuffer (full_file_path);
+}
@@ -45,6 +45,14 @@ IAnjutaIterable *
 engine_parser_process_expression (const gchar *stmt, const gchar * above_text,
     const gchar * full_file_path, gulong linenum);	
 
+/**
+ * The parser keeps a scope model of each buffer it has been asked to complete,
+ * updated as the text above the statement changes. Drop it when the buffer 
+ * goes away.
+ * @param full_file_path The full path given to engine_parser_process_expression ().
+ */
+void engine_parser_release_buffer (const gchar *full_file_path);
+
 #ifdef __cplusplus
 }	// extern "C" 
 #endif
@@ -995,6 +995,8 @@ parser_cxx_assist_finalize (GObject *object)
 		g_object_unref (priv->sync_query_project);
 	priv->sync_query_project = NULL;
 
+	if (priv->editor_filename)
+		engine_parser_release_buffer (priv->editor_filename);
 	engine_parser_deinit ();
 	
 	g_free (assist->priv);
@@ -23,7 +23,9 @@
 #include <libanjuta/anjuta-convert.h>
 #include <libanjuta/anjuta-encodings.h>
 
-#define READ_SIZE 4096
+/* Size of the chunks read from the file, each one is inserted in the
+ * buffer as soon as it is read */
+#define READ_SIZE 65536
 #define RATE_LIMIT 5000 /* Use a big rate limit to avoid duplicates */
 
 enum
@@ -53,7 +55,7 @@ on_sourceview_finalized (gpointer data, GObject* where_the_object_was)
 
 	sio->sv = NULL;
 	/* Cancel all open operations */
-	g_cancellable_cancel (sio->open_cancel);
+	sourceview_io_cancel (sio);
 }
 
 static void
@@ -61,12 +63,10 @@ sourceview_io_init (SourceviewIO *object)
 {
 	object->file = NULL;
 	object->filename = NULL;
-	object->read_buffer = NULL;
 	object->write_buffer = NULL;
-	object->open_cancel = g_cancellable_new();
+	object->loader = NULL;
 	object->monitor = NULL;
 	object->last_encoding = NULL;
-	object->bytes_read = 0;
 }
 
 static void
@@ -81,9 +81,7 @@ sourceview_io_finalize (GObject *object)
 		g_object_unref (sio->file);
 	g_free (sio->etag);
 	g_free(sio->filename);
-	g_free(sio->read_buffer);
 	g_free(sio->write_buffer);
-	g_object_unref (sio->open_cancel);
 	if (sio->monitor)
 		g_object_unref (sio->monitor);
 
@@ -385,149 +383,351 @@ sourceview_io_save_as (SourceviewIO* sio, GFile* file)
 	g_object_ref (sio);
 }
 
-static void insert_text_in_document(SourceviewIO* sio, const gchar* text, gsize len)
+/* File being opened. Each chunk read is converted to UTF-8 and inserted in
+ * the buffer at once, so big files do not block the user interface. The text
+ * is read as UTF-8 until an invalid sequence is found, then the file is read
+ * again as ISO-8859-15. */
+struct _SourceviewIOLoader
 {
-	GtkSourceBuffer* document = GTK_SOURCE_BUFFER (sio->sv->priv->document);
-	gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (sio->sv->priv->document));
+	SourceviewIO* sio;
+	GInputStream* stream;
+	GCancellable* cancel;
 
-	/* Insert text in the buffer */
-	gtk_text_buffer_set_text (GTK_TEXT_BUFFER (document),
-							  text,
-							  len);
+	/* Incomplete character at the end of the previous chunk */
+	gchar partial[8];
+	gsize n_partial;
 
-	gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (document),
-				      FALSE);
+	const AnjutaEncoding* encoding;
+	GCharsetConverter* converter;
 
-	gtk_source_buffer_end_not_undoable_action (document);
+	gboolean inserting;
+	AnjutaStatus* status;
+	gint ticks;
+};
+
+static void
+sourceview_io_loader_free (SourceviewIOLoader* loader)
+{
+	if (loader->converter)
+		g_object_unref (loader->converter);
+	if (loader->status)
+		g_object_unref (loader->status);
+	g_object_unref (loader->cancel);
+	g_object_unref (loader->stream);
+	g_object_unref (loader->sio);
+	g_free (loader);
 }
 
-static gboolean
-append_buffer (SourceviewIO* sio, gsize size)
+/* Stop inserting text in the document, the loader is freed once the pending
+ * read completes */
+static void
+sourceview_io_loader_stop (SourceviewIOLoader* loader)
 {
-	/* Text is utf-8 - good */
-	if (g_utf8_validate (sio->read_buffer, size, NULL))
+	SourceviewIO* sio = loader->sio;
+
+	if (loader->status && loader->ticks > 0)
 	{
-		insert_text_in_document (sio, sio->read_buffer, size);
+		anjuta_status_progress_increment_ticks (loader->status, loader->ticks, NULL);
+		loader->ticks = 0;
 	}
-	else
+	if (loader->inserting && sio->sv != NULL)
 	{
-		/* Text is not utf-8 */
-		GError *conv_error = NULL;
-		gchar *converted_text = NULL;
-		gsize new_len = size;
-		const AnjutaEncoding* enc = NULL;
-
-		converted_text = anjuta_convert_to_utf8 (sio->read_buffer,
-												 size,
-												 &enc,
-												 &new_len,
-												 &conv_error);
-		if  (converted_text == NULL)
+		gtk_source_buffer_end_not_undoable_action (GTK_SOURCE_BUFFER (sio->sv->priv->document));
+	}
+	loader->inserting = FALSE;
+}
+
+static void
+sourceview_io_loader_failed (SourceviewIOLoader* loader, GError* err)
+{
+	SourceviewIO* sio = loader->sio;
+
+	/* Do not leave a part of the file in the editor, it could be saved */
+	if (loader->inserting && sio->sv != NULL)
+	{
+		gtk_text_buffer_set_text (GTK_TEXT_BUFFER (sio->sv->priv->document),
+		                          "",
+		                          0);
+	}
+	sourceview_io_loader_stop (loader);
+	sio->loader = NULL;
+
+	g_signal_emit_by_name (sio, "open-failed", err);
+	sourceview_io_loader_free (loader);
+}
+
+/* Return the chunk converted to UTF-8, an incomplete character at the end is
+ * kept for the next chunk. Without converter, the text has to be valid UTF-8 */
+static gchar*
+sourceview_io_loader_convert (SourceviewIOLoader* loader,
+                              GBytes* chunk,
+                              gsize* new_len,
+                              GError** err)
+{
+	const gchar* data;
+	gsize size;
+	gchar* input;
+	gsize input_len;
+	gsize bytes_read = 0;
+	gchar* text;
+
+	data = g_bytes_get_data (chunk, &size);
+	input_len = loader->n_partial + size;
+	input = g_malloc (input_len);
+	memcpy (input, loader->partial, loader->n_partial);
+	memcpy (input + loader->n_partial, data, size);
+
+	if (loader->converter == NULL)
+	{
+		const gchar* end;
+
+		/* Text is utf-8 - good */
+		if (!g_utf8_validate (input, input_len, &end)
+		    && g_utf8_get_char_validated (end, input + input_len - end) != (gunichar)-2)
 		{
-			/* Last chance, let's try 8859-15 */
-			enc = anjuta_encoding_get_from_charset( "ISO-8859-15");
-			conv_error = NULL;
-			converted_text = anjuta_convert_to_utf8 (sio->read_buffer,
-													 size,
-													 &enc,
-													 &new_len,
-													 &conv_error);
+			g_set_error (err, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+			             _("The file you are trying to open contains an invalid byte sequence."));
+			g_free (input);
+			return NULL;
 		}
-		if (converted_text == NULL)
-		{
-			g_return_val_if_fail (conv_error != NULL, FALSE);
+		bytes_read = end - input;
+		*new_len = bytes_read;
+		text = input;
+	}
+	else
+	{
+		gsize text_size = input_len * 3 + 16;
 
-			g_signal_emit_by_name (sio, "open-failed", conv_error);
-			g_error_free (conv_error);
-			return FALSE;
+		text = g_malloc (text_size);
+		*new_len = 0;
+		while (bytes_read < input_len)
+		{
+			GError* conv_error = NULL;
+			gsize read, written;
+
+			if (g_converter_convert (G_CONVERTER (loader->converter),
+			                         input + bytes_read, input_len - bytes_read,
+			                         text + *new_len, text_size - *new_len,
+			                         G_CONVERTER_NO_FLAGS,
+			                         &read, &written,
+			                         &conv_error) == G_CONVERTER_ERROR)
+			{
+				if (g_error_matches (conv_error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT))
+				{
+					g_error_free (conv_error);
+					break;
+				}
+				else if (g_error_matches (conv_error, G_IO_ERROR, G_IO_ERROR_NO_SPACE))
+				{
+					g_error_free (conv_error);
+					text_size *= 2;
+					text = g_realloc (text, text_size);
+					continue;
+				}
+				g_propagate_error (err, conv_error);
+				g_free (text);
+				g_free (input);
+				return NULL;
+			}
+			bytes_read += read;
+			*new_len += written;
 		}
-		sio->last_encoding = enc;
-		insert_text_in_document (sio, converted_text, new_len);
-		g_free (converted_text);
 	}
+
+	loader->n_partial = input_len - bytes_read;
+	if (loader->n_partial >= sizeof (loader->partial))
+	{
+		g_set_error (err, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+		             _("The file you are trying to open contains an invalid byte sequence."));
+		if (text != input)
+			g_free (text);
+		g_free (input);
+		return NULL;
+	}
+	memcpy (loader->partial, input + bytes_read, loader->n_partial);
+	if (text != input)
+		g_free (input);
+
+	return text;
+}
+
+static void on_read_finished (GObject* input, GAsyncResult* result, gpointer data);
+
+static void
+sourceview_io_loader_read (SourceviewIOLoader* loader)
+{
+	g_input_stream_read_bytes_async (loader->stream,
+	                                 READ_SIZE,
+	                                 IO_PRIORITY,
+	                                 loader->cancel,
+	                                 on_read_finished,
+	                                 loader);
+}
+
+/* Text is not utf-8, remove the text inserted and read the file again as
+ * 8859-15 */
+static gboolean
+sourceview_io_loader_restart (SourceviewIOLoader* loader, GError** err)
+{
+	SourceviewIO* sio = loader->sio;
+	GFileInputStream* input_stream;
+
+	loader->encoding = anjuta_encoding_get_from_charset ("ISO-8859-15");
+	loader->converter = g_charset_converter_new ("UTF-8",
+	                                             anjuta_encoding_get_charset (loader->encoding),
+	                                             err);
+	if (loader->converter == NULL)
+		return FALSE;
+
+	input_stream = g_file_read (sio->file, NULL, err);
+	if (!input_stream)
+		return FALSE;
+	g_object_unref (loader->stream);
+	loader->stream = G_INPUT_STREAM (input_stream);
+
+	loader->n_partial = 0;
+	gtk_text_buffer_set_text (GTK_TEXT_BUFFER (sio->sv->priv->document),
+	                          "",
+	                          0);
+	sourceview_io_loader_read (loader);
+
 	return TRUE;
 }
 
 static void
-on_read_finished (GObject* input, GAsyncResult* result, gpointer data)
+sourceview_io_loader_insert (SourceviewIOLoader* loader, GBytes* chunk)
 {
-	SourceviewIO* sio = SOURCEVIEW_IO(data);
-	GInputStream* input_stream = G_INPUT_STREAM(input);
-	gsize current_bytes = 0;
+	SourceviewIO* sio = loader->sio;
+	GtkTextBuffer* document = GTK_TEXT_BUFFER (sio->sv->priv->document);
 	GError* err = NULL;
+	GtkTextIter end;
+	gchar* text;
+	gsize len;
 
-	if (!g_cancellable_set_error_if_cancelled (sio->open_cancel, &err))
-		current_bytes = g_input_stream_read_finish (input_stream, result, &err);
-	if (err)
+	text = sourceview_io_loader_convert (loader, chunk, &len, &err);
+	if (text == NULL)
 	{
-		g_signal_emit_by_name (sio, "open-failed", err);
+		if ((loader->converter != NULL) || !sourceview_io_loader_restart (loader, NULL))
+			sourceview_io_loader_failed (loader, err);
 		g_error_free (err);
+		return;
 	}
-	else
+
+	gtk_text_buffer_get_end_iter (document, &end);
+	gtk_text_buffer_insert (document, &end, text, len);
+	g_free (text);
+
+	if (loader->status && loader->ticks > 0)
 	{
-		/* Check that the parent Sourceview is still alive. */
-		if (sio->sv == NULL)
-		{
-			g_warning ("Sourceview was destroyed without canceling SourceviewIO open operation");
-			goto out;
-		}
+		loader->ticks--;
+		anjuta_status_progress_tick (loader->status, NULL, NULL);
+	}
 
-		sio->bytes_read += current_bytes;
-		if (current_bytes != 0)
-		{
-			sio->read_buffer = g_realloc (sio->read_buffer, sio->bytes_read + READ_SIZE);
-			g_input_stream_read_async (G_INPUT_STREAM (input_stream),
-									   sio->read_buffer + sio->bytes_read,
-									   READ_SIZE,
-									   IO_PRIORITY,
-									   sio->open_cancel,
-									   on_read_finished,
-									   sio);
+	sourceview_io_loader_read (loader);
+}
+
+static void
+sourceview_io_loader_finish (SourceviewIOLoader* loader)
+{
+	SourceviewIO* sio = loader->sio;
+	GFileInfo* info;
+	GError* err = NULL;
+
+	if (loader->n_partial > 0)
+	{
+		/* A file cut in the middle of a character is not UTF-8 */
+		if ((loader->converter == NULL) && sourceview_io_loader_restart (loader, NULL))
 			return;
-		}
-		else
-		{
-			GFileInfo* info;
 
-			info = g_file_input_stream_query_info (G_FILE_INPUT_STREAM (input_stream),
-			                                       G_FILE_ATTRIBUTE_ETAG_VALUE,
-			                                       NULL, &err);
-			if (!info)
-			{
-				g_signal_emit_by_name (sio, "open-failed", err);
-				g_error_free (err);
-			}
-			else
-			{
-				g_free (sio->etag);
-				sio->etag = g_strdup (g_file_info_get_etag (info));
-				g_object_unref (info);
+		g_set_error (&err, G_CONVERT_ERROR, G_CONVERT_ERROR_ILLEGAL_SEQUENCE,
+		             _("The file you are trying to open contains an invalid byte sequence."));
+		sourceview_io_loader_failed (loader, err);
+		g_error_free (err);
+		return;
+	}
 
-				if (append_buffer (sio, sio->bytes_read))
-					g_signal_emit_by_name (sio, "open-finished");
-				setup_monitor (sio);
-			}
-		}
+	info = g_file_input_stream_query_info (G_FILE_INPUT_STREAM (loader->stream),
+	                                       G_FILE_ATTRIBUTE_ETAG_VALUE,
+	                                       NULL, &err);
+	if (!info)
+	{
+		sourceview_io_loader_failed (loader, err);
+		g_error_free (err);
+		return;
 	}
+	g_free (sio->etag);
+	sio->etag = g_strdup (g_file_info_get_etag (info));
+	g_object_unref (info);
 
-out:
-	g_object_unref (input_stream);
-	g_free (sio->read_buffer);
-	sio->read_buffer = NULL;
-	sio->bytes_read = 0;
-	g_object_unref (sio);
+	setup_monitor (sio);
+
+	gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (sio->sv->priv->document), FALSE);
+	sourceview_io_loader_stop (loader);
+
+	if (loader->encoding != NULL)
+		sio->last_encoding = loader->encoding;
+	sio->loader = NULL;
+	g_signal_emit_by_name (sio, "open-finished");
+	sourceview_io_loader_free (loader);
+}
+
+static void
+on_read_finished (GObject* input, GAsyncResult* result, gpointer data)
+{
+	SourceviewIOLoader* loader = data;
+	SourceviewIO* sio = loader->sio;
+	GInputStream* input_stream = G_INPUT_STREAM(input);
+	GBytes* chunk;
+	GError* err = NULL;
+
+	chunk = g_input_stream_read_bytes_finish (input_stream, result, &err);
+
+	/* Loading has been cancelled */
+	if (sio->loader != loader)
+	{
+		if (chunk)
+			g_bytes_unref (chunk);
+		if (err)
+			g_error_free (err);
+		sourceview_io_loader_free (loader);
+		return;
+	}
+
+	if (err)
+	{
+		sourceview_io_loader_failed (loader, err);
+		g_error_free (err);
+	}
+	else if (g_bytes_get_size (chunk) != 0)
+	{
+		sourceview_io_loader_insert (loader, chunk);
+		g_bytes_unref (chunk);
+	}
+	else
+	{
+		g_bytes_unref (chunk);
+		sourceview_io_loader_finish (loader);
+	}
 }
 
 void
 sourceview_io_open (SourceviewIO* sio, GFile* file)
 {
 	GFileInputStream* input_stream;
+	SourceviewIOLoader* loader;
+	GFileInfo* info;
 	GError* err = NULL;
 
 	g_return_if_fail (SOURCEVIEW_IS_IO (sio));
 	g_return_if_fail (sio->sv != NULL);
 	g_return_if_fail (G_IS_FILE (file));
 
+	sourceview_io_cancel (sio);
+
+	/* The file is inserted while being read, the view is made editable
+	 * again on "open-finished" or "open-failed" */
+	gtk_text_view_set_editable (GTK_TEXT_VIEW (sio->sv->priv->view), FALSE);
+
 	if (sio->file != file)
 	{
 		sourceview_io_unset_current_file (sio);
@@ -543,14 +743,63 @@ sourceview_io_open (SourceviewIO* sio, GFile* file)
 		g_error_free (err);
 		return;
 	}
-	sio->read_buffer = g_realloc (sio->read_buffer, READ_SIZE);
-	g_input_stream_read_async (G_INPUT_STREAM (input_stream),
-							   sio->read_buffer,
-							   READ_SIZE,
-							   IO_PRIORITY,
-							   sio->open_cancel,
-							   on_read_finished,
-							   g_object_ref (sio));
+
+	loader = g_new0 (SourceviewIOLoader, 1);
+	loader->sio = g_object_ref (sio);
+	loader->stream = G_INPUT_STREAM (input_stream);
+	loader->cancel = g_cancellable_new ();
+	sio->loader = loader;
+
+	/* Show the progress of files needing several steps */
+	info = g_file_input_stream_query_info (input_stream,
+	                                       G_FILE_ATTRIBUTE_STANDARD_SIZE,
+	                                       NULL, NULL);
+	if (info != NULL)
+	{
+		goffset size = g_file_info_get_size (info);
+
+		g_object_unref (info);
+		if (size > READ_SIZE && sio->shell != NULL)
+		{
+			loader->status = anjuta_shell_get_status (sio->shell, NULL);
+			if (loader->status != NULL)
+			{
+				g_object_ref (loader->status);
+				loader->ticks = (size + READ_SIZE - 1) / READ_SIZE;
+				anjuta_status_progress_add_ticks (loader->status, loader->ticks);
+				anjuta_status_set (loader->status, _("Loading %s"),
+				                   sourceview_io_get_filename (sio));
+			}
+		}
+	}
+
+	loader->inserting = TRUE;
+	gtk_source_buffer_begin_not_undoable_action (GTK_SOURCE_BUFFER (sio->sv->priv->document));
+	gtk_text_buffer_set_text (GTK_TEXT_BUFFER (sio->sv->priv->document),
+	                          "",
+	                          0);
+
+	sourceview_io_loader_read (loader);
+}
+
+/* Stop a pending open operation, neither "open-finished" nor "open-failed"
+ * is emitted and the document keeps the part of the file already inserted */
+void
+sourceview_io_cancel (SourceviewIO* sio)
+{
+	SourceviewIOLoader* loader;
+
+	g_return_if_fail (SOURCEVIEW_IS_IO (sio));
+
+	loader = sio->loader;
+	if (loader == NULL)
+		return;
+	sio->loader = NULL;
+
+	/* on_read_finished is still waiting for the file and will free the
+	 * loader */
+	g_cancellable_cancel (loader->cancel);
+	sourceview_io_loader_stop (loader);
 }
 
 GFile*
@@ -36,6 +36,7 @@ G_BEGIN_DECLS
 
 typedef struct _SourceviewIOClass SourceviewIOClass;
 typedef struct _SourceviewIO SourceviewIO;
+typedef struct _SourceviewIOLoader SourceviewIOLoader;
 
 struct _SourceviewIOClass
 {
@@ -61,10 +62,8 @@ struct _SourceviewIO
 	gchar* etag;
 	gchar* filename;
 	gchar* write_buffer;
-	gchar* read_buffer;
-	GCancellable* open_cancel;
+	SourceviewIOLoader* loader;
 	GFileMonitor* monitor;
-	gssize bytes_read;
 
 	const AnjutaEncoding* last_encoding;
 };
@@ -73,6 +72,7 @@ GType sourceview_io_get_type (void) G_GNUC_CONST;
 void sourceview_io_save (SourceviewIO* sio);
 void sourceview_io_save_as (SourceviewIO* sio, GFile* file);
 void sourceview_io_open (SourceviewIO* sio, GFile* file);
+void sourceview_io_cancel (SourceviewIO* sio);
 GFile* sourceview_io_get_file (SourceviewIO* sio);
 const gchar* sourceview_io_get_filename (SourceviewIO* sio);
 void sourceview_io_set_filename (SourceviewIO* sio, const gchar* filename);
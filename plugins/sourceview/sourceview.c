@@ -334,9 +334,17 @@ on_insert_text (GtkTextBuffer *buffer,
 {
 	int i = 0, lines = 0;
 	gchar* signal_text;
-	SourceviewCell *cell = sourceview_cell_new (location, GTK_TEXT_VIEW (sv->priv->view));
-	IAnjutaIterable *iter = ianjuta_iterable_clone (IANJUTA_ITERABLE (cell), NULL);
-	GtkTextMark *mark = gtk_text_buffer_create_mark (buffer, NULL, location, TRUE);
+	SourceviewCell *cell;
+	IAnjutaIterable *iter;
+	GtkTextMark *mark;
+
+	/* The whole file is signaled once loaded */
+	if (sv->priv->loading)
+		return;
+
+	cell = sourceview_cell_new (location, GTK_TEXT_VIEW (sv->priv->view));
+	iter = ianjuta_iterable_clone (IANJUTA_ITERABLE (cell), NULL);
+	mark = gtk_text_buffer_create_mark (buffer, NULL, location, TRUE);
 	g_object_unref (cell);
 
 	ianjuta_iterable_set_position (iter,
@@ -378,6 +386,9 @@ on_delete_range (GtkTextBuffer *buffer,
 	g_return_if_fail (ANJUTA_IS_SOURCEVIEW (user_data));
 	sv = ANJUTA_SOURCEVIEW (user_data);
 
+	if (sv->priv->loading)
+		return;
+
 	sv->priv->deleted_text = gtk_text_buffer_get_text (buffer, start_iter, end_iter, TRUE);
 
 }
@@ -398,6 +409,9 @@ on_delete_range_after (GtkTextBuffer *buffer,
 	g_return_if_fail (ANJUTA_IS_SOURCEVIEW (user_data));
 	sv = ANJUTA_SOURCEVIEW (user_data);
 
+	if (sv->priv->deleted_text == NULL)
+		return;
+
 	/* Get the start iterator of the changed text */
 	cell = sourceview_cell_new (start_iter, GTK_TEXT_VIEW (sv->priv->view));
 	position = IANJUTA_ITERABLE (cell);
@@ -736,8 +750,24 @@ static void
 on_open_finish(SourceviewIO* io, Sourceview* sv)
 {
 	const gchar *lang;
+	GtkTextBuffer *buffer = GTK_TEXT_BUFFER(sv->priv->document);
+	GtkTextIter start, end;
+	SourceviewCell *cell;
+	gchar *text;
 
-	gtk_text_buffer_set_modified(GTK_TEXT_BUFFER(sv->priv->document), FALSE);
+	gtk_text_buffer_set_modified(buffer, FALSE);
+
+	/* Send a single "changed" signal for the whole file */
+	gtk_text_buffer_get_bounds (buffer, &start, &end);
+	text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+	if (*text != '\0')
+	{
+		cell = sourceview_cell_new (&start, GTK_TEXT_VIEW (sv->priv->view));
+		g_signal_emit_by_name (G_OBJECT (sv), "changed", cell, TRUE, (gint) strlen (text),
+		                       gtk_text_buffer_get_line_count (buffer) - 1, text);
+		g_object_unref (cell);
+	}
+	g_free (text);
 
 	if (sourceview_io_get_read_only (io))
 	{
@@ -996,6 +1026,8 @@ sourceview_dispose(GObject *object)
 		cobj->priv->assist_tip = NULL;
 	}
 
+	if (cobj->priv->io)
+		sourceview_io_cancel (cobj->priv->io);
 	g_clear_object (&cobj->priv->io);
 	g_clear_object (&cobj->priv->tooltip_cell);
 
@@ -1050,8 +1082,6 @@ ifile_open (IAnjutaFile* ifile, GFile* file, GError** e)
 							  0);
 	gtk_source_buffer_end_not_undoable_action (GTK_SOURCE_BUFFER (sv->priv->document));
 
-	gtk_text_view_set_editable (GTK_TEXT_VIEW (sv->priv->view),
-								FALSE);
 	sv->priv->loading = TRUE;
 	sourceview_io_open (sv->priv->io, file);
 }
@@ -31,6 +31,8 @@ subversion_ivcs_iface_init (IAnjutaVcsIface *iface)
 	iface->checkout = subversion_ivcs_checkout;
 	iface->diff = subversion_ivcs_diff;
 	iface->query_status = subversion_ivcs_query_status;
+	/* svn status is not recursive here, so it only lists the children */
+	iface->query_directory_status = subversion_ivcs_query_status;
 	iface->remove = subversion_ivcs_remove;
 }
 
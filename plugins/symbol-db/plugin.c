@@ -57,11 +57,13 @@
 #define ICON_FILE 							"anjuta-symbol-db-plugin-48.png"
 #define BUFFER_UPDATE 						"symboldb-buffer-update"
 #define PARALLEL_SCAN 						"symboldb-parallel-scan"
+#define SCAN_WORKERS 						"symboldb-scan-workers"
 #define PREFS_BUFFER_UPDATE 				"preferences_toggle:bool:1:1:symboldb-buffer-update"
 #define PREFS_PARALLEL_SCAN 				"preferences_toggle:bool:1:1:symboldb-parallel-scan"
 
 #define TIMEOUT_INTERVAL_SYMBOLS_UPDATE		10
 #define TIMEOUT_SECONDS_AFTER_LAST_TIP		5
+#define DIRTY_FILES_FLUSH_DELAY				2
 
 #define PROJECT_GLOBALS						"/"
 #define SESSION_SECTION						"SymbolDB"
@@ -352,6 +354,121 @@ static GtkActionEntry actions_search[] = {
   }
 };
 
+/* Returns the first line of the declaration whose name is on line, moving 
+ * back over the lines preceding the name, like the return type of a GNU style
+ * definition or the beginning of a multi-line declaration. The declaration
+ * starts after a blank line or a line ending a previous one. */
+static gint
+editor_buffer_symbols_declaration_start (IAnjutaEditor *editor, gint line)
+{
+	while (line > 1)
+	{
+		IAnjutaIterable *begin_pos;
+		IAnjutaIterable *end_pos;
+		gchar *text = NULL;
+		gboolean boundary;
+
+		begin_pos = ianjuta_editor_get_line_begin_position (editor, line - 1, NULL);
+		end_pos = ianjuta_editor_get_line_end_position (editor, line - 1, NULL);
+		if (begin_pos != NULL && end_pos != NULL)
+			text = ianjuta_editor_get_text (editor, begin_pos, end_pos, NULL);
+		if (begin_pos)
+			g_object_unref (begin_pos);
+		if (end_pos)
+			g_object_unref (end_pos);
+
+		if (text == NULL)
+			break;
+		g_strchomp (text);
+		boundary = *text == '\0' || g_str_has_suffix (text, ";") ||
+			g_str_has_suffix (text, "}") || g_str_has_suffix (text, "{");
+		g_free (text);
+
+		if (boundary)
+			break;
+		line--;
+	}
+
+	return line;
+}
+
+/* Updates only the top-level declarations enclosing the lines changed since
+ * the last update. Returns the scan process id or -1 if the whole buffer has
+ * to be updated instead */
+static gint
+editor_buffer_symbols_update_range (IAnjutaEditor *editor,
+                                    SymbolDBPlugin *sdb_plugin,
+                                    const gchar *local_path)
+{
+	IAnjutaIterable *begin_pos;
+	IAnjutaIterable *end_pos;
+	gchar *text;
+	gint begin_line;
+	gint old_end_line;
+	gint new_end_line;
+	gint proc_id;
+
+	if (editor != sdb_plugin->current_editor ||
+	    sdb_plugin->dirty_lines_known == FALSE ||
+	    sdb_plugin->dirty_begin_line <= 0)
+		return -1;
+
+	/* lines of the range in the file as it is on db */
+	begin_line = sdb_plugin->dirty_begin_line;
+	old_end_line = MAX (sdb_plugin->dirty_end_line - sdb_plugin->dirty_lines_delta,
+	                    begin_line);
+
+	if (!symbol_db_engine_get_buffer_update_range (sdb_plugin->sdbe_project,
+	                                               local_path,
+	                                               &begin_line, &old_end_line))
+		return -1;
+
+	/* lines before begin_line are not changed, they are the same in the
+	 * buffer and on db */
+	begin_line = editor_buffer_symbols_declaration_start (editor, begin_line);
+
+	begin_pos = ianjuta_editor_get_line_begin_position (editor, begin_line, NULL);
+	if (old_end_line < 0)
+	{
+		new_end_line = -1;
+		end_pos = ianjuta_editor_get_end_position (editor, NULL);
+	}
+	else
+	{
+		new_end_line = old_end_line + sdb_plugin->dirty_lines_delta;
+		end_pos = ianjuta_editor_get_line_begin_position (editor, new_end_line + 1,
+		                                                  NULL);
+	}
+
+	if (begin_pos == NULL || end_pos == NULL)
+	{
+		if (begin_pos)
+			g_object_unref (begin_pos);
+		if (end_pos)
+			g_object_unref (end_pos);
+		return -1;
+	}
+
+	text = ianjuta_editor_get_text (editor, begin_pos, end_pos, NULL);
+	g_object_unref (begin_pos);
+	g_object_unref (end_pos);
+
+	DEBUG_PRINT ("updating lines %d-%d (%d-%d on db) of %s", begin_line,
+	             new_end_line, begin_line, old_end_line, local_path);
+
+	proc_id = symbol_db_engine_update_buffer_range_symbols (sdb_plugin->sdbe_project,
+	                                                        sdb_plugin->project_opened,
+	                                                        local_path,
+	                                                        text ? text : "",
+	                                                        text ? strlen (text) : 0,
+	                                                        begin_line,
+	                                                        old_end_line,
+	                                                        new_end_line);
+	g_free (text);
+
+	return proc_id;
+}
+
 static gboolean
 editor_buffer_symbols_update (IAnjutaEditor *editor, SymbolDBPlugin *sdb_plugin)
 {
@@ -373,9 +490,6 @@ editor_buffer_symbols_update (IAnjutaEditor *editor, SymbolDBPlugin *sdb_plugin)
 
 	if (editor) 
 	{
-		buffer_size = ianjuta_editor_get_length (editor, NULL);
-		current_buffer = ianjuta_editor_get_text_all (editor, NULL);
-				
 		file = ianjuta_file_get_file (IANJUTA_FILE (editor), NULL);
 	} 
 	else
@@ -398,28 +512,50 @@ editor_buffer_symbols_update (IAnjutaEditor *editor, SymbolDBPlugin *sdb_plugin)
 			/* hey we found it */
 			/* something is already scanning this buffer file. Drop the procedure now. */
 			DEBUG_PRINT ("something is already scanning the file %s", local_path);
+			g_free (local_path);
+			g_object_unref (file);
 			return FALSE;			
 		}
 	}
 
-	real_files_list = g_ptr_array_new_with_free_func (g_free);
-	g_ptr_array_add (real_files_list, local_path);
-
-	text_buffers = g_ptr_array_new ();
-	g_ptr_array_add (text_buffers, current_buffer);	
-
-	buffer_sizes = g_ptr_array_new ();
-	g_ptr_array_add (buffer_sizes, GINT_TO_POINTER (buffer_size));
-
-
 	proc_id = 0;
 	if (symbol_db_engine_is_connected (sdb_plugin->sdbe_project))
-	{		
-		proc_id = symbol_db_engine_update_buffer_symbols (sdb_plugin->sdbe_project,
-											sdb_plugin->project_opened,
-											real_files_list,
-											text_buffers,
-											buffer_sizes);
+	{
+		proc_id = editor_buffer_symbols_update_range (editor, sdb_plugin,
+		                                              local_path);
+		if (proc_id <= 0)
+		{
+			buffer_size = ianjuta_editor_get_length (editor, NULL);
+			current_buffer = ianjuta_editor_get_text_all (editor, NULL);
+
+			real_files_list = g_ptr_array_new ();
+			g_ptr_array_add (real_files_list, local_path);
+
+			text_buffers = g_ptr_array_new ();
+			g_ptr_array_add (text_buffers, current_buffer);	
+
+			buffer_sizes = g_ptr_array_new ();
+			g_ptr_array_add (buffer_sizes, GINT_TO_POINTER (buffer_size));
+
+			proc_id = symbol_db_engine_update_buffer_symbols (sdb_plugin->sdbe_project,
+												sdb_plugin->project_opened,
+												real_files_list,
+												text_buffers,
+												buffer_sizes);
+			g_ptr_array_unref (real_files_list);
+			g_ptr_array_unref (text_buffers);
+			g_ptr_array_unref (buffer_sizes);
+			g_free (current_buffer);
+		}
+	}
+
+	if (editor == sdb_plugin->current_editor)
+	{
+		/* next changes are tracked from this buffer state */
+		sdb_plugin->dirty_lines_known = proc_id > 0;
+		sdb_plugin->dirty_begin_line = 0;
+		sdb_plugin->dirty_end_line = 0;
+		sdb_plugin->dirty_lines_delta = 0;
 	}
 
 	if (proc_id > 0)
@@ -439,13 +575,9 @@ editor_buffer_symbols_update (IAnjutaEditor *editor, SymbolDBPlugin *sdb_plugin)
 		}
 	}
 
-	g_ptr_array_unref (real_files_list);
-	g_free (current_buffer);  
+	g_free (local_path);
 	g_object_unref (file);
 
-	/* no need to free local_path, it'll be automatically freed later by the buffer_update
-	 * function */
-
 	if(sdb_plugin->buffer_update_files->len > 0)
 		sdb_plugin->need_symbols_update = TRUE;
 
@@ -585,12 +717,69 @@ on_code_added (IAnjutaEditor *editor, IAnjutaIterable *position, gchar *code,
 			   SymbolDBPlugin *sdb_plugin)
 {
 	IAnjutaEditor *old_editor = sdb_plugin->current_editor;
+
+	/* the changed lines tracked are the ones of the current editor */
+	if (editor != old_editor)
+		sdb_plugin->dirty_lines_known = FALSE;
 	sdb_plugin->current_editor = editor;
 	sdb_plugin->need_symbols_update = TRUE;
 	editor_buffer_symbols_update (editor, sdb_plugin);
 	sdb_plugin->current_editor = old_editor;
 }
 
+/* Keeps track of the lines changed in current editor, so that the next
+ * buffer update can be limited to them */
+static void
+on_editor_changed (IAnjutaEditor *editor, IAnjutaIterable *position,
+                   gboolean added, gint length, gint lines, const gchar *text,
+                   SymbolDBPlugin *sdb_plugin)
+{
+	gint line;
+
+	if (editor != sdb_plugin->current_editor ||
+	    sdb_plugin->dirty_lines_known == FALSE)
+		return;
+
+	line = ianjuta_editor_get_line_from_position (editor, position, NULL);
+
+	if (added)
+	{
+		if (sdb_plugin->dirty_begin_line <= 0)
+		{
+			sdb_plugin->dirty_begin_line = line;
+			sdb_plugin->dirty_end_line = line + lines;
+		}
+		else
+		{
+			/* lines after the insertion are moved down */
+			if (sdb_plugin->dirty_end_line >= line)
+				sdb_plugin->dirty_end_line += lines;
+			sdb_plugin->dirty_begin_line = MIN (sdb_plugin->dirty_begin_line, line);
+			sdb_plugin->dirty_end_line = MAX (sdb_plugin->dirty_end_line,
+			                                  line + lines);
+		}
+		sdb_plugin->dirty_lines_delta += lines;
+	}
+	else
+	{
+		if (sdb_plugin->dirty_begin_line <= 0)
+		{
+			sdb_plugin->dirty_begin_line = line;
+			sdb_plugin->dirty_end_line = line;
+		}
+		else
+		{
+			/* lines after the removal are moved up */
+			if (sdb_plugin->dirty_end_line > line)
+				sdb_plugin->dirty_end_line = MAX (sdb_plugin->dirty_end_line - lines,
+				                                  line);
+			sdb_plugin->dirty_begin_line = MIN (sdb_plugin->dirty_begin_line, line);
+			sdb_plugin->dirty_end_line = MAX (sdb_plugin->dirty_end_line, line);
+		}
+		sdb_plugin->dirty_lines_delta -= lines;
+	}
+}
+
 static void
 on_char_added (IAnjutaEditor *editor, IAnjutaIterable *position, gchar ch,
 			   SymbolDBPlugin *sdb_plugin)
@@ -662,6 +851,11 @@ on_editor_saved (IAnjutaEditor *editor, GFile* file,
 
 	/* if we saved it we shouldn't update a second time */
 	sdb_plugin->need_symbols_update = FALSE;
+
+	/* the file is scanned again as a whole, next buffer update must not
+	 * rely on the symbols lines until then */
+	if (editor == sdb_plugin->current_editor)
+		sdb_plugin->dirty_lines_known = FALSE;
 	
 	on_editor_update_ui (editor, sdb_plugin);
 	g_free (saved_uri);
@@ -768,6 +962,9 @@ value_added_current_editor (AnjutaPlugin *plugin, const char *name,
 		g_signal_connect (G_OBJECT (editor), "code-changed",
 						  G_CALLBACK (on_code_added),
 						  sdb_plugin);
+		g_signal_connect (G_OBJECT (editor), "changed",
+						  G_CALLBACK (on_editor_changed),
+						  sdb_plugin);
 		g_signal_connect (G_OBJECT(editor), "update_ui",
 						  G_CALLBACK (on_editor_update_ui),
 						  sdb_plugin);
@@ -776,6 +973,9 @@ value_added_current_editor (AnjutaPlugin *plugin, const char *name,
 	g_free (local_path);
 	
 	sdb_plugin->need_symbols_update = FALSE;
+
+	/* changes made while the editor was not current are unknown */
+	sdb_plugin->dirty_lines_known = FALSE;
 }
 
 static void
@@ -793,6 +993,9 @@ on_editor_foreach_disconnect (gpointer key, gpointer value, gpointer user_data)
 	g_signal_handlers_disconnect_by_func (G_OBJECT(key),
 										  G_CALLBACK (on_code_added),
 										  user_data);
+	g_signal_handlers_disconnect_by_func (G_OBJECT(key),
+										  G_CALLBACK (on_editor_changed),
+										  user_data);
 	g_object_weak_unref (G_OBJECT(key),
 						 (GWeakNotify) (on_editor_destroy),
 						 user_data);
@@ -968,6 +1171,222 @@ do_add_new_files (SymbolDBPlugin *sdb_plugin, const GPtrArray *sources_array,
 	return proc_id > 0 ? added_num : -1;
 }
 
+static gboolean
+same_uri (gpointer key, gpointer value, gpointer user_data)
+{
+	return g_strcmp0 (value, user_data) == 0;
+}
+
+static gboolean
+on_dirty_files_flush_timeout (gpointer user_data)
+{
+	SymbolDBPlugin *sdb_plugin;
+	GHashTableIter iter;
+	gpointer key;
+	GPtrArray *files_array;
+	gint proc_id = 0;
+
+	sdb_plugin = ANJUTA_PLUGIN_SYMBOL_DB (user_data);
+
+	/* let the running scans end first */
+	if (sdb_plugin->is_project_importing || sdb_plugin->is_project_updating ||
+	    sdb_plugin->is_offline_scanning)
+		return TRUE;
+
+	sdb_plugin->dirty_files_timeout_id = 0;
+	
+	files_array = g_ptr_array_new_with_free_func (g_free);
+	g_hash_table_iter_init (&iter, sdb_plugin->dirty_files);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		gchar *uri;
+		gboolean is_open = FALSE;
+
+		/* removed files are managed by the project manager */
+		if (!g_file_test (key, G_FILE_TEST_IS_REGULAR))
+			continue;
+
+		/* opened files are kept up to date by the buffer updates */
+		if (sdb_plugin->editor_connected && 
+		    (uri = g_filename_to_uri (key, NULL, NULL)) != NULL)
+		{
+			is_open = g_hash_table_find (sdb_plugin->editor_connected, 
+			                             same_uri, uri) != NULL;
+			g_free (uri);
+		}
+
+		if (!is_open)
+			g_ptr_array_add (files_array, g_strdup (key));
+	}
+	g_hash_table_remove_all (sdb_plugin->dirty_files);
+
+	DEBUG_PRINT ("%d files changed on disk", files_array->len);
+	if (files_array->len > 0 &&
+	    symbol_db_engine_is_connected (sdb_plugin->sdbe_project))
+	{
+		proc_id = symbol_db_engine_update_files_symbols (sdb_plugin->sdbe_project, 
+		                                                 sdb_plugin->project_opened,
+		                                                 files_array, FALSE);
+	}
+
+	if (proc_id > 0)
+	{		
+		/* add a task so that scan_end_manager can manage this */
+		g_tree_insert (sdb_plugin->proc_id_tree, GINT_TO_POINTER (proc_id),
+					   GINT_TO_POINTER (TASK_FILE_UPDATE));
+	}
+	
+	g_ptr_array_unref (files_array);
+	return FALSE;
+}
+
+static void
+on_source_dir_changed (GFileMonitor *monitor, GFile *file, GFile *other_file,
+                       GFileMonitorEvent event_type, SymbolDBPlugin *sdb_plugin)
+{
+	gchar *filename;
+	
+	switch (event_type)
+	{
+		case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		case G_FILE_MONITOR_EVENT_CREATED:
+			break;
+		case G_FILE_MONITOR_EVENT_MOVED:
+			/* the destination of a rename, e.g. an editor saving through a 
+			 * temporary file */
+			file = other_file;
+			break;
+		default:
+			return;
+	}
+
+	if (file == NULL || (filename = g_file_get_path (file)) == NULL)
+		return;
+
+	if (g_hash_table_contains (sdb_plugin->watched_files, filename))
+	{
+		g_hash_table_add (sdb_plugin->dirty_files, filename);
+
+		if (sdb_plugin->dirty_files_timeout_id > 0)
+			g_source_remove (sdb_plugin->dirty_files_timeout_id);
+		sdb_plugin->dirty_files_timeout_id = 
+			g_timeout_add_seconds (DIRTY_FILES_FLUSH_DELAY, 
+			                       on_dirty_files_flush_timeout, sdb_plugin);
+	}
+	else
+		g_free (filename);
+}
+
+static void
+source_dir_monitor_free (GFileMonitor *monitor)
+{
+	g_file_monitor_cancel (monitor);
+	g_object_unref (monitor);
+}
+
+/* adds @filename to the watched sources, monitoring its directory if it isn't
+ * already */
+static void
+do_watch_source_file (SymbolDBPlugin *sdb_plugin, const gchar *filename)
+{
+	gchar *dirname;
+	
+	g_hash_table_add (sdb_plugin->watched_files, g_strdup (filename));
+
+	dirname = g_path_get_dirname (filename);
+	if (!g_hash_table_contains (sdb_plugin->source_dir_monitors, dirname))
+	{
+		GFile *dir;
+		GFileMonitor *monitor;
+
+		dir = g_file_new_for_path (dirname);
+		monitor = g_file_monitor_directory (dir, G_FILE_MONITOR_SEND_MOVED, 
+		                                    NULL, NULL);
+		g_object_unref (dir);
+
+		if (monitor != NULL)
+		{
+			g_signal_connect (monitor, "changed",
+			                  G_CALLBACK (on_source_dir_changed), sdb_plugin);
+			g_hash_table_insert (sdb_plugin->source_dir_monitors, dirname,
+			                     monitor);
+			return;
+		}
+	}
+	g_free (dirname);
+}
+
+/**
+ * do_watch_project_sources:
+ * @sdb_plugin: self
+ * @pm: the project manager
+ * 
+ * Monitors the directories of the project sources, so that the files changed
+ * on disk while the project is open are scanned again and the check at the
+ * next opening finds them up to date.
+ */
+static void
+do_watch_project_sources (SymbolDBPlugin *sdb_plugin, IAnjutaProjectManager *pm)
+{
+	GList *prj_elements_list;
+	GList *node;
+	
+	if (sdb_plugin->source_dir_monitors == NULL)
+	{
+		sdb_plugin->source_dir_monitors = 
+			g_hash_table_new_full (g_str_hash, g_str_equal, g_free, 
+			                       (GDestroyNotify) source_dir_monitor_free);
+		sdb_plugin->watched_files = g_hash_table_new_full (g_str_hash, 
+		                                                   g_str_equal, 
+		                                                   g_free, NULL);
+		sdb_plugin->dirty_files = g_hash_table_new_full (g_str_hash, g_str_equal,
+		                                                 g_free, NULL);
+	}
+
+	prj_elements_list = ianjuta_project_manager_get_elements (pm,
+		   ANJUTA_PROJECT_SOURCE, NULL);
+
+	for (node = prj_elements_list; node != NULL; node = g_list_next (node))
+	{
+		GFile *gfile = node->data;
+		gchar *filename;
+		
+		if (gfile == NULL)
+			continue;
+
+		if ((filename = g_file_get_path (gfile)) != NULL)
+		{
+			do_watch_source_file (sdb_plugin, filename);
+			g_free (filename);
+		}
+		g_object_unref (gfile);
+	}
+	g_list_free (prj_elements_list);
+
+	DEBUG_PRINT ("watching %d source directories", 
+	             g_hash_table_size (sdb_plugin->source_dir_monitors));
+}
+
+static void
+do_unwatch_project_sources (SymbolDBPlugin *sdb_plugin)
+{
+	if (sdb_plugin->dirty_files_timeout_id > 0)
+	{
+		g_source_remove (sdb_plugin->dirty_files_timeout_id);
+		sdb_plugin->dirty_files_timeout_id = 0;
+	}
+
+	if (sdb_plugin->source_dir_monitors == NULL)
+		return;
+	
+	g_hash_table_destroy (sdb_plugin->source_dir_monitors);
+	g_hash_table_destroy (sdb_plugin->watched_files);
+	g_hash_table_destroy (sdb_plugin->dirty_files);
+	sdb_plugin->source_dir_monitors = NULL;
+	sdb_plugin->watched_files = NULL;
+	sdb_plugin->dirty_files = NULL;
+}
+
 static void
 on_project_element_added (IAnjutaProjectManager *pm, GFile *gfile,
 						  SymbolDBPlugin *sdb_plugin)
@@ -981,6 +1400,9 @@ on_project_element_added (IAnjutaProjectManager *pm, GFile *gfile,
 
 	filename = g_file_get_path (gfile);
 
+	if (sdb_plugin->watched_files != NULL && filename != NULL)
+		do_watch_source_file (sdb_plugin, filename);
+
 	files_array = g_ptr_array_new_with_free_func (g_free);
 	g_ptr_array_add (files_array, filename);
 
@@ -1426,14 +1848,6 @@ do_check_offline_files_changed (SymbolDBPlugin *sdb_plugin)
 			continue;
 		}
 		
-		/* test its existence */
-		if (g_file_query_exists (gfile, NULL) == FALSE) 
-		{
-			g_object_unref (gfile);
-
-			continue;
-		}
-
 		/* Use g_hash_table_replace instead of g_hash_table_insert because the key
 		 * and the value use the same block of memory, both must be changed at
 		 * the same time. */
@@ -1484,19 +1898,19 @@ do_check_offline_files_changed (SymbolDBPlugin *sdb_plugin)
 	to_add_files = g_ptr_array_new ();
 	if (g_hash_table_size (prj_elements_hash) > 0)
 	{
-		gint i;
-		GList *keys = g_hash_table_get_keys (prj_elements_hash);		
-		
+		GHashTableIter iter;
+		gpointer filename;
+
 		/* get all the nodes from the hash table and add them to the wannabe-added 
-		 * array
+		 * array. Only the files not on db yet need to be tested, the others
+		 * are checked by the update of the project symbols
 		 */
-		for (i = 0; i < g_hash_table_size (prj_elements_hash); i++)
+		g_hash_table_iter_init (&iter, prj_elements_hash);
+		while (g_hash_table_iter_next (&iter, NULL, &filename))
 		{
-			/*DEBUG_PRINT ("ARRAY ADD %s", (gchar*)g_list_nth_data (keys, i));*/
-			g_ptr_array_add (to_add_files,
-			                 g_hash_table_lookup (prj_elements_hash,
-			                                      g_list_nth_data (keys, i)));
-		}		
+			if (g_file_test (filename, G_FILE_TEST_EXISTS))
+				g_ptr_array_add (to_add_files, filename);
+		}
 	}
 
 	/* good. Let's go on with add of new files. */
@@ -1651,6 +2065,9 @@ on_project_loaded (IAnjutaProjectManager *pm, GError *error,
 			DEBUG_PRINT ("no changes. Skipping.");
 		}
 	}
+
+	/* keep the symbols up to date with the changes done outside anjuta */
+	do_watch_project_sources (sdb_plugin, pm);
 }
 
 /* add a new project */
@@ -1803,6 +2220,8 @@ on_project_root_removed (AnjutaPlugin *plugin, const gchar *name,
 										  on_project_element_removed,
 										  sdb_plugin);
 
+	do_unwatch_project_sources (sdb_plugin);
+
 	/* don't forget to close the project */
 	symbol_db_engine_close_db (sdb_plugin->sdbe_project);
 	
@@ -1947,6 +2366,21 @@ on_isymbol_manager_prj_scan_end (SymbolDBEngine *dbe,
 	g_signal_emit_by_name (sm, "prj-scan-end", process_id);
 }
 
+static void
+on_isymbol_manager_prj_symbol_changed (SymbolDBEngine *dbe,
+                                       gint symbol_id,
+                                       IAnjutaSymbolManager *sm)
+{
+	g_signal_emit_by_name (sm, "prj-symbol-changed", symbol_id);
+}
+
+static void
+on_isymbol_manager_prj_db_disconnected (SymbolDBEngine *dbe,
+                                        IAnjutaSymbolManager *sm)
+{
+	g_signal_emit_by_name (sm, "prj-symbol-changed", -1);
+}
+
 static void
 on_isymbol_manager_sys_scan_begin (SymbolDBEngine *dbe, gint process_id, 
                                    SymbolDBPlugin *sdb_plugin)
@@ -2084,6 +2518,12 @@ symbol_db_activate (AnjutaPlugin *plugin)
 	}
 	
 	g_free (ctags_path);
+
+	/* files parsed in parallel by the engines, 0 means one per processor */
+	symbol_db_engine_set_ctags_workers (sdb_plugin->sdbe_project,
+	    g_settings_get_int (sdb_plugin->settings, SCAN_WORKERS));
+	symbol_db_engine_set_ctags_workers (sdb_plugin->sdbe_globals,
+	    g_settings_get_int (sdb_plugin->settings, SCAN_WORKERS));
 	
 	/* open it */
 	anjuta_cache_path = anjuta_util_get_user_cache_file_path (".", NULL);
@@ -2123,6 +2563,18 @@ symbol_db_activate (AnjutaPlugin *plugin)
 
 	g_signal_connect (G_OBJECT (sdb_plugin->sdbe_project), "scan-end",
 				G_CALLBACK (on_isymbol_manager_prj_scan_end), sdb_plugin);
+
+	g_signal_connect (G_OBJECT (sdb_plugin->sdbe_project), "symbol-updated",
+				G_CALLBACK (on_isymbol_manager_prj_symbol_changed), sdb_plugin);
+
+	g_signal_connect (G_OBJECT (sdb_plugin->sdbe_project), "symbol-scope-updated",
+				G_CALLBACK (on_isymbol_manager_prj_symbol_changed), sdb_plugin);
+
+	g_signal_connect (G_OBJECT (sdb_plugin->sdbe_project), "symbol-removed",
+				G_CALLBACK (on_isymbol_manager_prj_symbol_changed), sdb_plugin);
+
+	g_signal_connect (G_OBJECT (sdb_plugin->sdbe_project), "db-disconnected",
+				G_CALLBACK (on_isymbol_manager_prj_db_disconnected), sdb_plugin);
 	
 	/* connect signals for interface to receive them */
 	g_signal_connect (G_OBJECT (sdb_plugin->sdbe_globals), "single-file-scan-end",
@@ -2350,6 +2802,12 @@ symbol_db_deactivate (AnjutaPlugin *plugin)
 	g_signal_handlers_disconnect_by_func (G_OBJECT (sdb_plugin->sdbe_project),
 				G_CALLBACK (on_isymbol_manager_prj_scan_end), plugin);
 
+	g_signal_handlers_disconnect_by_func (G_OBJECT (sdb_plugin->sdbe_project),
+				G_CALLBACK (on_isymbol_manager_prj_symbol_changed), plugin);
+
+	g_signal_handlers_disconnect_by_func (G_OBJECT (sdb_plugin->sdbe_project),
+				G_CALLBACK (on_isymbol_manager_prj_db_disconnected), plugin);
+
 	g_signal_handlers_disconnect_by_func (G_OBJECT (pm),
 	    		G_CALLBACK (on_project_element_added), plugin);
 
@@ -2433,6 +2891,8 @@ symbol_db_deactivate (AnjutaPlugin *plugin)
 		sdb_plugin->editors = NULL;
 	}
 	
+	do_unwatch_project_sources (sdb_plugin);
+	
 	// FIXME
 	g_tree_destroy (sdb_plugin->proc_id_tree);
 	
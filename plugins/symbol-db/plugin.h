@@ -85,6 +85,13 @@ struct _SymbolDBPlugin {
 	GTimer *update_timer;
 	GPtrArray *buffer_update_files;
 	GPtrArray *buffer_update_ids;
+	/* lines of the current editor changed since its last buffer update, in
+	 * buffer coordinates. dirty_begin_line is 0 if nothing changed. When 
+	 * dirty_lines_known is FALSE the whole buffer is updated */
+	gboolean dirty_lines_known;
+	gint dirty_begin_line;
+	gint dirty_end_line;
+	gint dirty_lines_delta;
 	gboolean buffer_update_semaphore;		/* it monitors the update status of the
 	 										 * buffer _and_ the editor switching.
 	 										 * A new page cannot be updated with the
@@ -96,6 +103,15 @@ struct _SymbolDBPlugin {
 	gchar *project_root_dir;
 	gchar *project_opened;
 	gboolean needs_sources_scan;
+
+	/* project sources changed on disk outside the editors. The directories of
+	 * the sources are monitored while the project is open, dirty_files is 
+	 * flushed to the engine DIRTY_FILES_FLUSH_DELAY seconds after the last
+	 * change */
+	GHashTable *source_dir_monitors;		/* dir path -> GFileMonitor */
+	GHashTable *watched_files;				/* source paths */
+	GHashTable *dirty_files;
+	guint dirty_files_timeout_id;
 	
 	/* Symbol's engine connection to database. Instance for local project */
 	SymbolDBEngine *sdbe_project;
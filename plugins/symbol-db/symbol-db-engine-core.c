@@ -38,6 +38,7 @@
 #include <regex.h>
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <libanjuta/interfaces/ianjuta-symbol.h>
 #include <libanjuta/anjuta-debug.h>
 #include <libanjuta/anjuta-launcher.h>
@@ -96,6 +97,50 @@ typedef struct _TableMapSymbol {
 
 } TableMapSymbol;
 
+/* New symbols waiting to be inserted, stored by column. Strings are kept
+ * in a chunk released after each flush. */
+struct _SymbolBatch {
+	gint n_rows;
+	GStringChunk *strings;
+	
+	gint file_defined_id[SYMBOL_BATCH_ROWS];
+	const gchar *name[SYMBOL_BATCH_ROWS];
+	gint file_position[SYMBOL_BATCH_ROWS];
+	gint is_file_scope[SYMBOL_BATCH_ROWS];
+	const gchar *signature[SYMBOL_BATCH_ROWS];
+	const gchar *returntype[SYMBOL_BATCH_ROWS];
+	gint scope_definition_id[SYMBOL_BATCH_ROWS];
+	const gchar *type_type[SYMBOL_BATCH_ROWS];
+	const gchar *type_name[SYMBOL_BATCH_ROWS];
+	gint kind_id[SYMBOL_BATCH_ROWS];
+	gint access_kind_id[SYMBOL_BATCH_ROWS];
+	gint implementation_kind_id[SYMBOL_BATCH_ROWS];
+
+	/* heritage and scope fields, pushed for the second pass once the
+	 * symbol id is known */
+	TableMapTmpHeritage *tmp_heritage[SYMBOL_BATCH_ROWS];
+};
+
+/* A multi row insert statement with its holders, SYMBOL_BATCH_COLUMNS for
+ * each row */
+struct _SymbolBatchQuery {
+	GdaStatement *stmt;
+	GdaSet *plist;
+	GdaHolder **holders;
+};
+
+/* A scan of a range of lines of a buffer. The symbols outside the range are
+ * marked when the scan of the buffer starts. */
+typedef struct _BufferRangeUpdate {
+	gint scan_id;
+	gchar *file_on_db;
+	gint begin_line;
+	gint old_end_line;
+	gint lines_delta;
+	gboolean prepared;
+	
+} BufferRangeUpdate;
+
 typedef struct _EngineScanDataAsync {
 	GPtrArray *files_list;
 	GPtrArray *real_files_list;
@@ -130,9 +175,7 @@ enum
  */
 enum {
 	DO_UPDATE_SYMS = 1,
-	DO_UPDATE_SYMS_AND_EXIT,
 	DONT_UPDATE_SYMS,
-	DONT_UPDATE_SYMS_AND_EXIT,
 	DONT_FAKE_UPDATE_SYMS,
 	END_UPDATE_GROUP_SYMS
 };
@@ -148,12 +191,24 @@ typedef struct _UpdateFileSymbolsData {
 	
 } UpdateFileSymbolsData;
 
+/* The state of a project file when its scan started. It's recorded on db
+ * once the file is scanned. */
+typedef struct _ScanFileStat {
+	gchar *abs_path;
+	gint64 size;
+	gint64 mtime;
+	gint64 inode;
+	gchar *hash;
+	gboolean record;
+	gboolean hash_needed;
+
+} ScanFileStat;
+
 typedef struct _ScanFiles1Data {
 	SymbolDBEngine *dbe;
+	SdbCtagsWorker *worker;
 	
 	gchar *real_file;	/* may be NULL. If not NULL must be freed */
-	gint partial_count;
-	gint files_list_len;
 	gint symbols_update;
 	
 } ScanFiles1Data;
@@ -181,6 +236,19 @@ static gint
 sdb_engine_add_new_symbol (SymbolDBEngine * dbe, const tagEntry * tag_entry,
 						   int file_defined_id, gboolean sym_update);
 
+static void
+sdb_engine_queue_new_symbol (SymbolDBEngine *dbe, const tagEntry *tag_entry,
+							 gint file_defined_id);
+
+static void
+sdb_engine_symbol_batch_flush (SymbolDBEngine *dbe);
+
+static void
+sdb_engine_prepare_range_update (SymbolDBEngine *dbe, gint scan_id);
+
+static void
+sdb_engine_record_scanned_files (SymbolDBEngine *dbe, GPtrArray *scanned_files);
+
 const GdaStatement *
 sdb_engine_get_statement_by_query_id (SymbolDBEngine * dbe, static_query_type query_id);
 
@@ -245,6 +313,61 @@ sdb_engine_scan_data_destroy (gpointer data)
 	g_free (esda);
 }
 
+static void
+sdb_engine_range_update_free (gpointer data)
+{
+	BufferRangeUpdate *range = (BufferRangeUpdate *)data;
+
+	g_free (range->file_on_db);
+	g_free (range);
+}
+
+static SymbolBatch *
+sdb_engine_symbol_batch_new (void)
+{
+	SymbolBatch *batch;
+
+	batch = g_new0 (SymbolBatch, 1);
+	batch->strings = g_string_chunk_new (4096);
+
+	return batch;
+}
+
+static void
+sdb_engine_symbol_batch_clear (SymbolBatch *batch)
+{
+	gint i;
+
+	for (i = 0; i < batch->n_rows; i++)
+	{
+		if (batch->tmp_heritage[i] != NULL)
+			sdb_engine_tablemap_tmp_heritage_destroy (batch->tmp_heritage[i]);
+		batch->tmp_heritage[i] = NULL;
+	}
+
+	g_string_chunk_clear (batch->strings);
+	batch->n_rows = 0;
+}
+
+static void
+sdb_engine_symbol_batch_free (SymbolBatch *batch)
+{
+	sdb_engine_symbol_batch_clear (batch);
+	g_string_chunk_free (batch->strings);
+	g_free (batch);
+}
+
+static void
+sdb_engine_symbol_batch_query_free (SymbolBatchQuery *query)
+{
+	if (query->stmt)
+		g_object_unref (query->stmt);
+	if (query->plist)
+		g_object_unref (query->plist);
+	g_free (query->holders);
+	g_free (query);
+}
+
 static void
 sdb_engine_clear_tablemaps (SymbolDBEngine *dbe)
 {
@@ -275,11 +398,14 @@ sdb_engine_clear_caches (SymbolDBEngine* dbe)
 		g_hash_table_destroy (priv->implementation_cache);
 	if (priv->language_cache)
 		g_hash_table_destroy (priv->language_cache);
+	if (priv->scope_cache)
+		g_hash_table_destroy (priv->scope_cache);
 	
 	priv->kind_cache = NULL;
 	priv->access_cache = NULL;
 	priv->implementation_cache = NULL;
 	priv->language_cache = NULL;
+	priv->scope_cache = NULL;
 }
 
 static void
@@ -314,6 +440,13 @@ sdb_engine_init_caches (SymbolDBEngine* dbe)
 	    									g_str_equal,
 	    									g_free,
 	    									NULL);
+
+	/* scope rows are deleted together with the symbols defining them: this
+	 * cache is valid only during a scan */
+	priv->scope_cache = g_hash_table_new_full (g_str_hash,
+	    									g_str_equal,
+	    									g_free,
+	    									NULL);
 }
 
 /* ~~~ Thread note: this function locks the mutex ~~~ */ 
@@ -513,6 +646,13 @@ sdb_engine_free_cached_queries (SymbolDBEngine *dbe)
 		g_free (node);
 		priv->static_query_list[i] = NULL;
 	}
+
+	for (i = 0; i <= SYMBOL_BATCH_ROWS; i++)
+	{
+		if (priv->symbol_batch_queries[i] != NULL)
+			sdb_engine_symbol_batch_query_free (priv->symbol_batch_queries[i]);
+		priv->symbol_batch_queries[i] = NULL;
+	}
 }
 
 static gboolean
@@ -839,6 +979,7 @@ sdb_engine_populate_db_by_tags (SymbolDBEngine * dbe, FILE* fd,
 			/* if we aren't at the first cycle then we can commit the transaction */
 			if (priv->symbols_scanned_count > 1)
 			{
+				sdb_engine_symbol_batch_flush (dbe);
 				gda_connection_commit_transaction (priv->db_connection, "symboltrans",
 					&error);
 
@@ -862,8 +1003,11 @@ sdb_engine_populate_db_by_tags (SymbolDBEngine * dbe, FILE* fd,
 		}
 		
 		/* insert or update a symbol */
-		sdb_engine_add_new_symbol (dbe, &tag_entry, file_defined_id,
-								   force_sym_update);
+		if (force_sym_update == FALSE)
+			sdb_engine_queue_new_symbol (dbe, &tag_entry, file_defined_id);
+		else
+			sdb_engine_add_new_symbol (dbe, &tag_entry, file_defined_id,
+									   force_sym_update);
 #ifdef DEBUG
 		tags_num_DEBUG++;
 #endif		
@@ -882,6 +1026,9 @@ sdb_engine_populate_db_by_tags (SymbolDBEngine * dbe, FILE* fd,
 */				 
 #endif
 	
+	/* the symbols of the file have to be on db when listeners are notified */
+	sdb_engine_symbol_batch_flush (dbe);
+
 	/* notify listeners that another file has been scanned */
 	DBESignal *dbesig = g_slice_new0 (DBESignal);
 	dbesig->value = GINT_TO_POINTER (SINGLE_FILE_SCAN_END +1);
@@ -892,208 +1039,229 @@ sdb_engine_populate_db_by_tags (SymbolDBEngine * dbe, FILE* fd,
 	/* we've done with tag_file but we don't need to tagsClose (tag_file); */
 }
 
-/* ~~~ Thread note: this function locks the mutex ~~~ */ 
+/**
+ * ### Thread note: this function inherits the mutex lock ###
+ *
+ * All the files of the current scan have been populated. Do the second pass
+ * and queue the signals for the listeners.
+ */
 static void
-sdb_engine_ctags_output_thread (gpointer data, gpointer user_data)
+sdb_engine_scan_group_end (SymbolDBEngine *dbe)
 {
-	gint len_chars;
-	gchar *chars, *chars_ptr;
-	gint remaining_chars;
-	gint len_marker;
 	SymbolDBEnginePriv *priv;
-	SymbolDBEngine *dbe;
-	
-	chars = chars_ptr = (gchar *)data;
-	dbe = SYMBOL_DB_ENGINE (user_data);
-	
-	g_return_if_fail (dbe != NULL);	
-	g_return_if_fail (chars_ptr != NULL);
+	DBESignal *dbesig;
+	gint tmp_inserted;
+	gint tmp_updated;
 
 	priv = dbe->priv;
 
-	SDB_LOCK(priv);
+	/* scan has ended. Go go with second step. */
+	DEBUG_PRINT ("%s", "FOUND end-of-group-files marker.");
+
+	/* all the symbols have to be on db before resolving scopes and
+	 * inheritances */
+	sdb_engine_symbol_batch_flush (dbe);
+	g_hash_table_remove_all (priv->scope_cache);
+
+	/* will emit symbol_scope_updated and will flush on disk 
+	 * tablemaps
+	 */
+	sdb_engine_second_pass_do (dbe);					
 	
-	remaining_chars = len_chars = strlen (chars_ptr);
-	len_marker = strlen (CTAGS_MARKER);	
+	/* Here we are. It's the right time to notify the listeners
+	 * about out fresh new inserted/updated symbols...
+	 * Go on by emitting them.
+	 */
+	while ((tmp_inserted = GPOINTER_TO_INT(
+			g_async_queue_try_pop (priv->inserted_syms_id_aqueue))) > 0)
+	{
+		/* we must be sure to insert both signals at once */
+		g_async_queue_lock (priv->signals_aqueue);
 
-	/*DEBUG_PRINT ("program output [new version]: ==>%s<==", chars);*/
-	if (len_chars >= len_marker) 
+		DBESignal *dbesig1 = g_slice_new0 (DBESignal);
+		DBESignal *dbesig2 = g_slice_new0 (DBESignal);
+		
+		dbesig1->value = GINT_TO_POINTER (SYMBOL_INSERTED + 1);
+		dbesig1->process_id = priv->current_scan_process_id;
+
+		dbesig2->value = GINT_TO_POINTER (tmp_inserted);
+		dbesig2->process_id = priv->current_scan_process_id;
+		
+		g_async_queue_push_unlocked (priv->signals_aqueue, 
+									 dbesig1);
+		g_async_queue_push_unlocked (priv->signals_aqueue, 
+									 dbesig2);
+		
+		g_async_queue_unlock (priv->signals_aqueue);
+	}
+		
+	while ((tmp_updated = GPOINTER_TO_INT(
+			g_async_queue_try_pop (priv->updated_syms_id_aqueue))) > 0)
 	{
-		gchar *marker_ptr = NULL;
-		gint tmp_str_length = 0;
+		g_async_queue_lock (priv->signals_aqueue);
 
-		/* is it an end file marker? */
-		marker_ptr = strstr (chars_ptr, CTAGS_MARKER);
+		DBESignal *dbesig1 = g_slice_new0 (DBESignal);
+		DBESignal *dbesig2 = g_slice_new0 (DBESignal);
 
-		do  
-		{
-			if (marker_ptr != NULL) 
-			{
-				int scan_flag;
-				gchar *real_file;
+		dbesig1->value = GINT_TO_POINTER (SYMBOL_UPDATED + 1);
+		dbesig1->process_id = priv->current_scan_process_id;
+
+		dbesig2->value = GINT_TO_POINTER (tmp_updated);
+		dbesig2->process_id = priv->current_scan_process_id;
 		
-				/* set the length of the string parsed */
-				tmp_str_length = marker_ptr - chars_ptr;
-	
-				/* write to shm_file all the chars_ptr received without the marker ones */
-				fwrite (chars_ptr, sizeof(gchar), tmp_str_length, priv->shared_mem_file);
+		g_async_queue_push_unlocked (priv->signals_aqueue, dbesig1);
+		g_async_queue_push_unlocked (priv->signals_aqueue, dbesig2);
+		g_async_queue_unlock (priv->signals_aqueue);
+	}
 
-				chars_ptr = marker_ptr + len_marker;
-				remaining_chars -= (tmp_str_length + len_marker);
-				fflush (priv->shared_mem_file);
-				
-				/* get the scan flag from the queue. We need it to know whether
-				 * an update of symbols must be done or not */
-				DBESignal *dbesig = g_async_queue_try_pop (priv->scan_aqueue);
-				scan_flag = GPOINTER_TO_INT(dbesig->value);
-				g_slice_free (DBESignal, dbesig);
-
-				dbesig = g_async_queue_try_pop (priv->scan_aqueue);
-				real_file = dbesig->value;
-				g_slice_free (DBESignal, dbesig);
-				
-				/* and now call the populating function */
-				if (scan_flag == DO_UPDATE_SYMS ||
-					scan_flag == DO_UPDATE_SYMS_AND_EXIT)
-				{
-					sdb_engine_populate_db_by_tags (dbe, priv->shared_mem_file,
-								(gsize)real_file == DONT_FAKE_UPDATE_SYMS ? NULL : real_file, 
-								TRUE);
-				}
-				else 
-				{
-					sdb_engine_populate_db_by_tags (dbe, priv->shared_mem_file,
-								(gsize)real_file == DONT_FAKE_UPDATE_SYMS ? NULL : real_file, 
-								FALSE);					
-				}
-				
-				/* don't forget to free the real_file, if it's a char */
-				if ((gsize)real_file != DONT_FAKE_UPDATE_SYMS)
-					g_free (real_file);
-				
-				/* check also if, together with an end file marker, we have an 
-				 * end group-of-files end marker.
-				 */
-				if (scan_flag == DO_UPDATE_SYMS_AND_EXIT || 
-					 scan_flag == DONT_UPDATE_SYMS_AND_EXIT )
-				{
-					gint tmp_inserted;
-					gint tmp_updated;
+	while ((tmp_updated = GPOINTER_TO_INT(
+			g_async_queue_try_pop (priv->updated_scope_syms_id_aqueue))) > 0)
+	{
+		g_async_queue_lock (priv->signals_aqueue);
 
-					/* scan has ended. Go go with second step. */
-					DEBUG_PRINT ("%s", "FOUND end-of-group-files marker.");
-					
-					chars_ptr += len_marker;
-					remaining_chars -= len_marker;
-					
-					/* will emit symbol_scope_updated and will flush on disk 
-					 * tablemaps
-					 */
-					sdb_engine_second_pass_do (dbe);					
-					
-					/* Here we are. It's the right time to notify the listeners
-					 * about out fresh new inserted/updated symbols...
-					 * Go on by emitting them.
-					 */
-					while ((tmp_inserted = GPOINTER_TO_INT(
-							g_async_queue_try_pop (priv->inserted_syms_id_aqueue))) > 0)
-					{
-						/* we must be sure to insert both signals at once */
-						g_async_queue_lock (priv->signals_aqueue);
+		DBESignal *dbesig1 = g_slice_new0 (DBESignal);
+		DBESignal *dbesig2 = g_slice_new0 (DBESignal);
 
-						DBESignal *dbesig1 = g_slice_new0 (DBESignal);
-						DBESignal *dbesig2 = g_slice_new0 (DBESignal);
-						
-						dbesig1->value = GINT_TO_POINTER (SYMBOL_INSERTED + 1);
-						dbesig1->process_id = priv->current_scan_process_id;
+		dbesig1->value = GINT_TO_POINTER (SYMBOL_SCOPE_UPDATED + 1);
+		dbesig1->process_id = priv->current_scan_process_id;
 
-						dbesig2->value = GINT_TO_POINTER (tmp_inserted);
-						dbesig2->process_id = priv->current_scan_process_id;
-						
-						g_async_queue_push_unlocked (priv->signals_aqueue, 
-													 dbesig1);
-						g_async_queue_push_unlocked (priv->signals_aqueue, 
-													 dbesig2);
-						
-						g_async_queue_unlock (priv->signals_aqueue);
-					}
+		dbesig2->value = GINT_TO_POINTER (tmp_updated);
+		dbesig2->process_id = priv->current_scan_process_id;
+		
+		g_async_queue_push_unlocked (priv->signals_aqueue, dbesig1);
+		g_async_queue_push_unlocked (priv->signals_aqueue, dbesig2);
+		g_async_queue_unlock (priv->signals_aqueue);
+	}		
 						
-					while ((tmp_updated = GPOINTER_TO_INT(
-							g_async_queue_try_pop (priv->updated_syms_id_aqueue))) > 0)
-					{
-						g_async_queue_lock (priv->signals_aqueue);
+#ifdef DEBUG	
+	if (priv->first_scan_timer_DEBUG != NULL)
+	{
+		DEBUG_PRINT ("~~~~~ TOTAL FIRST SCAN elapsed: %f ",
+		    g_timer_elapsed (priv->first_scan_timer_DEBUG, NULL));
+		g_timer_destroy (priv->first_scan_timer_DEBUG);
+		priv->first_scan_timer_DEBUG = NULL;
+	}
+#endif
 
-						DBESignal *dbesig1 = g_slice_new0 (DBESignal);
-						DBESignal *dbesig2 = g_slice_new0 (DBESignal);
+	dbesig = g_slice_new0 (DBESignal);
 
-						dbesig1->value = GINT_TO_POINTER (SYMBOL_UPDATED + 1);
-						dbesig1->process_id = priv->current_scan_process_id;
+	dbesig->value = GINT_TO_POINTER (SCAN_END + 1);
+	dbesig->process_id = priv->current_scan_process_id;
+	
+	g_async_queue_push (priv->signals_aqueue, dbesig);
+}
 
-						dbesig2->value = GINT_TO_POINTER (tmp_updated);
-						dbesig2->process_id = priv->current_scan_process_id;
-						
-						g_async_queue_push_unlocked (priv->signals_aqueue, dbesig1);
-						g_async_queue_push_unlocked (priv->signals_aqueue, dbesig2);
-						g_async_queue_unlock (priv->signals_aqueue);
-					}
+/* ~~~ Thread note: this function locks the mutex ~~~ */ 
+static void
+sdb_engine_ctags_output_thread (gpointer data, gpointer user_data)
+{
+	gchar *chars, *chars_ptr, *marker_ptr;
+	gint len_marker;
+	SdbCtagsWorker *worker;
+	SymbolDBEnginePriv *priv;
+	SymbolDBEngine *dbe;
+	GPtrArray *scanned_files;
+	
+	dbe = SYMBOL_DB_ENGINE (user_data);
+	
+	g_return_if_fail (dbe != NULL);	
+	g_return_if_fail (data != NULL);
 
-					while ((tmp_updated = GPOINTER_TO_INT(
-							g_async_queue_try_pop (priv->updated_scope_syms_id_aqueue))) > 0)
-					{
-						g_async_queue_lock (priv->signals_aqueue);
+	priv = dbe->priv;
 
-						DBESignal *dbesig1 = g_slice_new0 (DBESignal);
-						DBESignal *dbesig2 = g_slice_new0 (DBESignal);
+	SDB_LOCK(priv);
 
-						dbesig1->value = GINT_TO_POINTER (SYMBOL_SCOPE_UPDATED + 1);
-						dbesig1->process_id = priv->current_scan_process_id;
+	/* the last files of the group have been skipped, there is no marker
+	 * which will close the scan. Do it here. */
+	if (data == GINT_TO_POINTER (END_UPDATE_GROUP_SYMS))
+	{
+		sdb_engine_scan_group_end (dbe);
+		SDB_UNLOCK(priv);
+		return;
+	}
 
-						dbesig2->value = GINT_TO_POINTER (tmp_updated);
-						dbesig2->process_id = priv->current_scan_process_id;
-						
-						g_async_queue_push_unlocked (priv->signals_aqueue, dbesig1);
-						g_async_queue_push_unlocked (priv->signals_aqueue, dbesig2);
-						g_async_queue_unlock (priv->signals_aqueue);
-					}		
-										
-#ifdef DEBUG	
-					if (priv->first_scan_timer_DEBUG != NULL)
-					{
-						DEBUG_PRINT ("~~~~~ TOTAL FIRST SCAN elapsed: %f ",
-						    g_timer_elapsed (priv->first_scan_timer_DEBUG, NULL));
-						g_timer_destroy (priv->first_scan_timer_DEBUG);
-						priv->first_scan_timer_DEBUG = NULL;
-					}
-#endif
-		
-					DBESignal *dbesig1 = g_slice_new0 (DBESignal);
+	worker = (SdbCtagsWorker *) data;
 
-					dbesig1->value = GINT_TO_POINTER (SCAN_END + 1);
-					dbesig1->process_id = priv->current_scan_process_id;
-					
-					g_async_queue_push (priv->signals_aqueue, dbesig1);
-				}
-				
-				/* truncate the file to 0 length */
-				ftruncate (priv->shared_mem_fd, 0);				
-			}
-			else
-			{ 
-				/* marker_ptr is NULL here. We should then exit the loop. */
-				/* write to shm_file all the chars received */
-				fwrite (chars_ptr, sizeof(gchar), remaining_chars, 
-						priv->shared_mem_file);
+	/* take all the output received until now. Doing it with the engine lock
+	 * held keeps the output of a worker in order even if more threads of
+	 * the pool are running.
+	 */
+	g_mutex_lock (&worker->output_mutex);
+	chars = g_string_free (worker->output, FALSE);
+	worker->output = g_string_new (NULL);
+	g_mutex_unlock (&worker->output_mutex);
 
-				fflush (priv->shared_mem_file);
-				break;
-			}
+	chars_ptr = chars;
+	len_marker = strlen (CTAGS_MARKER);	
+	scanned_files = g_ptr_array_new ();
+
+	/*DEBUG_PRINT ("program output [new version]: ==>%s<==", chars);*/
+	while ((marker_ptr = strstr (chars_ptr, CTAGS_MARKER)) != NULL)
+	{
+		DBESignal *dbesig;
+		int scan_flag;
+		gint process_id;
+		gchar *real_file;
+
+		/* write to shm_file all the tags of the file, without the marker */
+		fwrite (chars_ptr, sizeof(gchar), marker_ptr - chars_ptr, 
+				worker->shared_mem_file);
+		fflush (worker->shared_mem_file);
+
+		chars_ptr = marker_ptr + len_marker;
+		
+		/* get the scan flag from the queue. We need it to know whether
+		 * an update of symbols must be done or not */
+		dbesig = g_async_queue_try_pop (worker->scan_aqueue);
+		scan_flag = GPOINTER_TO_INT(dbesig->value);
+		process_id = dbesig->process_id;
+		g_slice_free (DBESignal, dbesig);
+
+		dbesig = g_async_queue_try_pop (worker->scan_aqueue);
+		real_file = dbesig->value;
+		g_slice_free (DBESignal, dbesig);
+
+		dbesig = g_async_queue_try_pop (worker->scan_aqueue);
+		if (dbesig->value != NULL)
+			g_ptr_array_add (scanned_files, dbesig->value);
+		g_slice_free (DBESignal, dbesig);
+
+		/* a range update marks the symbols outside the range only now: the
+		 * scans of the file queued before it are over */
+		if (scan_flag == DO_UPDATE_SYMS)
+			sdb_engine_prepare_range_update (dbe, process_id);
+		
+		/* and now call the populating function */
+		sdb_engine_populate_db_by_tags (dbe, worker->shared_mem_file,
+					(gsize)real_file == DONT_FAKE_UPDATE_SYMS ? NULL : real_file, 
+					scan_flag == DO_UPDATE_SYMS);
+		
+		/* don't forget to free the real_file, if it's a char */
+		if ((gsize)real_file != DONT_FAKE_UPDATE_SYMS)
+			g_free (real_file);
+
+		/* truncate the file to 0 length */
+		ftruncate (worker->shared_mem_fd, 0);				
+		
+		/* was it the last file of the group, for all the workers? */
+		if (g_atomic_int_dec_and_test (&priv->scan_files_pending))
+			sdb_engine_scan_group_end (dbe);
+	}
 
-			/* found out a new marker */ 
-			marker_ptr = strstr (marker_ptr + len_marker, CTAGS_MARKER);
-		} while (remaining_chars + len_marker < len_chars || marker_ptr != NULL);
+	/* keep the tags of a file not completed yet, including a marker which
+	 * may be split between two outputs. New output may have been received
+	 * in the meantime, it comes after this one. */
+	if (*chars_ptr != '\0')
+	{
+		g_mutex_lock (&worker->output_mutex);
+		g_string_prepend (worker->output, chars_ptr);
+		g_mutex_unlock (&worker->output_mutex);
 	}
 	
 	SDB_UNLOCK(priv);
+
+	sdb_engine_record_scanned_files (dbe, scanned_files);
+	g_ptr_array_unref (scanned_files);
 	
 	g_free (chars);
 }
@@ -1235,31 +1403,47 @@ sdb_engine_timeout_trigger_signals (gpointer user_data)
 	return TRUE;
 }
 
+static void
+sdb_engine_start_signals_trigger (SymbolDBEngine *dbe)
+{
+	SymbolDBEnginePriv *priv;
+
+	priv = dbe->priv;
+
+	/* signals monitor */
+	if (priv->timeout_trigger_handler <= 0)
+	{
+		priv->timeout_trigger_handler = 
+			g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, TRIGGER_SIGNALS_DELAY, 
+						   sdb_engine_timeout_trigger_signals, dbe, NULL);
+		priv->trigger_closure_retries = 0;
+	}
+}
+
 static void
 sdb_engine_ctags_output_callback_1 (AnjutaLauncher * launcher,
 								  AnjutaLauncherOutputType output_type,
 								  const gchar * chars, gpointer user_data)
 {
-	SymbolDBEngine *dbe = (SymbolDBEngine *) user_data;
+	SdbCtagsWorker *worker = (SdbCtagsWorker *) user_data;
+	SymbolDBEngine *dbe;
 	SymbolDBEnginePriv *priv;
 
 	g_return_if_fail (user_data != NULL);
 	
+	dbe = worker->dbe;
 	priv = dbe->priv;	
 	
 	if (priv->shutting_down == TRUE)
 		return;
 
-	g_thread_pool_push (priv->thread_pool, g_strdup (chars), NULL);
+	g_mutex_lock (&worker->output_mutex);
+	g_string_append (worker->output, chars);
+	g_mutex_unlock (&worker->output_mutex);
+
+	g_thread_pool_push (priv->thread_pool, worker, NULL);
 	
-	/* signals monitor */
-	if (priv->timeout_trigger_handler <= 0)
-	{
-		priv->timeout_trigger_handler = 
-			g_timeout_add_full (G_PRIORITY_DEFAULT_IDLE, TRIGGER_SIGNALS_DELAY, 
-						   sdb_engine_timeout_trigger_signals, user_data, NULL);
-		priv->trigger_closure_retries = 0;
-	}
+	sdb_engine_start_signals_trigger (dbe);
 }
 
 static void
@@ -1267,12 +1451,12 @@ on_scan_files_end_1 (AnjutaLauncher * launcher, int child_pid,
 				   int exit_status, gulong time_taken_in_seconds,
 				   gpointer user_data)
 {
-	SymbolDBEngine *dbe = (SymbolDBEngine *) user_data;
+	SdbCtagsWorker *worker = (SdbCtagsWorker *) user_data;
 	SymbolDBEnginePriv *priv;
 
 	g_return_if_fail (user_data != NULL);
 	
-	priv = dbe->priv;	
+	priv = worker->dbe->priv;	
 	
 	DEBUG_PRINT ("***** ctags ended (%s) (%s) *****", priv->ctags_path, 
 	    priv->cnc_string);
@@ -1284,34 +1468,108 @@ on_scan_files_end_1 (AnjutaLauncher * launcher, int child_pid,
 }
 
 static void
-sdb_engine_ctags_launcher_create (SymbolDBEngine * dbe)
+sdb_engine_ctags_launcher_create (SdbCtagsWorker *worker)
 {
 	SymbolDBEnginePriv *priv;
 	gchar *exe_string;
 		
-	priv = dbe->priv;
+	priv = worker->dbe->priv;
 	
 	DEBUG_PRINT ("Creating anjuta_launcher with %s for %s", priv->ctags_path, 
 					priv->cnc_string);
 
-	priv->ctags_launcher = anjuta_launcher_new ();
+	worker->ctags_launcher = anjuta_launcher_new ();
 
-	anjuta_launcher_set_check_passwd_prompt (priv->ctags_launcher, FALSE);
-	anjuta_launcher_set_encoding (priv->ctags_launcher, NULL);
+	anjuta_launcher_set_check_passwd_prompt (worker->ctags_launcher, FALSE);
+	anjuta_launcher_set_encoding (worker->ctags_launcher, NULL);
 		
-	g_signal_connect (G_OBJECT (priv->ctags_launcher), "child-exited",
-						  G_CALLBACK (on_scan_files_end_1), dbe);
+	g_signal_connect (G_OBJECT (worker->ctags_launcher), "child-exited",
+						  G_CALLBACK (on_scan_files_end_1), worker);
 
 	exe_string = g_strdup_printf ("%s --sort=no --fields=afmiKlnsStTz --c++-kinds=+p "
 								  "--filter=yes --filter-terminator='"CTAGS_MARKER"'",
 								  priv->ctags_path);
 	DEBUG_PRINT ("Launching %s", exe_string);
-	anjuta_launcher_execute (priv->ctags_launcher,
+	anjuta_launcher_execute (worker->ctags_launcher,
 								 exe_string, sdb_engine_ctags_output_callback_1, 
-								 dbe);
+								 worker);
 	g_free (exe_string);
 }
 
+static SdbCtagsWorker *
+sdb_engine_ctags_worker_new (SymbolDBEngine *dbe)
+{
+	SdbCtagsWorker *worker;
+	gchar *temp_file;
+	gint i = 0;
+
+	worker = g_new0 (SdbCtagsWorker, 1);
+	worker->dbe = dbe;
+	worker->scan_aqueue = g_async_queue_new ();
+	worker->output = g_string_new (NULL);
+	g_mutex_init (&worker->output_mutex);
+
+	/* create the shared memory file */
+	while (TRUE)
+	{
+		temp_file = g_strdup_printf ("/anjuta-%d_%ld%d.tags", getpid (),
+							 time (NULL), i++);
+		gchar *test;
+		test = g_strconcat (SHARED_MEMORY_PREFIX, temp_file, NULL);
+		if (g_file_test (test, G_FILE_TEST_EXISTS) == TRUE)
+		{
+			DEBUG_PRINT ("Temp file %s already exists... retrying", test);
+			g_free (test);
+			g_free (temp_file);
+			continue;
+		}
+		else
+		{
+			g_free (test);
+			break;
+		}
+	}
+
+	worker->shared_mem_str = temp_file;
+	
+	if ((worker->shared_mem_fd = 
+		 shm_open (temp_file, O_CREAT|O_RDWR, S_IRUSR|S_IWUSR)) < 0)
+	{
+		g_error ("Error while trying to open a shared memory file. Be"
+				   "sure to have "SHARED_MEMORY_PREFIX" mounted with tmpfs");
+	}
+
+	worker->shared_mem_file = fdopen (worker->shared_mem_fd, "a+b");
+
+	sdb_engine_ctags_launcher_create (worker);
+
+	return worker;
+}
+
+static void
+sdb_engine_ctags_worker_free (SdbCtagsWorker *worker)
+{
+	if (worker->ctags_launcher)
+		g_object_unref (worker->ctags_launcher);
+
+	if (worker->scan_aqueue)
+		g_async_queue_unref (worker->scan_aqueue);
+
+	if (worker->shared_mem_file) 
+		fclose (worker->shared_mem_file);
+	
+	if (worker->shared_mem_str)
+	{
+		shm_unlink (worker->shared_mem_str);
+		g_free (worker->shared_mem_str);
+	}
+
+	g_string_free (worker->output, TRUE);
+	g_mutex_clear (&worker->output_mutex);
+
+	g_free (worker);
+}
+
 /**
  * A GAsyncReadyCallback function. This function is the async continuation for
  * sdb_engine_scan_files_1 ().
@@ -1324,18 +1582,17 @@ sdb_engine_scan_files_2 (GFile *gfile,
 	ScanFiles1Data *sf_data = (ScanFiles1Data*)user_data;
 	SymbolDBEngine *dbe;
 	SymbolDBEnginePriv *priv;
+	SdbCtagsWorker *worker;
 	GFileInfo *ginfo;
 	gchar *local_path;
 	gchar *real_file;
 	gboolean symbols_update;
-	gint partial_count;
-	gint files_list_len;
+	DBESignal *dbesig;
 
 	dbe = sf_data->dbe;
+	worker = sf_data->worker;
 	symbols_update = sf_data->symbols_update;
 	real_file = sf_data->real_file;
-	files_list_len = sf_data->files_list_len;
-	partial_count = sf_data->partial_count;
 
 	priv = dbe->priv;
 	
@@ -1357,86 +1614,67 @@ sdb_engine_scan_files_2 (GFile *gfile,
 			g_object_unref (ginfo);
 		if (gfile)
 			g_object_unref (gfile);
+
+		/* no output will come for this file. If it was the last one the 
+		 * group must be closed anyway */
+		if (g_atomic_int_dec_and_test (&priv->scan_files_pending))
+		{
+			g_thread_pool_push (priv->thread_pool, 
+								GINT_TO_POINTER (END_UPDATE_GROUP_SYMS), NULL);
+			sdb_engine_start_signals_trigger (dbe);
+		}
 		return;
 	}
 	
-	/* DEBUG_PRINT ("sent to stdin %s", local_path); */
-	anjuta_launcher_send_stdin (priv->ctags_launcher, local_path);
-	anjuta_launcher_send_stdin (priv->ctags_launcher, "\n");
-	
-	if (symbols_update == TRUE) 
-	{
-		DBESignal *dbesig;
-		
-		/* will this be the last file in the list? */
-		if (partial_count + 1 >= files_list_len) 
-		{
-			dbesig = g_slice_new0 (DBESignal);
-			dbesig->value = GINT_TO_POINTER (DO_UPDATE_SYMS_AND_EXIT);
-			dbesig->process_id = priv->current_scan_process_id;
-			
-			/* yes */
-			g_async_queue_push (priv->scan_aqueue, dbesig);
-		}
-		else 
-		{
-			dbesig = g_slice_new0 (DBESignal);
-			dbesig->value = GINT_TO_POINTER (DO_UPDATE_SYMS);
-			dbesig->process_id = priv->current_scan_process_id;
+	/* push the scan flags before sending the file: the output may be
+	 * parsed as soon as it is received */
+	dbesig = g_slice_new0 (DBESignal);
+	dbesig->value = GINT_TO_POINTER (symbols_update == TRUE ? 
+									 DO_UPDATE_SYMS : DONT_UPDATE_SYMS);
+	dbesig->process_id = priv->current_scan_process_id;
 
-			/* no */
-			g_async_queue_push (priv->scan_aqueue, dbesig);
-		}
-	}
-	else 
-	{
-		DBESignal *dbesig;
-		
-		if (partial_count + 1 >= files_list_len) 
-		{
-			dbesig = g_slice_new0 (DBESignal);
-			dbesig->value = GINT_TO_POINTER (DONT_UPDATE_SYMS_AND_EXIT);
-			dbesig->process_id = priv->current_scan_process_id;
-			
-			/* yes */
-			g_async_queue_push (priv->scan_aqueue, dbesig);
-		}
-		else 
-		{
-			dbesig = g_slice_new0 (DBESignal);
-			dbesig->value = GINT_TO_POINTER (DONT_UPDATE_SYMS);
-			dbesig->process_id = priv->current_scan_process_id;
-			
-			/* no */
-			g_async_queue_push (priv->scan_aqueue, dbesig);
-		}
-	}
+	g_async_queue_push (worker->scan_aqueue, dbesig);
 
 	/* don't forget to add the real_files if the caller provided a list for
 	 * them! */
+	dbesig = g_slice_new0 (DBESignal);
 	if (real_file != NULL)
 	{
-		DBESignal *dbesig;
-		
-		dbesig = g_slice_new0 (DBESignal);
 		dbesig->value = real_file;
-		dbesig->process_id = priv->current_scan_process_id;
-
-		g_async_queue_push (priv->scan_aqueue, dbesig);
 	}
 	else 
 	{
-		DBESignal *dbesig;
-		
-		dbesig = g_slice_new0 (DBESignal);
-		dbesig->value = GINT_TO_POINTER (DONT_FAKE_UPDATE_SYMS);
-		dbesig->process_id = priv->current_scan_process_id;
-		
 		/* else add a DONT_FAKE_UPDATE_SYMS marker, just to notify that this 
 		 * is not a fake file scan 
 		 */
-		g_async_queue_push (priv->scan_aqueue, dbesig);
+		dbesig->value = GINT_TO_POINTER (DONT_FAKE_UPDATE_SYMS);
 	}	
+	dbesig->process_id = priv->current_scan_process_id;
+
+	g_async_queue_push (worker->scan_aqueue, dbesig);
+
+	/* the state of a project file is taken before it's read by ctags: a 
+	 * change made during the scan will be noticed by the next check */
+	dbesig = g_slice_new0 (DBESignal);
+	if (real_file == NULL)
+	{
+		ScanFileStat *file_stat = g_slice_new0 (ScanFileStat);
+
+		file_stat->abs_path = g_strdup (local_path);
+		file_stat->size = g_file_info_get_size (ginfo);
+		file_stat->mtime = g_file_info_get_attribute_uint64 (ginfo, 
+		                                    G_FILE_ATTRIBUTE_TIME_MODIFIED);
+		file_stat->inode = g_file_info_get_attribute_uint64 (ginfo, 
+		                                    G_FILE_ATTRIBUTE_UNIX_INODE);
+		dbesig->value = file_stat;
+	}
+	dbesig->process_id = priv->current_scan_process_id;
+
+	g_async_queue_push (worker->scan_aqueue, dbesig);
+	
+	/* DEBUG_PRINT ("sent to stdin %s", local_path); */
+	anjuta_launcher_send_stdin (worker->ctags_launcher, local_path);
+	anjuta_launcher_send_stdin (worker->ctags_launcher, "\n");
 	
 	/* we don't need ginfo object anymore, bye */
 	g_object_unref (ginfo);
@@ -1484,6 +1722,8 @@ static gint sdb_sort_files_list (gconstpointer file1, gconstpointer file2)
  * containing language symbols. This function will call ctags 
  * executale and then sdb_engine_populate_db_by_tags () when it'll detect some
  * output.
+ * Files are dispatched in turn to the ctags workers, each one running its own
+ * anjuta-tags process, so that they are parsed in parallel.
  * Please note the files_list/real_files_list parameter:
  * this version of sdb_engine_scan_files_1 () let you scan for text buffer(s) that
  * will be claimed as buffers for the real files.
@@ -1505,11 +1745,13 @@ sdb_engine_scan_files_1 (SymbolDBEngine * dbe, GPtrArray * files_list,
 
 	priv = dbe->priv;
 	
-	/* if ctags_launcher isn't initialized, then do it now. */
+	/* if ctags workers aren't initialized, then do it now. */
 	/* lazy initialization */
-	if (priv->ctags_launcher == NULL) 
+	if (priv->ctags_workers == NULL) 
 	{
-		sdb_engine_ctags_launcher_create (dbe);
+		priv->ctags_workers = g_ptr_array_new ();
+		for (i = 0; i < priv->ctags_workers_count; i++)
+			g_ptr_array_add (priv->ctags_workers, sdb_engine_ctags_worker_new (dbe));
 	}
 
 	
@@ -1517,6 +1759,7 @@ sdb_engine_scan_files_1 (SymbolDBEngine * dbe, GPtrArray * files_list,
 	priv->is_scanning = TRUE;
 
 	priv->current_scan_process_id = scan_id;
+	g_atomic_int_set (&priv->scan_files_pending, files_list->len);
 	
 	DBESignal *dbesig;
 
@@ -1531,45 +1774,6 @@ sdb_engine_scan_files_1 (SymbolDBEngine * dbe, GPtrArray * files_list,
 		priv->first_scan_timer_DEBUG = g_timer_new ();
 #endif	
 	
-	/* create the shared memory file */
-	if (priv->shared_mem_file == 0)
-	{
-		gchar *temp_file;
-		gint i = 0;
-		while (TRUE)
-		{
-			temp_file = g_strdup_printf ("/anjuta-%d_%ld%d.tags", getpid (),
-								 time (NULL), i++);
-			gchar *test;
-			test = g_strconcat (SHARED_MEMORY_PREFIX, temp_file, NULL);
-			if (g_file_test (test, G_FILE_TEST_EXISTS) == TRUE)
-			{
-				DEBUG_PRINT ("Temp file %s already exists... retrying", test);
-				g_free (test);
-				g_free (temp_file);
-				continue;
-			}
-			else
-			{
-				g_free (test);
-				break;
-			}
-		}
-
-		priv->shared_mem_str = temp_file;
-		
-		if ((priv->shared_mem_fd = 
-			 shm_open (temp_file, O_CREAT|O_RDWR, S_IRUSR|S_IWUSR)) < 0)
-		{
-			g_error ("Error while trying to open a shared memory file. Be"
-					   "sure to have "SHARED_MEMORY_PREFIX" mounted with tmpfs");
-		}
-	
-		priv->shared_mem_file = fdopen (priv->shared_mem_fd, "a+b");
-
-		/* no need to free temp_file (alias shared_mem_str). It will be freed on plugin finalize */
-	}
-
 	/* Sort the files to have sources before headers */
 	g_ptr_array_sort (files_list, sdb_sort_files_list);
 	if (real_files_list)
@@ -1585,8 +1789,8 @@ sdb_engine_scan_files_1 (SymbolDBEngine * dbe, GPtrArray * files_list,
 		/* prepare an ojbect where to store some data for the async call */
 		sf_data = g_new0 (ScanFiles1Data, 1);
 		sf_data->dbe = dbe;
-		sf_data->files_list_len = files_list->len;
-		sf_data->partial_count = i;
+		sf_data->worker = g_ptr_array_index (priv->ctags_workers, 
+											 i % priv->ctags_workers->len);
 		sf_data->symbols_update = symbols_update;
 		
 		if (real_files_list != NULL)
@@ -1600,7 +1804,10 @@ sdb_engine_scan_files_1 (SymbolDBEngine * dbe, GPtrArray * files_list,
 
 		/* call it */
 		g_file_query_info_async (gfile, 
-								 G_FILE_ATTRIBUTE_ACCESS_CAN_READ, 
+								 G_FILE_ATTRIBUTE_ACCESS_CAN_READ ","
+								 G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+								 G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+								 G_FILE_ATTRIBUTE_UNIX_INODE, 
 								 G_FILE_QUERY_INFO_NONE, 
 								 G_PRIORITY_LOW,
 								 NULL,
@@ -1675,6 +1882,16 @@ sdb_engine_scan_files_async (SymbolDBEngine * dbe, GPtrArray * files_list,
 	return TRUE;
 }
 
+static gint
+sdb_engine_get_default_ctags_workers (void)
+{
+	glong n_cpus;
+
+	n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+
+	return CLAMP (n_cpus, 1, CTAGS_WORKERS_MAX);
+}
+
 static void
 sdb_engine_init (SymbolDBEngine * object)
 {
@@ -1763,7 +1980,11 @@ sdb_engine_init (SymbolDBEngine * object)
 	sdbe->priv->garbage_shared_mem_files = g_hash_table_new_full (g_str_hash, g_str_equal, 
 													  g_free, NULL);	
 	
-	sdbe->priv->ctags_launcher = NULL;
+	sdbe->priv->range_updates = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                                   NULL, sdb_engine_range_update_free);
+
+	sdbe->priv->ctags_workers = NULL;
+	sdbe->priv->ctags_workers_count = sdb_engine_get_default_ctags_workers ();
 	sdbe->priv->removed_launchers = NULL;
 	sdbe->priv->shutting_down = FALSE;
 	sdbe->priv->is_first_population = FALSE;
@@ -1782,11 +2003,6 @@ sdb_engine_init (SymbolDBEngine * object)
 	 */
 	sdbe->priv->scan_process_id_sequence = sdbe->priv->current_scan_process_id = 1;
 	
-	/* the scan_aqueue? It will contain mainly 
-	 * ints that refer to the force_update status.
-	 */
-	sdbe->priv->scan_aqueue = g_async_queue_new ();
-
 	/* the thread pool for tags scannning */
 	sdbe->priv->thread_pool = g_thread_pool_new (sdb_engine_ctags_output_thread,
 												 sdbe, THREADS_MAX_CONCURRENT,
@@ -1871,7 +2087,8 @@ sdb_engine_init (SymbolDBEngine * object)
 	
 	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
 									PREP_QUERY_GET_ALL_FROM_FILE_BY_PROJECT_NAME,
-		"SELECT file_id, file_path AS db_file_path, prj_id, lang_id, file.analyse_time \
+		"SELECT file_id, file_path AS db_file_path, prj_id, lang_id, file.analyse_time, \
+		 	file_size, file_mtime, file_inode, file_hash \
 		 FROM file JOIN project ON project.project_id = file.prj_id \
 	     WHERE \
 		 	project.project_name = ## /* name:'prjname' type:gchararray */");
@@ -1883,6 +2100,22 @@ sdb_engine_init (SymbolDBEngine * object)
 	     WHERE \
 	 	 	file_path = ## /* name:'filepath' type:gchararray */");
 
+	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
+									PREP_QUERY_GET_FILE_RECORD,
+		"SELECT file_size, file_mtime, file_inode FROM file \
+	     WHERE \
+	 	 	file_path = ## /* name:'filepath' type:gchararray */ LIMIT 1");
+
+	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
+									PREP_QUERY_UPDATE_FILE_RECORD,
+		"UPDATE file SET \
+	    	file_size = ## /* name:'filesize' type:gint64 */, \
+	    	file_mtime = ## /* name:'filemtime' type:gint64 */, \
+	    	file_inode = ## /* name:'fileinode' type:gint64 */, \
+	    	file_hash = ## /* name:'filehash' type:gchararray */ \
+	     WHERE \
+	 	 	file_path = ## /* name:'filepath' type:gchararray */");
+
 	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
 									PREP_QUERY_GET_ALL_FROM_FILE_WHERE_NOT_IN_SYMBOLS,
 		"SELECT file_id, file_path AS db_file_path FROM file \
@@ -2008,6 +2241,13 @@ sdb_engine_init (SymbolDBEngine * object)
 	    	update_flag = 0 \
 		  ORDER BY abs(file_position - ## /* name:'fileposition' type:gint */) \
 		  LIMIT 1");
+
+	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
+	 								PREP_QUERY_GET_LAST_SYMBOL_IDS,
+	 	"SELECT symbol_id, name, file_position FROM symbol \
+	     WHERE symbol_id <= ## /* name:'lastid' type:gint */ \
+	     ORDER BY symbol_id DESC \
+	     LIMIT ## /* name:'limit' type:gint */");
 	
 	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
 	 								PREP_QUERY_UPDATE_SYMBOL_ALL,
@@ -2039,6 +2279,47 @@ sdb_engine_init (SymbolDBEngine * object)
 	 	 WHERE file_defined_id = (SELECT file_id FROM file \
 	    						  WHERE \
 	 	 							file_path = ## /* name:'filepath' type:gchararray */)");
+
+	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
+	 								PREP_QUERY_SET_UPDATE_FLAG_SYMBOLS_BEFORE_LINE,
+	 	"UPDATE symbol SET \
+	    	update_flag = 1 \
+	 	 WHERE file_defined_id = (SELECT file_id FROM file \
+	    						  WHERE \
+	 	 							file_path = ## /* name:'filepath' type:gchararray */) AND \
+	 	 	file_position < ## /* name:'fileposition' type:gint */");
+
+	/* update_flag = 2 keeps the moved symbols away from the unique index
+	 * entries of the ones not moved yet */
+	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
+	 								PREP_QUERY_SHIFT_SYMBOLS_AFTER_LINE,
+	 	"UPDATE symbol SET \
+	    	file_position = file_position + ## /* name:'linesdelta' type:gint */, \
+	    	update_flag = 2 \
+	 	 WHERE file_defined_id = (SELECT file_id FROM file \
+	    						  WHERE \
+	 	 							file_path = ## /* name:'filepath' type:gchararray */) AND \
+	 	 	file_position > ## /* name:'fileposition' type:gint */");
+
+	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
+	 								PREP_QUERY_GET_TOP_LEVEL_SYMBOL_LINE_BEFORE,
+	 	"SELECT file_position FROM symbol \
+	 	 WHERE file_defined_id = (SELECT file_id FROM file \
+	    						  WHERE \
+	 	 							file_path = ## /* name:'filepath' type:gchararray */) AND \
+	 	 	scope_id <= 0 AND \
+	 	 	file_position <= ## /* name:'fileposition' type:gint */ \
+	 	 ORDER BY file_position DESC LIMIT 1");
+
+	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
+	 								PREP_QUERY_GET_TOP_LEVEL_SYMBOL_LINE_AFTER,
+	 	"SELECT file_position FROM symbol \
+	 	 WHERE file_defined_id = (SELECT file_id FROM file \
+	    						  WHERE \
+	 	 							file_path = ## /* name:'filepath' type:gchararray */) AND \
+	 	 	scope_id <= 0 AND \
+	 	 	file_position > ## /* name:'fileposition' type:gint */ \
+	 	 ORDER BY file_position ASC LIMIT 1");
 	
 	/* -- tmp_removed -- */
 	STATIC_QUERY_POPULATE_INIT_NODE(sdbe->priv->static_query_list, 
@@ -2061,6 +2342,8 @@ sdb_engine_init (SymbolDBEngine * object)
 
 	/* init table maps */
 	sdb_engine_init_table_maps (sdbe);
+
+	sdbe->priv->symbol_batch = sdb_engine_symbol_batch_new ();
 }
 
 static void
@@ -2093,10 +2376,12 @@ sdb_engine_finalize (GObject * object)
 		priv->thread_pool = NULL;
 	}
 	
-	if (priv->ctags_launcher)
+	if (priv->ctags_workers)
 	{
-		g_object_unref (priv->ctags_launcher);
-		priv->ctags_launcher = NULL;
+		g_ptr_array_foreach (priv->ctags_workers, 
+							 (GFunc)sdb_engine_ctags_worker_free, NULL);
+		g_ptr_array_free (priv->ctags_workers, TRUE);
+		priv->ctags_workers = NULL;
 	}		
 	
 	if (priv->removed_launchers)
@@ -2117,12 +2402,6 @@ sdb_engine_finalize (GObject * object)
 	
 	sdb_engine_free_cached_queries (dbe);
 	
-	if (priv->scan_aqueue)
-	{
-		g_async_queue_unref (priv->scan_aqueue);
-		priv->scan_aqueue = NULL;
-	}
-	
 	if (priv->updated_syms_id_aqueue)
 	{
 		g_async_queue_unref (priv->updated_syms_id_aqueue);
@@ -2147,17 +2426,10 @@ sdb_engine_finalize (GObject * object)
 		priv->waiting_scan_aqueue = NULL;
 	}
 	
-	if (priv->shared_mem_file) 
-	{
-		fclose (priv->shared_mem_file);
-		priv->shared_mem_file = NULL; 
-	}	
-	
-	if (priv->shared_mem_str)
+	if (priv->range_updates)
 	{
-		shm_unlink (priv->shared_mem_str);
-		g_free (priv->shared_mem_str);
-		priv->shared_mem_str = NULL;
+		g_hash_table_destroy (priv->range_updates);
+		priv->range_updates = NULL;
 	}
 	
 	if (priv->garbage_shared_mem_files)
@@ -2181,6 +2453,10 @@ sdb_engine_finalize (GObject * object)
 	sdb_engine_clear_caches (dbe);
 	sdb_engine_clear_tablemaps (dbe);
 
+	if (priv->symbol_batch)
+		sdb_engine_symbol_batch_free (priv->symbol_batch);
+	priv->symbol_batch = NULL;
+
 	g_free (priv->anjuta_db_file);
 	priv->anjuta_db_file = NULL;
 	
@@ -2344,24 +2620,64 @@ symbol_db_engine_set_ctags_path (SymbolDBEngine * dbe, const gchar * ctags_path)
 		g_strcmp0 (priv->ctags_path, ctags_path) == 0)
 		return TRUE;
 
-	/* free the old value */
+	/* free the old value and set the new one */
 	g_free (priv->ctags_path);
+	priv->ctags_path = g_strdup (ctags_path);	
 	
-	/* is anjutalauncher already created? */
-	if (priv->ctags_launcher != NULL)
+	/* are the anjutalaunchers already created? */
+	if (priv->ctags_workers != NULL)
 	{
-		AnjutaLauncher *tmp;
-		tmp = priv->ctags_launcher;
+		gint i;
+
+		for (i = 0; i < priv->ctags_workers->len; i++)
+		{
+			SdbCtagsWorker *worker = g_ptr_array_index (priv->ctags_workers, i);
 
-		/* recreate it on the fly */
-		sdb_engine_ctags_launcher_create (dbe);
+			/* keep the launcher alive to avoid crashes */
+			priv->removed_launchers = g_list_prepend (priv->removed_launchers, 
+													  worker->ctags_launcher);
 
-		/* keep the launcher alive to avoid crashes */
-		priv->removed_launchers = g_list_prepend (priv->removed_launchers, tmp);
+			/* recreate it on the fly */
+			sdb_engine_ctags_launcher_create (worker);
+		}
 	}	
 	
-	/* set the new one */
-	priv->ctags_path = g_strdup (ctags_path);	
+	return TRUE;
+}
+
+/**
+ * symbol_db_engine_set_ctags_workers:
+ * @dbe: self
+ * @n_workers: number of anjuta-tags processes used to scan files, or 0 to use
+ * 			one for each processor.
+ * 
+ * Set how many files can be parsed in parallel. This has to be called before
+ * the first scan, the workers are started with it.
+ *
+ * Returns: TRUE if the set is successful.
+ */ 
+gboolean
+symbol_db_engine_set_ctags_workers (SymbolDBEngine *dbe, gint n_workers)
+{
+	SymbolDBEnginePriv *priv;
+
+	g_return_val_if_fail (dbe != NULL, FALSE);
+	g_return_val_if_fail (n_workers >= 0, FALSE);
+	
+	priv = dbe->priv;
+
+	if (priv->ctags_workers != NULL)
+	{
+		g_warning ("symbol_db_engine_set_ctags_workers (): workers already "
+				   "started. Keeping the old value %d", priv->ctags_workers_count);
+		return FALSE;
+	}
+
+	if (n_workers == 0)
+		priv->ctags_workers_count = sdb_engine_get_default_ctags_workers ();
+	else
+		priv->ctags_workers_count = MIN (n_workers, CTAGS_WORKERS_MAX);
+
 	return TRUE;
 }
 
@@ -2670,6 +2986,9 @@ symbol_db_engine_close_db (SymbolDBEngine *dbe)
 	/* terminate threads, if ever they're running... */
 	g_thread_pool_free (priv->thread_pool, TRUE, TRUE);
 	priv->thread_pool = NULL;
+
+	/* symbols of an interrupted scan */
+	sdb_engine_symbol_batch_clear (priv->symbol_batch);
 	ret = sdb_engine_disconnect_from_db (dbe);
 
 	/* reset count */
@@ -3228,105 +3547,509 @@ sdb_engine_add_new_language (SymbolDBEngine * dbe, const gchar *language)
 	return table_id;
 }
 
+/* state of a project file on disk compared to its record on db */
+typedef enum
+{
+	SDB_FILE_UNCHANGED,
+	SDB_FILE_TOUCHED,		/* stat info changed but the contents didn't */
+	SDB_FILE_CHANGED,
+	SDB_FILE_MISSING
+} SdbFileState;
+
+typedef struct _SdbFileCheck
+{
+	gchar *abs_path;
+	gchar *file_on_db;
+
+	/* record on db. db_size is -1 if there's none */
+	gint64 db_size;
+	gint64 db_mtime;
+	gint64 db_inode;
+	gchar *db_hash;
+
+	/* filled by sdb_engine_check_files () */
+	SdbFileState state;
+	gint64 size;
+	gint64 mtime;
+	gint64 inode;
+	gchar *hash;
+} SdbFileCheck;
+
+typedef struct _SdbFileCheckSlice
+{
+	GPtrArray *checks;
+	guint begin;
+	guint end;
+	gboolean force;
+} SdbFileCheckSlice;
+
+static void
+sdb_file_check_free (SdbFileCheck *check)
+{
+	g_free (check->abs_path);
+	g_free (check->file_on_db);
+	g_free (check->db_hash);
+	g_free (check->hash);
+	g_slice_free (SdbFileCheck, check);
+}
+
 /**
- * ~~~ Thread note: this function locks the mutex ~~~
+ * sdb_engine_get_file_hash:
+ * @abs_path: full path of the file.
  *
- * Add a file to project. 
- * This function requires an opened db, i.e. calling before
- * symbol_db_engine_open_db ()
- * filepath: referes to a full file path.
- * project: 
- * WARNING: we suppose that project_directory is already set.
- * WARNING2: we suppose that the given local_filepath include the project_directory path.
- * + correct example: local_filepath: /home/user/projects/foo_project/src/main.c
- *                    project_directory: /home/user/projects/foo_project
- * - wrong one: local_filepath: /tmp/foo.c
- *                    project_directory: /home/user/projects/foo_project
+ * Returns: the md5 of the contents of @abs_path, NULL if the file cannot be 
+ * read. Free it with g_free ().
  */
-static gboolean
-sdb_engine_add_new_db_file (SymbolDBEngine * dbe, const gchar * project_name,
-    					const gchar *project_version,  const gchar * local_filepath, 
-    					const gchar * language)
+static gchar *
+sdb_engine_get_file_hash (const gchar *abs_path)
 {
-	const GdaSet *plist;
-	const GdaStatement *stmt;
-	GdaHolder *param;
-	GError * error = NULL;
-	SymbolDBEnginePriv *priv;
-	gint language_id;
-	GValue v = {0};
+	GMappedFile *mapped;
+	gchar *hash;
+
+	if ((mapped = g_mapped_file_new (abs_path, FALSE, NULL)) == NULL)
+		return NULL;
+
+	hash = g_compute_checksum_for_data (G_CHECKSUM_MD5, 
+	                       (const guchar *)g_mapped_file_get_contents (mapped),
+	                       g_mapped_file_get_length (mapped));
+	g_mapped_file_unref (mapped);
 	
-	priv = dbe->priv;
+	return hash;
+}
 
-	/* check if the file is a correct one compared to the local_filepath */
-	if (strstr (local_filepath, priv->project_directory) == NULL)
+static gboolean
+sdb_engine_stat_file (const gchar *abs_path, gint64 *size, gint64 *mtime, 
+                      gint64 *inode)
+{
+	GStatBuf st;
+
+	if (g_stat (abs_path, &st) != 0 || !S_ISREG (st.st_mode))
 		return FALSE;
 
-	SDB_LOCK(priv);
+	*size = st.st_size;
+	*mtime = st.st_mtime;
+	*inode = st.st_ino;
+	return TRUE;
+}
 
-	/* we're gonna set the file relative to the project folder, not the full one.
-	 * e.g.: we have a file on disk: "/tmp/foo/src/file.c" and a db_directory located on
-	 * "/tmp/foo/". The entry on db will be "src/file.c" 
-	 */
-	const gchar *relative_path = symbol_db_util_get_file_db_path (dbe, local_filepath);
-	if (relative_path == NULL)
+/**
+ * ~~~ Thread note: this function doesn't access the db, the mutex may be 
+ * released while it runs ~~~
+ *
+ * Compares the files of a slice with their db record. The contents are hashed
+ * only when the size is the same but mtime or inode are not, e.g. after a vcs
+ * checkout or a save without modifications.
+ */
+static gpointer
+sdb_engine_check_files_thread (gpointer data)
+{
+	SdbFileCheckSlice *slice = data;
+	guint i;
+
+	for (i = slice->begin; i < slice->end; i++)
 	{
-		DEBUG_PRINT ("%s", "relative_path == NULL");
-		SDB_UNLOCK(priv);
-		return FALSE;
-	}	
+		SdbFileCheck *check = g_ptr_array_index (slice->checks, i);
+
+		if (sdb_engine_stat_file (check->abs_path, &check->size, &check->mtime,
+		                          &check->inode) == FALSE)
+		{
+			check->state = SDB_FILE_MISSING;
+			continue;
+		}
+
+		if (slice->force == TRUE || check->db_size < 0 || 
+		    check->size != check->db_size)
+		{
+			check->state = SDB_FILE_CHANGED;
+			continue;
+		}
+
+		if (check->mtime == check->db_mtime && check->inode == check->db_inode)
+		{
+			check->state = SDB_FILE_UNCHANGED;
+			continue;
+		}
+
+		check->hash = sdb_engine_get_file_hash (check->abs_path);
+		if (check->hash != NULL && check->db_hash != NULL &&
+		    g_strcmp0 (check->hash, check->db_hash) == 0)
+			check->state = SDB_FILE_TOUCHED;
+		else
+			check->state = SDB_FILE_CHANGED;
+	}
+
+	return NULL;
+}
+
+/**
+ * sdb_engine_check_files:
+ * @checks: array of SdbFileCheck.
+ * @force: if TRUE every existing file is reported as changed.
+ *
+ * Fills the state of each check. Big arrays are split among up to
+ * FILE_CHECK_THREADS_MAX threads, the calling one included.
+ */
+static void
+sdb_engine_check_files (GPtrArray *checks, gboolean force)
+{
+	SdbFileCheckSlice *slices;
+	GThread **threads;
+	guint n_threads;
+	guint step;
+	guint i;
+
+	n_threads = CLAMP (checks->len / FILE_CHECK_BATCH_SIZE, 1, 
+	                   FILE_CHECK_THREADS_MAX);
+	step = (checks->len + n_threads - 1) / n_threads;
 	
-	/* insert a new entry on db */	
-	language_id = sdb_engine_add_new_language (dbe, language);
-	if (language_id < 0)
+	slices = g_new0 (SdbFileCheckSlice, n_threads);
+	threads = g_new0 (GThread *, n_threads);
+
+	for (i = 0; i < n_threads; i++)
 	{
-		DEBUG_PRINT ("Unknown language: %s", language);
-		SDB_UNLOCK(priv);
-		return FALSE;
+		slices[i].checks = checks;
+		slices[i].begin = MIN (i * step, checks->len);
+		slices[i].end = MIN (slices[i].begin + step, checks->len);
+		slices[i].force = force;
+
+		if (i > 0)
+			threads[i] = g_thread_new ("sdb-file-check", 
+			                           sdb_engine_check_files_thread, &slices[i]);
 	}
 
-	if ((stmt = sdb_engine_get_statement_by_query_id (dbe, PREP_QUERY_FILE_NEW))
-		== NULL)
+	sdb_engine_check_files_thread (&slices[0]);
+	
+	for (i = 1; i < n_threads; i++)
+		g_thread_join (threads[i]);
+
+	g_free (threads);
+	g_free (slices);
+}
+
+/**
+ * ~~~ Thread note: the mutex must be held by the caller ~~~
+ *
+ * Stores the stat info and the hash of @file_on_db. An empty @hash means that
+ * the contents are unknown.
+ */
+static gboolean
+sdb_engine_set_file_record (SymbolDBEngine *dbe, const gchar *file_on_db,
+                            gint64 size, gint64 mtime, gint64 inode, 
+                            const gchar *hash)
+{
+	const GdaSet *plist;
+	const GdaStatement *stmt;
+	GdaHolder *param;
+	GValue v = {0};
+
+	if ((stmt = sdb_engine_get_statement_by_query_id (dbe,
+										PREP_QUERY_UPDATE_FILE_RECORD)) == NULL)
 	{
 		g_warning ("query is null");
-		SDB_UNLOCK(priv);
 		return FALSE;
 	}
 
-	plist = sdb_engine_get_query_parameters_list (dbe, PREP_QUERY_FILE_NEW);
-		
-	/* filepath parameter */
-	if ((param = gda_set_get_holder ((GdaSet*)plist, "filepath")) == NULL)
+	plist = sdb_engine_get_query_parameters_list (dbe, PREP_QUERY_UPDATE_FILE_RECORD);
+
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filesize")) == NULL)
 	{
-		g_warning ("param langname is NULL from pquery!");
-		SDB_UNLOCK(priv);
+		g_warning ("param filesize is NULL from pquery!");
 		return FALSE;
 	}
+	SDB_PARAM_SET_INT64(param, size);
 
-	SDB_PARAM_SET_STRING(param, relative_path);
-								
-	/* project name parameter */
-	if ((param = gda_set_get_holder ((GdaSet*)plist, "prjname")) == NULL)
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filemtime")) == NULL)
 	{
-		g_warning ("param prjname is NULL from pquery!");
-		SDB_UNLOCK(priv);
+		g_warning ("param filemtime is NULL from pquery!");
 		return FALSE;
 	}
+	SDB_PARAM_SET_INT64(param, mtime);
 
-	SDB_PARAM_SET_STRING(param, project_name);
-	
-	/* prjversion parameter */
-	if ((param = gda_set_get_holder ((GdaSet*)plist, "prjversion")) == NULL)
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "fileinode")) == NULL)
 	{
-		g_warning ("param prjversion is NULL from pquery!");
-		SDB_UNLOCK(priv);
+		g_warning ("param fileinode is NULL from pquery!");
 		return FALSE;
 	}
+	SDB_PARAM_SET_INT64(param, inode);
 
-	SDB_PARAM_SET_STRING(param, project_version);
-		
-	/* language id parameter */
-	if ((param = gda_set_get_holder ((GdaSet*)plist, "langid")) == NULL)
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filehash")) == NULL)
+	{
+		g_warning ("param filehash is NULL from pquery!");
+		return FALSE;
+	}
+	SDB_PARAM_SET_STRING(param, hash != NULL ? hash : "");
+
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filepath")) == NULL)
+	{
+		g_warning ("param filepath is NULL from pquery!");
+		return FALSE;
+	}
+	SDB_PARAM_SET_STRING(param, file_on_db);
+
+	return gda_connection_statement_execute_non_select (dbe->priv->db_connection,
+	                                                    (GdaStatement*)stmt,
+	                                                    (GdaSet*)plist, NULL,
+	                                                    NULL) != -1;
+}
+
+/**
+ * ~~~ Thread note: the mutex must be held by the caller ~~~
+ *
+ * Reads the stat info recorded for @file_on_db.
+ *
+ * Returns: FALSE if there is no record.
+ */
+static gboolean
+sdb_engine_get_file_record (SymbolDBEngine *dbe, const gchar *file_on_db,
+                            gint64 *size, gint64 *mtime, gint64 *inode)
+{
+	const GdaSet *plist;
+	const GdaStatement *stmt;
+	GdaHolder *param;
+	GdaDataModel *data_model;
+	const GValue *value;
+	gboolean found;
+	GValue v = {0};
+
+	if ((stmt = sdb_engine_get_statement_by_query_id (dbe,
+										PREP_QUERY_GET_FILE_RECORD)) == NULL)
+	{
+		g_warning ("query is null");
+		return FALSE;
+	}
+
+	plist = sdb_engine_get_query_parameters_list (dbe, PREP_QUERY_GET_FILE_RECORD);
+
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filepath")) == NULL)
+	{
+		g_warning ("param filepath is NULL from pquery!");
+		return FALSE;
+	}
+	SDB_PARAM_SET_STRING(param, file_on_db);
+
+	GType gtype_array[4] = {	G_TYPE_INT64, 
+								G_TYPE_INT64, 
+								G_TYPE_INT64, 
+								G_TYPE_NONE
+							};
+	data_model = gda_connection_statement_execute_select_full (dbe->priv->db_connection, 
+												(GdaStatement*)stmt, 
+	    										(GdaSet*)plist,
+	    										GDA_STATEMENT_MODEL_RANDOM_ACCESS,
+	    										gtype_array,
+	    										NULL);
+	if (!GDA_IS_DATA_MODEL (data_model) ||
+		gda_data_model_get_n_rows (GDA_DATA_MODEL (data_model)) <= 0)
+	{
+		if (data_model != NULL)
+			g_object_unref (data_model);
+		return FALSE;
+	}
+
+	/* file_size is NULL until the file is recorded */
+	value = gda_data_model_get_value_at (data_model, 0, 0, NULL);
+	found = value != NULL && G_VALUE_HOLDS_INT64 (value);
+	if (found)
+	{
+		*size = g_value_get_int64 (value);
+		value = gda_data_model_get_value_at (data_model, 1, 0, NULL);
+		*mtime = value != NULL && G_VALUE_HOLDS_INT64 (value) ? 
+			g_value_get_int64 (value) : -1;
+		value = gda_data_model_get_value_at (data_model, 2, 0, NULL);
+		*inode = value != NULL && G_VALUE_HOLDS_INT64 (value) ? 
+			g_value_get_int64 (value) : -1;
+	}
+
+	g_object_unref (data_model);
+	return found;
+}
+
+static void
+sdb_engine_scan_file_stat_free (ScanFileStat *file_stat)
+{
+	g_free (file_stat->abs_path);
+	g_free (file_stat->hash);
+	g_slice_free (ScanFileStat, file_stat);
+}
+
+/**
+ * ~~~ Thread note: this function locks the mutex ~~~
+ *
+ * Records on db the state the files had when their scan started. A file 
+ * whose record already matches is left as it is. The contents are hashed, 
+ * without holding the mutex, only when the file has been changed since it
+ * was recorded: files never recorded get no hash, so that an import reads
+ * them only once. The hash is dropped if the file has been modified since
+ * the start of its scan.
+ */
+static void
+sdb_engine_record_scanned_files (SymbolDBEngine *dbe, GPtrArray *scanned_files)
+{
+	SymbolDBEnginePriv *priv;
+	gint64 size, mtime, inode;
+	guint i;
+
+	if (scanned_files->len == 0)
+		return;
+	
+	priv = dbe->priv;
+
+	SDB_LOCK(priv);
+	for (i = 0; i < scanned_files->len; i++)
+	{
+		ScanFileStat *file_stat = g_ptr_array_index (scanned_files, i);
+		const gchar *file_on_db;
+
+		file_on_db = symbol_db_util_get_file_db_path (dbe, file_stat->abs_path);
+		if (file_on_db == NULL)
+			continue;
+		
+		if (sdb_engine_get_file_record (dbe, file_on_db, &size, &mtime, 
+		                                &inode) == FALSE)
+		{
+			file_stat->record = TRUE;
+		}
+		else if (size != file_stat->size || mtime != file_stat->mtime ||
+		         inode != file_stat->inode)
+		{
+			file_stat->record = TRUE;
+			file_stat->hash_needed = TRUE;
+		}
+	}
+	SDB_UNLOCK(priv);
+
+	for (i = 0; i < scanned_files->len; i++)
+	{
+		ScanFileStat *file_stat = g_ptr_array_index (scanned_files, i);
+
+		if (file_stat->hash_needed == FALSE)
+			continue;
+
+		file_stat->hash = sdb_engine_get_file_hash (file_stat->abs_path);
+		if (file_stat->hash != NULL &&
+		    (sdb_engine_stat_file (file_stat->abs_path, &size, &mtime, &inode) == FALSE ||
+		     size != file_stat->size || mtime != file_stat->mtime ||
+		     inode != file_stat->inode))
+		{
+			g_free (file_stat->hash);
+			file_stat->hash = NULL;
+		}
+	}
+	
+	SDB_LOCK(priv);
+	for (i = 0; i < scanned_files->len; i++)
+	{
+		ScanFileStat *file_stat = g_ptr_array_index (scanned_files, i);
+
+		if (file_stat->record == TRUE)
+			sdb_engine_set_file_record (dbe, 
+			                symbol_db_util_get_file_db_path (dbe, file_stat->abs_path),
+			                file_stat->size, file_stat->mtime, file_stat->inode,
+			                file_stat->hash);
+		sdb_engine_scan_file_stat_free (file_stat);
+	}
+	SDB_UNLOCK(priv);
+}
+
+/**
+ * ~~~ Thread note: this function locks the mutex ~~~
+ *
+ * Add a file to project. 
+ * This function requires an opened db, i.e. calling before
+ * symbol_db_engine_open_db ()
+ * filepath: referes to a full file path.
+ * project: 
+ * WARNING: we suppose that project_directory is already set.
+ * WARNING2: we suppose that the given local_filepath include the project_directory path.
+ * + correct example: local_filepath: /home/user/projects/foo_project/src/main.c
+ *                    project_directory: /home/user/projects/foo_project
+ * - wrong one: local_filepath: /tmp/foo.c
+ *                    project_directory: /home/user/projects/foo_project
+ */
+static gboolean
+sdb_engine_add_new_db_file (SymbolDBEngine * dbe, const gchar * project_name,
+    					const gchar *project_version,  const gchar * local_filepath, 
+    					const gchar * language)
+{
+	const GdaSet *plist;
+	const GdaStatement *stmt;
+	GdaHolder *param;
+	GError * error = NULL;
+	SymbolDBEnginePriv *priv;
+	gint language_id;
+	GValue v = {0};
+	
+	priv = dbe->priv;
+
+	/* check if the file is a correct one compared to the local_filepath */
+	if (strstr (local_filepath, priv->project_directory) == NULL)
+		return FALSE;
+
+	SDB_LOCK(priv);
+
+	/* we're gonna set the file relative to the project folder, not the full one.
+	 * e.g.: we have a file on disk: "/tmp/foo/src/file.c" and a db_directory located on
+	 * "/tmp/foo/". The entry on db will be "src/file.c" 
+	 */
+	const gchar *relative_path = symbol_db_util_get_file_db_path (dbe, local_filepath);
+	if (relative_path == NULL)
+	{
+		DEBUG_PRINT ("%s", "relative_path == NULL");
+		SDB_UNLOCK(priv);
+		return FALSE;
+	}	
+	
+	/* insert a new entry on db */	
+	language_id = sdb_engine_add_new_language (dbe, language);
+	if (language_id < 0)
+	{
+		DEBUG_PRINT ("Unknown language: %s", language);
+		SDB_UNLOCK(priv);
+		return FALSE;
+	}
+
+	if ((stmt = sdb_engine_get_statement_by_query_id (dbe, PREP_QUERY_FILE_NEW))
+		== NULL)
+	{
+		g_warning ("query is null");
+		SDB_UNLOCK(priv);
+		return FALSE;
+	}
+
+	plist = sdb_engine_get_query_parameters_list (dbe, PREP_QUERY_FILE_NEW);
+		
+	/* filepath parameter */
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filepath")) == NULL)
+	{
+		g_warning ("param langname is NULL from pquery!");
+		SDB_UNLOCK(priv);
+		return FALSE;
+	}
+
+	SDB_PARAM_SET_STRING(param, relative_path);
+								
+	/* project name parameter */
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "prjname")) == NULL)
+	{
+		g_warning ("param prjname is NULL from pquery!");
+		SDB_UNLOCK(priv);
+		return FALSE;
+	}
+
+	SDB_PARAM_SET_STRING(param, project_name);
+	
+	/* prjversion parameter */
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "prjversion")) == NULL)
+	{
+		g_warning ("param prjversion is NULL from pquery!");
+		SDB_UNLOCK(priv);
+		return FALSE;
+	}
+
+	SDB_PARAM_SET_STRING(param, project_version);
+		
+	/* language id parameter */
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "langid")) == NULL)
 	{
 		g_warning ("param langid is NULL from pquery!");
 		SDB_UNLOCK(priv);
@@ -3354,7 +4077,7 @@ sdb_engine_add_new_db_file (SymbolDBEngine * dbe, const gchar * project_name,
 		SDB_UNLOCK(priv);
 		return FALSE;
 	}	
-	
+
 	SDB_UNLOCK(priv);
 	return TRUE;
 } 
@@ -4043,6 +4766,14 @@ sdb_engine_add_new_scope_definition (SymbolDBEngine * dbe, const tagEntry * tag_
 	{
 		return -1;
 	}
+
+	/* cache lookup. A scope defined twice would make the insert fail on the
+	 * unique constraint and need a select too. */
+	table_id = sdb_engine_cache_lookup (priv->scope_cache, scope);
+	if (table_id != -1)
+	{
+		return table_id;
+	}
 	
 	if ((stmt = sdb_engine_get_statement_by_query_id (dbe, PREP_QUERY_SCOPE_NEW))
 		== NULL)
@@ -4085,31 +4816,27 @@ sdb_engine_add_new_scope_definition (SymbolDBEngine * dbe, const tagEntry * tag_
 	if (last_inserted)
 		g_object_unref (last_inserted);	
 
+	/* we should cache only tables which are != -1 */
+	if (table_id > 0)
+		sdb_engine_insert_cache (priv->scope_cache, scope, table_id);
+
 	return table_id;
 }
 
 /**
- * ### Thread note: this function inherits the mutex lock ### 
- *
  * Saves the tagEntry info for a second pass parsing.
  * Usually we don't know all the symbol at the first scan of the tags. We need
  * a second one. 
  *
  */
-static GNUC_INLINE void
-sdb_engine_add_new_tmp_heritage_scope (SymbolDBEngine * dbe,
-									   const tagEntry * tag_entry,
-									   gint symbol_referer_id)
+static TableMapTmpHeritage *
+sdb_engine_tmp_heritage_scope_new (const tagEntry * tag_entry)
 {
-	SymbolDBEnginePriv *priv;
 	const gchar *field_inherits, *field_struct, *field_typeref,
 		*field_enum, *field_union, *field_class, *field_namespace;
 	TableMapTmpHeritage * node;
 
-	priv = dbe->priv;
-
 	node = g_slice_new0 (TableMapTmpHeritage);	
-	node->symbol_referer_id = symbol_referer_id;
 
 	if ((field_inherits = tagsField (tag_entry, "inherits")) != NULL)
 	{
@@ -4146,6 +4873,25 @@ sdb_engine_add_new_tmp_heritage_scope (SymbolDBEngine * dbe,
 		node->field_namespace = g_strdup (field_namespace);
 	}
 
+	return node;
+}
+
+/** 
+ * ### Thread note: this function inherits the mutex lock ### 
+ */
+static GNUC_INLINE void
+sdb_engine_add_new_tmp_heritage_scope (SymbolDBEngine * dbe,
+									   const tagEntry * tag_entry,
+									   gint symbol_referer_id)
+{
+	SymbolDBEnginePriv *priv;
+	TableMapTmpHeritage * node;
+
+	priv = dbe->priv;
+
+	node = sdb_engine_tmp_heritage_scope_new (tag_entry);
+	node->symbol_referer_id = symbol_referer_id;
+
 	g_queue_push_head (priv->tmp_heritage_tablemap, node);
 }
 
@@ -4767,27 +5513,464 @@ sdb_engine_add_new_symbol_common_params (SymbolDBEngine *dbe,
 /**
  * ### Thread note: this function inherits the mutex lock ### 
  *
- * base_prj_path can be NULL. In that case path info tag_entry will be taken
- * as an absolute path.
- * fake_file can be used when a buffer updating is being executed. In that 
- * particular case both base_prj_path and tag_entry->file will be ignored. 
- * fake_file is real_path of file on disk
+ * Return the statement inserting n_rows symbols at once, parsing it the first
+ * time it is needed.
  */
-static gint
-sdb_engine_add_new_symbol (SymbolDBEngine * dbe, const tagEntry * tag_entry,
-						   gint file_defined_id,
-						   gboolean sym_update)
+static SymbolBatchQuery *
+sdb_engine_get_symbol_batch_query (SymbolDBEngine *dbe, gint n_rows)
 {
+	static const gchar *columns[SYMBOL_BATCH_COLUMNS] = {
+		"filedefid", "name", "fileposition", "isfilescope", "signature",
+		"returntype", "scopedefinitionid", "typetype", "typename", "kindid",
+		"accesskindid", "implementationkindid"
+	};
 	SymbolDBEnginePriv *priv;
-	GdaSet *plist;
-	GdaStatement *stmt;
-	GdaSet *last_inserted = NULL;
-	gint table_id, symbol_id;
-	const gchar* name;
-	gint file_position = 0;
-	gint is_file_scope = 0;
-	const gchar *signature;
-	const gchar *returntype;
+	SymbolBatchQuery *query;
+	GString *sql;
+	GError *error = NULL;
+	gint i, j;
+
+	priv = dbe->priv;
+
+	if (priv->symbol_batch_queries[n_rows] != NULL)
+		return priv->symbol_batch_queries[n_rows];
+
+	/* scope_id is calculated on the second pass, update_flag is always 0 for
+	 * new symbols */
+	sql = g_string_new ("INSERT INTO symbol (file_defined_id, name, file_position, "
+	                    "is_file_scope, signature, returntype, "
+	                    "scope_definition_id, scope_id, "
+	                    "type_type, type_name, kind_id, access_kind_id, "
+	                    "implementation_kind_id, update_flag) VALUES ");
+	for (i = 0; i < n_rows; i++)
+	{
+		g_string_append_printf (sql, "%s("
+			"## /* name:'filedefid%d' type:gint */, "
+			"## /* name:'name%d' type:gchararray */, "
+			"## /* name:'fileposition%d' type:gint */, "
+			"## /* name:'isfilescope%d' type:gint */, "
+			"## /* name:'signature%d' type:gchararray */, "
+			"## /* name:'returntype%d' type:gchararray */, "
+			"## /* name:'scopedefinitionid%d' type:gint */, 0, "
+			"## /* name:'typetype%d' type:gchararray */, "
+			"## /* name:'typename%d' type:gchararray */, "
+			"## /* name:'kindid%d' type:gint */, "
+			"## /* name:'accesskindid%d' type:gint */, "
+			"## /* name:'implementationkindid%d' type:gint */, 0)",
+			i == 0 ? "" : ", ",
+			i, i, i, i, i, i, i, i, i, i, i, i);
+	}
+
+	query = g_new0 (SymbolBatchQuery, 1);
+	query->stmt = gda_sql_parser_parse_string (priv->sql_parser, sql->str, NULL,
+											   &error);
+	g_string_free (sql, TRUE);
+
+	if (error)
+	{
+		g_warning ("%s", error->message);
+		g_error_free (error);
+		sdb_engine_symbol_batch_query_free (query);
+		return NULL;
+	}
+
+	if (gda_statement_get_parameters (query->stmt, &query->plist, NULL) == FALSE)
+	{
+		g_warning ("Error on getting parameters for symbol batch %d", n_rows);
+		sdb_engine_symbol_batch_query_free (query);
+		return NULL;
+	}
+
+	/* lookup the holders only once */
+	query->holders = g_new (GdaHolder *, n_rows * SYMBOL_BATCH_COLUMNS);
+	for (i = 0; i < n_rows; i++)
+	{
+		for (j = 0; j < SYMBOL_BATCH_COLUMNS; j++)
+		{
+			gchar *holder_name = g_strdup_printf ("%s%d", columns[j], i);
+			query->holders[i * SYMBOL_BATCH_COLUMNS + j] = 
+				gda_set_get_holder (query->plist, holder_name);
+			g_free (holder_name);
+		}
+	}
+
+	priv->symbol_batch_queries[n_rows] = query;
+	return query;
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * The symbol row of the batch has been inserted with symbol_id (-1 on error).
+ */
+static void
+sdb_engine_symbol_batch_row_inserted (SymbolDBEngine *dbe, SymbolBatch *batch,
+									  gint row, gint symbol_id)
+{
+	SymbolDBEnginePriv *priv;
+
+	priv = dbe->priv;
+
+	if (symbol_id <= 0)
+		return;
+
+	/* see sdb_engine_add_new_symbol (): signals are emitted after the second
+	 * pass */
+	g_async_queue_push (priv->inserted_syms_id_aqueue, GINT_TO_POINTER(symbol_id));
+
+	batch->tmp_heritage[row]->symbol_referer_id = symbol_id;
+	g_queue_push_head (priv->tmp_heritage_tablemap, batch->tmp_heritage[row]);
+	batch->tmp_heritage[row] = NULL;
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * Insert a single row of the batch, like sdb_engine_add_new_symbol () does.
+ * Returns the symbol id or -1 on error.
+ */
+static gint
+sdb_engine_symbol_batch_insert_row (SymbolDBEngine *dbe, SymbolBatch *batch,
+									gint row)
+{
+	SymbolDBEnginePriv *priv;
+	GdaSet *plist = NULL;
+	GdaStatement *stmt = NULL;
+	GdaSet *last_inserted = NULL;
+	gint table_id = -1;
+
+	priv = dbe->priv;
+
+	sdb_engine_add_new_symbol_case_2_3 (dbe, -1, &plist, &stmt, 
+							batch->file_defined_id[row], batch->name[row], 
+							batch->type_type[row], batch->type_name[row]);
+	if (stmt == NULL)
+		return -1;
+
+	sdb_engine_add_new_symbol_common_params (dbe,  plist, stmt,
+							batch->file_position[row], batch->is_file_scope[row],
+							batch->signature[row], batch->returntype[row],
+							batch->scope_definition_id[row], 0, batch->kind_id[row],
+							batch->access_kind_id[row], 
+							batch->implementation_kind_id[row], FALSE);
+
+	if (gda_connection_statement_execute_non_select (priv->db_connection, 
+													 stmt, plist, &last_inserted,
+													 NULL) > 0)
+	{
+		const GValue *value = gda_set_get_holder_value (last_inserted, "+0");
+		table_id = g_value_get_int (value);
+	}
+
+	if (last_inserted)
+		g_object_unref (last_inserted);
+
+	return table_id;
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * Look for the id of a row of the batch by its unique key.
+ */
+static gint
+sdb_engine_symbol_batch_lookup_id (SymbolDBEngine *dbe, SymbolBatch *batch,
+								   gint row)
+{
+	GValue v1 = {0}, v2 = {0}, v3 = {0}, v4 = {0}, v5 = {0};
+
+	SDB_GVALUE_SET_STATIC_STRING(v1, batch->name[row]);
+	SDB_GVALUE_SET_INT(v2, batch->file_defined_id[row]);
+	SDB_GVALUE_SET_STATIC_STRING(v3, batch->type_type[row]);
+	SDB_GVALUE_SET_STATIC_STRING(v4, batch->type_name[row]);
+	SDB_GVALUE_SET_INT(v5, batch->file_position[row]);
+
+	return sdb_engine_get_tuple_id_by_unique_name5 (dbe,
+							  PREP_QUERY_GET_SYMBOL_ID_BY_UNIQUE_INDEX_KEY_EXT,
+							  "symname", &v1,
+							  "filedefid", &v2,
+							  "typetype", &v3,
+							  "typename", &v4,
+							  "fileposition", &v5);
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * The whole batch has been inserted, last_id being the id of its last row.
+ * Read back the ids of the rows: symbol ids are AUTOINCREMENT so the batch
+ * rows are the last ones, in the order of the statement. Each row is checked
+ * against the batch and looked up by its unique key if it does not match.
+ */
+static void
+sdb_engine_symbol_batch_read_ids (SymbolDBEngine *dbe, SymbolBatch *batch,
+								  gint last_id)
+{
+	SymbolDBEnginePriv *priv;
+	const GdaStatement *stmt;
+	const GdaSet *plist;
+	GdaHolder *param;
+	GdaDataModel *data_model = NULL;
+	GValue v = {0};
+	gint n_ids = 0;
+	gint i;
+
+	priv = dbe->priv;
+
+	if ((stmt = sdb_engine_get_statement_by_query_id (dbe, 
+									PREP_QUERY_GET_LAST_SYMBOL_IDS)) != NULL)
+	{
+		plist = sdb_engine_get_query_parameters_list (dbe, 
+									PREP_QUERY_GET_LAST_SYMBOL_IDS);
+
+		if ((param = gda_set_get_holder ((GdaSet*)plist, "lastid")) != NULL)
+		{
+			SDB_PARAM_SET_INT (param, last_id);
+		}
+		if ((param = gda_set_get_holder ((GdaSet*)plist, "limit")) != NULL)
+		{
+			SDB_PARAM_SET_INT (param, batch->n_rows);
+		}
+
+		data_model = gda_connection_statement_execute_select (priv->db_connection, 
+													   (GdaStatement*)stmt, 
+													   (GdaSet*)plist, NULL);
+		if (GDA_IS_DATA_MODEL (data_model))
+			n_ids = gda_data_model_get_n_rows (data_model);
+	}
+
+	for (i = 0; i < batch->n_rows; i++)
+	{
+		/* rows are sorted by decreasing id */
+		gint model_row = batch->n_rows - 1 - i;
+		gint symbol_id = -1;
+
+		if (model_row < n_ids)
+		{
+			const GValue *id_value, *name_value, *position_value;
+
+			id_value = gda_data_model_get_value_at (data_model, 0, model_row, NULL);
+			name_value = gda_data_model_get_value_at (data_model, 1, model_row, NULL);
+			position_value = gda_data_model_get_value_at (data_model, 2, model_row, NULL);
+
+			if (id_value != NULL && name_value != NULL && position_value != NULL &&
+			    G_VALUE_HOLDS_STRING (name_value) &&
+			    g_strcmp0 (g_value_get_string (name_value), batch->name[i]) == 0 &&
+			    g_value_get_int (position_value) == batch->file_position[i])
+			{
+				symbol_id = g_value_get_int (id_value);
+			}
+		}
+
+		if (symbol_id <= 0)
+			symbol_id = sdb_engine_symbol_batch_lookup_id (dbe, batch, i);
+
+		sdb_engine_symbol_batch_row_inserted (dbe, batch, i, symbol_id);
+	}
+
+	if (data_model != NULL)
+		g_object_unref (data_model);
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * Insert all the symbols waiting in the batch with a single statement.
+ */
+static void
+sdb_engine_symbol_batch_flush (SymbolDBEngine *dbe)
+{
+	SymbolDBEnginePriv *priv;
+	SymbolBatch *batch;
+	SymbolBatchQuery *query;
+	GdaSet *last_inserted = NULL;
+	GError *error = NULL;
+	gint nrows = -1;
+	gint i;
+
+	priv = dbe->priv;
+	batch = priv->symbol_batch;
+
+	if (batch == NULL || batch->n_rows == 0)
+		return;
+
+	if ((query = sdb_engine_get_symbol_batch_query (dbe, batch->n_rows)) != NULL)
+	{
+		GValue v = {0};
+		
+		for (i = 0; i < batch->n_rows; i++)
+		{
+			GdaHolder **holders = query->holders + i * SYMBOL_BATCH_COLUMNS;
+
+			SDB_PARAM_SET_INT (holders[0], batch->file_defined_id[i]);
+			SDB_PARAM_SET_STRING (holders[1], batch->name[i]);
+			SDB_PARAM_SET_INT (holders[2], batch->file_position[i]);
+			SDB_PARAM_SET_INT (holders[3], batch->is_file_scope[i]);
+			SDB_PARAM_SET_STRING (holders[4], batch->signature[i]);
+			SDB_PARAM_SET_STRING (holders[5], batch->returntype[i]);
+			SDB_PARAM_SET_INT (holders[6], batch->scope_definition_id[i]);
+			SDB_PARAM_SET_STRING (holders[7], batch->type_type[i]);
+			SDB_PARAM_SET_STRING (holders[8], batch->type_name[i]);
+			SDB_PARAM_SET_INT (holders[9], batch->kind_id[i]);
+			SDB_PARAM_SET_INT (holders[10], batch->access_kind_id[i]);
+			SDB_PARAM_SET_INT (holders[11], batch->implementation_kind_id[i]);
+		}
+
+		nrows = gda_connection_statement_execute_non_select (priv->db_connection, 
+															 query->stmt, 
+															 query->plist, 
+															 &last_inserted,
+															 &error);
+		if (error)
+		{
+			DEBUG_PRINT ("symbol batch insert failed: %s", error->message);
+			g_error_free (error);
+		}
+	}
+
+	if (nrows == batch->n_rows && last_inserted != NULL)
+	{
+		const GValue *value = gda_set_get_holder_value (last_inserted, "+0");
+
+		sdb_engine_symbol_batch_read_ids (dbe, batch, g_value_get_int (value));
+	}
+	else
+	{
+		/* a row already on db, e.g. two tags with the same name and line,
+		 * makes the whole statement fail. Fall back to one insert for each
+		 * row, so that only the duplicated ones are lost as before */
+		for (i = 0; i < batch->n_rows; i++)
+		{
+			sdb_engine_symbol_batch_row_inserted (dbe, batch, i, 
+							sdb_engine_symbol_batch_insert_row (dbe, batch, i));
+		}
+	}
+	
+	if (last_inserted)
+		g_object_unref (last_inserted);
+
+	sdb_engine_symbol_batch_clear (batch);
+}
+
+/**
+ * Return the type name of the symbol. For variables it is extracted from
+ * the pattern into *type_regex, which has to be freed.
+ */
+static const gchar *
+sdb_engine_get_symbol_type_name (const tagEntry *tag_entry, gchar **type_regex)
+{
+	const gchar *type_type = tag_entry->kind;
+	
+	*type_regex = NULL;
+	if (g_strcmp0 (type_type, "member") == 0 || 
+	    g_strcmp0 (type_type, "variable") == 0 || 
+	    g_strcmp0 (type_type, "field") == 0)
+	{
+		*type_regex = sdb_engine_extract_type_qualifier (tag_entry->address.pattern, 
+		                                                 tag_entry->name);
+		/*DEBUG_PRINT ("type_regex for %s [kind %s] is %s", tag_entry->name, 
+		             tag_entry->kind, *type_regex);*/
+
+		/* if the extractor failed we should fallback to the default one */
+		if (*type_regex != NULL)
+			return *type_regex;
+	}
+
+	return tag_entry->name;
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * Queue a new symbol for a multi row insert, flushing the batch when it is
+ * full. Strings are copied.
+ */
+static void
+sdb_engine_symbol_batch_add (SymbolDBEngine *dbe, const tagEntry *tag_entry,
+							 gint file_defined_id, const gchar *signature,
+							 const gchar *returntype, gint scope_definition_id,
+							 const gchar *type_type, const gchar *type_name,
+							 gint kind_id, gint access_kind_id,
+							 gint implementation_kind_id)
+{
+	SymbolBatch *batch;
+	gint row;
+
+	batch = dbe->priv->symbol_batch;
+	row = batch->n_rows++;
+
+	batch->file_defined_id[row] = file_defined_id;
+	batch->name[row] = g_string_chunk_insert_const (batch->strings, tag_entry->name);
+	batch->file_position[row] = tag_entry->address.lineNumber;
+	batch->is_file_scope[row] = tag_entry->fileScope;
+	batch->signature[row] = signature == NULL ? NULL :
+		g_string_chunk_insert (batch->strings, signature);
+	batch->returntype[row] = returntype == NULL ? NULL :
+		g_string_chunk_insert_const (batch->strings, returntype);
+	batch->scope_definition_id[row] = scope_definition_id;
+	batch->type_type[row] = type_type == NULL ? NULL :
+		g_string_chunk_insert_const (batch->strings, type_type);
+	batch->type_name[row] = g_string_chunk_insert_const (batch->strings, type_name);
+	batch->kind_id[row] = kind_id;
+	batch->access_kind_id[row] = access_kind_id;
+	batch->implementation_kind_id[row] = implementation_kind_id;
+	batch->tmp_heritage[row] = sdb_engine_tmp_heritage_scope_new (tag_entry);
+
+	if (batch->n_rows == SYMBOL_BATCH_ROWS)
+		sdb_engine_symbol_batch_flush (dbe);
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * Queue a symbol of a file being scanned for the first time: it cannot be
+ * already on db. Unlike sdb_engine_add_new_symbol () the symbol id is not
+ * known until the batch is flushed.
+ */
+static void
+sdb_engine_queue_new_symbol (SymbolDBEngine *dbe, const tagEntry *tag_entry,
+							 gint file_defined_id)
+{
+	gchar *type_regex;
+	const gchar *type_name;
+	
+	type_name = sdb_engine_get_symbol_type_name (tag_entry, &type_regex);
+	
+	sdb_engine_symbol_batch_add (dbe, tag_entry, file_defined_id,
+								 tagsField (tag_entry, "signature"),
+								 tagsField (tag_entry, "returntype"),
+								 sdb_engine_add_new_scope_definition (dbe, tag_entry),
+								 tag_entry->kind, type_name,
+								 sdb_engine_add_new_sym_kind (dbe, tag_entry),
+								 sdb_engine_add_new_sym_access (dbe, tag_entry),
+								 sdb_engine_add_new_sym_implementation (dbe, tag_entry));
+	g_free (type_regex);
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ### 
+ *
+ * base_prj_path can be NULL. In that case path info tag_entry will be taken
+ * as an absolute path.
+ * fake_file can be used when a buffer updating is being executed. In that 
+ * particular case both base_prj_path and tag_entry->file will be ignored. 
+ * fake_file is real_path of file on disk
+ */
+static gint
+sdb_engine_add_new_symbol (SymbolDBEngine * dbe, const tagEntry * tag_entry,
+						   gint file_defined_id,
+						   gboolean sym_update)
+{
+	SymbolDBEnginePriv *priv;
+	GdaSet *plist;
+	GdaStatement *stmt;
+	GdaSet *last_inserted = NULL;
+	gint table_id, symbol_id;
+	const gchar* name;
+	gint file_position = 0;
+	gint is_file_scope = 0;
+	const gchar *signature;
+	const gchar *returntype;
 	gint scope_definition_id = 0;
 	gint scope_id = 0;
 	gint kind_id = 0;
@@ -4830,25 +6013,7 @@ sdb_engine_add_new_symbol (SymbolDBEngine * dbe, const tagEntry * tag_entry,
 	 */
 	/* we assume that tag_entry is != NULL */
 	type_type = tag_entry->kind;
-	type_regex = NULL;
-	
-	if (g_strcmp0 (type_type, "member") == 0 || 
-	    g_strcmp0 (type_type, "variable") == 0 || 
-	    g_strcmp0 (type_type, "field") == 0)
-	{
-		type_regex = sdb_engine_extract_type_qualifier (tag_entry->address.pattern, 
-		                                                tag_entry->name);
-		/*DEBUG_PRINT ("type_regex for %s [kind %s] is %s", tag_entry->name, 
-		             tag_entry->kind, type_regex);*/
-		type_name = type_regex;
-
-		/* if the extractor failed we should fallback to the default one */
-		if (type_name == NULL)
-			type_name = tag_entry->name;
-	}	else 
-	{
-		type_name = tag_entry->name;
-	}
+	type_name = sdb_engine_get_symbol_type_name (tag_entry, &type_regex);
 	
 
 	/*
@@ -4868,7 +6033,7 @@ sdb_engine_add_new_symbol (SymbolDBEngine * dbe, const tagEntry * tag_entry,
 	access_kind_id = sdb_engine_add_new_sym_access (dbe, tag_entry);
 	
 	implementation_kind_id = sdb_engine_add_new_sym_implementation (dbe, tag_entry);
-	
+
 	/* ok: was the symbol updated [at least on it's type_id/name]? 
 	 * There are 3 cases:
 	 * #1. The symbol remains the same [at least on unique index key]. We will 
@@ -5015,6 +6180,11 @@ sdb_engine_detects_removed_ids (SymbolDBEngine *dbe)
 	gint i, num_rows;	
 		
 	priv = dbe->priv;
+
+	/* the scope rows defined by the removed symbols have been deleted by
+	 * the trigger */
+	if (priv->scope_cache)
+		g_hash_table_remove_all (priv->scope_cache);
 	
 	/* ok, now we should read from __tmp_removed all the symbol ids which have
 	 * been removed, and emit a signal 
@@ -5388,6 +6558,10 @@ symbol_db_engine_update_files_symbols (SymbolDBEngine * dbe, const gchar * proje
  * 
  * Update symbols of the whole project. It scans all file symbols etc. 
  * If force is true then update forcely all the files.
+ * Each file is compared with its record on db (size, mtime, inode and, when
+ * these aren't enough, the md5 of the contents) by a parallel stat pass, so
+ * that only the files really changed are scanned again. Files which don't 
+ * exist anymore are removed.
  * ~~~ Thread note: this function locks the mutex ~~~ *
  * 
  * Returns: scan id of the process, or -1 in case of problems.
@@ -5402,7 +6576,10 @@ symbol_db_engine_update_project_symbols (SymbolDBEngine *dbe,
 	GdaDataModel *data_model;
 	gint num_rows = 0;
 	gint i;
+	gint col_path, col_size, col_mtime, col_inode, col_hash;
+	GPtrArray *checks;
 	GPtrArray *files_to_scan;
+	GPtrArray *files_to_remove;
 	SymbolDBEnginePriv *priv;
 	GValue v = {0};
 	
@@ -5439,11 +6616,15 @@ symbol_db_engine_update_project_symbols (SymbolDBEngine *dbe,
 	SDB_PARAM_SET_STRING(param, project_name);	
 	
 	/* execute the query with parameters just set */
-	GType gtype_array [6] = {	G_TYPE_INT, 
+	GType gtype_array [10] = {	G_TYPE_INT, 
 								G_TYPE_STRING, 
 								G_TYPE_INT, 
 								G_TYPE_INT, 
 								GDA_TYPE_TIMESTAMP, 
+								G_TYPE_INT64, 
+								G_TYPE_INT64, 
+								G_TYPE_INT64, 
+								G_TYPE_STRING, 
 								G_TYPE_NONE
 							};
 	data_model = gda_connection_statement_execute_select_full (priv->db_connection, 
@@ -5466,108 +6647,111 @@ symbol_db_engine_update_project_symbols (SymbolDBEngine *dbe,
 		return FALSE;		    
 	}
 
-	/* initialize the array */
-	files_to_scan = g_ptr_array_new_with_free_func (g_free);
-
-	/* we can now scan each filename entry to check the last modification time. */
+	/* collect the db record of each file. Files are then checked without
+	 * holding the mutex */
+	checks = g_ptr_array_new_with_free_func ((GDestroyNotify)sdb_file_check_free);
+	col_path = gda_data_model_get_column_index (data_model, "db_file_path");
+	col_size = gda_data_model_get_column_index (data_model, "file_size");
+	col_mtime = gda_data_model_get_column_index (data_model, "file_mtime");
+	col_inode = gda_data_model_get_column_index (data_model, "file_inode");
+	col_hash = gda_data_model_get_column_index (data_model, "file_hash");
+	
 	for (i = 0; i < num_rows; i++)
 	{	
-		const GValue *value, *value1;
-		const GdaTimestamp *timestamp;
+		const GValue *value;
 		const gchar *file_name;
-		gchar *file_abs_path = NULL;
-		struct tm filetm;
-		time_t db_time;
-		GFile *gfile;
-		GFileInfo* gfile_info;
-		GFileInputStream* gfile_is;
-
-		if ((value =
-			 gda_data_model_get_value_at (data_model, 
-						gda_data_model_get_column_index(data_model,
-												   "db_file_path"), 
-										  i, NULL)) == NULL)
+		SdbFileCheck *check;
+
+		if ((value = gda_data_model_get_value_at (data_model, col_path, 
+		                                          i, NULL)) == NULL)
 		{
 			continue;
 		}
 
-		/* build abs path. */
 		file_name = g_value_get_string (value);
 		if (!file_name)
 			continue;
 
-		file_abs_path = g_build_filename (priv->project_directory,
-		    file_name, NULL);
+		check = g_slice_new0 (SdbFileCheck);
+		check->file_on_db = g_strdup (file_name);
+		check->abs_path = g_build_filename (priv->project_directory,
+		                                    file_name, NULL);
+		check->db_size = -1;
 
-		gfile = g_file_new_for_path (file_abs_path);
-		gfile_is = g_file_read (gfile, NULL, NULL);
-		/* retrieve data/time info */
-		if (gfile_is == NULL)
-		{
-			g_message ("could not open path %s", file_abs_path);
-			g_free (file_abs_path);
-			g_object_unref (gfile);
-			continue;
-		}
-		g_object_unref (gfile_is);
-				
-		gfile_info = g_file_query_info (gfile, "*", G_FILE_QUERY_INFO_NONE,
-										NULL, NULL);
-
-		if (gfile_info == NULL)
-		{
-			g_message ("cannot get file info from handle");
-			g_free (file_abs_path);
-			g_object_unref (gfile);
-			continue;
-		}
-
-		if ((value1 = gda_data_model_get_value_at (data_model, 
-						gda_data_model_get_column_index(data_model,
-												   "analyse_time"), i, NULL)) == NULL)
-		{
-			continue;
-		}
+		value = gda_data_model_get_value_at (data_model, col_size, i, NULL);
+		if (value != NULL && G_VALUE_HOLDS_INT64 (value))
+			check->db_size = g_value_get_int64 (value);
+		
+		value = gda_data_model_get_value_at (data_model, col_mtime, i, NULL);
+		if (value != NULL && G_VALUE_HOLDS_INT64 (value))
+			check->db_mtime = g_value_get_int64 (value);
 
+		value = gda_data_model_get_value_at (data_model, col_inode, i, NULL);
+		if (value != NULL && G_VALUE_HOLDS_INT64 (value))
+			check->db_inode = g_value_get_int64 (value);
 
-		timestamp = gda_value_get_timestamp (value1);
+		value = gda_data_model_get_value_at (data_model, col_hash, i, NULL);
+		if (value != NULL && G_VALUE_HOLDS_STRING (value) &&
+		    g_value_get_string (value) != NULL && 
+		    *g_value_get_string (value) != '\0')
+			check->db_hash = g_value_dup_string (value);
 
-		/* fill a struct tm with the date retrieved by the string. */
-		/* string is something like '2007-04-18 23:51:39' */
-		memset (&filetm, 0, sizeof (struct tm));
-		filetm.tm_year = timestamp->year - 1900;		
-		filetm.tm_mon = timestamp->month - 1;
-		filetm.tm_mday = timestamp->day;
-		filetm.tm_hour = timestamp->hour;
-		filetm.tm_min = timestamp->minute;
-		filetm.tm_sec = timestamp->second;
+		g_ptr_array_add (checks, check);
+	}
+	
+	g_object_unref (data_model);
+	SDB_UNLOCK(priv);
 
-		/* remove one hour to the db_file_time. */
-		db_time = mktime (&filetm) - 3600;
+	sdb_engine_check_files (checks, force_all_files);
 
-		guint64 modified_time = g_file_info_get_attribute_uint64 (gfile_info, 
-										  G_FILE_ATTRIBUTE_TIME_MODIFIED);
-		if (difftime (db_time, modified_time) < 0 ||
-		    force_all_files == TRUE)
-		{
-			g_ptr_array_add (files_to_scan, file_abs_path);
-		}
-		else
+	files_to_scan = g_ptr_array_new_with_free_func (g_free);
+	files_to_remove = g_ptr_array_new_with_free_func (g_free);
+	
+	SDB_LOCK(priv);
+	gda_connection_begin_transaction (priv->db_connection, "filerecordtrans",
+	                                  GDA_TRANSACTION_ISOLATION_READ_UNCOMMITTED,
+	                                  NULL);
+	for (i = 0; i < checks->len; i++)
+	{
+		SdbFileCheck *check = g_ptr_array_index (checks, i);
+
+		switch (check->state)
 		{
-			g_free (file_abs_path);
+			case SDB_FILE_CHANGED:
+				g_ptr_array_add (files_to_scan, g_strdup (check->abs_path));
+				break;
+
+			case SDB_FILE_TOUCHED:
+				/* same contents: just refresh the record */
+				sdb_engine_set_file_record (dbe, check->file_on_db, check->size,
+				                            check->mtime, check->inode, 
+				                            check->hash);
+				break;
+
+			case SDB_FILE_MISSING:
+				g_message ("could not find path %s", check->abs_path);
+				g_ptr_array_add (files_to_remove, g_strdup (check->file_on_db));
+				break;
+
+			default:
+				break;
 		}
-		
-		g_object_unref (gfile_info);
-		g_object_unref (gfile);
 	}
-	
-	if (data_model)
-		g_object_unref (data_model);
+	gda_connection_commit_transaction (priv->db_connection, "filerecordtrans",
+	                                   NULL);
+	SDB_UNLOCK(priv);
+
+	DEBUG_PRINT ("%d files checked: %d changed, %d missing", checks->len, 
+	             files_to_scan->len, files_to_remove->len);
+	g_ptr_array_unref (checks);
+
+	/* files removed from disk while the project was closed */
+	if (files_to_remove->len > 0)
+		symbol_db_engine_remove_files (dbe, project_name, files_to_remove);
+	g_ptr_array_unref (files_to_remove);
 	
 	if (files_to_scan->len > 0)
 	{
-		SDB_UNLOCK(priv);
-
 		/* at the end let the scanning function do its job */
 		gint id = symbol_db_engine_update_files_symbols (dbe, project_name,
 											   files_to_scan, TRUE);
@@ -5576,7 +6760,7 @@ symbol_db_engine_update_project_symbols (SymbolDBEngine *dbe,
 		return id;
 	}
 	
-	SDB_UNLOCK(priv);
+	g_ptr_array_unref (files_to_scan);
 
 	/* some error occurred */
 	return -1;
@@ -5712,6 +6896,81 @@ on_scan_update_buffer_end (SymbolDBEngine * dbe, gint process_id, gpointer data)
 	data = files_to_scan = NULL;
 }
 
+/**
+ * sdb_engine_buffer_to_shared_mem:
+ * @dbe: self
+ * @relative_path: path on db of the file the buffer belongs to.
+ * @padding_lines: number of empty lines written before the buffer.
+ * @buffer: the text to write.
+ * @buffer_size: size of @buffer.
+ *
+ * Writes @buffer to a /dev/shm/anjuta-XYZ file to be scanned by ctags. The
+ * padding lines make ctags report the line numbers of a buffer holding only
+ * a part of the file as if it was the whole file.
+ *
+ * Returns: the path of the shared memory file, NULL on error.
+ */
+static gchar *
+sdb_engine_buffer_to_shared_mem (SymbolDBEngine *dbe, const gchar *relative_path,
+                                 gint padding_lines, const gchar *buffer,
+                                 gint buffer_size)
+{
+	SymbolDBEnginePriv *priv;
+	FILE *buffer_mem_file;
+	gint buffer_mem_fd;
+	gchar *shared_temp_file;
+	gchar *base_filename;
+	gchar *temp_file;
+	gint i;
+
+	priv = dbe->priv;
+	
+	/* it's ok to have just the base filename to create the
+	 * target buffer one */
+	base_filename = g_filename_display_basename (relative_path);
+		
+	shared_temp_file = g_strdup_printf ("/anjuta-%d-%ld-%s", getpid (),
+					 time (NULL), base_filename);
+	g_free (base_filename);
+		
+	if ((buffer_mem_fd = 
+		 shm_open (shared_temp_file, O_CREAT|O_RDWR|O_TRUNC, S_IRUSR|S_IWUSR)) < 0)
+	{
+		g_warning ("Error while trying to open a shared memory file. Be"
+				   "sure to have "SHARED_MEMORY_PREFIX" mounted with tmpfs");
+		g_free (shared_temp_file);
+		return NULL;
+	}
+	
+	buffer_mem_file = fdopen (buffer_mem_fd, "w+b");
+		
+	for (i = 0; i < padding_lines; i++)
+		fputc ('\n', buffer_mem_file);
+	fwrite (buffer, sizeof(gchar), buffer_size, buffer_mem_file);
+	fflush (buffer_mem_file);
+	fclose (buffer_mem_file);
+		
+	temp_file = g_strdup_printf (SHARED_MEMORY_PREFIX"%s", shared_temp_file);
+		
+	/* check if we already have an entry stored in the hash table, else
+	 * insert it 
+	 */		
+	if (g_hash_table_lookup (priv->garbage_shared_mem_files, shared_temp_file) 
+		== NULL)
+	{
+		DEBUG_PRINT ("inserting into garbage hash table %s", shared_temp_file);
+		g_hash_table_insert (priv->garbage_shared_mem_files, shared_temp_file, 
+							 NULL);
+	}
+	else 
+	{
+		/* the item is already stored. Just free it here. */
+		g_free (shared_temp_file);
+	}
+
+	return temp_file;
+}
+
 /**
  * symbol_db_engine_update_buffer_symbols:
  * @dbe: self
@@ -5759,12 +7018,9 @@ symbol_db_engine_update_buffer_symbols (SymbolDBEngine * dbe, const gchar *proje
 	{
 		const gchar *relative_path;
 		const gchar *curr_abs_file;
-		FILE *buffer_mem_file;
 		const gchar *temp_buffer;
-		gint buffer_mem_fd;
 		gint temp_size;
 		gchar *shared_temp_file;
-		gchar *base_filename;
 		
 		curr_abs_file = g_ptr_array_index (real_files_list, i);
 		/* check if the file exists in db. We will not scan buffers for files
@@ -5785,50 +7041,16 @@ symbol_db_engine_update_buffer_symbols (SymbolDBEngine * dbe, const gchar *proje
 		}
 		g_ptr_array_add (real_files_on_db, (gpointer) relative_path);
 
-		/* it's ok to have just the base filename to create the
-		 * target buffer one */
-		base_filename = g_filename_display_basename (relative_path);
-		
-		shared_temp_file = g_strdup_printf ("/anjuta-%d-%ld-%s", getpid (),
-						 time (NULL), base_filename);
-		g_free (base_filename);
-		
-		if ((buffer_mem_fd = 
-			 shm_open (shared_temp_file, O_CREAT|O_RDWR, S_IRUSR|S_IWUSR)) < 0)
-		{
-			g_warning ("Error while trying to open a shared memory file. Be"
-					   "sure to have "SHARED_MEMORY_PREFIX" mounted with tmpfs");
-			return -1;
-		}
-	
-		buffer_mem_file = fdopen (buffer_mem_fd, "w+b");
-		
 		temp_buffer = g_ptr_array_index (text_buffers, i);
 		temp_size = GPOINTER_TO_INT(g_ptr_array_index (buffer_sizes, i));
-		
-		fwrite (temp_buffer, sizeof(gchar), temp_size, buffer_mem_file);
-		fflush (buffer_mem_file);
-		fclose (buffer_mem_file);
+
+		shared_temp_file = sdb_engine_buffer_to_shared_mem (dbe, relative_path, 0,
+		                                                    temp_buffer, temp_size);
+		if (shared_temp_file == NULL)
+			return -1;
 		
 		/* add the temp file to the array. */
-		g_ptr_array_add (temp_files, g_strdup_printf (SHARED_MEMORY_PREFIX"%s", 
-													  shared_temp_file));
-		
-		/* check if we already have an entry stored in the hash table, else
-		 * insert it 
-		 */		
-		if (g_hash_table_lookup (priv->garbage_shared_mem_files, shared_temp_file) 
-			== NULL)
-		{
-			DEBUG_PRINT ("inserting into garbage hash table %s", shared_temp_file);
-			g_hash_table_insert (priv->garbage_shared_mem_files, shared_temp_file, 
-								 NULL);
-		}
-		else 
-		{
-			/* the item is already stored. Just free it here. */
-			g_free (shared_temp_file);
-		}
+		g_ptr_array_add (temp_files, shared_temp_file);
 	}
 
 	/* in case we didn't have any good buffer to scan...*/
@@ -5859,6 +7081,340 @@ symbol_db_engine_update_buffer_symbols (SymbolDBEngine * dbe, const gchar *proje
 	return ret_id;
 }
 
+/* ### Thread note: this function inherits the mutex lock ### */
+static gint
+sdb_engine_get_top_level_symbol_line (SymbolDBEngine *dbe, static_query_type qtype,
+                                      const gchar *file_on_db, gint line)
+{
+	const GdaSet *plist;
+	const GdaStatement *stmt;
+	GdaHolder *param;
+	GdaDataModel *data_model;
+	const GValue *value;
+	gint symbol_line;
+	GValue v = {0};
+
+	if ((stmt = sdb_engine_get_statement_by_query_id (dbe, qtype)) == NULL)
+	{
+		g_warning ("query is null");
+		return -1;
+	}
+
+	plist = sdb_engine_get_query_parameters_list (dbe, qtype);
+
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filepath")) == NULL)
+	{
+		g_warning ("param filepath is NULL from pquery!");
+		return -1;
+	}
+	SDB_PARAM_SET_STRING(param, file_on_db);
+
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "fileposition")) == NULL)
+	{
+		g_warning ("param fileposition is NULL from pquery!");
+		return -1;
+	}
+	SDB_PARAM_SET_INT(param, line);
+
+	data_model = gda_connection_statement_execute_select (dbe->priv->db_connection, 
+														  (GdaStatement*)stmt, 
+														  (GdaSet*)plist, NULL);
+	if (!GDA_IS_DATA_MODEL (data_model) ||
+		gda_data_model_get_n_rows (GDA_DATA_MODEL (data_model)) <= 0)
+	{
+		if (data_model != NULL)
+			g_object_unref (data_model);
+		return -1;
+	}
+
+	value = gda_data_model_get_value_at (data_model, 0, 0, NULL);
+	symbol_line = value && G_VALUE_HOLDS_INT (value) ? g_value_get_int (value) : -1;
+	g_object_unref (data_model);
+
+	return symbol_line;
+}
+
+/**
+ * symbol_db_engine_get_buffer_update_range:
+ * @dbe: self
+ * @real_file: full path on disk to the file.
+ * @begin_line: first line changed, set to the line of the enclosing
+ * 				top-level symbol. The declaration may start on the lines 
+ * 				before, like the return type of a GNU style definition.
+ * @end_line: last line changed, set to the line preceding the next top-level
+ * 				declaration or to -1 if there is none.
+ *
+ * Widens a range of changed lines to the top-level declarations enclosing it,
+ * according to the symbols currently in db. Lines are counted from 1.
+ *
+ * Returns: FALSE if the file isn't in db.
+ */
+gboolean
+symbol_db_engine_get_buffer_update_range (SymbolDBEngine *dbe,
+                                          const gchar *real_file,
+                                          gint *begin_line, gint *end_line)
+{
+	SymbolDBEnginePriv *priv;
+	const gchar *relative_path;
+	gint line;
+
+	g_return_val_if_fail (dbe != NULL, FALSE);
+	g_return_val_if_fail (real_file != NULL, FALSE);
+	g_return_val_if_fail (begin_line != NULL && end_line != NULL, FALSE);
+	priv = dbe->priv;
+
+	if (symbol_db_engine_file_exists (dbe, real_file) == FALSE)
+		return FALSE;
+
+	relative_path = symbol_db_util_get_file_db_path (dbe, real_file);
+	if (relative_path == NULL)
+		return FALSE;
+
+	SDB_LOCK(priv);
+	line = sdb_engine_get_top_level_symbol_line (dbe,
+	                                             PREP_QUERY_GET_TOP_LEVEL_SYMBOL_LINE_BEFORE,
+	                                             relative_path, *begin_line);
+	*begin_line = line > 0 ? line : 1;
+
+	line = sdb_engine_get_top_level_symbol_line (dbe,
+	                                             PREP_QUERY_GET_TOP_LEVEL_SYMBOL_LINE_AFTER,
+	                                             relative_path, *end_line);
+	*end_line = line > 0 ? line - 1 : -1;
+	SDB_UNLOCK(priv);
+
+	return TRUE;
+}
+
+/**
+ * ### Thread note: this function inherits the mutex lock ###
+ *
+ * Marks the symbols outside the range of the range update scan_id, if any, 
+ * so that the update pass of the scan only changes the symbols of the range.
+ */
+static void
+sdb_engine_prepare_range_update (SymbolDBEngine *dbe, gint scan_id)
+{
+	BufferRangeUpdate *range;
+	const GdaSet *plist;
+	const GdaStatement *stmt;
+	GdaHolder *param;
+	GValue v = {0};
+
+	range = g_hash_table_lookup (dbe->priv->range_updates, 
+	                             GINT_TO_POINTER (scan_id));
+	if (range == NULL || range->prepared == TRUE)
+		return;
+
+	/* symbols before the range are kept as they are */
+	if ((stmt = sdb_engine_get_statement_by_query_id (dbe, 
+								PREP_QUERY_SET_UPDATE_FLAG_SYMBOLS_BEFORE_LINE)) == NULL)
+	{
+		g_warning ("query is null");
+		return;
+	}
+	plist = sdb_engine_get_query_parameters_list (dbe, 
+								PREP_QUERY_SET_UPDATE_FLAG_SYMBOLS_BEFORE_LINE);
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filepath")) == NULL)
+	{
+		g_warning ("param filepath is NULL from pquery!");
+		return;
+	}
+	SDB_PARAM_SET_STRING(param, range->file_on_db);
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "fileposition")) == NULL)
+	{
+		g_warning ("param fileposition is NULL from pquery!");
+		return;
+	}
+	SDB_PARAM_SET_INT(param, range->begin_line);
+	gda_connection_statement_execute_non_select (dbe->priv->db_connection, 
+												 (GdaStatement*)stmt, 
+												 (GdaSet*)plist, NULL, NULL);
+	range->prepared = TRUE;
+
+	/* symbols after the range are kept too, only moved by the lines added
+	 * or removed */
+	if (range->old_end_line < 0)
+		return;
+	
+	if ((stmt = sdb_engine_get_statement_by_query_id (dbe, 
+								PREP_QUERY_SHIFT_SYMBOLS_AFTER_LINE)) == NULL)
+	{
+		g_warning ("query is null");
+		return;
+	}
+	plist = sdb_engine_get_query_parameters_list (dbe, 
+								PREP_QUERY_SHIFT_SYMBOLS_AFTER_LINE);
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "filepath")) == NULL)
+	{
+		g_warning ("param filepath is NULL from pquery!");
+		return;
+	}
+	SDB_PARAM_SET_STRING(param, range->file_on_db);
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "fileposition")) == NULL)
+	{
+		g_warning ("param fileposition is NULL from pquery!");
+		return;
+	}
+	SDB_PARAM_SET_INT(param, range->old_end_line);
+	if ((param = gda_set_get_holder ((GdaSet*)plist, "linesdelta")) == NULL)
+	{
+		g_warning ("param linesdelta is NULL from pquery!");
+		return;
+	}
+	SDB_PARAM_SET_INT(param, range->lines_delta);
+	gda_connection_statement_execute_non_select (dbe->priv->db_connection, 
+												 (GdaStatement*)stmt, 
+												 (GdaSet*)plist, NULL, NULL);
+}
+
+static void
+on_scan_update_range_end (SymbolDBEngine *dbe, gint process_id, gpointer data)
+{
+	SymbolDBEnginePriv *priv;
+	BufferRangeUpdate *range;
+	gchar *file_on_db;
+	gboolean prepared;
+
+	g_return_if_fail (dbe != NULL);
+	g_return_if_fail (data != NULL);
+
+	priv = dbe->priv;
+	range = (BufferRangeUpdate *) data;
+
+	/* the end of another scan */
+	if (process_id != range->scan_id)
+		return;
+	
+	g_signal_handlers_disconnect_by_func (dbe, on_scan_update_range_end,
+										  range);
+
+	SDB_LOCK(priv);
+	prepared = range->prepared;
+	file_on_db = range->file_on_db;
+	range->file_on_db = NULL;
+	g_hash_table_remove (priv->range_updates, GINT_TO_POINTER (process_id));
+	SDB_UNLOCK(priv);
+
+	/* if the buffer has not been scanned no symbol has been marked */
+	if (prepared == TRUE &&
+	    sdb_engine_update_file (dbe, file_on_db) == FALSE)
+		g_warning ("Error processing file %s", file_on_db);
+
+	g_free (file_on_db);
+}
+
+/**
+ * symbol_db_engine_update_buffer_range_symbols:
+ * @dbe: self
+ * @project: project name
+ * @real_file: full path on disk to the 'real file' to update.
+ * @text_buffer: text of lines @begin_line to @new_end_line of the buffer.
+ * @buffer_size: size of @text_buffer.
+ * @begin_line: first line of the range, usually got from
+ * 				symbol_db_engine_get_buffer_update_range().
+ * @old_end_line: last line of the range in the file as known by db, -1 if 
+ * 				the range goes up to the end of file.
+ * @new_end_line: last line of the range in the buffer, ignored if
+ * 				@old_end_line is -1.
+ * 
+ * Like symbol_db_engine_update_buffer_symbols() but scans only a range of
+ * lines of the buffer. Symbols outside the range are kept, the ones after it
+ * being moved by the number of lines added or removed. Symbols inside the 
+ * range are updated, keeping their ids when they are found again.
+ * 
+ * Returns: scan process id if insertion is successful, -1 on error.
+ */
+gint
+symbol_db_engine_update_buffer_range_symbols (SymbolDBEngine *dbe,
+                                              const gchar *project,
+                                              const gchar *real_file,
+                                              const gchar *text_buffer,
+                                              gint buffer_size,
+                                              gint begin_line,
+                                              gint old_end_line,
+                                              gint new_end_line)
+{
+	SymbolDBEnginePriv *priv;
+	GPtrArray *temp_files;
+	BufferRangeUpdate *range;
+	GPtrArray *real_files_on_db;
+	gchar *relative_path;
+	gchar *shared_temp_file;
+	gint scan_id;
+	gboolean ret_code;
+	
+	g_return_val_if_fail (dbe != NULL, -1);
+	priv = dbe->priv;
+	
+	g_return_val_if_fail (priv->db_connection != NULL, -1);
+	g_return_val_if_fail (project != NULL, -1);
+	g_return_val_if_fail (real_file != NULL, -1);
+	g_return_val_if_fail (text_buffer != NULL, -1);
+	g_return_val_if_fail (begin_line > 0, -1);
+
+	if (symbol_db_engine_file_exists (dbe, real_file) == FALSE)
+	{
+		DEBUG_PRINT ("will not scan buffer claiming to be %s because not in db",
+					 real_file);
+		return -1;
+	}
+
+	relative_path = g_strdup (symbol_db_util_get_file_db_path (dbe, real_file));
+	if (relative_path == NULL)
+	{
+		g_warning ("relative_path is NULL");
+		return -1;
+	}
+	
+	shared_temp_file = sdb_engine_buffer_to_shared_mem (dbe, relative_path,
+	                                                    begin_line - 1,
+	                                                    text_buffer, buffer_size);
+	if (shared_temp_file == NULL)
+	{
+		g_free (relative_path);
+		return -1;
+	}
+
+	scan_id = sdb_engine_get_unique_scan_id (dbe);
+
+	/* the symbols outside the range are marked by the scan itself, once the
+	 * scans queued before this one are over */
+	range = g_new0 (BufferRangeUpdate, 1);
+	range->scan_id = scan_id;
+	range->file_on_db = g_strdup (relative_path);
+	range->begin_line = begin_line;
+	range->old_end_line = old_end_line;
+	range->lines_delta = new_end_line - old_end_line;
+	
+	SDB_LOCK(priv);
+	g_hash_table_insert (priv->range_updates, GINT_TO_POINTER (scan_id), range);
+	SDB_UNLOCK(priv);
+
+	temp_files = g_ptr_array_new_with_free_func (g_free);
+	g_ptr_array_add (temp_files, shared_temp_file);
+	real_files_on_db = g_ptr_array_new_with_free_func (g_free);
+	g_ptr_array_add (real_files_on_db, relative_path);
+
+	/* the update flags are reset when the scan ends */
+	g_signal_connect (G_OBJECT (dbe), "scan-end",
+					  G_CALLBACK (on_scan_update_range_end), range);
+
+	ret_code = sdb_engine_scan_files_async (dbe, temp_files, real_files_on_db, 
+	                                        TRUE, scan_id);
+	if (ret_code == FALSE)
+	{
+		g_signal_handlers_disconnect_by_func (dbe, on_scan_update_range_end,
+											  range);
+		SDB_LOCK(priv);
+		g_hash_table_remove (priv->range_updates, GINT_TO_POINTER (scan_id));
+		SDB_UNLOCK(priv);
+	}
+	
+	g_ptr_array_unref (temp_files);	
+	g_ptr_array_unref (real_files_on_db);
+	return ret_code == TRUE ? scan_id : -1;
+}
+
 /**
  * symbol_db_engine_get_files_for_project:
  * @dbe: self
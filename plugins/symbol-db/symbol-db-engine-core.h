@@ -95,6 +95,9 @@ symbol_db_engine_new_full (const gchar * ctags_path, const gchar * database_name
 gboolean
 symbol_db_engine_set_ctags_path (SymbolDBEngine *dbe, const gchar * ctags_path);
 
+gboolean
+symbol_db_engine_set_ctags_workers (SymbolDBEngine *dbe, gint n_workers);
+
 
 SymbolDBEngineOpenStatus
 symbol_db_engine_open_db (SymbolDBEngine *dbe, const gchar* base_db_path,
@@ -174,6 +177,21 @@ symbol_db_engine_update_buffer_symbols (SymbolDBEngine * dbe, const gchar * proj
 										const GPtrArray * text_buffers,
 										const GPtrArray * buffer_sizes);
 
+gboolean
+symbol_db_engine_get_buffer_update_range (SymbolDBEngine *dbe,
+                                          const gchar *real_file,
+                                          gint *begin_line, gint *end_line);
+
+gint
+symbol_db_engine_update_buffer_range_symbols (SymbolDBEngine *dbe,
+                                              const gchar *project,
+                                              const gchar *real_file,
+                                              const gchar *text_buffer,
+                                              gint buffer_size,
+                                              gint begin_line,
+                                              gint old_end_line,
+                                              gint new_end_line);
+
 GdaDataModel*
 symbol_db_engine_get_files_for_project (SymbolDBEngine *dbe);
 
@@ -34,11 +34,13 @@
 #include <libanjuta/interfaces/ianjuta-symbol-manager.h>
 #include <libanjuta/interfaces/ianjuta-symbol.h>
 
+#include "symbol-db-engine-core.h"
+
 /* file should be specified without the ".db" extension. */
 #define ANJUTA_DB_FILE	".anjuta_sym_db"
 
 /* if tables.sql changes or general db structure changes modify also the value here */
-#define SYMBOL_DB_VERSION	"373.0"
+#define SYMBOL_DB_VERSION	"377.0"
 
 #define TABLES_SQL			PACKAGE_DATA_DIR"/tables.sql"
 
@@ -47,10 +49,23 @@
 #define SHARED_MEMORY_PREFIX			SYMBOL_DB_SHM
 
 #define THREADS_MAX_CONCURRENT			2
+#define CTAGS_WORKERS_MAX				4
 #define TRIGGER_SIGNALS_DELAY			100
 
 #define BATCH_SYMBOL_NUMBER				15000
 
+/* the project files are checked against their db record by up to 
+ * FILE_CHECK_THREADS_MAX threads, each one taking FILE_CHECK_BATCH_SIZE 
+ * files at least */
+#define FILE_CHECK_THREADS_MAX			4
+#define FILE_CHECK_BATCH_SIZE			512
+
+/* new symbols are inserted SYMBOL_BATCH_ROWS at a time. Keep 
+ * SYMBOL_BATCH_ROWS * SYMBOL_BATCH_COLUMNS under the sqlite limit of 999
+ * parameters per statement. */
+#define SYMBOL_BATCH_ROWS				64
+#define SYMBOL_BATCH_COLUMNS			12
+
 #define SDB_QUERY_SEARCH_HEADER \
 	GValue v = {0}; \
 	SymbolDBQueryPriv *priv; \
@@ -61,6 +76,10 @@
 	g_value_init (&value, G_TYPE_INT); \
 	g_value_set_int (&value, (int_value));
 
+#define SDB_GVALUE_SET_INT64(value, int64_value) \
+	g_value_init (&value, G_TYPE_INT64); \
+	g_value_set_int64 (&value, (int64_value));
+
 #define SDB_GVALUE_SET_DOUBLE(value, double_value) \
 	g_value_init (&value, G_TYPE_DOUBLE); \
 	g_value_set_double (&value, (double_value));
@@ -79,6 +98,11 @@
 	gda_holder_set_value ((gda_param), &v, NULL); \
 	g_value_unset (&v);
 
+#define SDB_PARAM_SET_INT64(gda_param, int64_value) \
+	SDB_GVALUE_SET_INT64(v, int64_value); \
+	gda_holder_set_value ((gda_param), &v, NULL); \
+	g_value_unset (&v);
+
 #define SDB_PARAM_SET_DOUBLE(gda_param, double_value) \
 	SDB_GVALUE_SET_DOUBLE(v, double_value); \
 	gda_holder_set_value ((gda_param), &v, NULL); \
@@ -114,6 +138,8 @@ typedef enum
 	PREP_QUERY_GET_FILE_ID_BY_UNIQUE_NAME,
 	PREP_QUERY_GET_ALL_FROM_FILE_BY_PROJECT_NAME,
 	PREP_QUERY_UPDATE_FILE_ANALYSE_TIME,
+	PREP_QUERY_GET_FILE_RECORD,
+	PREP_QUERY_UPDATE_FILE_RECORD,
 	PREP_QUERY_GET_ALL_FROM_FILE_WHERE_NOT_IN_SYMBOLS,
 	PREP_QUERY_LANGUAGE_NEW,
 	PREP_QUERY_GET_LANGUAGE_ID_BY_UNIQUE_NAME,
@@ -131,9 +157,14 @@ typedef enum
 	PREP_QUERY_GET_SYMBOL_ID_BY_CLASS_NAME_AND_NAMESPACE,
 	PREP_QUERY_UPDATE_SYMBOL_SCOPE_ID,
 	PREP_QUERY_GET_SYMBOL_ID_BY_UNIQUE_INDEX_KEY_EXT,
+	PREP_QUERY_GET_LAST_SYMBOL_IDS,
 	PREP_QUERY_UPDATE_SYMBOL_ALL,
 	PREP_QUERY_REMOVE_NON_UPDATED_SYMBOLS,
 	PREP_QUERY_RESET_UPDATE_FLAG_SYMBOLS,
+	PREP_QUERY_SET_UPDATE_FLAG_SYMBOLS_BEFORE_LINE,
+	PREP_QUERY_SHIFT_SYMBOLS_AFTER_LINE,
+	PREP_QUERY_GET_TOP_LEVEL_SYMBOL_LINE_BEFORE,
+	PREP_QUERY_GET_TOP_LEVEL_SYMBOL_LINE_AFTER,
 	PREP_QUERY_GET_REMOVED_IDS,
 	PREP_QUERY_TMP_REMOVED_DELETE_ALL,
 	PREP_QUERY_REMOVE_FILE_BY_PROJECT_NAME,
@@ -150,6 +181,9 @@ typedef struct _static_query_node
 
 } static_query_node;
 
+typedef struct _SymbolBatch SymbolBatch;
+typedef struct _SymbolBatchQuery SymbolBatchQuery;
+
 /* normalize with iface naming */
 typedef IAnjutaSymbolType SymType;
 
@@ -160,6 +194,28 @@ typedef struct _DBESignal
 	
 } DBESignal;
 
+/* An anjuta-tags process running in filter mode. Files are distributed 
+ * between the workers, so that more files can be parsed in parallel while the
+ * output of each worker is written to db.
+ */
+typedef struct _SdbCtagsWorker
+{
+	SymbolDBEngine *dbe;
+	AnjutaLauncher *ctags_launcher;
+
+	/* scan flags and real files of the files sent to this worker, in order */
+	GAsyncQueue *scan_aqueue;
+
+	/* output received from the launcher and not yet parsed */
+	GMutex output_mutex;
+	GString *output;
+
+	gchar *shared_mem_str;
+	FILE *shared_mem_file;
+	gint shared_mem_fd;
+	
+} SdbCtagsWorker;
+
 /* the SymbolDBEngine Private structure */
 struct _SymbolDBEnginePriv
 {
@@ -177,16 +233,14 @@ struct _SymbolDBEnginePriv
 	gint scan_process_id_sequence;
 	gint current_scan_process_id;
 	
-	GAsyncQueue *scan_aqueue;	
 	GAsyncQueue *updated_syms_id_aqueue;
 	GAsyncQueue *updated_scope_syms_id_aqueue;
 	GAsyncQueue *inserted_syms_id_aqueue;
 	gboolean is_scanning;
 	
-	gchar *shared_mem_str;
-	FILE *shared_mem_file;
-	gint shared_mem_fd;
-	AnjutaLauncher *ctags_launcher;
+	GPtrArray *ctags_workers;
+	gint ctags_workers_count;
+	gint scan_files_pending;
 	GList *removed_launchers;
 	gboolean shutting_down;
 	gboolean is_first_population;
@@ -195,6 +249,9 @@ struct _SymbolDBEnginePriv
 	GAsyncQueue *waiting_scan_aqueue;
 	gulong waiting_scan_handler;
 
+	/* buffer range updates waiting for their scan, by scan id */
+	GHashTable *range_updates;
+
 	/* Threads management */
 	GMutex mutex;
 	GAsyncQueue* signals_aqueue;
@@ -213,12 +270,18 @@ struct _SymbolDBEnginePriv
 	GHashTable *access_cache;
 	GHashTable *implementation_cache;
 	GHashTable *language_cache;
+	GHashTable *scope_cache;
 
 	/* Table maps */
 	GQueue *tmp_heritage_tablemap;
 	
 	static_query_node *static_query_list[PREP_QUERY_COUNT]; 
 
+	/* Symbols waiting for a multi row insert, and the statements to insert
+	 * 1 up to SYMBOL_BATCH_ROWS symbols at once. */
+	SymbolBatch *symbol_batch;
+	SymbolBatchQuery *symbol_batch_queries[SYMBOL_BATCH_ROWS + 1];
+
 #ifdef DEBUG
 	GTimer *first_scan_timer_DEBUG;
 #endif	
@@ -221,8 +221,10 @@ sdb_model_file_set_property (GObject *object, guint prop_id,
 	switch (prop_id)
 	{
 	case PROP_SYMBOL_DB_FILE_PATH:
+		symbol_db_model_lock_backend (SYMBOL_DB_MODEL (object));
 		old_file_path = priv->file_path;
 		priv->file_path = g_value_dup_string (value);
+		symbol_db_model_unlock_backend (SYMBOL_DB_MODEL (object));
 		if (g_strcmp0 (old_file_path, priv->file_path) != 0)
 		{
 			if (!priv->refresh_queue_id)
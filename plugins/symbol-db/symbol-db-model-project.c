@@ -331,7 +331,9 @@ on_sdb_project_dbe_unref (SymbolDBModelProject *model)
 
 	g_return_if_fail (SYMBOL_DB_IS_MODEL_PROJECT (model));
 	priv = SYMBOL_DB_MODEL_PROJECT (model)->priv;
+	symbol_db_model_lock_backend (SYMBOL_DB_MODEL (model));
 	priv->dbe = NULL;
+	symbol_db_model_unlock_backend (SYMBOL_DB_MODEL (model));
 	symbol_db_model_update (SYMBOL_DB_MODEL (model));
 }
 
@@ -362,7 +364,9 @@ sdb_model_project_set_property (GObject *object, guint prop_id,
 				              G_CALLBACK (symbol_db_model_thaw),
 				              object);
 		}
+		symbol_db_model_lock_backend (SYMBOL_DB_MODEL (object));
 		priv->dbe = g_value_dup_object (value);
+		symbol_db_model_unlock_backend (SYMBOL_DB_MODEL (object));
 		g_object_weak_ref (G_OBJECT (priv->dbe),
 			                    (GWeakNotify)on_sdb_project_dbe_unref,
 			                     object);
@@ -172,9 +172,11 @@ sdb_model_search_set_property (GObject *object, guint prop_id,
 	switch (prop_id)
 	{
 	case PROP_SEARCH_PATTERN:
+		symbol_db_model_lock_backend (SYMBOL_DB_MODEL (object));
 		old_pattern = priv->search_pattern;
 		priv->search_pattern = g_strdup_printf ("%%%s%%",
 		                                        g_value_get_string (value));
+		symbol_db_model_unlock_backend (SYMBOL_DB_MODEL (object));
 		if (g_strcmp0 (old_pattern, priv->search_pattern) != 0)
 		{
 			if (priv->refresh_queue_id)
@@ -29,15 +29,46 @@
 #define SYMBOL_DB_MODEL_PAGE_SIZE 50
 #define SYMBOL_DB_MODEL_ENSURE_CHILDREN_BATCH_SIZE 10
 
+/* How far ahead of the rows being displayed pages are prefetched */
+#define SYMBOL_DB_MODEL_PREFETCH_DISTANCE SYMBOL_DB_MODEL_PAGE_SIZE
+
+typedef struct _SymbolDBModelFetch SymbolDBModelFetch;
+typedef struct _SymbolDBModelNode SymbolDBModelNode;
+
 typedef struct _SymbolDBModelPage SymbolDBModelPage;
 struct _SymbolDBModelPage
 {
 	gint begin_offset, end_offset;
 	SymbolDBModelPage *prev;
 	SymbolDBModelPage *next;
+
+	/* Pending background fetch filling this page, NULL once loaded */
+	SymbolDBModelFetch *fetch;
+};
+
+/* A page load or a children count running in the fetch thread. The thread
+ * only works on the copy of the parent values, the nodes are created back in
+ * main thread. @parent_node and @page are reset to NULL if the page or the
+ * node is destroyed before the fetch completes.
+ */
+struct _SymbolDBModelFetch
+{
+	SymbolDBModel *model;
+	SymbolDBModelNode *parent_node;
+	SymbolDBModelPage *page;
+
+	gint tree_level;
+	gint n_values;
+	GValue *values;
+	gint offset, limit;
+
+	GdaDataModel *data_model;
+
+	/* Count the children of @parent_node instead of loading a page */
+	gboolean count;
+	gint n_children;
 };
 
-typedef struct _SymbolDBModelNode SymbolDBModelNode;
 struct _SymbolDBModelNode {
 
 	gint n_columns;
@@ -50,6 +81,9 @@ struct _SymbolDBModelNode {
 
 	/* List of currently active (cached) pages */
 	SymbolDBModelPage *pages;
+
+	/* Last child accessed, gives the scrolling direction for prefetch */
+	gint last_offset;
 	
 	/* Data structure */
 	gint level;
@@ -63,6 +97,10 @@ struct _SymbolDBModelNode {
 	gboolean children_ensured;
 	guint n_children;
 	SymbolDBModelNode **children;
+
+	/* Pending background count of the children. Until it completes, the
+	 * node has a single empty child */
+	SymbolDBModelFetch *count_fetch;
 };
 
  struct _SymbolDBModelPriv {
@@ -77,6 +115,12 @@ struct _SymbolDBModelNode {
 	gint *query_columns; /* Corresponding GdaDataModel column */
 	
 	SymbolDBModelNode *root;
+
+	/* Pages are loaded in a background thread, backend_mutex serializes
+	 * the backend queries of the thread with the ones done in main thread.
+	 */
+	GThreadPool *fetch_pool;
+	GMutex backend_mutex;
 };
 
 enum {
@@ -122,6 +166,16 @@ static void sdb_model_ensure_node_children (SymbolDBModel *model,
                                             gboolean emit_has_child,
                                             gboolean fake_child);
 
+static void sdb_model_ensure_node_children_async (SymbolDBModel *model,
+                                                  SymbolDBModelNode *node);
+
+static void sdb_model_node_set_n_children (SymbolDBModel *model,
+                                           SymbolDBModelNode *node,
+                                           gint n_children);
+
+static GtkTreePath *sdb_model_get_path (GtkTreeModel *tree_model,
+                                        GtkTreeIter *iter);
+
 /* Class definition */
 G_DEFINE_TYPE_WITH_CODE (SymbolDBModel, sdb_model, G_TYPE_OBJECT,
                          G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
@@ -224,15 +278,25 @@ sdb_model_node_cleanse (SymbolDBModelNode *node, gboolean force)
 		}
 	}
 	
-	/* Reset cached pages */
+	/* Reset cached pages, cancelling the ones still being fetched */
 	page = node->pages;
 	while (page)
 	{
 		next = page->next;
+		if (page->fetch)
+		{
+			page->fetch->parent_node = NULL;
+			page->fetch->page = NULL;
+		}
 		g_slice_free (SymbolDBModelPage, page);
 		page = next;
 	}
 	node->pages = NULL;
+	if (node->count_fetch)
+	{
+		node->count_fetch->parent_node = NULL;
+		node->count_fetch = NULL;
+	}
 	node->children_ensured = FALSE;
 	node->n_children = 0;
 
@@ -267,8 +331,8 @@ sdb_model_node_free (SymbolDBModelNode *node, gboolean force)
  * @node: The node with the page
  * @page: The page to remove
  *
- * Removes the cache @page from the @node. The associated nodes are all
- * destroyed and set to NULL. They could be re-fetched later if needed.
+ * Removes the cache @page from the @node and destroys it. The page must
+ * not have any child node created yet.
  */
 static void
 sdb_model_node_remove_page (SymbolDBModelNode *node,
@@ -282,7 +346,7 @@ sdb_model_node_remove_page (SymbolDBModelNode *node,
 	if (page->next)
 		page->next->prev = page->prev;
 
-	/* FIXME: Destroy the page */
+	g_slice_free (SymbolDBModelPage, page);
 }
 
 /**
@@ -302,6 +366,7 @@ sdb_model_node_insert_page (SymbolDBModelNode *node,
 {
 	
 	/* Insert the new page after "after" page */
+	page->prev = after;
 	if (after)
 	{
 		page->next = after->next;
@@ -312,6 +377,8 @@ sdb_model_node_insert_page (SymbolDBModelNode *node,
 		page->next = node->pages;
 		node->pages = page;
 	}
+	if (page->next)
+		page->next->prev = page;
 }
 
 /**
@@ -480,10 +547,213 @@ sdb_model_iter_is_valid (GtkTreeModel *model, GtkTreeIter *iter)
 	return TRUE;
 }
 
+/**
+ * sdb_model_page_fill:
+ * @model: The model
+ * @parent_node: The node whose children are filled
+ * @page: The page being filled
+ * @data_model: The rows of the page
+ * @emit_changed: Whether to emit row-changed for the new nodes
+ *
+ * Creates the children nodes of @parent_node covered by @page from the
+ * rows fetched in @data_model.
+ */
+static void
+sdb_model_page_fill (SymbolDBModel *model,
+                     SymbolDBModelNode *parent_node,
+                     SymbolDBModelPage *page,
+                     GdaDataModel *data_model,
+                     gboolean emit_changed)
+{
+	gint i;
+	GdaDataModelIter *data_iter;
+
+	if (!GDA_IS_DATA_MODEL (data_model))
+		return;
+
+	/* Fill up the page */
+	data_iter = gda_data_model_create_iter (data_model);
+	if (gda_data_model_iter_move_to_row (data_iter, 0))
+	{
+		for (i = page->begin_offset; i < page->end_offset; i++)
+		{
+			if (i >= parent_node->n_children)
+			{
+				/* FIXME: There are more rows in DB. Extend node */
+				break;
+			}
+			SymbolDBModelNode *node =
+				sdb_model_node_new (model, parent_node, i,
+				                    data_model, data_iter);
+			g_assert (sdb_model_node_get_child (parent_node, i) == NULL);
+			sdb_model_node_set_child (parent_node, i, node);
+
+			/* The row was displayed empty until now */
+			if (emit_changed)
+			{
+				GtkTreePath *path;
+				GtkTreeIter iter = {0};
+
+				iter.stamp = SYMBOL_DB_MODEL_STAMP;
+				iter.user_data = parent_node;
+				iter.user_data2 = GINT_TO_POINTER (i);
+				path = sdb_model_get_path (GTK_TREE_MODEL (model), &iter);
+				gtk_tree_model_row_changed (GTK_TREE_MODEL (model),
+				                            path, &iter);
+				gtk_tree_path_free (path);
+			}
+			if (!gda_data_model_iter_move_next (data_iter))
+			{
+				if (i < (page->end_offset - 1))
+				{
+					/* FIXME: There are fewer rows in DB. Shrink node */
+				}
+				break;
+			}
+		}
+	}
+
+	if (data_iter)
+		g_object_unref (data_iter);
+}
+
+static void
+sdb_model_fetch_free (SymbolDBModelFetch *fetch)
+{
+	gint i;
+
+	for (i = 0; i < fetch->n_values; i++)
+		g_value_unset (&fetch->values[i]);
+	g_free (fetch->values);
+	if (fetch->data_model)
+		g_object_unref (fetch->data_model);
+	g_object_unref (fetch->model);
+	g_slice_free (SymbolDBModelFetch, fetch);
+}
+
+/**
+ * sdb_model_fetch_done:
+ * @data: The completed fetch
+ *
+ * Called in main thread once a page has been fetched or the children of a
+ * node counted in the background. The page nodes are created unless the
+ * page has been destroyed meanwhile. If the model got frozen, the result is
+ * dropped to be fetched again later.
+ */
+static gboolean
+sdb_model_fetch_done (gpointer data)
+{
+	SymbolDBModelFetch *fetch = data;
+	SymbolDBModelPage *page = fetch->page;
+
+	if (fetch->count)
+	{
+		/* A frozen model is updated when thawed */
+		if (fetch->parent_node)
+		{
+			fetch->parent_node->count_fetch = NULL;
+			if (fetch->model->priv->freeze_count == 0)
+				sdb_model_node_set_n_children (fetch->model,
+				                               fetch->parent_node,
+				                               fetch->n_children);
+		}
+	}
+	else if (page)
+	{
+		page->fetch = NULL;
+		if (fetch->model->priv->freeze_count > 0)
+			sdb_model_node_remove_page (fetch->parent_node, page);
+		else
+			sdb_model_page_fill (fetch->model, fetch->parent_node, page,
+			                     fetch->data_model, TRUE);
+	}
+	sdb_model_fetch_free (fetch);
+	return FALSE;
+}
+
+/* Thread function of the fetch pool */
+static void
+sdb_model_fetch_thread (gpointer data, gpointer user_data)
+{
+	SymbolDBModelFetch *fetch = data;
+
+	/* Skip pages and nodes destroyed before being fetched. The flag is
+	 * set in main thread, so this check is only an optimization.
+	 */
+	if (fetch->count)
+	{
+		if (fetch->parent_node != NULL)
+			fetch->n_children = sdb_model_get_n_children (fetch->model,
+			                                              fetch->tree_level,
+			                                              fetch->values);
+	}
+	else if (fetch->page != NULL)
+	{
+		fetch->data_model = sdb_model_get_children (fetch->model,
+		                                            fetch->tree_level,
+		                                            fetch->values,
+		                                            fetch->offset,
+		                                            fetch->limit);
+		/* Make sure all rows are read here and not in main thread */
+		if (GDA_IS_DATA_MODEL (fetch->data_model))
+			gda_data_model_get_n_rows (fetch->data_model);
+	}
+	g_idle_add (sdb_model_fetch_done, fetch);
+}
+
+static SymbolDBModelFetch*
+sdb_model_fetch_new (SymbolDBModel *model, SymbolDBModelNode *parent_node)
+{
+	SymbolDBModelFetch *fetch;
+	gint i;
+
+	fetch = g_slice_new0 (SymbolDBModelFetch);
+	fetch->model = g_object_ref (model);
+	fetch->parent_node = parent_node;
+	fetch->tree_level = parent_node->level;
+
+	/* The parent node could be destroyed while fetching */
+	fetch->n_values = parent_node->values ? parent_node->n_columns : 0;
+	fetch->values = g_new0 (GValue, fetch->n_values);
+	for (i = 0; i < fetch->n_values; i++)
+	{
+		g_value_init (&fetch->values[i], G_VALUE_TYPE (&parent_node->values[i]));
+		g_value_copy (&parent_node->values[i], &fetch->values[i]);
+	}
+
+	return fetch;
+}
+
+/**
+ * sdb_model_page_fetch_async:
+ * @model: The model
+ * @parent_node: The node whose children are fetched
+ * @page: The page to fill
+ *
+ * Queues the fetch of @page in the background thread. The page stays empty
+ * until the fetch completes, the view showing blank rows meanwhile.
+ */
+static void
+sdb_model_page_fetch_async (SymbolDBModel *model,
+                            SymbolDBModelNode *parent_node,
+                            SymbolDBModelPage *page)
+{
+	SymbolDBModelFetch *fetch;
+
+	fetch = sdb_model_fetch_new (model, parent_node);
+	fetch->page = page;
+	fetch->offset = page->begin_offset;
+	fetch->limit = page->end_offset - page->begin_offset;
+
+	page->fetch = fetch;
+	g_thread_pool_push (model->priv->fetch_pool, fetch, NULL);
+}
+
 /**
  * sdb_model_page_fault:
  * @parent_node: The node which needs children data fetched
  * @child_offset: Offset of the child where page fault occured
+ * @async: Whether to fetch the page in background
  *
  * Page fault should happen on a child which is not yet available in cache
  * and needs to be fetched from backend database. Fetch happens in a page
@@ -491,51 +761,76 @@ sdb_model_iter_is_valid (GtkTreeModel *model, GtkTreeIter *iter)
  * child node. Also, the page will adjust the boundry to any preceeding or
  * or following pages so that they don't overlap.
  *
+ * If @async is TRUE, the page is returned empty and filled later by the
+ * fetch thread. Otherwise the page is fetched right away, including when
+ * a background fetch was already pending for it. Nothing is fetched while
+ * the children of @parent_node are being counted.
+ *
  * Returns: The newly fetched page
  */
 static SymbolDBModelPage*
 sdb_model_page_fault (SymbolDBModel *model,
                       SymbolDBModelNode *parent_node,
-                      gint child_offset)
+                      gint child_offset,
+                      gboolean async)
 {
 	SymbolDBModelPriv *priv;
 	SymbolDBModelPage *page, *prev_page, *page_found;
-	gint i;
-	GdaDataModelIter *data_iter;
 	GdaDataModel *data_model = NULL;
 
+	/* The children are not known yet */
+	if (parent_node->count_fetch != NULL)
+		return NULL;
+
 	/* Insert after prev_page */
 	page_found = sdb_model_node_find_child_page (parent_node,
 	                                             child_offset,
 	                                             &prev_page);
 
-	if (page_found)
+	if (page_found && (async || page_found->fetch == NULL))
 		return page_found;
 
 	/* If model is frozen, can't fetch data from backend */
 	priv = model->priv;
 	if (priv->freeze_count > 0)
 		return NULL;
-	
-	/* New page to cover current child_offset */
-	page = g_slice_new0 (SymbolDBModelPage);
 
-	/* Define page range */
-	page->begin_offset = child_offset - SYMBOL_DB_MODEL_PAGE_SIZE;
-	page->end_offset = child_offset + SYMBOL_DB_MODEL_PAGE_SIZE;
+	if (page_found)
+	{
+		/* Needed now, take over the pending fetch */
+		page = page_found;
+		page->fetch->parent_node = NULL;
+		page->fetch->page = NULL;
+		page->fetch = NULL;
+	}
+	else
+	{
+		/* New page to cover current child_offset */
+		page = g_slice_new0 (SymbolDBModelPage);
 
-	sdb_model_node_insert_page (parent_node, page, prev_page);
+		/* Define page range */
+		page->begin_offset = child_offset - SYMBOL_DB_MODEL_PAGE_SIZE;
+		page->end_offset = child_offset + SYMBOL_DB_MODEL_PAGE_SIZE;
+
+		sdb_model_node_insert_page (parent_node, page, prev_page);
 	
-	/* Adjust boundries not to overlap with preceeding or following page */
-	if (prev_page && prev_page->end_offset > page->begin_offset)
-		page->begin_offset = prev_page->end_offset;
+		/* Adjust boundries not to overlap with preceeding or following page */
+		if (prev_page && prev_page->end_offset > page->begin_offset)
+			page->begin_offset = prev_page->end_offset;
 
-	if (page->next && page->end_offset >= page->next->begin_offset)
-		page->end_offset = page->next->begin_offset;
+		if (page->next && page->end_offset >= page->next->begin_offset)
+			page->end_offset = page->next->begin_offset;
 
-	/* Adjust boundries not to preceed 0 index */
-	if (page->begin_offset < 0)
-		page->begin_offset = 0;
+		/* Adjust boundries not to preceed 0 index */
+		if (page->begin_offset < 0)
+			page->begin_offset = 0;
+	}
+
+	if (async)
+	{
+		sdb_model_page_fetch_async (model, parent_node, page);
+		return page;
+	}
 	
 	/* Load a page from database */
 	data_model = sdb_model_get_children (model, parent_node->level,
@@ -543,40 +838,45 @@ sdb_model_page_fault (SymbolDBModel *model,
 	                                     page->begin_offset,
 	                                     page->end_offset - page->begin_offset);
 
-	/* Fill up the page */
-	data_iter = gda_data_model_create_iter (data_model);
-	if (gda_data_model_iter_move_to_row (data_iter, 0))
-	{
-		for (i = page->begin_offset; i < page->end_offset; i++)
-		{
-			if (i >= parent_node->n_children)
-			{
-				/* FIXME: There are more rows in DB. Extend node */
-				break;
-			}
-			SymbolDBModelNode *node =
-				sdb_model_node_new (model, parent_node, i,
-				                    data_model, data_iter);
-			g_assert (sdb_model_node_get_child (parent_node, i) == NULL);
-			sdb_model_node_set_child (parent_node, i, node);
-			if (!gda_data_model_iter_move_next (data_iter))
-			{
-				if (i < (page->end_offset - 1))
-				{
-					/* FIXME: There are fewer rows in DB. Shrink node */
-				}
-				break;
-			}
-		}
-	}
+	sdb_model_page_fill (model, parent_node, page, data_model, FALSE);
 
-	if (data_iter)
-		g_object_unref (data_iter);
 	if (data_model)
 		g_object_unref (data_model);
 	return page;
 }
 
+/**
+ * sdb_model_prefetch:
+ * @model: The model
+ * @parent_node: The parent of the child being displayed
+ * @child_offset: Offset of the child being displayed
+ *
+ * Guesses the scrolling direction from the previously displayed child and
+ * starts fetching in background the page coming next in that direction,
+ * so that it's likely loaded by the time the view reaches it.
+ */
+static void
+sdb_model_prefetch (SymbolDBModel *model,
+                    SymbolDBModelNode *parent_node,
+                    gint child_offset)
+{
+	SymbolDBModelPage *prev_page;
+	gint ahead;
+
+	if (child_offset >= parent_node->last_offset)
+		ahead = child_offset + SYMBOL_DB_MODEL_PREFETCH_DISTANCE;
+	else
+		ahead = child_offset - SYMBOL_DB_MODEL_PREFETCH_DISTANCE;
+	parent_node->last_offset = child_offset;
+
+	ahead = CLAMP (ahead, 0, parent_node->n_children - 1);
+	if (sdb_model_node_get_child (parent_node, ahead) == NULL &&
+	    sdb_model_node_find_child_page (parent_node, ahead, &prev_page) == NULL)
+	{
+		sdb_model_page_fault (model, parent_node, ahead, TRUE);
+	}
+}
+
 /* GtkTreeModel implementation */
 
 static GtkTreeModelFlags
@@ -704,9 +1004,13 @@ sdb_model_get_value (GtkTreeModel *tree_model,
 	parent_node = (SymbolDBModelNode*) iter->user_data;
 	offset = GPOINTER_TO_INT (iter->user_data2);
 
+	/* Rows not loaded yet are fetched in background and shown empty
+	 * until then */
 	if (sdb_model_node_get_child (parent_node, offset) == NULL)
 		sdb_model_page_fault (SYMBOL_DB_MODEL (tree_model),
-		                      parent_node, offset);
+		                      parent_node, offset, TRUE);
+	if (priv->freeze_count == 0)
+		sdb_model_prefetch (SYMBOL_DB_MODEL (tree_model), parent_node, offset);
 	node = sdb_model_node_get_child (parent_node, offset);
 	g_value_init (value, priv->column_types[column]);
 
@@ -777,10 +1081,12 @@ sdb_model_iter_children (GtkTreeModel *tree_model,
 		if (!node)
 		{
 			sdb_model_page_fault (SYMBOL_DB_MODEL (tree_model),
-			                      parent_node, offset);
+			                      parent_node, offset, FALSE);
 			node = sdb_model_node_get_child (parent_node, offset);
 		}
-		g_return_val_if_fail (node != NULL, FALSE);
+		/* The parent node can still be counting its children */
+		if (node == NULL)
+			return FALSE;
 	}
 
 	/* Apparently view can call this funtion without testing has_child first */
@@ -788,8 +1094,14 @@ sdb_model_iter_children (GtkTreeModel *tree_model,
 		return FALSE;
 
 	if (!node->children_ensured)
-		sdb_model_ensure_node_children (SYMBOL_DB_MODEL (tree_model),
-		                                node, FALSE, TRUE);
+	{
+		if (node->parent)
+			sdb_model_ensure_node_children_async (SYMBOL_DB_MODEL (tree_model),
+			                                      node);
+		else
+			sdb_model_ensure_node_children (SYMBOL_DB_MODEL (tree_model),
+			                                node, FALSE, TRUE);
+	}
 
 	iter->user_data = node;
 	iter->user_data2 = GINT_TO_POINTER (0);
@@ -853,8 +1165,14 @@ sdb_model_iter_n_children (GtkTreeModel *tree_model,
 	if (node == NULL)
 		return 0;
 	if (!node->children_ensured)
-		sdb_model_ensure_node_children (SYMBOL_DB_MODEL (tree_model),
-		                                node, FALSE, FALSE);
+	{
+		if (node->parent)
+			sdb_model_ensure_node_children_async (SYMBOL_DB_MODEL (tree_model),
+			                                      node);
+		else
+			sdb_model_ensure_node_children (SYMBOL_DB_MODEL (tree_model),
+			                                node, FALSE, FALSE);
+	}
 	return node->n_children;
 }
 
@@ -1022,6 +1340,84 @@ sdb_model_ensure_node_children (SymbolDBModel *model,
 	}
 }
 
+/**
+ * sdb_model_ensure_node_children_async:
+ * @model: The tree model
+ * @node: The node for which the children are being ensured
+ *
+ * Same as sdb_model_ensure_node_children() but the children are counted in
+ * the fetch thread, so that expanding a node does not wait for the backend.
+ * Meanwhile the node has one empty child if it has any.
+ */
+static void
+sdb_model_ensure_node_children_async (SymbolDBModel *model,
+                                      SymbolDBModelNode *node)
+{
+	g_return_if_fail (node->n_children == 0);
+	g_return_if_fail (node->children == NULL);
+	g_return_if_fail (node->children_ensured == FALSE);
+
+	/* Can not ensure if model is frozen */
+	if (model->priv->freeze_count > 0)
+		return;
+
+	if (!sdb_model_get_has_child (model, node))
+	{
+		node->children_ensured = TRUE;
+		return;
+	}
+
+	node->children_ensured = TRUE;
+	node->n_children = 1;
+	node->count_fetch = sdb_model_fetch_new (model, node);
+	node->count_fetch->count = TRUE;
+	g_thread_pool_push (model->priv->fetch_pool, node->count_fetch, NULL);
+}
+
+/**
+ * sdb_model_node_set_n_children:
+ * @model: The tree model
+ * @node: The node whose children have been counted
+ * @n_children: Number of children
+ *
+ * Replaces the empty child shown while counting by the @n_children
+ * children of @node.
+ */
+static void
+sdb_model_node_set_n_children (SymbolDBModel *model,
+                               SymbolDBModelNode *node,
+                               gint n_children)
+{
+	GtkTreePath *path;
+	GtkTreeIter iter = {0};
+	gint i;
+
+	iter.stamp = SYMBOL_DB_MODEL_STAMP;
+	iter.user_data = node;
+	iter.user_data2 = GINT_TO_POINTER (0);
+	path = sdb_model_get_path (GTK_TREE_MODEL (model), &iter);
+
+	if (n_children <= 0)
+	{
+		node->n_children = 0;
+		node->has_child = FALSE;
+		gtk_tree_model_row_deleted (GTK_TREE_MODEL (model), path);
+		gtk_tree_path_free (path);
+		sdb_model_emit_has_child (model, node);
+		return;
+	}
+
+	node->n_children = n_children;
+	gtk_tree_model_row_changed (GTK_TREE_MODEL (model), path, &iter);
+	for (i = 1; i < n_children; i++)
+	{
+		gtk_tree_path_next (path);
+		iter.user_data2 = GINT_TO_POINTER (i);
+		gtk_tree_model_row_inserted (GTK_TREE_MODEL (model), path, &iter);
+	}
+	gtk_tree_path_free (path);
+}
+
 /**
  * sdb_model_update_node_children:
  * @model: The model being updated
@@ -1242,8 +1638,14 @@ static gint
 sdb_model_get_n_children (SymbolDBModel *model, gint tree_level,
                           GValue column_values[])
 {
-	return SYMBOL_DB_MODEL_GET_CLASS(model)->get_n_children (model, tree_level,
-	                                                         column_values);
+	gint n_children;
+
+	g_mutex_lock (&model->priv->backend_mutex);
+	n_children = SYMBOL_DB_MODEL_GET_CLASS(model)->get_n_children (model,
+	                                                               tree_level,
+	                                                               column_values);
+	g_mutex_unlock (&model->priv->backend_mutex);
+	return n_children;
 }
 
 /**
@@ -1271,13 +1673,19 @@ sdb_model_get_children_real (SymbolDBModel *model, gint tree_level,
 	return data_model;
 }
 
+/* Can be called from the fetch thread */
 static GdaDataModel*
 sdb_model_get_children (SymbolDBModel *model, gint tree_level,
                         GValue column_values[], gint offset,
                         gint limit)
 {
-	return SYMBOL_DB_MODEL_GET_CLASS(model)->
+	GdaDataModel *data_model;
+
+	g_mutex_lock (&model->priv->backend_mutex);
+	data_model = SYMBOL_DB_MODEL_GET_CLASS(model)->
 		get_children (model, tree_level, column_values, offset, limit);
+	g_mutex_unlock (&model->priv->backend_mutex);
+	return data_model;
 }
 
 /* Object implementation */
@@ -1288,6 +1696,11 @@ sdb_model_finalize (GObject *object)
 	SymbolDBModelPriv *priv;
 
 	priv = SYMBOL_DB_MODEL (object)->priv;;
+
+	/* Pending fetches hold a reference on the model, so none is left */
+	g_thread_pool_free (priv->fetch_pool, TRUE, TRUE);
+	g_mutex_clear (&priv->backend_mutex);
+	
 	g_free (priv->column_types);
 	g_free (priv->query_columns);
 	sdb_model_node_cleanse (priv->root, TRUE);
@@ -1337,6 +1750,10 @@ sdb_model_init (SymbolDBModel *object)
 	priv->n_columns = 0;
 	priv->column_types = NULL;
 	priv->query_columns = NULL;
+
+	g_mutex_init (&priv->backend_mutex);
+	priv->fetch_pool = g_thread_pool_new (sdb_model_fetch_thread, NULL,
+	                                      1, FALSE, NULL);
 }
 
 static void
@@ -1489,3 +1906,43 @@ symbol_db_model_thaw (SymbolDBModel *model)
 	if (priv->freeze_count <= 0)
 		symbol_db_model_update (model);
 }
+
+/**
+ * symbol_db_model_load_row:
+ * @model: The model
+ * @iter: A row of the model
+ *
+ * The rows are loaded in background and read empty until then. Readers other
+ * than the view, which need the content, call this to load the row now.
+ * The row can still be empty if its parent is counting its children.
+ */
+void
+symbol_db_model_load_row (SymbolDBModel *model, GtkTreeIter *iter)
+{
+	SymbolDBModelNode *parent_node;
+	gint offset;
+
+	g_return_if_fail (SYMBOL_DB_IS_MODEL (model));
+	g_return_if_fail (sdb_model_iter_is_valid (GTK_TREE_MODEL (model), iter));
+
+	parent_node = (SymbolDBModelNode*) iter->user_data;
+	offset = GPOINTER_TO_INT (iter->user_data2);
+	if (sdb_model_node_get_child (parent_node, offset) == NULL)
+		sdb_model_page_fault (model, parent_node, offset, FALSE);
+}
+
+void
+symbol_db_model_lock_backend (SymbolDBModel *model)
+{
+	g_return_if_fail (SYMBOL_DB_IS_MODEL (model));
+
+	g_mutex_lock (&model->priv->backend_mutex);
+}
+
+void
+symbol_db_model_unlock_backend (SymbolDBModel *model)
+{
+	g_return_if_fail (SYMBOL_DB_IS_MODEL (model));
+
+	g_mutex_unlock (&model->priv->backend_mutex);
+}
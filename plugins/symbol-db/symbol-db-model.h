@@ -87,6 +87,16 @@ GtkTreeModel* symbol_db_model_newv (gint n_columns, GType *types,
 void symbol_db_model_set_columns (SymbolDBModel *model, gint n_columns,
                                   GType *types, gint *data_cols);
 
+/* Used by derived classes around changes of the state used by the
+ * get_children and get_n_children methods, which can be called from
+ * a background thread.
+ */
+void symbol_db_model_lock_backend (SymbolDBModel *model);
+void symbol_db_model_unlock_backend (SymbolDBModel *model);
+
+/* Loads a row which is still being fetched in background */
+void symbol_db_model_load_row (SymbolDBModel *model, GtkTreeIter *iter);
+
 void symbol_db_model_update (SymbolDBModel *model);
 void symbol_db_model_freeze (SymbolDBModel *model);
 void symbol_db_model_thaw (SymbolDBModel *model);
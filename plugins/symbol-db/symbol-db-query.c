@@ -30,6 +30,10 @@
 #define SYMBOL_DB_QUERY_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
 	SYMBOL_DB_TYPE_QUERY, SymbolDBQueryPriv))
 
+/* Number of trigrams of the search pattern looked up in symbol_name_trigram */
+#define SDB_QUERY_TRIGRAMS 3
+#define SDB_QUERY_CHAIN_MAX 8
+
 /* Class properties */
 enum
 {
@@ -54,6 +58,12 @@ struct _SymbolDBQueryPriv {
 	gchar *sql_stmt;
 	GdaStatement *stmt;
 
+	/* Same statement restricted through the trigram index, for searches
+	 * with a leading wildcard */
+	gchar *sql_stmt_trigram;
+	GdaStatement *stmt_trigram;
+	gboolean use_trigrams;
+
 	IAnjutaSymbolQueryName name;
 	IAnjutaSymbolQueryMode mode;
 	IAnjutaSymbolField fields[IANJUTA_SYMBOL_FIELD_END];
@@ -72,6 +82,11 @@ struct _SymbolDBQueryPriv {
 	GdaSet *params;
 	GdaHolder *param_pattern, *param_file_path, *param_limit, *param_offset;
 	GdaHolder *param_file_line, *param_id;
+	GdaHolder *param_trigrams[SDB_QUERY_TRIGRAMS];
+	GdaHolder *param_members[SDB_QUERY_CHAIN_MAX];
+
+	/* Number of members of the last member chain searched */
+	gint chain_length;
 
 	/* Aync results */
 	gboolean query_queued;
@@ -336,6 +351,150 @@ sdb_query_reset (SymbolDBQuery *query)
 	query->priv->stmt = NULL;
 	g_free (query->priv->sql_stmt);
 	query->priv->sql_stmt = NULL;
+
+	if (query->priv->stmt_trigram)
+		g_object_unref (query->priv->stmt_trigram);
+	query->priv->stmt_trigram = NULL;
+	g_free (query->priv->sql_stmt_trigram);
+	query->priv->sql_stmt_trigram = NULL;
+}
+
+/**
+ * sdb_query_set_pattern:
+ * @query: The query
+ * @pattern: The LIKE pattern searched.
+ *
+ * Sets the pattern parameter and decides whether the search goes through
+ * the trigram index. That's the case when the pattern starts with a
+ * wildcard, which defeats the index on symbol.name, and has a literal part
+ * at least 3 characters long. Trigrams are taken at the beginning, the
+ * middle and the end of the longest literal part, lower cased like the
+ * ones stored by the insert_symbol_name_trg trigger. As only ASCII letters
+ * are lower cased on both sides, the index gives the same results as the
+ * plain LIKE, case sensitive or not.
+ */
+static void
+sdb_query_set_pattern (SymbolDBQuery *query, const gchar *pattern)
+{
+	SymbolDBQueryPriv *priv = query->priv;
+	const gchar *literal = NULL;
+	glong literal_len = 0;
+	const gchar *start;
+	const gchar *p;
+	glong len;
+	gint i;
+	GValue v = {0};
+
+	SDB_PARAM_SET_STATIC_STRING (priv->param_pattern, pattern);
+	priv->use_trigrams = FALSE;
+
+	if (pattern == NULL || (*pattern != '%' && *pattern != '_'))
+		return;
+
+	/* Find the longest part without any wildcard */
+	start = pattern;
+	len = 0;
+	for (p = pattern;; p = g_utf8_next_char (p))
+	{
+		if (*p == '%' || *p == '_' || *p == '\0')
+		{
+			if (len > literal_len)
+			{
+				literal = start;
+				literal_len = len;
+			}
+			if (*p == '\0')
+				break;
+			start = g_utf8_next_char (p);
+			len = 0;
+		}
+		else
+		{
+			len++;
+		}
+	}
+
+	if (literal_len < 3)
+		return;
+
+	for (i = 0; i < SDB_QUERY_TRIGRAMS; i++)
+	{
+		const gchar *trigram;
+		const gchar *trigram_end;
+		gchar *lower;
+
+		trigram = g_utf8_offset_to_pointer (literal,
+		                                    (literal_len - 3) * i / (SDB_QUERY_TRIGRAMS - 1));
+		trigram_end = g_utf8_offset_to_pointer (trigram, 3);
+		lower = g_ascii_strdown (trigram, trigram_end - trigram);
+		SDB_PARAM_TAKE_STRING (priv->param_trigrams[i], lower);
+	}
+	priv->use_trigrams = TRUE;
+}
+
+/**
+ * sdb_query_build_chain_condition:
+ * @length: Number of members of the chain
+ *
+ * Builds the condition selecting the container reached from the symbol
+ * 'symbolid' through @length members. Each member is searched in the scope
+ * of the previous container, and the next container is the scope named
+ * after the type of the member, or the one a typedef of that name points to.
+ * Types are known by their bare name only, so when several containers have
+ * that name the one nested in the previous container is preferred, then one
+ * sitting next to it in the same scope, then a global one.
+ *
+ * Returns: A newly allocated SQL condition.
+ */
+static gchar*
+sdb_query_build_chain_condition (gint length)
+{
+	GString *tables;
+	GString *where;
+	GString *order;
+	gchar *condition;
+	gint i;
+
+	tables = g_string_new ("symbol c0");
+	where = g_string_new ("c0.symbol_id = ## /* name:'symbolid' type:gint */ ");
+	order = g_string_new (NULL);
+	for (i = 1; i <= length; i++)
+	{
+		g_string_append_printf (tables, ", symbol m%d, symbol c%d", i, i);
+		g_string_append_printf (order,
+			"%sCASE \
+				WHEN c%d.scope_id = c%d.scope_definition_id THEN 0 \
+				WHEN c%d.scope_id = c%d.scope_id THEN 1 \
+				WHEN c%d.scope_id <= 0 THEN 2 \
+				ELSE 3 \
+			 END ",
+			i > 1 ? ", " : "", i, i - 1, i, i - 1, i);
+		g_string_append_printf (where,
+			"AND m%d.scope_id = c%d.scope_definition_id \
+			 AND m%d.name = ## /* name:'member%d' type:gchararray */ \
+			 AND m%d.kind_id IN \
+			 ( \
+				SELECT sym_kind_id FROM sym_kind \
+				WHERE kind_name IN ('member', 'variable', 'field') \
+			 ) \
+			 AND c%d.scope_definition_id > 0 \
+			 AND (c%d.name = m%d.type_name OR c%d.scope_definition_id IN \
+			 ( \
+				SELECT td.scope_id FROM symbol td \
+				JOIN sym_kind tk ON td.kind_id = tk.sym_kind_id \
+				WHERE td.name = m%d.type_name AND tk.kind_name = 'typedef' \
+			 )) ",
+			i, i - 1, i, i - 1, i, i, i, i, i, i);
+	}
+
+	condition = g_strdup_printf ("(symbol.symbol_id = \
+		( \
+			SELECT c%d.symbol_id FROM %s WHERE %s ORDER BY %s LIMIT 1 \
+		)) ", length, tables->str, where->str, order->str);
+	g_string_free (tables, TRUE);
+	g_string_free (where, TRUE);
+	g_string_free (order, TRUE);
+	return condition;
 }
 
 /**
@@ -351,7 +510,10 @@ static void
 sdb_query_update (SymbolDBQuery *query)
 {
 	const gchar *condition;
+	gchar *chain_condition = NULL;
+	gboolean has_pattern = FALSE;
 	GString *sql;
+	GString *sql_tail;
 	SymbolDBQueryPriv *priv;
 
 	g_return_if_fail (SYMBOL_DB_IS_QUERY (query));
@@ -362,6 +524,7 @@ sdb_query_update (SymbolDBQuery *query)
 	{
 		case IANJUTA_SYMBOL_QUERY_SEARCH:
 			condition = " (symbol.name LIKE ## /* name:'pattern' type:gchararray */) ";
+			has_pattern = TRUE;
 			break;
 		case IANJUTA_SYMBOL_QUERY_SEARCH_ALL:
 			condition = "1 = 1 ";
@@ -377,6 +540,7 @@ sdb_query_update (SymbolDBQuery *query)
 					) \
 				) ";
 			sdb_query_add_field (query, IANJUTA_SYMBOL_FIELD_FILE_PATH);
+			has_pattern = TRUE;
 			break;
 		case IANJUTA_SYMBOL_QUERY_SEARCH_IN_SCOPE:
 			condition = " \
@@ -387,6 +551,7 @@ sdb_query_update (SymbolDBQuery *query)
 						FROM symbol \
 						WHERE symbol_id = ## /* name:'symbolid' type:gint */ \
 					)) ";
+			has_pattern = TRUE;
 			break;
 		case IANJUTA_SYMBOL_QUERY_SEARCH_ID:
 			condition = "(symbol.symbol_id = ## /* name:'symbolid' type:gint */)";
@@ -439,6 +604,10 @@ sdb_query_update (SymbolDBQuery *query)
 			sdb_query_add_field (query, IANJUTA_SYMBOL_FIELD_FILE_PATH);
 			g_object_set (query, "limit", 1, NULL);
 			break;
+		case IANJUTA_SYMBOL_QUERY_SEARCH_MEMBER_CHAIN:
+			chain_condition = sdb_query_build_chain_condition (priv->chain_length);
+			condition = chain_condition;
+			break;
 		default:
 			g_warning ("Invalid query kind");
 			g_warn_if_reached ();
@@ -447,15 +616,17 @@ sdb_query_update (SymbolDBQuery *query)
 
 	/* Build SQL statement */
 	sql = g_string_new_len ("", 1024);
+	sql_tail = g_string_new_len ("", 1024);
 
 	/* Add head of the SQL statement */
 	sdb_query_build_sql_head (query, sql);
 
 	/* Add condition of the SQL statement */
-	g_string_append (sql, condition);
+	g_string_append (sql_tail, condition);
+	g_free (chain_condition);
 
 	/* Add symbol type filters of the SQL statement */
-	sdb_query_build_sql_kind_filter (query, sql);
+	sdb_query_build_sql_kind_filter (query, sql_tail);
 		
 	/* Add filter for file scope */
 	switch (priv->file_scope)
@@ -463,10 +634,10 @@ sdb_query_update (SymbolDBQuery *query)
 		case IANJUTA_SYMBOL_QUERY_SEARCH_FS_IGNORE:
 			break;
 		case IANJUTA_SYMBOL_QUERY_SEARCH_FS_PRIVATE:
-			g_string_append (sql, "AND (symbol.is_file_scope = 1) ");
+			g_string_append (sql_tail, "AND (symbol.is_file_scope = 1) ");
 			break;
 		case IANJUTA_SYMBOL_QUERY_SEARCH_FS_PUBLIC:
-			g_string_append (sql, "AND (symbol.is_file_scope = 0) ");
+			g_string_append (sql_tail, "AND (symbol.is_file_scope = 0) ");
 			break;
 		default:
 			g_warn_if_reached ();
@@ -474,15 +645,57 @@ sdb_query_update (SymbolDBQuery *query)
 
 	/* Group by clause */
 	if (priv->group_by != IANJUTA_SYMBOL_FIELD_END)
-		g_string_append_printf (sql, "GROUP BY %s ", field_specs[priv->group_by].column);
+		g_string_append_printf (sql_tail, "GROUP BY %s ", field_specs[priv->group_by].column);
 
 	/* Order by clause */
 	if (priv->order_by != IANJUTA_SYMBOL_FIELD_END)
-		g_string_append_printf (sql, "ORDER BY %s ", field_specs[priv->order_by].column);
+		g_string_append_printf (sql_tail, "ORDER BY %s ", field_specs[priv->order_by].column);
 	
 	/* Add tail of the SQL statement */
-	g_string_append (sql, "LIMIT ## /* name:'limit' type:gint */ ");
-	g_string_append (sql, "OFFSET ## /* name:'offset' type:gint */ ");
+	g_string_append (sql_tail, "LIMIT ## /* name:'limit' type:gint */ ");
+	g_string_append (sql_tail, "OFFSET ## /* name:'offset' type:gint */ ");
+
+	/* Pattern searches get a second statement, selecting first the names
+	 * having all the trigrams of the pattern. The LIKE condition is kept
+	 * to filter out the false positives. Names too long to have all their
+	 * trigrams stored have the empty trigram and are always selected.
+	 */
+	g_free (priv->sql_stmt_trigram);
+	priv->sql_stmt_trigram = NULL;
+	if (priv->stmt_trigram)
+		g_object_unref (priv->stmt_trigram);
+	priv->stmt_trigram = NULL;
+	if (has_pattern)
+	{
+		GString *sql_trigram;
+
+		sql_trigram = g_string_new (sql->str);
+		g_string_append (sql_trigram, 
+			"(symbol.name IN \
+			( \
+				SELECT symbol_name.name \
+				FROM symbol_name \
+				WHERE symbol_name.name_id IN \
+				( \
+					SELECT name_id FROM symbol_name_trigram \
+					WHERE trigram = ## /* name:'trigram0' type:gchararray */ \
+					INTERSECT \
+					SELECT name_id FROM symbol_name_trigram \
+					WHERE trigram = ## /* name:'trigram1' type:gchararray */ \
+					INTERSECT \
+					SELECT name_id FROM symbol_name_trigram \
+					WHERE trigram = ## /* name:'trigram2' type:gchararray */ \
+					UNION \
+					SELECT name_id FROM symbol_name_trigram \
+					WHERE trigram = '' \
+				) \
+			)) AND ");
+		g_string_append (sql_trigram, sql_tail->str);
+		priv->sql_stmt_trigram = g_string_free (sql_trigram, FALSE);
+	}
+
+	g_string_append (sql, sql_tail->str);
+	g_string_free (sql_tail, TRUE);
 
 	/* Prepare statement */
 	g_free (priv->sql_stmt);
@@ -494,7 +707,12 @@ sdb_query_update (SymbolDBQuery *query)
 	 * otherwise compile it now.
 	 */
 	if (symbol_db_engine_is_connected (priv->dbe_selected))
+	{
 		priv->stmt = symbol_db_engine_get_statement (priv->dbe_selected, sql->str);
+		if (priv->sql_stmt_trigram)
+			priv->stmt_trigram = symbol_db_engine_get_statement (priv->dbe_selected,
+			                                                     priv->sql_stmt_trigram);
+	}
 	else
 		priv->stmt = NULL;
 	g_string_free (sql, FALSE);
@@ -515,6 +733,7 @@ static SymbolDBQueryResult*
 sdb_query_execute_real (SymbolDBQuery *query)
 {
 	GdaDataModel *data_model;
+	GdaStatement *stmt;
 	SymbolDBQueryPriv *priv = query->priv;
 
 	if (!symbol_db_engine_is_connected (priv->dbe_selected))
@@ -530,8 +749,19 @@ sdb_query_execute_real (SymbolDBQuery *query)
 	else if (!priv->stmt)
 		priv->stmt = symbol_db_engine_get_statement (priv->dbe_selected,
 		                                             priv->sql_stmt);
+
+	stmt = priv->stmt;
+	if (priv->use_trigrams && priv->sql_stmt_trigram)
+	{
+		if (!priv->stmt_trigram)
+			priv->stmt_trigram = 
+				symbol_db_engine_get_statement (priv->dbe_selected,
+				                                priv->sql_stmt_trigram);
+		if (priv->stmt_trigram)
+			stmt = priv->stmt_trigram;
+	}
 	data_model = symbol_db_engine_execute_select (priv->dbe_selected,
-	                                              priv->stmt,
+	                                              stmt,
 	                                              priv->params);
 	
 	if (!data_model) return GINT_TO_POINTER (-1);
@@ -648,6 +878,12 @@ on_sdb_query_dbe_connected (SymbolDBEngine *dbe, SymbolDBQuery *query)
 			symbol_db_engine_get_statement (query->priv->dbe_selected,
 			                                query->priv->sql_stmt);
 	}
+	if (!query->priv->stmt_trigram && query->priv->sql_stmt_trigram)
+	{
+		query->priv->stmt_trigram =
+			symbol_db_engine_get_statement (query->priv->dbe_selected,
+			                                query->priv->sql_stmt_trigram);
+	}
 }
 
 static void
@@ -734,6 +970,7 @@ sdb_query_init (SymbolDBQuery *query)
 	SymbolDBQueryPriv *priv;
 	GdaHolder *param;
 	GSList *param_holders = NULL;
+	gint i;
 	
 	priv = query->priv = SYMBOL_DB_QUERY_GET_PRIVATE(query);
 
@@ -764,6 +1001,23 @@ sdb_query_init (SymbolDBQuery *query)
 	param = priv->param_file_line = gda_holder_new_int ("fileline", 0);
 	param_holders = g_slist_prepend (param_holders, param);
 
+	for (i = 0; i < SDB_QUERY_TRIGRAMS; i++)
+	{
+		gchar *name = g_strdup_printf ("trigram%d", i);
+		param = priv->param_trigrams[i] = gda_holder_new_string (name, "");
+		param_holders = g_slist_prepend (param_holders, param);
+		g_free (name);
+	}
+
+	for (i = 0; i < SDB_QUERY_CHAIN_MAX; i++)
+	{
+		gchar *name = g_strdup_printf ("member%d", i);
+		param = priv->param_members[i] = gda_holder_new_string (name, "");
+		param_holders = g_slist_prepend (param_holders, param);
+		g_free (name);
+	}
+	priv->chain_length = 1;
+
 	priv->params = gda_set_new (param_holders);
 	g_slist_free (param_holders);
 
@@ -811,6 +1065,11 @@ sdb_query_dispose (GObject *object)
 		g_object_unref (priv->stmt);
 		priv->stmt = NULL;
 	}
+	if (priv->stmt_trigram)
+	{
+		g_object_unref (priv->stmt_trigram);
+		priv->stmt_trigram = NULL;
+	}
 	if (priv->params)
 	{
 		g_object_unref (priv->params);
@@ -836,6 +1095,7 @@ sdb_query_finalize (GObject *object)
 
 	priv = SYMBOL_DB_QUERY (object)->priv;
 	g_free (priv->sql_stmt);
+	g_free (priv->sql_stmt_trigram);
 	G_OBJECT_CLASS (sdb_query_parent_class)->finalize (object);
 }
 
@@ -1189,7 +1449,7 @@ sdb_query_search (IAnjutaSymbolQuery *query, const gchar *search_string,
 {
 	SDB_QUERY_SEARCH_HEADER;
 	g_return_val_if_fail (priv->name == IANJUTA_SYMBOL_QUERY_SEARCH, NULL);
-	SDB_PARAM_SET_STATIC_STRING (priv->param_pattern, search_string);
+	sdb_query_set_pattern (SYMBOL_DB_QUERY (query), search_string);
 	return sdb_query_execute (SYMBOL_DB_QUERY (query));
 }
 
@@ -1213,7 +1473,7 @@ sdb_query_search_file (IAnjutaSymbolQuery *query, const gchar *search_string,
 	abs_file_path = g_file_get_path ((GFile*)file);
 	rel_file_path = symbol_db_util_get_file_db_path (priv->dbe_selected, abs_file_path);
 
-	SDB_PARAM_SET_STATIC_STRING (priv->param_pattern, search_string);
+	sdb_query_set_pattern (SYMBOL_DB_QUERY (query), search_string);
 	SDB_PARAM_SET_STATIC_STRING (priv->param_file_path, rel_file_path);
 	g_free (abs_file_path);
 	return sdb_query_execute (SYMBOL_DB_QUERY (query));
@@ -1225,7 +1485,7 @@ sdb_query_search_in_scope (IAnjutaSymbolQuery *query, const gchar *search_string
 {
 	SDB_QUERY_SEARCH_HEADER;
 	g_return_val_if_fail (priv->name == IANJUTA_SYMBOL_QUERY_SEARCH_IN_SCOPE, NULL);
-	SDB_PARAM_SET_STATIC_STRING (priv->param_pattern, search_string);
+	sdb_query_set_pattern (SYMBOL_DB_QUERY (query), search_string);
 	SDB_PARAM_SET_INT (priv->param_id, ianjuta_symbol_get_int (scope, IANJUTA_SYMBOL_FIELD_ID, NULL));
 	return sdb_query_execute (SYMBOL_DB_QUERY (query));
 }
@@ -1309,6 +1569,34 @@ sdb_query_search_parent_scope_file (IAnjutaSymbolQuery *query, IAnjutaSymbol *sy
 	return sdb_query_execute (SYMBOL_DB_QUERY (query));
 }
 
+static IAnjutaIterable*
+sdb_query_search_member_chain (IAnjutaSymbolQuery *query, IAnjutaSymbol *scope,
+                               GList *members, GError **error)
+{
+	GList *node;
+	gint length;
+	gint i;
+	SDB_QUERY_SEARCH_HEADER;
+	g_return_val_if_fail (priv->name == IANJUTA_SYMBOL_QUERY_SEARCH_MEMBER_CHAIN, NULL);
+
+	length = g_list_length (members);
+	g_return_val_if_fail (length > 0 && length <= SDB_QUERY_CHAIN_MAX, NULL);
+
+	/* The statement depends on the chain length */
+	if (length != priv->chain_length)
+	{
+		priv->chain_length = length;
+		sdb_query_reset (SYMBOL_DB_QUERY (query));
+	}
+
+	for (node = members, i = 0; node != NULL; node = g_list_next (node), i++)
+	{
+		SDB_PARAM_SET_STRING (priv->param_members[i], node->data);
+	}
+	SDB_PARAM_SET_INT (priv->param_id, ianjuta_symbol_get_int (scope, IANJUTA_SYMBOL_FIELD_ID, NULL));
+	return sdb_query_execute (SYMBOL_DB_QUERY (query));
+}
+
 static void
 ianjuta_symbol_query_iface_init (IAnjutaSymbolQueryIface *iface)
 {
@@ -1331,6 +1619,7 @@ ianjuta_symbol_query_iface_init (IAnjutaSymbolQueryIface *iface)
 	iface->search_scope = sdb_query_search_scope;
 	iface->search_parent_scope = sdb_query_search_parent_scope;
 	iface->search_parent_scope_file = sdb_query_search_parent_scope_file;
+	iface->search_member_chain = sdb_query_search_member_chain;
 }
 
 SymbolDBQuery *
@@ -44,11 +44,15 @@ on_treeview_row_activated (GtkTreeView *view, GtkTreePath *arg1,
 	if (!gtk_tree_selection_get_selected (selection, &model, &iter))
 	    return;
 
+	/* The row can be still loading in background */
+	if (SYMBOL_DB_IS_MODEL (model))
+		symbol_db_model_load_row (SYMBOL_DB_MODEL (model), &iter);
 	gtk_tree_model_get (model, &iter,
 	                    SYMBOL_DB_MODEL_PROJECT_COL_FILE, &filename,
 	                    SYMBOL_DB_MODEL_PROJECT_COL_LINE, &line,
 	                    -1);
-	g_return_if_fail (filename != NULL);
+	if (filename == NULL)
+		return;
 
 	docman = anjuta_shell_get_interface (shell, IAnjutaDocumentManager,
 	                                     NULL);
@@ -82,9 +86,12 @@ on_treeview_row_expanded (GtkTreeView *view, GtkTreeIter *iter,
 		g_object_get_data (G_OBJECT (view), "__expanded_nodes__");
 
 	model = gtk_tree_view_get_model (view);
+	if (SYMBOL_DB_IS_MODEL (model))
+		symbol_db_model_load_row (SYMBOL_DB_MODEL (model), iter);
 	gtk_tree_model_get (model, iter, SYMBOL_DB_MODEL_PROJECT_COL_LABEL,
 	                    &symbol_name, -1);
-	g_hash_table_insert (expanded_nodes, symbol_name, GINT_TO_POINTER (1));
+	if (symbol_name)
+		g_hash_table_insert (expanded_nodes, symbol_name, GINT_TO_POINTER (1));
 }
 
 static void
@@ -98,9 +105,12 @@ on_treeview_row_collapsed (GtkTreeView *view, GtkTreeIter *iter,
 		g_object_get_data (G_OBJECT (view), "__expanded_nodes__");
 
 	model = gtk_tree_view_get_model (view);
+	if (SYMBOL_DB_IS_MODEL (model))
+		symbol_db_model_load_row (SYMBOL_DB_MODEL (model), iter);
 	gtk_tree_model_get (model, iter, SYMBOL_DB_MODEL_PROJECT_COL_LABEL,
 	                    &symbol_name, -1);
-	g_hash_table_remove (expanded_nodes, symbol_name);
+	if (symbol_name)
+		g_hash_table_remove (expanded_nodes, symbol_name);
 	g_free (symbol_name);
 }
 
@@ -117,7 +127,7 @@ on_treeview_has_child_toggled (GtkTreeModel *model,
 	
 	gtk_tree_model_get (model, iter, SYMBOL_DB_MODEL_PROJECT_COL_LABEL,
 	                    &symbol_name, -1);
-	if (g_hash_table_lookup (expanded_nodes, symbol_name))
+	if (symbol_name && g_hash_table_lookup (expanded_nodes, symbol_name))
 		gtk_tree_view_expand_row (view, path, FALSE);
 	g_free (symbol_name);
 }
@@ -130,7 +140,12 @@ symbol_db_view_search_equal_func (GtkTreeModel *model, gint column,
 	gchar *pattern, *str;
 	gboolean res;
 
+	if (SYMBOL_DB_IS_MODEL (model))
+		symbol_db_model_load_row (SYMBOL_DB_MODEL (model), iter);
 	gtk_tree_model_get (model, iter, column, &str, -1);
+	/* Not matching, the row can still be empty */
+	if (str == NULL)
+		return TRUE;
 	
 	pattern = g_strdup_printf (".*%s.*", key);
 	res = g_regex_match_simple (pattern, str, G_REGEX_CASELESS, 0);
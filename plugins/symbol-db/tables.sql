@@ -22,7 +22,11 @@ CREATE TABLE file (file_id integer PRIMARY KEY AUTOINCREMENT,
                    file_path text not null unique,
                    prj_id integer REFERENCES project (projec_id),
                    lang_id integer REFERENCES language (language_id),
-                   analyse_time date
+                   analyse_time date,
+                   file_size integer,
+                   file_mtime integer,
+                   file_inode integer,
+                   file_hash text
                    );
 
 DROP TABLE IF EXISTS language;
@@ -80,6 +84,48 @@ DROP TABLE IF EXISTS version;
 CREATE TABLE version (sdb_version numeric PRIMARY KEY);
 
 
+DROP TABLE IF EXISTS symbol_name;
+CREATE TABLE symbol_name (name_id integer PRIMARY KEY AUTOINCREMENT,
+                          name text not null unique
+                          );
+
+-- lower case trigrams of each symbol name, used for substring searches.
+-- Both the trigrams and the query patterns are lower cased on ASCII letters
+-- only, like the case insensitive LIKE does, so the index works whatever the
+-- case_sensitive_like setting.
+DROP TABLE IF EXISTS symbol_name_trigram;
+CREATE TABLE symbol_name_trigram (trigram text not null,
+                                  name_id integer not null REFERENCES symbol_name (name_id),
+                                  PRIMARY KEY (trigram, name_id)
+                                  );
+
+-- positions of the trigrams in a name. Names longer than 258 characters get
+-- also an empty trigram, which makes the searches always check them with LIKE
+DROP TABLE IF EXISTS trigram_position;
+CREATE TABLE trigram_position (position integer PRIMARY KEY);
+
+DROP TABLE IF EXISTS __tmp_hex;
+CREATE TABLE __tmp_hex (digit integer PRIMARY KEY);
+INSERT INTO __tmp_hex VALUES (0);
+INSERT INTO __tmp_hex VALUES (1);
+INSERT INTO __tmp_hex VALUES (2);
+INSERT INTO __tmp_hex VALUES (3);
+INSERT INTO __tmp_hex VALUES (4);
+INSERT INTO __tmp_hex VALUES (5);
+INSERT INTO __tmp_hex VALUES (6);
+INSERT INTO __tmp_hex VALUES (7);
+INSERT INTO __tmp_hex VALUES (8);
+INSERT INTO __tmp_hex VALUES (9);
+INSERT INTO __tmp_hex VALUES (10);
+INSERT INTO __tmp_hex VALUES (11);
+INSERT INTO __tmp_hex VALUES (12);
+INSERT INTO __tmp_hex VALUES (13);
+INSERT INTO __tmp_hex VALUES (14);
+INSERT INTO __tmp_hex VALUES (15);
+INSERT INTO trigram_position (position) 
+	SELECT high.digit * 16 + low.digit + 1 FROM __tmp_hex AS high, __tmp_hex AS low;
+DROP TABLE __tmp_hex;
+
 DROP TABLE IF EXISTS __tmp_removed;
 CREATE TABLE __tmp_removed (tmp_removed_id integer PRIMARY KEY AUTOINCREMENT,
                             symbol_removed_id integer not null
@@ -97,6 +143,12 @@ CREATE INDEX symbol_idx_2 ON symbol (scope_id);
 DROP INDEX IF EXISTS symbol_idx_3;
 CREATE INDEX symbol_idx_3 ON symbol (type_type, type_name);
 
+DROP INDEX IF EXISTS symbol_idx_4;
+CREATE INDEX symbol_idx_4 ON symbol (file_defined_id, file_position);
+
+DROP INDEX IF EXISTS symbol_name_trigram_idx_1;
+CREATE INDEX symbol_name_trigram_idx_1 ON symbol_name_trigram (name_id);
+
 
 DROP TRIGGER IF EXISTS delete_file_trg;
 CREATE TRIGGER delete_file_trg BEFORE DELETE ON file
@@ -112,6 +164,33 @@ BEGIN
     DELETE FROM scope WHERE scope.scope_id=old.scope_definition_id;
     UPDATE symbol SET scope_id='-1' WHERE symbol.scope_id=old.scope_definition_id AND symbol.scope_id > 0;
     INSERT INTO __tmp_removed (symbol_removed_id) VALUES (old.symbol_id);
+    DELETE FROM symbol_name WHERE symbol_name.name = old.name AND NOT EXISTS 
+        (SELECT 1 FROM symbol WHERE symbol.name = old.name AND symbol.symbol_id != old.symbol_id);
+END;
+
+DROP TRIGGER IF EXISTS insert_symbol_trg;
+CREATE TRIGGER insert_symbol_trg AFTER INSERT ON symbol
+FOR EACH ROW
+BEGIN
+    INSERT OR IGNORE INTO symbol_name (name) VALUES (new.name);
+END;
+
+DROP TRIGGER IF EXISTS insert_symbol_name_trg;
+CREATE TRIGGER insert_symbol_name_trg AFTER INSERT ON symbol_name
+FOR EACH ROW
+BEGIN
+    INSERT OR IGNORE INTO symbol_name_trigram (trigram, name_id)
+        SELECT lower (substr (new.name, position, 3)), new.name_id FROM trigram_position
+        WHERE position <= length (new.name) - 2;
+    INSERT OR IGNORE INTO symbol_name_trigram (trigram, name_id)
+        SELECT '', new.name_id WHERE length (new.name) > 258;
+END;
+
+DROP TRIGGER IF EXISTS delete_symbol_name_trg;
+CREATE TRIGGER delete_symbol_name_trg BEFORE DELETE ON symbol_name
+FOR EACH ROW
+BEGIN
+    DELETE FROM symbol_name_trigram WHERE name_id = old.name_id;
 END;
 
 PRAGMA page_size = 32768;